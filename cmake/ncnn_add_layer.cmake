@@ -178,6 +178,9 @@ macro(ncnn_add_layer class)
             if(NCNN_RUNTIME_CPU AND NCNN_AVX512FP16)
                 ncnn_add_arch_opt_source(${class} avx512fp16 "/arch:AVX512 /D__SSSE3__ /D__SSE4_1__ /D__FMA__ /D__F16C__ /D__AVX512FP16__")
             endif()
+            if(NCNN_RUNTIME_CPU AND NCNN_AMX)
+                ncnn_add_arch_opt_source(${class} amx "/arch:AVX512 /D__SSSE3__ /D__SSE4_1__ /D__FMA__ /D__F16C__ /D__AVX512VNNI__ /D__AVX512BF16__ /D__AMX_TILE__ /D__AMX_INT8__ /D__AMX_BF16__")
+            endif()
             if(NCNN_RUNTIME_CPU AND NCNN_AVXVNNI)
                 ncnn_add_arch_opt_source(${class} avxvnni "/arch:AVX2 /D__SSSE3__ /D__SSE4_1__ /D__FMA__ /D__F16C__ /D__AVXVNNI__")
             endif()
@@ -218,6 +221,9 @@ macro(ncnn_add_layer class)
             if(NCNN_RUNTIME_CPU AND NCNN_AVX512FP16)
                 ncnn_add_arch_opt_source(${class} avx512fp16 "/arch:AVX512 -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mfma -mf16c -mavx512fp16 /D__SSSE3__ /D__SSE4_1__ /D__FMA__ /D__F16C__ /D__AVX512FP16__")
             endif()
+            if(NCNN_RUNTIME_CPU AND NCNN_AMX)
+                ncnn_add_arch_opt_source(${class} amx "/arch:AVX512 -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mfma -mf16c -mavx512vnni -mavx512bf16 -mamx-tile -mamx-int8 -mamx-bf16 /D__SSSE3__ /D__SSE4_1__ /D__FMA__ /D__F16C__ /D__AVX512VNNI__ /D__AVX512BF16__ /D__AMX_TILE__ /D__AMX_INT8__ /D__AMX_BF16__")
+            endif()
             if(NCNN_RUNTIME_CPU AND NCNN_AVXVNNI)
                 ncnn_add_arch_opt_source(${class} avxvnni "/arch:AVX2 -mfma -mf16c -mavxvnni /D__SSSE3__ /D__SSE4_1__ /D__FMA__ /D__F16C__ /D__AVXVNNI__")
             endif()
@@ -258,6 +264,9 @@ macro(ncnn_add_layer class)
             if(NCNN_RUNTIME_CPU AND NCNN_AVX512FP16)
                 ncnn_add_arch_opt_source(${class} avx512fp16 "-mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mfma -mf16c -mavx512fp16")
             endif()
+            if(NCNN_RUNTIME_CPU AND NCNN_AMX)
+                ncnn_add_arch_opt_source(${class} amx "-mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mfma -mf16c -mavx512vnni -mavx512bf16 -mamx-tile -mamx-int8 -mamx-bf16")
+            endif()
             if(NCNN_RUNTIME_CPU AND NCNN_AVXVNNI)
                 ncnn_add_arch_opt_source(${class} avxvnni "-mavx2 -mfma -mf16c -mavxvnni")
             endif()
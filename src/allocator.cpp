@@ -346,6 +346,918 @@ void UnlockedPoolAllocator::fastFree(void* ptr)
     ncnn::fastFree(ptr);
 }
 
+// size classes are 64 bytes and then four steps per power of two
+// so that a budget wastes at most 25% of its space
+#define NCNN_SIZE_CLASS_MIN_SHIFT 6
+#define NCNN_SIZE_CLASS_MAX_SHIFT 32
+#define NCNN_SIZE_CLASS_COUNT (1 + (NCNN_SIZE_CLASS_MAX_SHIFT - NCNN_SIZE_CLASS_MIN_SHIFT) * 4)
+#define NCNN_SIZE_CLASS_MAGIC 0x5a5a5c6e
+
+// the counters are written by their owner thread and read by any thread
+static NCNN_FORCEINLINE size_t size_class_xadd(size_t* addr, size_t delta)
+{
+#if NCNN_THREADS && defined __GNUC__
+    return __atomic_fetch_add(addr, delta, __ATOMIC_ACQ_REL);
+#elif NCNN_THREADS && defined _WIN64
+    return (size_t)InterlockedExchangeAdd64((volatile LONG64*)addr, (LONG64)delta);
+#elif NCNN_THREADS && defined _WIN32
+    return (size_t)InterlockedExchangeAdd((volatile LONG*)addr, (LONG)delta);
+#else
+    size_t tmp = *addr;
+    *addr += delta;
+    return tmp;
+#endif
+}
+
+static NCNN_FORCEINLINE size_t size_class_load(size_t* addr)
+{
+    return size_class_xadd(addr, 0);
+}
+
+static int size_class_index(size_t size)
+{
+    if (size <= ((size_t)1 << NCNN_SIZE_CLASS_MIN_SHIFT))
+        return 0;
+
+    const size_t s = size - 1;
+
+    int k = NCNN_SIZE_CLASS_MIN_SHIFT;
+    while (k < (int)sizeof(size_t) * 8 - 1 && (s >> (k + 1)) != 0)
+        k++;
+
+    if (k >= NCNN_SIZE_CLASS_MAX_SHIFT || k >= (int)sizeof(size_t) * 8 - 1)
+        return -1;
+
+    const size_t base = (size_t)1 << k;
+    const int j = (int)((s - base) >> (k - 2));
+
+    return 1 + (k - NCNN_SIZE_CLASS_MIN_SHIFT) * 4 + j;
+}
+
+static size_t size_class_space(int index)
+{
+    if (index == 0)
+        return (size_t)1 << NCNN_SIZE_CLASS_MIN_SHIFT;
+
+    const int k = NCNN_SIZE_CLASS_MIN_SHIFT + (index - 1) / 4;
+    const int j = (index - 1) % 4;
+
+    const size_t base = (size_t)1 << k;
+    return base + (j + 1) * (base >> 2);
+}
+
+// stored in front of every payout, keeps the payout aligned
+struct SizeClassHeader
+{
+    int magic;
+    int index;
+    size_t space;
+};
+
+class SizeClassPoolAllocatorPrivate
+{
+public:
+    // budgets owned by one thread, no lock needed
+    // the counters are atomic for the statistics read from other threads
+    struct ThreadCache
+    {
+        std::vector<void*> budgets[NCNN_SIZE_CLASS_COUNT];
+        size_t hit;
+        size_t miss;
+        size_t bytes_held;
+        // payouts minus returns on this thread, wraps around when freed elsewhere
+        size_t payouts;
+        // the allocator this cache belongs to, null once the allocator is destroyed
+        SizeClassPoolAllocatorPrivate* owner;
+    };
+
+    ThreadCache* get_thread_cache();
+
+    // move the budgets of an exiting thread to the shared bins and drop its cache
+    // called with g_size_class_caches_lock held
+    void retire_thread_cache(ThreadCache* tc);
+
+    void* new_payout(int index, size_t space);
+    void free_payout(void* raw);
+
+    // reserve space in the allocator wide byte budget
+    bool reserve_bytes(size_t space);
+
+    size_t size_drop_threshold;
+    size_t thread_budget_bytes;
+    size_t total_budget_bytes;
+
+    // bytes kept in all thread caches and shared bins
+    size_t total_bytes_held;
+
+    // every live thread cache, guarded by g_size_class_caches_lock
+    std::vector<ThreadCache*> caches;
+
+    // counters of the thread caches dropped at thread exit
+    size_t retired_hit;
+    size_t retired_miss;
+    size_t retired_payouts;
+
+    // shared budgets for each size class
+    Mutex shared_locks[NCNN_SIZE_CLASS_COUNT];
+    std::vector<void*> shared_budgets[NCNN_SIZE_CLASS_COUNT];
+    size_t shared_bytes_held[NCNN_SIZE_CLASS_COUNT];
+};
+
+// guards the owner of every thread cache and the caches of every allocator
+static Mutex g_size_class_caches_lock;
+
+// one thread local slot shared by all size class pool allocators
+// it holds the caches of this thread, one per allocator used here
+// they are returned to their allocators when the thread exits
+#if NCNN_THREADS
+static void size_class_thread_exit(void* ptr);
+
+#if defined _WIN32
+class SizeClassThreadLocalStorage
+{
+public:
+    SizeClassThreadLocalStorage()
+    {
+        key = FlsAlloc(size_class_fls_callback);
+    }
+    ~SizeClassThreadLocalStorage()
+    {
+        FlsFree(key);
+    }
+    void set(void* value)
+    {
+        FlsSetValue(key, (PVOID)value);
+    }
+    void* get()
+    {
+        return (void*)FlsGetValue(key);
+    }
+
+private:
+    static VOID WINAPI size_class_fls_callback(PVOID ptr)
+    {
+        if (ptr)
+            size_class_thread_exit((void*)ptr);
+    }
+
+    DWORD key;
+};
+#else  // defined _WIN32
+class SizeClassThreadLocalStorage
+{
+public:
+    SizeClassThreadLocalStorage()
+    {
+        pthread_key_create(&key, size_class_thread_exit);
+    }
+    ~SizeClassThreadLocalStorage()
+    {
+        pthread_key_delete(key);
+    }
+    void set(void* value)
+    {
+        pthread_setspecific(key, value);
+    }
+    void* get()
+    {
+        return pthread_getspecific(key);
+    }
+
+private:
+    pthread_key_t key;
+};
+#endif // defined _WIN32
+#else  // NCNN_THREADS
+typedef ThreadLocalStorage SizeClassThreadLocalStorage;
+#endif // NCNN_THREADS
+
+static SizeClassThreadLocalStorage g_size_class_tls;
+
+#if NCNN_THREADS
+static void size_class_thread_exit(void* ptr)
+{
+    std::vector<SizeClassPoolAllocatorPrivate::ThreadCache*>* thread_caches = (std::vector<SizeClassPoolAllocatorPrivate::ThreadCache*>*)ptr;
+
+    {
+        MutexLockGuard guard(g_size_class_caches_lock);
+
+        for (size_t i = 0; i < thread_caches->size(); i++)
+        {
+            SizeClassPoolAllocatorPrivate::ThreadCache* tc = (*thread_caches)[i];
+            if (tc->owner)
+                tc->owner->retire_thread_cache(tc);
+
+            delete tc;
+        }
+    }
+
+    delete thread_caches;
+}
+#endif // NCNN_THREADS
+
+SizeClassPoolAllocatorPrivate::ThreadCache* SizeClassPoolAllocatorPrivate::get_thread_cache()
+{
+    std::vector<ThreadCache*>* thread_caches = (std::vector<ThreadCache*>*)g_size_class_tls.get();
+    if (thread_caches)
+    {
+        for (size_t i = 0; i < thread_caches->size(); i++)
+        {
+            ThreadCache* tc = (*thread_caches)[i];
+            if (tc->owner == this)
+                return tc;
+        }
+    }
+    else
+    {
+        thread_caches = new std::vector<ThreadCache*>;
+        g_size_class_tls.set(thread_caches);
+    }
+
+    ThreadCache* tc = new ThreadCache;
+    tc->hit = 0;
+    tc->miss = 0;
+    tc->bytes_held = 0;
+    tc->payouts = 0;
+    tc->owner = this;
+
+    MutexLockGuard guard(g_size_class_caches_lock);
+
+    // drop the caches of destroyed allocators
+    size_t j = 0;
+    for (size_t i = 0; i < thread_caches->size(); i++)
+    {
+        ThreadCache* tci = (*thread_caches)[i];
+        if (tci->owner)
+            (*thread_caches)[j++] = tci;
+        else
+            delete tci;
+    }
+    thread_caches->resize(j);
+
+    thread_caches->push_back(tc);
+    caches.push_back(tc);
+
+    return tc;
+}
+
+void SizeClassPoolAllocatorPrivate::retire_thread_cache(ThreadCache* tc)
+{
+    for (int j = 0; j < NCNN_SIZE_CLASS_COUNT; j++)
+    {
+        std::vector<void*>& budgets = tc->budgets[j];
+        if (budgets.empty())
+            continue;
+
+        const size_t space = size_class_space(j);
+
+        MutexLockGuard guard(shared_locks[j]);
+
+        std::vector<void*>& shared = shared_budgets[j];
+        for (size_t k = 0; k < budgets.size(); k++)
+        {
+            // the bytes stay reserved when the budget moves to the shared bin
+            if (shared.size() < size_drop_threshold)
+            {
+                shared.push_back(budgets[k]);
+                shared_bytes_held[j] += space;
+            }
+            else
+            {
+                free_payout(budgets[k]);
+                size_class_xadd(&total_bytes_held, (size_t)0 - space);
+            }
+        }
+        budgets.clear();
+    }
+
+    size_class_xadd(&retired_hit, size_class_load(&tc->hit));
+    size_class_xadd(&retired_miss, size_class_load(&tc->miss));
+    size_class_xadd(&retired_payouts, size_class_load(&tc->payouts));
+
+    for (size_t i = 0; i < caches.size(); i++)
+    {
+        if (caches[i] == tc)
+        {
+            caches.erase(caches.begin() + i);
+            break;
+        }
+    }
+
+    tc->owner = 0;
+}
+
+void* SizeClassPoolAllocatorPrivate::new_payout(int index, size_t space)
+{
+    unsigned char* raw = (unsigned char*)ncnn::fastMalloc(space + NCNN_MALLOC_ALIGN);
+    if (!raw)
+        return 0;
+
+    SizeClassHeader* header = (SizeClassHeader*)raw;
+    header->magic = NCNN_SIZE_CLASS_MAGIC;
+    header->index = index;
+    header->space = space;
+
+    return raw;
+}
+
+void SizeClassPoolAllocatorPrivate::free_payout(void* raw)
+{
+    SizeClassHeader* header = (SizeClassHeader*)raw;
+    header->magic = 0;
+
+    ncnn::fastFree(raw);
+}
+
+bool SizeClassPoolAllocatorPrivate::reserve_bytes(size_t space)
+{
+    const size_t old = size_class_xadd(&total_bytes_held, space);
+    if (old + space <= total_budget_bytes)
+        return true;
+
+    // over budget, undo
+    size_class_xadd(&total_bytes_held, (size_t)0 - space);
+    return false;
+}
+
+SizeClassPoolAllocator::SizeClassPoolAllocator()
+    : Allocator(), d(new SizeClassPoolAllocatorPrivate)
+{
+    d->size_drop_threshold = 10;
+    d->thread_budget_bytes = (size_t)256 * 1024 * 1024;
+    d->total_budget_bytes = (size_t)1024 * 1024 * 1024;
+    d->total_bytes_held = 0;
+    d->retired_hit = 0;
+    d->retired_miss = 0;
+    d->retired_payouts = 0;
+
+    for (int i = 0; i < NCNN_SIZE_CLASS_COUNT; i++)
+    {
+        d->shared_bytes_held[i] = 0;
+    }
+}
+
+SizeClassPoolAllocator::~SizeClassPoolAllocator()
+{
+    clear();
+
+    {
+        MutexLockGuard guard(g_size_class_caches_lock);
+
+        size_t payouts = size_class_load(&d->retired_payouts);
+        for (size_t i = 0; i < d->caches.size(); i++)
+        {
+            payouts += size_class_load(&d->caches[i]->payouts);
+        }
+
+        if (payouts != 0)
+        {
+            NCNN_LOGE("FATAL ERROR! size class pool allocator destroyed too early");
+            NCNN_LOGE("%d payouts still in use", (int)payouts);
+        }
+
+        // the threads drop their caches on the next cache creation or at exit
+        for (size_t i = 0; i < d->caches.size(); i++)
+        {
+            d->caches[i]->owner = 0;
+        }
+    }
+
+    delete d;
+}
+
+SizeClassPoolAllocator::SizeClassPoolAllocator(const SizeClassPoolAllocator&)
+    : d(0)
+{
+}
+
+SizeClassPoolAllocator& SizeClassPoolAllocator::operator=(const SizeClassPoolAllocator&)
+{
+    return *this;
+}
+
+void SizeClassPoolAllocator::set_size_drop_threshold(size_t threshold)
+{
+    d->size_drop_threshold = threshold;
+}
+
+void SizeClassPoolAllocator::set_thread_budget_bytes(size_t bytes)
+{
+    d->thread_budget_bytes = bytes;
+}
+
+void SizeClassPoolAllocator::set_total_budget_bytes(size_t bytes)
+{
+    d->total_budget_bytes = bytes;
+}
+
+void SizeClassPoolAllocator::clear()
+{
+    g_size_class_caches_lock.lock();
+
+    for (size_t i = 0; i < d->caches.size(); i++)
+    {
+        SizeClassPoolAllocatorPrivate::ThreadCache* tc = d->caches[i];
+        for (int j = 0; j < NCNN_SIZE_CLASS_COUNT; j++)
+        {
+            std::vector<void*>& budgets = tc->budgets[j];
+            for (size_t k = 0; k < budgets.size(); k++)
+            {
+                d->free_payout(budgets[k]);
+            }
+            budgets.clear();
+        }
+
+        const size_t bytes = size_class_load(&tc->bytes_held);
+        size_class_xadd(&tc->bytes_held, (size_t)0 - bytes);
+        size_class_xadd(&d->total_bytes_held, (size_t)0 - bytes);
+    }
+
+    g_size_class_caches_lock.unlock();
+
+    for (int j = 0; j < NCNN_SIZE_CLASS_COUNT; j++)
+    {
+        MutexLockGuard guard(d->shared_locks[j]);
+
+        std::vector<void*>& budgets = d->shared_budgets[j];
+        for (size_t k = 0; k < budgets.size(); k++)
+        {
+            d->free_payout(budgets[k]);
+        }
+        budgets.clear();
+
+        size_class_xadd(&d->total_bytes_held, (size_t)0 - d->shared_bytes_held[j]);
+        d->shared_bytes_held[j] = 0;
+    }
+}
+
+size_t SizeClassPoolAllocator::hit_count() const
+{
+    MutexLockGuard guard(g_size_class_caches_lock);
+
+    size_t hit = size_class_load(&d->retired_hit);
+    for (size_t i = 0; i < d->caches.size(); i++)
+    {
+        hit += size_class_load(&d->caches[i]->hit);
+    }
+
+    return hit;
+}
+
+size_t SizeClassPoolAllocator::miss_count() const
+{
+    MutexLockGuard guard(g_size_class_caches_lock);
+
+    size_t miss = size_class_load(&d->retired_miss);
+    for (size_t i = 0; i < d->caches.size(); i++)
+    {
+        miss += size_class_load(&d->caches[i]->miss);
+    }
+
+    return miss;
+}
+
+size_t SizeClassPoolAllocator::bytes_held() const
+{
+    return size_class_load(&d->total_bytes_held);
+}
+
+void* SizeClassPoolAllocator::fastMalloc(size_t size)
+{
+    SizeClassPoolAllocatorPrivate::ThreadCache* tc = d->get_thread_cache();
+
+    const int index = size_class_index(size);
+    if (index == -1)
+    {
+        // too large for any size class, never kept as budget
+        size_class_xadd(&tc->miss, 1);
+        size_class_xadd(&tc->payouts, 1);
+
+        unsigned char* raw = (unsigned char*)d->new_payout(-1, size);
+        return raw ? raw + NCNN_MALLOC_ALIGN : 0;
+    }
+
+    const size_t space = size_class_space(index);
+
+    // find free budget in this thread
+    std::vector<void*>& budgets = tc->budgets[index];
+    if (!budgets.empty())
+    {
+        unsigned char* raw = (unsigned char*)budgets.back();
+        budgets.pop_back();
+
+        size_class_xadd(&tc->hit, 1);
+        size_class_xadd(&tc->bytes_held, (size_t)0 - space);
+        size_class_xadd(&d->total_bytes_held, (size_t)0 - space);
+        size_class_xadd(&tc->payouts, 1);
+
+        return raw + NCNN_MALLOC_ALIGN;
+    }
+
+    // find free budget returned by other threads
+    {
+        MutexLockGuard guard(d->shared_locks[index]);
+
+        std::vector<void*>& shared_budgets = d->shared_budgets[index];
+        if (!shared_budgets.empty())
+        {
+            unsigned char* raw = (unsigned char*)shared_budgets.back();
+            shared_budgets.pop_back();
+
+            d->shared_bytes_held[index] -= space;
+            size_class_xadd(&d->total_bytes_held, (size_t)0 - space);
+
+            size_class_xadd(&tc->hit, 1);
+            size_class_xadd(&tc->payouts, 1);
+
+            return raw + NCNN_MALLOC_ALIGN;
+        }
+    }
+
+    // new
+    size_class_xadd(&tc->miss, 1);
+    size_class_xadd(&tc->payouts, 1);
+
+    unsigned char* raw = (unsigned char*)d->new_payout(index, space);
+    return raw ? raw + NCNN_MALLOC_ALIGN : 0;
+}
+
+void SizeClassPoolAllocator::fastFree(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    unsigned char* raw = (unsigned char*)ptr - NCNN_MALLOC_ALIGN;
+    const SizeClassHeader* header = (const SizeClassHeader*)raw;
+    if (header->magic != NCNN_SIZE_CLASS_MAGIC)
+    {
+        NCNN_LOGE("FATAL ERROR! size class pool allocator get wild %p", ptr);
+        ncnn::fastFree(ptr);
+        return;
+    }
+
+    SizeClassPoolAllocatorPrivate::ThreadCache* tc = d->get_thread_cache();
+    size_class_xadd(&tc->payouts, (size_t)0 - 1);
+
+    const int index = header->index;
+    if (index == -1)
+    {
+        d->free_payout(raw);
+        return;
+    }
+
+    const size_t space = header->space;
+
+    // return to budgets in this thread
+    std::vector<void*>& budgets = tc->budgets[index];
+    if (budgets.size() < d->size_drop_threshold && size_class_load(&tc->bytes_held) + space <= d->thread_budget_bytes && d->reserve_bytes(space))
+    {
+        budgets.push_back(raw);
+        size_class_xadd(&tc->bytes_held, space);
+        return;
+    }
+
+    // share with other threads
+    {
+        MutexLockGuard guard(d->shared_locks[index]);
+
+        std::vector<void*>& shared_budgets = d->shared_budgets[index];
+        if (shared_budgets.size() < d->size_drop_threshold && d->reserve_bytes(space))
+        {
+            shared_budgets.push_back(raw);
+            d->shared_bytes_held[index] += space;
+            return;
+        }
+    }
+
+    // all budgets of this size are full or over the byte budget, return to OS
+    d->free_payout(raw);
+}
+
+class ArenaAllocatorPrivate
+{
+public:
+    struct Block
+    {
+        size_t size;
+        size_t space;
+        size_t offset;
+        // lifetime in allocation events of the recorded pass
+        size_t birth;
+        size_t death;
+    };
+
+    struct LiveBlock
+    {
+        void* ptr;
+        // index into blocks, -1 for heap memory
+        int block_index;
+        // 0 for heap memory
+        size_t space;
+    };
+
+    void plan();
+
+    // index of the first live block at or above ptr
+    size_t find_live(const void* ptr) const;
+    void insert_live(const LiveBlock& lb);
+    // whether a live arena block overlaps [ptr, ptr + space)
+    bool overlaps_live(const unsigned char* ptr, size_t space) const;
+
+    Mutex lock;
+    bool planned;
+    size_t event;
+    size_t cursor;
+    std::vector<Block> blocks;
+    // sorted by address, so frees and occupancy checks are binary searches
+    std::vector<LiveBlock> live;
+    unsigned char* arena;
+    size_t arena_size;
+};
+
+static bool compare_arena_block_space(const std::pair<size_t, int>& a, const std::pair<size_t, int>& b)
+{
+    // larger blocks first, then allocation order
+    if (a.first != b.first)
+        return a.first > b.first;
+
+    return a.second < b.second;
+}
+
+static bool compare_arena_block_offset(const ArenaAllocatorPrivate::Block* a, const ArenaAllocatorPrivate::Block* b)
+{
+    return a->offset < b->offset;
+}
+
+void ArenaAllocatorPrivate::plan()
+{
+    const int count = (int)blocks.size();
+
+    std::vector<std::pair<size_t, int> > order(count);
+    for (int i = 0; i < count; i++)
+    {
+        order[i] = std::make_pair(blocks[i].space, i);
+    }
+    std::sort(order.begin(), order.end(), compare_arena_block_space);
+
+    // greedy interval colouring
+    // place each block at the lowest offset not used by a placed block with overlapping lifetime
+    std::vector<const Block*> placed;
+    std::vector<const Block*> conflicts;
+    arena_size = 0;
+    for (int i = 0; i < count; i++)
+    {
+        Block& b = blocks[order[i].second];
+
+        conflicts.clear();
+        for (size_t j = 0; j < placed.size(); j++)
+        {
+            const Block* p = placed[j];
+            if (b.birth < p->death && p->birth < b.death)
+                conflicts.push_back(p);
+        }
+        std::sort(conflicts.begin(), conflicts.end(), compare_arena_block_offset);
+
+        size_t offset = 0;
+        for (size_t j = 0; j < conflicts.size(); j++)
+        {
+            const Block* p = conflicts[j];
+            if (offset + b.space <= p->offset)
+                break;
+
+            offset = std::max(offset, p->offset + p->space);
+        }
+
+        b.offset = offset;
+        placed.push_back(&b);
+
+        arena_size = std::max(arena_size, offset + b.space);
+    }
+
+    arena = arena_size ? (unsigned char*)ncnn::fastMalloc(arena_size) : 0;
+    planned = true;
+}
+
+size_t ArenaAllocatorPrivate::find_live(const void* ptr) const
+{
+    size_t lo = 0;
+    size_t hi = live.size();
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((const unsigned char*)live[mid].ptr < (const unsigned char*)ptr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+void ArenaAllocatorPrivate::insert_live(const LiveBlock& lb)
+{
+    live.insert(live.begin() + find_live(lb.ptr), lb);
+}
+
+bool ArenaAllocatorPrivate::overlaps_live(const unsigned char* ptr, size_t space) const
+{
+    // live arena blocks never overlap each other, so only the neighbours around ptr may overlap it
+    const size_t i = find_live(ptr);
+
+    if (i < live.size() && live[i].space && (const unsigned char*)live[i].ptr < ptr + space)
+        return true;
+
+    if (i > 0 && live[i - 1].space && ptr < (const unsigned char*)live[i - 1].ptr + live[i - 1].space)
+        return true;
+
+    return false;
+}
+
+ArenaAllocator::ArenaAllocator()
+    : Allocator(), d(new ArenaAllocatorPrivate)
+{
+    d->planned = false;
+    d->event = 0;
+    d->cursor = 0;
+    d->arena = 0;
+    d->arena_size = 0;
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    if (!d->live.empty())
+    {
+        NCNN_LOGE("FATAL ERROR! arena allocator destroyed too early");
+#if NCNN_STDIO
+        for (size_t i = 0; i < d->live.size(); i++)
+        {
+            void* ptr = d->live[i].ptr;
+            NCNN_LOGE("%p still in use", ptr);
+        }
+#endif
+    }
+
+    if (d->arena)
+    {
+        ncnn::fastFree(d->arena);
+    }
+
+    delete d;
+}
+
+ArenaAllocator::ArenaAllocator(const ArenaAllocator&)
+    : d(0)
+{
+}
+
+ArenaAllocator& ArenaAllocator::operator=(const ArenaAllocator&)
+{
+    return *this;
+}
+
+void ArenaAllocator::rewind()
+{
+    MutexLockGuard guard(d->lock);
+
+    if (!d->planned)
+    {
+        // nothing recorded yet, keep recording
+        if (d->blocks.empty())
+            return;
+
+        // blocks still alive at the end of the recorded pass live forever
+        for (size_t i = 0; i < d->blocks.size(); i++)
+        {
+            if (d->blocks[i].death == (size_t)-1)
+                d->blocks[i].death = d->event;
+        }
+
+        d->plan();
+    }
+
+    d->cursor = 0;
+}
+
+void ArenaAllocator::clear()
+{
+    MutexLockGuard guard(d->lock);
+
+    for (size_t i = 0; i < d->live.size(); i++)
+    {
+        if (d->live[i].space != 0)
+        {
+            NCNN_LOGE("arena allocator clear while %p still in use", d->live[i].ptr);
+            return;
+        }
+    }
+
+    // heap blocks outlive the plan
+    for (size_t i = 0; i < d->live.size(); i++)
+    {
+        d->live[i].block_index = -1;
+    }
+
+    if (d->arena)
+    {
+        ncnn::fastFree(d->arena);
+        d->arena = 0;
+    }
+
+    d->arena_size = 0;
+    d->blocks.clear();
+    d->planned = false;
+    d->event = 0;
+    d->cursor = 0;
+}
+
+size_t ArenaAllocator::arena_size() const
+{
+    return d->arena_size;
+}
+
+void* ArenaAllocator::fastMalloc(size_t size)
+{
+    MutexLockGuard guard(d->lock);
+
+    const size_t space = alignSize(size + NCNN_MALLOC_OVERREAD, NCNN_MALLOC_ALIGN);
+
+    if (!d->planned)
+    {
+        // record
+        ArenaAllocatorPrivate::Block b;
+        b.size = size;
+        b.space = space;
+        b.offset = 0;
+        b.birth = d->event++;
+        b.death = (size_t)-1;
+        d->blocks.push_back(b);
+
+        ArenaAllocatorPrivate::LiveBlock lb;
+        lb.ptr = ncnn::fastMalloc(size);
+        lb.block_index = (int)d->blocks.size() - 1;
+        lb.space = 0;
+        d->insert_live(lb);
+
+        return lb.ptr;
+    }
+
+    const size_t index = d->cursor++;
+    if (index < d->blocks.size() && size <= d->blocks[index].size)
+    {
+        const ArenaAllocatorPrivate::Block& b = d->blocks[index];
+
+        // the planned slot may still be held, eg. the output of the previous pass
+        unsigned char* ptr = d->arena + b.offset;
+        if (!d->overlaps_live(ptr, b.space))
+        {
+            ArenaAllocatorPrivate::LiveBlock lb;
+            lb.ptr = ptr;
+            lb.block_index = (int)index;
+            lb.space = b.space;
+            d->insert_live(lb);
+
+            return lb.ptr;
+        }
+    }
+
+    // not planned, fallback to heap
+    ArenaAllocatorPrivate::LiveBlock lb;
+    lb.ptr = ncnn::fastMalloc(size);
+    lb.block_index = -1;
+    lb.space = 0;
+    d->insert_live(lb);
+
+    return lb.ptr;
+}
+
+void ArenaAllocator::fastFree(void* ptr)
+{
+    MutexLockGuard guard(d->lock);
+
+    const size_t i = d->find_live(ptr);
+    if (i == d->live.size() || d->live[i].ptr != ptr)
+    {
+        NCNN_LOGE("FATAL ERROR! arena allocator get wild %p", ptr);
+        ncnn::fastFree(ptr);
+        return;
+    }
+
+    const ArenaAllocatorPrivate::LiveBlock& lb = d->live[i];
+
+    if (!d->planned && lb.block_index != -1)
+    {
+        d->blocks[lb.block_index].death = d->event++;
+    }
+
+    if (lb.space == 0)
+    {
+        // recorded or fallback allocation
+        ncnn::fastFree(ptr);
+    }
+
+    d->live.erase(d->live.begin() + i);
+}
+
 #if NCNN_VULKAN
 VkAllocator::VkAllocator(const VulkanDevice* _vkdev)
     : vkdev(_vkdev)
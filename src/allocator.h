@@ -162,6 +162,16 @@ public:
     // default threshold = 10
     void set_size_drop_threshold(size_t);
 
+    // byte budget of the budgets cached by one thread
+    // budgets beyond it go to the shared bins
+    // default 256MB
+    void set_thread_budget_bytes(size_t);
+
+    // byte budget of all budgets kept by this allocator, thread caches and shared bins together
+    // budgets beyond it go back to OS
+    // default 1GB
+    void set_total_budget_bytes(size_t);
+
     // release all budgets immediately
     void clear();
 
@@ -191,6 +201,16 @@ public:
     // default threshold = 10
     void set_size_drop_threshold(size_t);
 
+    // byte budget of the budgets cached by one thread
+    // budgets beyond it go to the shared bins
+    // default 256MB
+    void set_thread_budget_bytes(size_t);
+
+    // byte budget of all budgets kept by this allocator, thread caches and shared bins together
+    // budgets beyond it go back to OS
+    // default 1GB
+    void set_total_budget_bytes(size_t);
+
     // release all budgets immediately
     void clear();
 
@@ -205,6 +225,82 @@ private:
     UnlockedPoolAllocatorPrivate* const d;
 };
 
+class SizeClassPoolAllocatorPrivate;
+class NCNN_EXPORT SizeClassPoolAllocator : public Allocator
+{
+public:
+    SizeClassPoolAllocator();
+    ~SizeClassPoolAllocator();
+
+    // budget drop threshold, per size class
+    // each thread caches up to threshold budgets of one size class
+    // and up to threshold more are shared between threads
+    // a thread cache moves to the shared bins when its thread exits
+    // default threshold = 10
+    void set_size_drop_threshold(size_t);
+
+    // byte budget of the budgets cached by one thread
+    // budgets beyond it go to the shared bins
+    // default 256MB
+    void set_thread_budget_bytes(size_t);
+
+    // byte budget of all budgets kept by this allocator, thread caches and shared bins together
+    // budgets beyond it go back to OS
+    // default 1GB
+    void set_total_budget_bytes(size_t);
+
+    // release all budgets immediately
+    // must not be called while other threads are allocating
+    void clear();
+
+    // allocations served from budgets
+    size_t hit_count() const;
+    // allocations that went to the system allocator
+    size_t miss_count() const;
+    // bytes kept in budgets
+    size_t bytes_held() const;
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+private:
+    SizeClassPoolAllocator(const SizeClassPoolAllocator&);
+    SizeClassPoolAllocator& operator=(const SizeClassPoolAllocator&);
+
+private:
+    SizeClassPoolAllocatorPrivate* const d;
+};
+
+class ArenaAllocatorPrivate;
+class NCNN_EXPORT ArenaAllocator : public Allocator
+{
+public:
+    ArenaAllocator();
+    ~ArenaAllocator();
+
+    // the first forward pass after construction or clear() is recorded
+    // rewind() computes the lifetime of each allocation and packs them into one arena
+    // call rewind() before every following forward pass with the same input shapes
+    // allocations that do not match the plan fall back to the heap
+    void rewind();
+
+    // drop the plan and release the arena, next pass is recorded again
+    void clear();
+
+    // arena size in bytes, 0 before planning
+    size_t arena_size() const;
+
+    virtual void* fastMalloc(size_t size);
+    virtual void fastFree(void* ptr);
+
+private:
+    ArenaAllocator(const ArenaAllocator&);
+    ArenaAllocator& operator=(const ArenaAllocator&);
+
+private:
+    ArenaAllocatorPrivate* const d;
+};
+
 #if NCNN_VULKAN
 
 class VulkanDevice;
@@ -177,6 +177,8 @@ static int g_powersave;
 static ncnn::CpuSet g_cpu_affinity_mask_all;
 static ncnn::CpuSet g_cpu_affinity_mask_little;
 static ncnn::CpuSet g_cpu_affinity_mask_big;
+static int g_numa_node_count;
+static ncnn::CpuSet g_numa_node_affinity_mask[64];
 
 // isa info
 #if defined _WIN32
@@ -227,6 +229,9 @@ static int g_cpu_support_x86_avx512;
 static int g_cpu_support_x86_avx512_vnni;
 static int g_cpu_support_x86_avx512_bf16;
 static int g_cpu_support_x86_avx512_fp16;
+static int g_cpu_support_x86_amx_tile;
+static int g_cpu_support_x86_amx_int8;
+static int g_cpu_support_x86_amx_bf16;
 #endif // defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
 
 #if defined __ANDROID__ || defined __linux__
@@ -856,6 +861,64 @@ static int get_cpu_support_x86_avx512_fp16()
     return cpu_info[3] & (1u << 23);
 #endif
 }
+
+static int get_cpu_support_x86_amx_tile()
+{
+#if __APPLE__
+    return 0;
+#else
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid(0, cpu_info);
+
+    int nIds = cpu_info[0];
+    if (nIds < 7)
+        return 0;
+
+    x86_cpuid(1, cpu_info);
+    // check XSAVE OSXSAVE
+    if (!(cpu_info[2] & (1u << 26)) || !(cpu_info[2] & (1u << 27)))
+        return 0;
+
+    // check tile config and tile data XSAVE enabled by kernel
+    if ((x86_get_xcr0() & 0x60000) != 0x60000)
+        return 0;
+
+    x86_cpuid_sublevel(7, 0, cpu_info);
+    if (!(cpu_info[3] & (1u << 24)))
+        return 0;
+
+#if defined __linux__ && (defined(__x86_64__) || defined(_M_X64))
+    // linux keeps the tile data state disabled until the process requests it
+    // ARCH_REQ_XCOMP_PERM = 0x1023, XFEATURE_XTILEDATA = 18
+    if (syscall(SYS_arch_prctl, 0x1023, 18) != 0)
+        return 0;
+#endif
+
+    return 1;
+#endif
+}
+
+static int get_cpu_support_x86_amx_int8()
+{
+#if __APPLE__
+    return 0;
+#else
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid_sublevel(7, 0, cpu_info);
+    return cpu_info[3] & (1u << 25);
+#endif
+}
+
+static int get_cpu_support_x86_amx_bf16()
+{
+#if __APPLE__
+    return 0;
+#else
+    unsigned int cpu_info[4] = {0};
+    x86_cpuid_sublevel(7, 0, cpu_info);
+    return cpu_info[3] & (1u << 22);
+#endif
+}
 #endif // defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
 
 static int get_cpucount()
@@ -1816,6 +1879,71 @@ static void initialize_cpu_thread_affinity_mask(ncnn::CpuSet& mask_all, ncnn::Cp
 #endif
 }
 
+static int initialize_numa_node_affinity_mask(ncnn::CpuSet* masks, int max_node_count)
+{
+    int node_count = 0;
+
+#if defined __ANDROID__ || defined __linux__
+    // https://github.com/torvalds/linux/blob/v6.0/Documentation/ABI/stable/sysfs-devices-node
+    for (int nodeid = 0; nodeid < max_node_count; nodeid++)
+    {
+        char path[256];
+        sprintf(path, "/sys/devices/system/node/node%d/cpulist", nodeid);
+
+        FILE* fp = fopen(path, "rb");
+        if (!fp)
+            continue;
+
+        ncnn::CpuSet& mask = masks[node_count];
+        mask.disable_all();
+
+        // parse human-readable list like 0-15,32-47
+        int id0;
+        int nscan = fscanf(fp, "%d", &id0);
+        if (nscan == 1)
+        {
+            int id1;
+            char sep;
+            mask.enable(id0);
+
+            while (fscanf(fp, "%c%d", &sep, &id1) == 2)
+            {
+                if (sep == ',')
+                {
+                    mask.enable(id1);
+                }
+                if (sep == '-' && id0 < id1)
+                {
+                    for (int i = id0 + 1; i <= id1; i++)
+                    {
+                        mask.enable(i);
+                    }
+                }
+
+                id0 = id1;
+            }
+        }
+
+        fclose(fp);
+
+        // memory-only node
+        if (mask.num_enabled() == 0)
+            continue;
+
+        node_count++;
+    }
+#endif // defined __ANDROID__ || defined __linux__
+
+    if (node_count == 0)
+    {
+        // TODO implement me for other platforms
+        masks[0] = g_cpu_affinity_mask_all;
+        node_count = 1;
+    }
+
+    return node_count;
+}
+
 #if defined __ANDROID__ || defined __linux__
 #if __aarch64__
 union midr_info_t
@@ -2142,6 +2270,7 @@ static void initialize_global_cpu_info()
     g_physical_cpucount = get_physical_cpucount();
     g_powersave = 0;
     initialize_cpu_thread_affinity_mask(g_cpu_affinity_mask_all, g_cpu_affinity_mask_little, g_cpu_affinity_mask_big);
+    g_numa_node_count = initialize_numa_node_affinity_mask(g_numa_node_affinity_mask, 64);
 
 #if (defined _WIN32 && (__aarch64__ || __arm__)) || ((defined __ANDROID__ || defined __linux__) && __riscv)
     if (!is_being_debugged())
@@ -2224,6 +2353,9 @@ static void initialize_global_cpu_info()
     g_cpu_support_x86_avx512_vnni = get_cpu_support_x86_avx512_vnni();
     g_cpu_support_x86_avx512_bf16 = get_cpu_support_x86_avx512_bf16();
     g_cpu_support_x86_avx512_fp16 = get_cpu_support_x86_avx512_fp16();
+    g_cpu_support_x86_amx_tile = get_cpu_support_x86_amx_tile();
+    g_cpu_support_x86_amx_int8 = g_cpu_support_x86_amx_tile ? get_cpu_support_x86_amx_int8() : 0;
+    g_cpu_support_x86_amx_bf16 = g_cpu_support_x86_amx_tile ? get_cpu_support_x86_amx_bf16() : 0;
 #endif // defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
 
 #if defined __ANDROID__ || defined __linux__
@@ -2782,6 +2914,36 @@ int cpu_support_x86_avx512_fp16()
 #endif
 }
 
+int cpu_support_x86_amx_tile()
+{
+    try_initialize_global_cpu_info();
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    return g_cpu_support_x86_amx_tile;
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_amx_int8()
+{
+    try_initialize_global_cpu_info();
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    return g_cpu_support_x86_amx_int8;
+#else
+    return 0;
+#endif
+}
+
+int cpu_support_x86_amx_bf16()
+{
+    try_initialize_global_cpu_info();
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    return g_cpu_support_x86_amx_bf16;
+#else
+    return 0;
+#endif
+}
+
 int cpu_support_mips_msa()
 {
     try_initialize_global_cpu_info();
@@ -3099,6 +3261,61 @@ int set_cpu_thread_affinity(const CpuSet& thread_affinity_mask)
 #endif
 }
 
+int get_numa_node_count()
+{
+    try_initialize_global_cpu_info();
+    return g_numa_node_count;
+}
+
+const CpuSet& get_numa_node_thread_affinity_mask(int node)
+{
+    try_initialize_global_cpu_info();
+    if (node >= 0 && node < g_numa_node_count)
+        return g_numa_node_affinity_mask[node];
+
+    NCNN_LOGE("numa node %d not found", node);
+
+    // fallback to all cores anyway
+    return g_cpu_affinity_mask_all;
+}
+
+int get_current_thread_affinity(CpuSet& thread_affinity_mask)
+{
+    try_initialize_global_cpu_info();
+#if defined __ANDROID__ || defined __linux__
+#if defined(__BIONIC__) && !defined(__OHOS__)
+    pid_t pid = gettid();
+#else
+    pid_t pid = syscall(SYS_gettid);
+#endif
+
+    thread_affinity_mask.disable_all();
+
+    // the raw syscall returns the mask size on success
+    int syscallret = syscall(__NR_sched_getaffinity, pid, sizeof(cpu_set_t), &thread_affinity_mask.cpu_set);
+    if (syscallret < 0)
+        return -1;
+
+    return 0;
+#else
+    // TODO
+    (void)thread_affinity_mask;
+    return -1;
+#endif
+}
+
+int set_current_thread_affinity(const CpuSet& thread_affinity_mask)
+{
+    try_initialize_global_cpu_info();
+#if defined __ANDROID__ || defined __linux__ || defined _WIN32 || __APPLE__
+    return set_sched_affinity(thread_affinity_mask);
+#else
+    // TODO
+    (void)thread_affinity_mask;
+    return -1;
+#endif
+}
+
 int is_current_thread_running_on_a53_a55()
 {
     try_initialize_global_cpu_info();
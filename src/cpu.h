@@ -96,6 +96,12 @@ NCNN_EXPORT int cpu_support_x86_avx512_vnni();
 NCNN_EXPORT int cpu_support_x86_avx512_bf16();
 // avx512_fp16 = x86 avx512 fp16
 NCNN_EXPORT int cpu_support_x86_avx512_fp16();
+// amx_tile = x86 amx tile, with the tile data state granted by the os
+NCNN_EXPORT int cpu_support_x86_amx_tile();
+// amx_int8 = x86 amx tile + amx int8
+NCNN_EXPORT int cpu_support_x86_amx_int8();
+// amx_bf16 = x86 amx tile + amx bf16
+NCNN_EXPORT int cpu_support_x86_amx_bf16();
 
 // lsx = loongarch lsx
 NCNN_EXPORT int cpu_support_loongarch_lsx();
@@ -148,6 +154,20 @@ NCNN_EXPORT const CpuSet& get_cpu_thread_affinity_mask(int powersave);
 // set explicit thread affinity
 NCNN_EXPORT int set_cpu_thread_affinity(const CpuSet& thread_affinity_mask);
 
+// numa topology info
+// nodes without cpu are skipped, so node index may differ from the os node id
+// only implemented on linux at the moment, otherwise all cpus form one node
+NCNN_EXPORT int get_numa_node_count();
+
+// cpus of the numa node
+NCNN_EXPORT const CpuSet& get_numa_node_thread_affinity_mask(int node);
+
+// affinity of the calling thread alone, openmp worker threads are left as they are
+// only implemented on android and linux at the moment for the getter
+// return 0 if success
+NCNN_EXPORT int get_current_thread_affinity(CpuSet& thread_affinity_mask);
+NCNN_EXPORT int set_current_thread_affinity(const CpuSet& thread_affinity_mask);
+
 // runtime thread affinity info
 NCNN_EXPORT int is_current_thread_running_on_a53_a55();
 
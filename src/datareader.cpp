@@ -5,6 +5,18 @@
 
 #include <string.h>
 
+#if NCNN_STDIO
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif // NCNN_STDIO
+
 namespace ncnn {
 
 DataReader::DataReader()
@@ -76,6 +88,146 @@ size_t DataReaderFromStdio::read(void* buf, size_t size) const
 }
 #endif // NCNN_STDIO
 
+#if NCNN_STDIO
+class DataReaderFromMmapPrivate
+{
+public:
+    DataReaderFromMmapPrivate()
+        : data(0), size(0), offset(0)
+    {
+#if defined _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = 0;
+#endif
+    }
+
+    const unsigned char* data;
+    size_t size;
+    mutable size_t offset;
+
+#if defined _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+DataReaderFromMmap::DataReaderFromMmap(const char* path)
+    : DataReader(), d(new DataReaderFromMmapPrivate)
+{
+#if defined _WIN32
+    d->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (d->file == INVALID_HANDLE_VALUE)
+    {
+        NCNN_LOGE("CreateFile %s failed", path);
+        return;
+    }
+
+    LARGE_INTEGER filesize;
+    if (!GetFileSizeEx(d->file, &filesize) || filesize.QuadPart == 0)
+    {
+        NCNN_LOGE("GetFileSize %s failed", path);
+        return;
+    }
+
+    d->mapping = CreateFileMappingA(d->file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (!d->mapping)
+    {
+        NCNN_LOGE("CreateFileMapping %s failed", path);
+        return;
+    }
+
+    d->data = (const unsigned char*)MapViewOfFile(d->mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!d->data)
+    {
+        NCNN_LOGE("MapViewOfFile %s failed", path);
+        return;
+    }
+
+    d->size = (size_t)filesize.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+    {
+        NCNN_LOGE("open %s failed", path);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        NCNN_LOGE("fstat %s failed", path);
+        close(fd);
+        return;
+    }
+
+    // weights written by layers get private copies of their pages
+    void* ptr = mmap(0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        NCNN_LOGE("mmap %s failed", path);
+        return;
+    }
+
+    d->data = (const unsigned char*)ptr;
+    d->size = (size_t)st.st_size;
+#endif
+}
+
+DataReaderFromMmap::~DataReaderFromMmap()
+{
+#if defined _WIN32
+    if (d->data)
+        UnmapViewOfFile(d->data);
+    if (d->mapping)
+        CloseHandle(d->mapping);
+    if (d->file != INVALID_HANDLE_VALUE)
+        CloseHandle(d->file);
+#else
+    if (d->data)
+        munmap((void*)d->data, d->size);
+#endif
+
+    delete d;
+}
+
+DataReaderFromMmap::DataReaderFromMmap(const DataReaderFromMmap&)
+    : d(0)
+{
+}
+
+DataReaderFromMmap& DataReaderFromMmap::operator=(const DataReaderFromMmap&)
+{
+    return *this;
+}
+
+bool DataReaderFromMmap::mapped() const
+{
+    return d->data != 0;
+}
+
+size_t DataReaderFromMmap::read(void* buf, size_t size) const
+{
+    if (d->offset + size > d->size)
+        size = d->size - d->offset;
+
+    memcpy(buf, d->data + d->offset, size);
+    d->offset += size;
+    return size;
+}
+
+size_t DataReaderFromMmap::reference(size_t size, const void** buf) const
+{
+    if (d->offset + size > d->size)
+        return 0;
+
+    *buf = d->data + d->offset;
+    d->offset += size;
+    return size;
+}
+#endif // NCNN_STDIO
+
 class DataReaderFromMemoryPrivate
 {
 public:
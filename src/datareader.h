@@ -59,6 +59,30 @@ private:
 private:
     DataReaderFromStdioPrivate* const d;
 };
+
+class DataReaderFromMmapPrivate;
+class NCNN_EXPORT DataReaderFromMmap : public DataReader
+{
+public:
+    // map the whole file into memory
+    // the mapping is private copy-on-write, pages are shared with other processes until written
+    // referenced model data stays valid until this reader is destroyed
+    explicit DataReaderFromMmap(const char* path);
+    virtual ~DataReaderFromMmap();
+
+    // return true if the file is mapped
+    bool mapped() const;
+
+    virtual size_t read(void* buf, size_t size) const;
+    virtual size_t reference(size_t size, const void** buf) const;
+
+private:
+    DataReaderFromMmap(const DataReaderFromMmap&);
+    DataReaderFromMmap& operator=(const DataReaderFromMmap&);
+
+private:
+    DataReaderFromMmapPrivate* const d;
+};
 #endif // NCNN_STDIO
 
 class DataReaderFromMemoryPrivate;
@@ -60,6 +60,21 @@ int Layer::destroy_pipeline(const Option& /*opt*/)
     return 0;
 }
 
+int Layer::save_pipeline_weights(std::vector<Mat>& /*weights*/) const
+{
+    return -1;
+}
+
+int Layer::load_pipeline_weights(const std::vector<Mat>& /*weights*/, const Option& /*opt*/)
+{
+    return -1;
+}
+
+const char* Layer::kernel_name() const
+{
+    return 0;
+}
+
 int Layer::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     if (!support_inplace)
@@ -346,6 +361,39 @@ public:
         return layer_cpu->destroy_pipeline(opt);
     }
 
+    virtual int save_pipeline_weights(std::vector<Mat>& weights) const
+    {
+#if NCNN_VULKAN
+        if (layer_vulkan)
+            return -1;
+#endif // NCNN_VULKAN
+
+        return layer_cpu->save_pipeline_weights(weights);
+    }
+
+    virtual int load_pipeline_weights(const std::vector<Mat>& weights, const Option& opt)
+    {
+        set_layer_properties();
+#if NCNN_VULKAN
+        if (layer_vulkan)
+            return -1;
+#endif // NCNN_VULKAN
+
+        int ret = layer_cpu->load_pipeline_weights(weights, opt);
+        get_layer_properties();
+        return ret;
+    }
+
+    virtual const char* kernel_name() const
+    {
+#if NCNN_VULKAN
+        if (layer_vulkan)
+            return "vulkan";
+#endif // NCNN_VULKAN
+
+        return layer_cpu->kernel_name();
+    }
+
 public:
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
     {
@@ -41,6 +41,19 @@ public:
     // return 0 if success
     virtual int destroy_pipeline(const Option& opt);
 
+    // collect the weights transformed by create_pipeline for the weight cache
+    // return 0 if success, the layer is not cached otherwise
+    virtual int save_pipeline_weights(std::vector<Mat>& weights) const;
+
+    // setup with weights collected by save_pipeline_weights instead of create_pipeline
+    // cpu isa and option are the same as when they were collected
+    // return 0 if success, create_pipeline is used otherwise
+    virtual int load_pipeline_weights(const std::vector<Mat>& weights, const Option& opt);
+
+    // name of the kernel chosen by create_pipeline, reported by extractor profiling
+    // return null if the layer has no kernel choice
+    virtual const char* kernel_name() const;
+
 public:
     // one input and one output blob
     bool one_blob_only;
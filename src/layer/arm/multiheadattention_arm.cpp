@@ -3,6 +3,8 @@
 
 #include "multiheadattention_arm.h"
 
+#include <float.h>
+
 #include "cpu.h"
 #include "layer_type.h"
 
@@ -300,12 +302,42 @@ int MultiHeadAttention_arm::destroy_pipeline(const Option& _opt)
     return 0;
 }
 
+// append the new affine(k) or affine(v) columns after the cached sequence positions
+static int concat_kv_cache(const Mat& cache_blob, const Mat& affine, Mat& top_cache_blob, const Option& opt)
+{
+    const int past_seqlen = cache_blob.empty() ? 0 : cache_blob.w;
+    const int cur_seqlen = affine.w;
+    const size_t elemsize = affine.elemsize;
+
+    top_cache_blob.create(past_seqlen + cur_seqlen, affine.h, elemsize, opt.blob_allocator);
+    if (top_cache_blob.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < affine.h; i++)
+    {
+        unsigned char* outptr = top_cache_blob.row<unsigned char>(i);
+
+        if (past_seqlen > 0)
+        {
+            memcpy(outptr, cache_blob.row<const unsigned char>(i), past_seqlen * elemsize);
+        }
+
+        memcpy(outptr + past_seqlen * elemsize, affine.row<const unsigned char>(i), cur_seqlen * elemsize);
+    }
+
+    return 0;
+}
+
 int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& _opt) const
 {
+    // the cached k v blobs always come last
+    const size_t bottom_blob_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : (bottom_blob_count == 2 || (bottom_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blob_count - 1] : Mat();
 
     Option opt = _opt;
     opt.use_fp16_storage &= support_fp16_storage;
@@ -323,9 +355,18 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
         attn_mask_blob_unpacked = attn_mask_blob;
     }
 
+    Mat cache_k_blob_unpacked;
+    Mat cache_v_blob_unpacked;
+    if (kv_cache)
+    {
+        // the cache is stored unpacked, rows are the features of all heads
+        convert_packing(bottom_blobs[bottom_blob_count], cache_k_blob_unpacked, 1, opt);
+        convert_packing(bottom_blobs[bottom_blob_count + 1], cache_v_blob_unpacked, 1, opt);
+    }
+
     const int embed_dim_per_head = embed_dim / num_heads;
     const int src_seqlen = q_blob.h * q_blob.elempack;
-    const int dst_seqlen = k_blob.h * k_blob.elempack;
+    const int dst_seqlen = (cache_k_blob_unpacked.empty() ? 0 : cache_k_blob_unpacked.w) + k_blob.h * k_blob.elempack;
 
     // const int elembits = q_blob.elembits();
 
@@ -341,6 +382,15 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retk != 0)
         return retk;
 
+    if (kv_cache)
+    {
+        int retkc = concat_kv_cache(cache_k_blob_unpacked, k_affine, top_blobs[1], opt);
+        if (retkc != 0)
+            return retkc;
+
+        k_affine = top_blobs[1];
+    }
+
     Mat qk_cross(dst_seqlen, src_seqlen * num_heads, elemsize, opt.blob_allocator);
     if (qk_cross.empty())
         return -100;
@@ -373,6 +423,33 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
     q_affine.release();
     k_affine.release();
 
+    if (causal)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < num_heads * src_seqlen; i++)
+        {
+            const int j0 = std::max(i % src_seqlen + dst_seqlen - src_seqlen + 1, 0);
+
+            if (elemsize == 2)
+            {
+                unsigned short* ptr = qk_cross.row<unsigned short>(i);
+                const unsigned short neg = float32_to_float16(-65504.f);
+                for (int j = j0; j < dst_seqlen; j++)
+                {
+                    ptr[j] = neg;
+                }
+            }
+            else
+            {
+                float* ptr = qk_cross.row(i);
+                for (int j = j0; j < dst_seqlen; j++)
+                {
+                    ptr[j] = -FLT_MAX;
+                }
+            }
+        }
+    }
+
     int retqk = qk_softmax->forward_inplace(qk_cross, opt);
     if (retqk != 0)
         return retqk;
@@ -382,6 +459,15 @@ int MultiHeadAttention_arm::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retv != 0)
         return retv;
 
+    if (kv_cache)
+    {
+        int retvc = concat_kv_cache(cache_v_blob_unpacked, v_affine, top_blobs[2], opt);
+        if (retvc != 0)
+            return retvc;
+
+        v_affine = top_blobs[2];
+    }
+
     Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, elemsize, opt.blob_allocator);
     if (qkv_cross.empty())
         return -100;
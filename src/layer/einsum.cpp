@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include "einsum.h"
+
+#include "layer_type.h"
+
 #include <string.h>
 
 namespace ncnn {
@@ -10,6 +13,30 @@ Einsum::Einsum()
 {
     one_blob_only = false;
     support_inplace = false;
+
+    use_gemm = 0;
+    gemm = 0;
+}
+
+static bool token_has(const std::string& token, char c)
+{
+    return token.find(c) != std::string::npos;
+}
+
+static bool token_is_unique(const std::string& token)
+{
+    for (size_t i = 0; i < token.size(); i++)
+    {
+        if (token.find(token[i], i + 1) != std::string::npos)
+            return false;
+    }
+
+    return true;
+}
+
+static bool token_ends_with(const std::string& token, const std::string& tail)
+{
+    return token.size() >= tail.size() && token.compare(token.size() - tail.size(), tail.size(), tail) == 0;
 }
 
 int Einsum::load_param(const ParamDict& pd)
@@ -88,6 +115,115 @@ int Einsum::load_param(const ParamDict& pd)
         }
     }
 
+    // lower plain two operand contractions, such as bij,bjk->bik and bhqd,bhkd->bhqk, to batched gemm
+    // diagonals and letters summed within one operand stay on the naive path
+    use_gemm = 0;
+    if (lhs_tokens.size() == 2 && token_is_unique(lhs_tokens[0]) && token_is_unique(lhs_tokens[1]) && token_is_unique(rhs_token))
+    {
+        const std::string& a = lhs_tokens[0];
+        const std::string& b = lhs_tokens[1];
+
+        batch_token.clear();
+        m_token.clear();
+        n_token.clear();
+        k_token.clear();
+
+        bool lowerable = true;
+        for (size_t i = 0; i < rhs_token.size(); i++)
+        {
+            const char c = rhs_token[i];
+            const bool in_a = token_has(a, c);
+            const bool in_b = token_has(b, c);
+
+            if (in_a && in_b)
+                batch_token += c;
+            else if (in_a)
+                m_token += c;
+            else if (in_b)
+                n_token += c;
+            else
+                lowerable = false;
+        }
+
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            const char c = a[i];
+            if (token_has(rhs_token, c))
+                continue;
+
+            if (token_has(b, c))
+                k_token += c;
+            else
+                lowerable = false;
+        }
+
+        for (size_t i = 0; i < b.size(); i++)
+        {
+            if (!token_has(rhs_token, b[i]) && !token_has(a, b[i]))
+                lowerable = false;
+        }
+
+        if (lowerable)
+        {
+            // prefer the layout the operand already has, so that it can be used without a copy
+            a_token = token_ends_with(a, k_token + m_token) ? k_token + m_token : m_token + k_token;
+            b_token = token_ends_with(b, k_token + n_token) ? k_token + n_token : n_token + k_token;
+            c_token = token_ends_with(rhs_token, n_token + m_token) ? n_token + m_token : m_token + n_token;
+
+            use_gemm = 1;
+        }
+    }
+
+    return 0;
+}
+
+int Einsum::create_pipeline(const Option& opt)
+{
+    if (!use_gemm)
+        return 0;
+
+    const int transA = a_token != m_token + k_token;
+    const int transB = b_token != k_token + n_token;
+    const int output_transpose = c_token != m_token + n_token;
+
+    gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
+
+    ncnn::ParamDict pd;
+    pd.set(2, transA);            // transA
+    pd.set(3, transB);            // transB
+    pd.set(4, 0);                 // constantA
+    pd.set(5, 0);                 // constantB
+    pd.set(6, 1);                 // constantC
+    pd.set(7, 0);                 // M
+    pd.set(8, 0);                 // N
+    pd.set(9, 0);                 // K
+    pd.set(10, -1);               // constant_broadcast_type_C
+    pd.set(11, 0);                // output_N1M
+    pd.set(12, 1);                // output_elempack
+    pd.set(14, output_transpose); // output_transpose
+
+    gemm->load_param(pd);
+
+    gemm->load_model(ModelBinFromMatArray(0));
+
+    Option opt_g = opt;
+    opt_g.use_packing_layout = false;
+    opt_g.use_fp16_storage = false;
+    opt_g.use_bf16_storage = false;
+    gemm->create_pipeline(opt_g);
+
+    return 0;
+}
+
+int Einsum::destroy_pipeline(const Option& opt)
+{
+    if (gemm)
+    {
+        gemm->destroy_pipeline(opt);
+        delete gemm;
+        gemm = 0;
+    }
+
     return 0;
 }
 
@@ -154,6 +290,343 @@ static float sum_dim(const std::vector<int>& dim_sizes, int d, const std::vector
     return sum;
 }
 
+static void resolve_dim_sizes(const std::vector<Mat>& bottom_blobs, const std::vector<std::string>& lhs_tokens, std::vector<int>& dim_sizes)
+{
+    dim_sizes.resize(16, 1); // map ijklmnopqrstuvwx -> dim_size
+    int dim_sizes_count = 0;
+
+    for (size_t b = 0; b < bottom_blobs.size(); b++)
+    {
+        const std::string& lhs_token = lhs_tokens[b];
+        const Mat& bottom_blob = bottom_blobs[b];
+        const int in_dims = bottom_blob.dims;
+
+        for (int s = 0; s < in_dims; s++)
+        {
+            int dim_size = 1;
+            if (in_dims == 1) dim_size = bottom_blob.w;
+            if (in_dims == 2 && s == 0) dim_size = bottom_blob.h;
+            if (in_dims == 2 && s == 1) dim_size = bottom_blob.w;
+            if (in_dims == 3 && s == 0) dim_size = bottom_blob.c;
+            if (in_dims == 3 && s == 1) dim_size = bottom_blob.h;
+            if (in_dims == 3 && s == 2) dim_size = bottom_blob.w;
+            if (in_dims == 4 && s == 0) dim_size = bottom_blob.c;
+            if (in_dims == 4 && s == 1) dim_size = bottom_blob.d;
+            if (in_dims == 4 && s == 2) dim_size = bottom_blob.h;
+            if (in_dims == 4 && s == 3) dim_size = bottom_blob.w;
+
+            int dim_sizes_index = lhs_token[s] - 'i';
+            dim_sizes[dim_sizes_index] = dim_size;
+            dim_sizes_count = std::max(dim_sizes_count, dim_sizes_index + 1);
+        }
+    }
+
+    dim_sizes.resize(dim_sizes_count);
+}
+
+// element strides of each letter in token
+static void resolve_strides(const Mat& m, const std::string& token, size_t* strides)
+{
+    const int dims = m.dims;
+
+    if (dims == 1)
+    {
+        strides[token[0] - 'i'] = 1;
+    }
+    if (dims == 2)
+    {
+        strides[token[0] - 'i'] = m.w;
+        strides[token[1] - 'i'] = 1;
+    }
+    if (dims == 3)
+    {
+        strides[token[0] - 'i'] = m.cstep;
+        strides[token[1] - 'i'] = m.w;
+        strides[token[2] - 'i'] = 1;
+    }
+    if (dims == 4)
+    {
+        strides[token[0] - 'i'] = m.cstep;
+        strides[token[1] - 'i'] = (size_t)m.w * m.h;
+        strides[token[2] - 'i'] = m.w;
+        strides[token[3] - 'i'] = 1;
+    }
+}
+
+// dense strides for the letters laid out in token order
+static void resolve_dense_strides(const std::string& token, const std::vector<int>& dim_sizes, size_t* strides)
+{
+    size_t stride = 1;
+    for (int i = (int)token.size() - 1; i >= 0; i--)
+    {
+        strides[token[i] - 'i'] = stride;
+        stride *= dim_sizes[token[i] - 'i'];
+    }
+}
+
+// whether the trailing letters of token are exactly block and form one dense matrix per batch
+static bool is_dense_block(const std::string& token, const std::string& block, const size_t* strides, const std::vector<int>& dim_sizes)
+{
+    if (!token_ends_with(token, block))
+        return false;
+
+    size_t stride = 1;
+    for (int i = (int)block.size() - 1; i >= 0; i--)
+    {
+        const int size = dim_sizes[block[i] - 'i'];
+        if (size != 1 && strides[block[i] - 'i'] != stride)
+            return false;
+
+        stride *= size;
+    }
+
+    return true;
+}
+
+static int token_size(const std::string& token, const std::vector<int>& dim_sizes)
+{
+    int size = 1;
+    for (size_t i = 0; i < token.size(); i++)
+    {
+        size *= dim_sizes[token[i] - 'i'];
+    }
+
+    return size;
+}
+
+// copy src to dst, walking the letters in order, the last one innermost
+static void copy_strided(const float* src, const size_t* src_strides, float* dst, const size_t* dst_strides, const std::string& order, const std::vector<int>& dim_sizes, const Option& opt)
+{
+    const int n = (int)order.size();
+    if (n == 0)
+    {
+        dst[0] = src[0];
+        return;
+    }
+
+    if (n == 1)
+    {
+        const int size = dim_sizes[order[0] - 'i'];
+        const size_t src_stride = src_strides[order[0] - 'i'];
+        const size_t dst_stride = dst_strides[order[0] - 'i'];
+        for (int i = 0; i < size; i++)
+        {
+            dst[i * dst_stride] = src[i * src_stride];
+        }
+        return;
+    }
+
+    const int outer = dim_sizes[order[0] - 'i'];
+    const size_t outer_src_stride = src_strides[order[0] - 'i'];
+    const size_t outer_dst_stride = dst_strides[order[0] - 'i'];
+
+    const int inner = dim_sizes[order[n - 1] - 'i'];
+    const size_t inner_src_stride = src_strides[order[n - 1] - 'i'];
+    const size_t inner_dst_stride = dst_strides[order[n - 1] - 'i'];
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < outer; q++)
+    {
+        const float* ptr0 = src + q * outer_src_stride;
+        float* outptr0 = dst + q * outer_dst_stride;
+
+        // odometer over the middle letters
+        int index[16] = {0};
+        for (;;)
+        {
+            const float* ptr = ptr0;
+            float* outptr = outptr0;
+            for (int i = 1; i < n - 1; i++)
+            {
+                ptr += index[i] * src_strides[order[i] - 'i'];
+                outptr += index[i] * dst_strides[order[i] - 'i'];
+            }
+
+            if (inner_src_stride == 1 && inner_dst_stride == 1)
+            {
+                memcpy(outptr, ptr, inner * sizeof(float));
+            }
+            else
+            {
+                for (int j = 0; j < inner; j++)
+                {
+                    outptr[j * inner_dst_stride] = ptr[j * inner_src_stride];
+                }
+            }
+
+            int i = n - 2;
+            for (; i >= 1; i--)
+            {
+                index[i]++;
+                if (index[i] < dim_sizes[order[i] - 'i'])
+                    break;
+
+                index[i] = 0;
+            }
+
+            if (i < 1)
+                break;
+        }
+    }
+}
+
+int Einsum::forward_gemm(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& A = bottom_blobs[0];
+    const Mat& B = bottom_blobs[1];
+    Mat& top_blob = top_blobs[0];
+
+    std::vector<int> dim_sizes;
+    resolve_dim_sizes(bottom_blobs, lhs_tokens, dim_sizes);
+    dim_sizes.resize(16, 1);
+
+    const int out_dims = (int)rhs_token.size();
+    std::vector<int> outshape(4, 1);
+    for (int i = 0; i < out_dims; i++)
+    {
+        outshape[i] = dim_sizes[rhs_token[out_dims - 1 - i] - 'i'];
+    }
+
+    if (out_dims == 0 || out_dims == 1)
+        top_blob.create(outshape[0], 4u, opt.blob_allocator);
+    if (out_dims == 2)
+        top_blob.create(outshape[0], outshape[1], 4u, opt.blob_allocator);
+    if (out_dims == 3)
+        top_blob.create(outshape[0], outshape[1], outshape[2], 4u, opt.blob_allocator);
+    if (out_dims == 4)
+        top_blob.create(outshape[0], outshape[1], outshape[2], outshape[3], 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int batch = token_size(batch_token, dim_sizes);
+    const int M = token_size(m_token, dim_sizes);
+    const int N = token_size(n_token, dim_sizes);
+    const int K = token_size(k_token, dim_sizes);
+
+    // operands whose matrices are not dense in gemm layout are packed first
+    size_t A_strides[16] = {0};
+    resolve_strides(A, lhs_tokens[0], A_strides);
+
+    Mat A_packed;
+    const float* A_ptr = A;
+    if (!is_dense_block(lhs_tokens[0], a_token, A_strides, dim_sizes))
+    {
+        A_packed.create(M * K * batch, 4u, opt.workspace_allocator);
+        if (A_packed.empty())
+            return -100;
+
+        size_t A_packed_strides[16] = {0};
+        resolve_dense_strides(batch_token + a_token, dim_sizes, A_packed_strides);
+        copy_strided(A, A_strides, A_packed, A_packed_strides, batch_token + a_token, dim_sizes, opt);
+
+        A_ptr = A_packed;
+        memcpy(A_strides, A_packed_strides, sizeof(A_strides));
+    }
+
+    size_t B_strides[16] = {0};
+    resolve_strides(B, lhs_tokens[1], B_strides);
+
+    Mat B_packed;
+    const float* B_ptr = B;
+    if (!is_dense_block(lhs_tokens[1], b_token, B_strides, dim_sizes))
+    {
+        B_packed.create(N * K * batch, 4u, opt.workspace_allocator);
+        if (B_packed.empty())
+            return -100;
+
+        size_t B_packed_strides[16] = {0};
+        resolve_dense_strides(batch_token + b_token, dim_sizes, B_packed_strides);
+        copy_strided(B, B_strides, B_packed, B_packed_strides, batch_token + b_token, dim_sizes, opt);
+
+        B_ptr = B_packed;
+        memcpy(B_strides, B_packed_strides, sizeof(B_strides));
+    }
+
+    // gemm writes into the output directly when each batch owns a dense matrix there
+    size_t top_strides[16] = {0};
+    if (out_dims > 0)
+        resolve_strides(top_blob, rhs_token, top_strides);
+
+    const bool top_dense = is_dense_block(rhs_token, c_token, top_strides, dim_sizes);
+
+    Mat C_packed;
+    float* C_ptr = top_blob;
+    size_t C_strides[16] = {0};
+    Allocator* C_allocator = top_blob.allocator;
+    if (top_dense)
+    {
+        memcpy(C_strides, top_strides, sizeof(C_strides));
+    }
+    else
+    {
+        C_packed.create(M * N * batch, 4u, opt.workspace_allocator);
+        if (C_packed.empty())
+            return -100;
+
+        resolve_dense_strides(batch_token + c_token, dim_sizes, C_strides);
+
+        C_ptr = C_packed;
+        C_allocator = C_packed.allocator;
+    }
+
+    const int A_w = a_token == m_token + k_token ? K : M;
+    const int B_w = b_token == k_token + n_token ? N : K;
+    const int C_w = c_token == m_token + n_token ? N : M;
+
+    // small batches let gemm spread over the threads, large ones run one gemm per thread
+    const int nn_batch_threads = batch >= opt.num_threads ? opt.num_threads : 1;
+
+    Option opt_g = opt;
+    opt_g.num_threads = nn_batch_threads > 1 ? 1 : opt.num_threads;
+    opt_g.blob_allocator = C_allocator;
+    opt_g.use_packing_layout = false;
+    opt_g.use_fp16_storage = false;
+    opt_g.use_bf16_storage = false;
+
+    std::vector<int> rets(batch);
+    #pragma omp parallel for num_threads(nn_batch_threads)
+    for (int b = 0; b < batch; b++)
+    {
+        size_t A_offset = 0;
+        size_t B_offset = 0;
+        size_t C_offset = 0;
+        {
+            int bi = b;
+            for (int i = (int)batch_token.size() - 1; i >= 0; i--)
+            {
+                const int l = batch_token[i] - 'i';
+                const int index = bi % dim_sizes[l];
+                bi /= dim_sizes[l];
+
+                A_offset += index * A_strides[l];
+                B_offset += index * B_strides[l];
+                C_offset += index * C_strides[l];
+            }
+        }
+
+        std::vector<Mat> gemm_bottom_blobs(2);
+        gemm_bottom_blobs[0] = Mat(A_w, M * K / A_w, (void*)(A_ptr + A_offset), 4u);
+        gemm_bottom_blobs[1] = Mat(B_w, N * K / B_w, (void*)(B_ptr + B_offset), 4u);
+
+        std::vector<Mat> gemm_top_blobs(1);
+        gemm_top_blobs[0] = Mat(C_w, M * N / C_w, (void*)(C_ptr + C_offset), 4u, C_allocator);
+
+        rets[b] = gemm->forward(gemm_bottom_blobs, gemm_top_blobs, opt_g);
+    }
+    for (int b = 0; b < batch; b++)
+    {
+        if (rets[b] != 0)
+            return rets[b];
+    }
+
+    if (!top_dense)
+    {
+        copy_strided(C_packed, C_strides, top_blob, top_strides, batch_token + c_token, dim_sizes, opt);
+    }
+
+    return 0;
+}
+
 int Einsum::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
     // assert bottom_blobs.size() == lhs_tokens.size()
@@ -187,37 +660,13 @@ int Einsum::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_
         return 0;
     }
 
-    // resolve dimension sizes
-    std::vector<int> dim_sizes(16, 1); // map ijklmnopqrstuvwx -> dim_size
-    int dim_sizes_count = 0;
-
-    for (size_t b = 0; b < bottom_blobs.size(); b++)
-    {
-        const std::string& lhs_token = lhs_tokens[b];
-        const Mat& bottom_blob = bottom_blobs[b];
-        const int in_dims = bottom_blob.dims;
+    if (use_gemm)
+        return forward_gemm(bottom_blobs, top_blobs, opt);
 
-        for (int s = 0; s < in_dims; s++)
-        {
-            int dim_size = 1;
-            if (in_dims == 1) dim_size = bottom_blob.w;
-            if (in_dims == 2 && s == 0) dim_size = bottom_blob.h;
-            if (in_dims == 2 && s == 1) dim_size = bottom_blob.w;
-            if (in_dims == 3 && s == 0) dim_size = bottom_blob.c;
-            if (in_dims == 3 && s == 1) dim_size = bottom_blob.h;
-            if (in_dims == 3 && s == 2) dim_size = bottom_blob.w;
-            if (in_dims == 4 && s == 0) dim_size = bottom_blob.c;
-            if (in_dims == 4 && s == 1) dim_size = bottom_blob.d;
-            if (in_dims == 4 && s == 2) dim_size = bottom_blob.h;
-            if (in_dims == 4 && s == 3) dim_size = bottom_blob.w;
-
-            int dim_sizes_index = lhs_token[s] - 'i';
-            dim_sizes[dim_sizes_index] = dim_size;
-            dim_sizes_count = std::max(dim_sizes_count, dim_sizes_index + 1);
-        }
-    }
-
-    dim_sizes.resize(dim_sizes_count);
+    // resolve dimension sizes
+    std::vector<int> dim_sizes;
+    resolve_dim_sizes(bottom_blobs, lhs_tokens, dim_sizes);
+    const int dim_sizes_count = (int)dim_sizes.size();
 
     const int out_dims = (int)rhs_token.size();
 
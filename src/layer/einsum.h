@@ -15,12 +15,30 @@ public:
 
     virtual int load_param(const ParamDict& pd);
 
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
 public:
     // equation tokens
     std::vector<std::string> lhs_tokens;
     std::string rhs_token;
+
+    // two operand contraction lowered to batched gemm, the naive path handles the rest
+    int use_gemm;
+    std::string batch_token; // in both operands and the output
+    std::string m_token;     // in the first operand and the output
+    std::string n_token;     // in the second operand and the output
+    std::string k_token;     // in both operands, summed over
+    std::string a_token;     // gemm A layout, m_token + k_token or k_token + m_token
+    std::string b_token;     // gemm B layout, n_token + k_token or k_token + n_token
+    std::string c_token;     // gemm output layout, m_token + n_token or n_token + m_token
+
+    Layer* gemm;
+
+protected:
+    int forward_gemm(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 };
 
 } // namespace ncnn
@@ -40,7 +40,9 @@ int Embed::load_model(const ModelBin& mb)
 #if NCNN_INT8
     if (int8_scale_term)
     {
-        weight_data_int8_scale = mb.load(1, 1)[0];
+        weight_data_int8_scales = mb.load(int8_scale_term == 3 ? input_dim : 1, 1);
+        if (weight_data_int8_scales.empty())
+            return -100;
     }
 #endif // NCNN_INT8
 
@@ -83,7 +85,7 @@ static void embed(const Mat& bottom_blob, const Mat& weight_data, const Mat& bia
 }
 
 #if NCNN_INT8
-static void embed_int8(const Mat& bottom_blob, const Mat& weight_data, float weight_data_int8_scale, const Mat& bias_data, Mat& top_blob, int input_dim, const Option& opt)
+static void embed_int8(const Mat& bottom_blob, const Mat& weight_data, const Mat& weight_data_int8_scales, const Mat& bias_data, Mat& top_blob, int input_dim, const Option& opt)
 {
     const int num_output = top_blob.w;
     const int words = top_blob.h;
@@ -102,7 +104,7 @@ static void embed_int8(const Mat& bottom_blob, const Mat& weight_data, float wei
         if (word_index >= input_dim)
             word_index = input_dim - 1;
 
-        const float descale_em = 1.f / weight_data_int8_scale;
+        const float descale_em = 1.f / weight_data_int8_scales[weight_data_int8_scales.w == 1 ? 0 : word_index];
 
         const signed char* em = (const signed char*)weight_data + num_output * word_index;
 
@@ -135,7 +137,7 @@ int Embed::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) con
 #if NCNN_INT8
     if (int8_scale_term)
     {
-        embed_int8(bottom_blob, weight_data, weight_data_int8_scale, bias_data, top_blob, input_dim, opt);
+        embed_int8(bottom_blob, weight_data, weight_data_int8_scales, bias_data, top_blob, input_dim, opt);
     }
     else
 #endif // NCNN_INT8
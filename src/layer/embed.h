@@ -27,6 +27,7 @@ public:
 
     int weight_data_size;
 
+    // 0=disabled 1,2=one scale for the whole table 3=one scale per row
     int int8_scale_term;
 
     // model
@@ -34,7 +35,7 @@ public:
     Mat bias_data;
 
 #if NCNN_INT8
-    float weight_data_int8_scale;
+    Mat weight_data_int8_scales;
 #endif
 };
 
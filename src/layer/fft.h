@@ -0,0 +1,395 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_FFT_H
+#define LAYER_FFT_H
+
+#include "mat.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace ncnn {
+
+// mixed radix fft helpers shared by spectrogram and inversespectrogram
+// complex sequences are stored split, real parts and imaginary parts in separate arrays
+// the twiddle table of a n points transform holds exp(-2*pi*i*t/n) for t in [0, n)
+// real parts in row 0 and imaginary parts in row 1
+// a n/2 points transform reuses the same table with twiddle stride 2
+
+static void fft_make_twiddles(int n, Mat& twiddles)
+{
+    twiddles.create(n, 2);
+
+    float* twr = twiddles.row(0);
+    float* twi = twiddles.row(1);
+    for (int t = 0; t < n; t++)
+    {
+        double angle = 2 * 3.14159265358979323846 * t / n;
+        twr[t] = (float)cos(angle);
+        twi[t] = (float)-sin(angle);
+    }
+}
+
+static void fft_make_factors(int n, std::vector<int>& factors)
+{
+    factors.clear();
+
+    while (n % 4 == 0)
+    {
+        factors.push_back(4);
+        n /= 4;
+    }
+    while (n % 2 == 0)
+    {
+        factors.push_back(2);
+        n /= 2;
+    }
+    for (int p = 3; p * p <= n; p += 2)
+    {
+        while (n % p == 0)
+        {
+            factors.push_back(p);
+            n /= p;
+        }
+    }
+    if (n > 1)
+    {
+        factors.push_back(n);
+    }
+}
+
+// one stockham autosort pass of radix p
+// y[q + s * (p * j + k)] = W_L^(j * k) * sum_r x[q + s * (j + r * m)] * W_p^(r * k)
+// with L = p * m and W_L^t found at twiddle index twstep * t
+// the innermost loop runs over the contiguous q so that butterflies vectorize
+static void fft_pass(const float* xr, const float* xi, float* yr, float* yi, int s, int m, int p, const float* twr, const float* twi, int twstep)
+{
+    if (p == 4)
+    {
+        for (int j = 0; j < m; j++)
+        {
+            const float w1r = twr[twstep * j];
+            const float w1i = twi[twstep * j];
+            const float w2r = twr[twstep * j * 2];
+            const float w2i = twi[twstep * j * 2];
+            const float w3r = twr[twstep * j * 3];
+            const float w3i = twi[twstep * j * 3];
+
+            const float* x0r = xr + s * j;
+            const float* x0i = xi + s * j;
+            const float* x1r = x0r + s * m;
+            const float* x1i = x0i + s * m;
+            const float* x2r = x1r + s * m;
+            const float* x2i = x1i + s * m;
+            const float* x3r = x2r + s * m;
+            const float* x3i = x2i + s * m;
+            float* y0r = yr + s * 4 * j;
+            float* y0i = yi + s * 4 * j;
+            float* y1r = y0r + s;
+            float* y1i = y0i + s;
+            float* y2r = y1r + s;
+            float* y2i = y1i + s;
+            float* y3r = y2r + s;
+            float* y3i = y2i + s;
+
+            for (int q = 0; q < s; q++)
+            {
+                const float t0r = x0r[q] + x2r[q];
+                const float t0i = x0i[q] + x2i[q];
+                const float t1r = x0r[q] - x2r[q];
+                const float t1i = x0i[q] - x2i[q];
+                const float t2r = x1r[q] + x3r[q];
+                const float t2i = x1i[q] + x3i[q];
+                // (x1 - x3) * -i
+                const float t3r = x1i[q] - x3i[q];
+                const float t3i = x3r[q] - x1r[q];
+
+                const float v1r = t1r + t3r;
+                const float v1i = t1i + t3i;
+                const float v2r = t0r - t2r;
+                const float v2i = t0i - t2i;
+                const float v3r = t1r - t3r;
+                const float v3i = t1i - t3i;
+
+                y0r[q] = t0r + t2r;
+                y0i[q] = t0i + t2i;
+                y1r[q] = v1r * w1r - v1i * w1i;
+                y1i[q] = v1r * w1i + v1i * w1r;
+                y2r[q] = v2r * w2r - v2i * w2i;
+                y2i[q] = v2r * w2i + v2i * w2r;
+                y3r[q] = v3r * w3r - v3i * w3i;
+                y3i[q] = v3r * w3i + v3i * w3r;
+            }
+        }
+        return;
+    }
+
+    if (p == 2)
+    {
+        for (int j = 0; j < m; j++)
+        {
+            const float w1r = twr[twstep * j];
+            const float w1i = twi[twstep * j];
+
+            const float* x0r = xr + s * j;
+            const float* x0i = xi + s * j;
+            const float* x1r = x0r + s * m;
+            const float* x1i = x0i + s * m;
+            float* y0r = yr + s * 2 * j;
+            float* y0i = yi + s * 2 * j;
+            float* y1r = y0r + s;
+            float* y1i = y0i + s;
+
+            for (int q = 0; q < s; q++)
+            {
+                const float v1r = x0r[q] - x1r[q];
+                const float v1i = x0i[q] - x1i[q];
+
+                y0r[q] = x0r[q] + x1r[q];
+                y0i[q] = x0i[q] + x1i[q];
+                y1r[q] = v1r * w1r - v1i * w1i;
+                y1i[q] = v1r * w1i + v1i * w1r;
+            }
+        }
+        return;
+    }
+
+    if (p == 3)
+    {
+        // W_3 = -1/2 - i * sqrt(3)/2
+        const float c = 0.86602540378443864676f;
+
+        for (int j = 0; j < m; j++)
+        {
+            const float w1r = twr[twstep * j];
+            const float w1i = twi[twstep * j];
+            const float w2r = twr[twstep * j * 2];
+            const float w2i = twi[twstep * j * 2];
+
+            const float* x0r = xr + s * j;
+            const float* x0i = xi + s * j;
+            const float* x1r = x0r + s * m;
+            const float* x1i = x0i + s * m;
+            const float* x2r = x1r + s * m;
+            const float* x2i = x1i + s * m;
+            float* y0r = yr + s * 3 * j;
+            float* y0i = yi + s * 3 * j;
+            float* y1r = y0r + s;
+            float* y1i = y0i + s;
+            float* y2r = y1r + s;
+            float* y2i = y1i + s;
+
+            for (int q = 0; q < s; q++)
+            {
+                const float t1r = x1r[q] + x2r[q];
+                const float t1i = x1i[q] + x2i[q];
+                const float t2r = x0r[q] - 0.5f * t1r;
+                const float t2i = x0i[q] - 0.5f * t1i;
+                const float dr = c * (x1r[q] - x2r[q]);
+                const float di = c * (x1i[q] - x2i[q]);
+
+                const float v1r = t2r + di;
+                const float v1i = t2i - dr;
+                const float v2r = t2r - di;
+                const float v2i = t2i + dr;
+
+                y0r[q] = x0r[q] + t1r;
+                y0i[q] = x0i[q] + t1i;
+                y1r[q] = v1r * w1r - v1i * w1i;
+                y1i[q] = v1r * w1i + v1i * w1r;
+                y2r[q] = v2r * w2r - v2i * w2i;
+                y2i[q] = v2r * w2i + v2i * w2r;
+            }
+        }
+        return;
+    }
+
+    // generic odd radix, W_p^t at twiddle index twstep * m * t
+    for (int j = 0; j < m; j++)
+    {
+        for (int k = 0; k < p; k++)
+        {
+            float* ykr = yr + s * (p * j + k);
+            float* yki = yi + s * (p * j + k);
+
+            {
+                const float* x0r = xr + s * j;
+                const float* x0i = xi + s * j;
+                for (int q = 0; q < s; q++)
+                {
+                    ykr[q] = x0r[q];
+                    yki[q] = x0i[q];
+                }
+            }
+            for (int r = 1; r < p; r++)
+            {
+                const int t = r * k % p;
+                const float wr = twr[twstep * m * t];
+                const float wi = twi[twstep * m * t];
+
+                const float* xkr = xr + s * (j + r * m);
+                const float* xki = xi + s * (j + r * m);
+                for (int q = 0; q < s; q++)
+                {
+                    ykr[q] += xkr[q] * wr - xki[q] * wi;
+                    yki[q] += xkr[q] * wi + xki[q] * wr;
+                }
+            }
+            if (k > 0)
+            {
+                const float wr = twr[twstep * j * k];
+                const float wi = twi[twstep * j * k];
+                for (int q = 0; q < s; q++)
+                {
+                    const float vr = ykr[q];
+                    const float vi = yki[q];
+                    ykr[q] = vr * wr - vi * wi;
+                    yki[q] = vr * wi + vi * wr;
+                }
+            }
+        }
+    }
+}
+
+// in-place forward complex transform of n points on xr/xi
+// yr/yi is scratch space of n points
+static void fft_complex(float* xr, float* xi, float* yr, float* yi, int n, const std::vector<int>& factors, const Mat& twiddles, int twstride)
+{
+    const float* twr = twiddles.row(0);
+    const float* twi = twiddles.row(1);
+
+    float* ar = xr;
+    float* ai = xi;
+    float* br = yr;
+    float* bi = yi;
+
+    int s = 1;
+    int l = n;
+    for (size_t i = 0; i < factors.size(); i++)
+    {
+        const int p = factors[i];
+        const int m = l / p;
+
+        fft_pass(ar, ai, br, bi, s, m, p, twr, twi, twstride * s);
+
+        std::swap(ar, br);
+        std::swap(ai, bi);
+        s *= p;
+        l = m;
+    }
+
+    if (ar != xr)
+    {
+        memcpy(xr, ar, n * sizeof(float));
+        memcpy(xi, ai, n * sizeof(float));
+    }
+}
+
+// in-place inverse complex transform of n points on xr/xi, scaled by 1/n
+static void ifft_complex(float* xr, float* xi, float* yr, float* yi, int n, const std::vector<int>& factors, const Mat& twiddles, int twstride)
+{
+    // ifft(x) = conj(fft(conj(x))) / n
+    for (int i = 0; i < n; i++)
+    {
+        xi[i] = -xi[i];
+    }
+
+    fft_complex(xr, xi, yr, yi, n, factors, twiddles, twstride);
+
+    const float scale = 1.f / n;
+    for (int i = 0; i < n; i++)
+    {
+        xr[i] *= scale;
+        xi[i] *= -scale;
+    }
+}
+
+// forward transform of n real points, n even
+// half_factors factorizes n / 2, twiddles is the n points table
+// writes bins [0, n/2] to outr/outi
+// buffer holds 4 * (n / 2) floats
+static void rfft(const float* x, float* outr, float* outi, float* buffer, int n, const std::vector<int>& half_factors, const Mat& twiddles)
+{
+    const int h = n / 2;
+
+    float* zr = buffer;
+    float* zi = buffer + h;
+
+    // pack even samples as real and odd samples as imaginary
+    for (int i = 0; i < h; i++)
+    {
+        zr[i] = x[i * 2];
+        zi[i] = x[i * 2 + 1];
+    }
+
+    fft_complex(zr, zi, buffer + h * 2, buffer + h * 3, h, half_factors, twiddles, 2);
+
+    const float* twr = twiddles.row(0);
+    const float* twi = twiddles.row(1);
+
+    // X[k] = E[k] + W_n^k * O[k]
+    // E[k] = (Z[k] + conj(Z[h-k])) / 2
+    // O[k] = (Z[k] - conj(Z[h-k])) / 2i
+    for (int k = 0; k <= h; k++)
+    {
+        const int k0 = k == h ? 0 : k;
+        const int k1 = k == 0 ? 0 : h - k;
+
+        const float er = 0.5f * (zr[k0] + zr[k1]);
+        const float ei = 0.5f * (zi[k0] - zi[k1]);
+        const float or_ = 0.5f * (zi[k0] + zi[k1]);
+        const float oi = -0.5f * (zr[k0] - zr[k1]);
+
+        outr[k] = er + or_ * twr[k] - oi * twi[k];
+        outi[k] = ei + or_ * twi[k] + oi * twr[k];
+    }
+}
+
+// inverse transform of the hermitian spectrum bins [0, n/2] to n real points, n even, scaled by 1/n
+// the imaginary parts of the dc and nyquist bins are ignored
+// buffer holds 4 * (n / 2) floats
+static void irfft(const float* inr, const float* ini, float* x, float* buffer, int n, const std::vector<int>& half_factors, const Mat& twiddles)
+{
+    const int h = n / 2;
+
+    float* zr = buffer;
+    float* zi = buffer + h;
+
+    const float* twr = twiddles.row(0);
+    const float* twi = twiddles.row(1);
+
+    // E[k] = (X[k] + conj(X[h-k])) / 2
+    // O[k] = (X[k] - conj(X[h-k])) / 2 * W_n^-k
+    // Z[k] = E[k] + i * O[k]
+    for (int k = 0; k < h; k++)
+    {
+        const float ar = inr[k];
+        const float ai = k == 0 ? 0.f : ini[k];
+        const float br = inr[h - k];
+        const float bi = k == 0 ? 0.f : -ini[h - k];
+
+        const float er = 0.5f * (ar + br);
+        const float ei = 0.5f * (ai + bi);
+        const float dr = 0.5f * (ar - br);
+        const float di = 0.5f * (ai - bi);
+        const float or_ = dr * twr[k] + di * twi[k];
+        const float oi = di * twr[k] - dr * twi[k];
+
+        zr[k] = er - oi;
+        zi[k] = ei + or_;
+    }
+
+    ifft_complex(zr, zi, buffer + h * 2, buffer + h * 3, h, half_factors, twiddles, 2);
+
+    for (int i = 0; i < h; i++)
+    {
+        x[i * 2] = zr[i];
+        x[i * 2 + 1] = zi[i];
+    }
+}
+
+} // namespace ncnn
+
+#endif // LAYER_FFT_H
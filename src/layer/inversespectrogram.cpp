@@ -3,6 +3,9 @@
 
 #include "inversespectrogram.h"
 
+#include "cpu.h"
+#include "fft.h"
+
 namespace ncnn {
 
 InverseSpectrogram::InverseSpectrogram()
@@ -71,6 +74,15 @@ int InverseSpectrogram::load_param(const ParamDict& pd)
         }
     }
 
+    // pre-calculated fft twiddles and radix factors
+    if (n_fft > 0)
+    {
+        fft_make_twiddles(n_fft, twiddle_data);
+        fft_make_factors(n_fft, fft_factors);
+        if (n_fft % 2 == 0)
+            fft_make_factors(n_fft / 2, rfft_factors);
+    }
+
     return 0;
 }
 
@@ -102,100 +114,140 @@ int InverseSpectrogram::forward(const Mat& bottom_blob, Mat& top_blob, const Opt
     if (top_blob.empty())
         return -100;
 
-    Mat window_sumsquare(outsize + n_fft, elemsize, opt.workspace_allocator);
-    if (window_sumsquare.empty())
+    // real output from a onesided spectrum only needs the half size transform
+    const int use_rfft = onesided == 1 && returns == 1 && n_fft % 2 == 0;
+
+    float norm = 1.f;
+    if (normalized == 1)
+    {
+        norm = sqrt(n_fft);
+    }
+    if (normalized == 2)
+    {
+        norm = window_data[n_fft];
+    }
+
+    // windowed inverse transform of every frame, imaginary part in channel 1 for complex output
+    Mat frames_data(n_fft, frames, returns == 0 ? 2 : 1, elemsize, opt.workspace_allocator);
+    if (frames_data.empty())
         return -100;
 
-    top_blob.fill(0.f);
-    window_sumsquare.fill(0.f);
+    // transform scratch per thread
+    Mat buffer(n_fft * 4 + 2, opt.num_threads, 4u, opt.workspace_allocator);
+    if (buffer.empty())
+        return -100;
 
+    #pragma omp parallel for num_threads(opt.num_threads)
     for (int j = 0; j < frames; j++)
     {
-        // collect complex
-        Mat sp(2, n_fft);
-        if (onesided == 1)
+        float* buf = buffer.row(get_omp_thread_num());
+        float* outptr = frames_data.channel(0).row(j);
+
+        if (use_rfft)
         {
-            for (int k = 0; k < n_fft / 2 + 1; k++)
+            float* inr = buf;
+            float* ini = buf + freqs;
+            for (int k = 0; k < freqs; k++)
             {
-                sp.row(k)[0] = bottom_blob.channel(k).row(j)[0];
-                sp.row(k)[1] = bottom_blob.channel(k).row(j)[1];
-            }
-            for (int k = n_fft / 2 + 1; k < n_fft; k++)
-            {
-                sp.row(k)[0] = bottom_blob.channel(n_fft - k).row(j)[0];
-                sp.row(k)[1] = -bottom_blob.channel(n_fft - k).row(j)[1];
+                const float* ptr = bottom_blob.channel(k).row(j);
+                inr[k] = ptr[0] * norm;
+                ini[k] = ptr[1] * norm;
             }
+
+            irfft(inr, ini, outptr, ini + freqs, n_fft, rfft_factors, twiddle_data);
         }
         else
         {
-            for (int k = 0; k < n_fft; k++)
+            // collect complex
+            float* xr = buf;
+            float* xi = buf + n_fft;
+            if (onesided == 1)
             {
-                sp.row(k)[0] = bottom_blob.channel(k).row(j)[0];
-                sp.row(k)[1] = bottom_blob.channel(k).row(j)[1];
+                for (int k = 0; k < n_fft / 2 + 1; k++)
+                {
+                    const float* ptr = bottom_blob.channel(k).row(j);
+                    xr[k] = ptr[0] * norm;
+                    xi[k] = ptr[1] * norm;
+                }
+                for (int k = n_fft / 2 + 1; k < n_fft; k++)
+                {
+                    const float* ptr = bottom_blob.channel(n_fft - k).row(j);
+                    xr[k] = ptr[0] * norm;
+                    xi[k] = -ptr[1] * norm;
+                }
+            }
+            else
+            {
+                for (int k = 0; k < n_fft; k++)
+                {
+                    const float* ptr = bottom_blob.channel(k).row(j);
+                    xr[k] = ptr[0] * norm;
+                    xi[k] = ptr[1] * norm;
+                }
             }
-        }
 
-        if (normalized == 1)
-        {
-            float norm = sqrt(n_fft);
-            for (int i = 0; i < 2 * n_fft; i++)
+            ifft_complex(xr, xi, buf + n_fft * 2, buf + n_fft * 3, n_fft, fft_factors, twiddle_data, 1);
+
+            if (returns == 0)
             {
-                sp[i] *= norm;
+                memcpy(outptr, xr, n_fft * sizeof(float));
+                memcpy(frames_data.channel(1).row(j), xi, n_fft * sizeof(float));
             }
-        }
-        if (normalized == 2)
-        {
-            float norm = window_data[n_fft];
-            for (int i = 0; i < 2 * n_fft; i++)
+            if (returns == 1)
+            {
+                memcpy(outptr, xr, n_fft * sizeof(float));
+            }
+            if (returns == 2)
             {
-                sp[i] *= norm;
+                memcpy(outptr, xi, n_fft * sizeof(float));
             }
         }
 
-        #pragma omp parallel for num_threads(opt.num_threads)
-        for (int i = 0; i < n_fft; i++)
+        // apply window
+        for (int q = 0; q < frames_data.c; q++)
         {
-            // inverse dft
-            float re = 0.f;
-            float im = 0.f;
-            for (int k = 0; k < n_fft; k++)
+            float* ptr = frames_data.channel(q).row(j);
+            for (int i = 0; i < n_fft; i++)
             {
-                double angle = 2 * 3.14159265358979323846 * i * k / n_fft;
-
-                re += sp.row(k)[0] * cosf(angle) - sp.row(k)[1] * sinf(angle);
-                im += sp.row(k)[0] * sinf(angle) + sp.row(k)[1] * cosf(angle);
+                ptr[i] *= window_data[i];
             }
+        }
+    }
 
-            re /= n_fft;
-            im /= n_fft;
+    Mat window_sumsquare(outsize + n_fft, elemsize, opt.workspace_allocator);
+    if (window_sumsquare.empty())
+        return -100;
+
+    top_blob.fill(0.f);
+    window_sumsquare.fill(0.f);
 
-            // apply window
-            re *= window_data[i];
-            im *= window_data[i];
+    // overlap add
+    for (int j = 0; j < frames; j++)
+    {
+        const float* reptr = frames_data.channel(0).row(j);
+        const float* imptr = returns == 0 ? frames_data.channel(1).row(j) : 0;
 
+        for (int i = 0; i < n_fft; i++)
+        {
             int output_index = j * hoplen + i;
             if (center == 1)
             {
                 output_index -= n_fft / 2;
             }
-            if (output_index >= 0 && output_index < outsize)
-            {
-                // square window
-                window_sumsquare[output_index] += window_data[i] * window_data[i];
+            if (output_index < 0 || output_index >= outsize)
+                continue;
 
-                if (returns == 0)
-                {
-                    top_blob.row(output_index)[0] += re;
-                    top_blob.row(output_index)[1] += im;
-                }
-                if (returns == 1)
-                {
-                    top_blob[output_index] += re;
-                }
-                if (returns == 2)
-                {
-                    top_blob[output_index] += im;
-                }
+            // square window
+            window_sumsquare[output_index] += window_data[i] * window_data[i];
+
+            if (returns == 0)
+            {
+                top_blob.row(output_index)[0] += reptr[i];
+                top_blob.row(output_index)[1] += imptr[i];
+            }
+            else
+            {
+                top_blob[output_index] += reptr[i];
             }
         }
     }
@@ -20,6 +20,8 @@ int MultiHeadAttention::load_param(const ParamDict& pd)
     vdim = pd.get(4, embed_dim);
     attn_mask = pd.get(5, 0);
     scale = pd.get(6, 1.f / sqrtf(embed_dim / num_heads));
+    causal = pd.get(7, 0);
+    kv_cache = pd.get(8, 0);
     int8_scale_term = pd.get(18, 0);
 
     return 0;
@@ -74,6 +76,43 @@ int MultiHeadAttention::load_model(const ModelBin& mb)
     return 0;
 }
 
+// xk and xv hold the new positions after past_seqlen, fill in the cached positions and write out the grown cache
+// the cache rows are the affine(k) and affine(v) features of all heads, the columns are sequence positions
+static void kv_cache_concat(const Mat& cache_k_blob, const Mat& cache_v_blob, Mat& xk, Mat& xv, Mat& top_cache_k_blob, Mat& top_cache_v_blob, int q, int past_seqlen)
+{
+    const int embed_dim_per_head = xk.w;
+    const int dst_seqlen = xk.h;
+
+    Mat xkm = xk.channel(q);
+    Mat xvm = xv.channel(q);
+
+    for (int i = 0; i < embed_dim_per_head; i++)
+    {
+        if (past_seqlen > 0)
+        {
+            const float* kptr = cache_k_blob.row(q * embed_dim_per_head + i);
+            const float* vptr = cache_v_blob.row(q * embed_dim_per_head + i);
+
+            for (int j = 0; j < past_seqlen; j++)
+            {
+                xkm.row(j)[i] = kptr[j];
+            }
+
+            memcpy(xvm.row(i), vptr, past_seqlen * sizeof(float));
+        }
+
+        float* outkptr = top_cache_k_blob.row(q * embed_dim_per_head + i);
+        float* outvptr = top_cache_v_blob.row(q * embed_dim_per_head + i);
+
+        for (int j = 0; j < dst_seqlen; j++)
+        {
+            outkptr[j] = xkm.row(j)[i];
+        }
+
+        memcpy(outvptr, xvm.row(i), dst_seqlen * sizeof(float));
+    }
+}
+
 // refers to https://pytorch.org/docs/stable/generated/torch.nn.MultiheadAttention.html
 int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
@@ -84,13 +123,19 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
     }
 #endif
 
+    // the cached k v blobs always come last
+    const size_t bottom_blob_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : (bottom_blob_count == 2 || (bottom_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blob_count - 1] : Mat();
+    const Mat& cache_k_blob = kv_cache ? bottom_blobs[bottom_blob_count] : Mat();
+    const Mat& cache_v_blob = kv_cache ? bottom_blobs[bottom_blob_count + 1] : Mat();
 
+    const int past_seqlen = cache_k_blob.empty() ? 0 : cache_k_blob.w;
     const int src_seqlen = q_blob.h;
-    const int dst_seqlen = k_blob.h;
+    const int dst_seqlen = past_seqlen + k_blob.h;
     const int embed_dim_per_head = embed_dim / num_heads;
     const int qdim = weight_data_size / embed_dim;
 
@@ -101,6 +146,17 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
     if (top_blob.empty())
         return -100;
 
+    if (kv_cache)
+    {
+        top_blobs[1].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[1].empty())
+            return -100;
+
+        top_blobs[2].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[2].empty())
+            return -100;
+    }
+
     Mat xq(embed_dim_per_head, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xq.empty())
         return -100;
@@ -150,9 +206,9 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
         {
             Mat outm = xk.channel(q);
 
-            for (int i = 0; i < dst_seqlen; i++)
+            for (int i = 0; i < k_blob.h; i++)
             {
-                float* outptr = outm.row(i);
+                float* outptr = outm.row(past_seqlen + i);
 
                 for (int j = 0; j < embed_dim_per_head; j++)
                 {
@@ -176,7 +232,7 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
 
             for (int i = 0; i < embed_dim_per_head; i++)
             {
-                for (int j = 0; j < dst_seqlen; j++)
+                for (int j = 0; j < v_blob.h; j++)
                 {
                     const float* ptr = v_blob.row(j);
                     const float* kptr = (const float*)v_weight_data + vdim * (q * embed_dim_per_head + i);
@@ -189,11 +245,16 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
 
                     float* outptr = outm.row(i);
 
-                    outptr[j] = sum;
+                    outptr[past_seqlen + j] = sum;
                 }
             }
         }
 
+        if (kv_cache)
+        {
+            kv_cache_concat(cache_k_blob, cache_v_blob, xk, xv, top_blobs[1], top_blobs[2], q, past_seqlen);
+        }
+
         // xqk = xq * xk
         // xq  (embed_dim_per_head, src_seqlen)
         // xk  (embed_dim_per_head, dst_seqlen)
@@ -241,6 +302,22 @@ int MultiHeadAttention::forward(const std::vector<Mat>& bottom_blobs, std::vecto
             }
         }
 
+        // xqk = -inf where the key comes after the query, the last query sees every key
+        if (causal)
+        {
+            Mat outm = xqk.channel(q);
+
+            for (int i = 0; i < src_seqlen; i++)
+            {
+                float* outptr = outm.row(i);
+
+                for (int j = std::max(i + dst_seqlen - src_seqlen + 1, 0); j < dst_seqlen; j++)
+                {
+                    outptr[j] = -FLT_MAX;
+                }
+            }
+        }
+
         // softmax(xqk)
         {
             Mat outm = xqk.channel(q);
@@ -394,13 +471,19 @@ static void dynamic_quantize_2d_per_h(const Mat& blob, Mat& blob_int8, Mat& scal
 
 int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
+    // the cached k v blobs always come last
+    const size_t bottom_blob_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : (bottom_blob_count == 2 || (bottom_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blob_count - 1] : Mat();
+    const Mat& cache_k_blob = kv_cache ? bottom_blobs[bottom_blob_count] : Mat();
+    const Mat& cache_v_blob = kv_cache ? bottom_blobs[bottom_blob_count + 1] : Mat();
 
+    const int past_seqlen = cache_k_blob.empty() ? 0 : cache_k_blob.w;
     const int src_seqlen = q_blob.h;
-    const int dst_seqlen = k_blob.h;
+    const int dst_seqlen = past_seqlen + k_blob.h;
     const int embed_dim_per_head = embed_dim / num_heads;
     const int qdim = weight_data_size / embed_dim;
 
@@ -411,6 +494,17 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     if (top_blob.empty())
         return -100;
 
+    if (kv_cache)
+    {
+        top_blobs[1].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[1].empty())
+            return -100;
+
+        top_blobs[2].create(dst_seqlen, embed_dim, 4u, opt.blob_allocator);
+        if (top_blobs[2].empty())
+            return -100;
+    }
+
     Mat xq(embed_dim_per_head, src_seqlen, num_heads, 4u, opt.workspace_allocator);
     if (xq.empty())
         return -100;
@@ -437,7 +531,7 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     // dynamic quantize k_blob
     Mat k_blob_int8;
     float k_blob_int8_scale;
-    if (bottom_blobs.size() == 1)
+    if (bottom_blob_count == 1)
     {
         k_blob_int8 = q_blob_int8;
         k_blob_int8_scale = q_blob_int8_scale;
@@ -450,12 +544,12 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
     // dynamic quantize v_blob
     Mat v_blob_int8;
     float v_blob_int8_scale;
-    if (bottom_blobs.size() == 1)
+    if (bottom_blob_count == 1)
     {
         v_blob_int8 = q_blob_int8;
         v_blob_int8_scale = q_blob_int8_scale;
     }
-    else if (bottom_blobs.size() == 2)
+    else if (bottom_blob_count == 2)
     {
         v_blob_int8 = k_blob_int8;
         v_blob_int8_scale = k_blob_int8_scale;
@@ -498,7 +592,7 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
 
         // xk = affine(k)
         {
-            float* outptr = xk.channel(q);
+            float* outptr = xk.channel(q).row(past_seqlen);
 
             for (int i = 0; i < k_blob_int8.h; i++)
             {
@@ -526,7 +620,7 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
 
             for (int i = 0; i < embed_dim_per_head; i++)
             {
-                float* outptr = outm.row(i);
+                float* outptr = outm.row(i) + past_seqlen;
 
                 for (int j = 0; j < v_blob_int8.h; j++)
                 {
@@ -546,6 +640,11 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
             }
         }
 
+        if (kv_cache)
+        {
+            kv_cache_concat(cache_k_blob, cache_v_blob, xk, xv, top_blobs[1], top_blobs[2], q, past_seqlen);
+        }
+
         // xqk = xq * xk
         // xq  (embed_dim_per_head, src_seqlen)
         // xk  (embed_dim_per_head, dst_seqlen)
@@ -605,6 +704,22 @@ int MultiHeadAttention::forward_int8(const std::vector<Mat>& bottom_blobs, std::
             }
         }
 
+        // xqk = -inf where the key comes after the query, the last query sees every key
+        if (causal)
+        {
+            Mat outm = xqk.channel(q);
+
+            for (int i = 0; i < src_seqlen; i++)
+            {
+                float* outptr = outm.row(i);
+
+                for (int j = std::max(i + dst_seqlen - src_seqlen + 1, 0); j < dst_seqlen; j++)
+                {
+                    outptr[j] = -FLT_MAX;
+                }
+            }
+        }
+
         // softmax(xqk)
         {
             Mat outm = xqk.channel(q);
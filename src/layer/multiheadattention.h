@@ -32,6 +32,8 @@ public:
     int vdim;
     int attn_mask;
     float scale;
+    int causal;
+    int kv_cache;
 
     int int8_scale_term;
 
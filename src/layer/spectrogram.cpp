@@ -3,6 +3,9 @@
 
 #include "spectrogram.h"
 
+#include "cpu.h"
+#include "fft.h"
+
 namespace ncnn {
 
 Spectrogram::Spectrogram()
@@ -73,6 +76,16 @@ int Spectrogram::load_param(const ParamDict& pd)
         }
     }
 
+    // pre-calculated fft twiddles and radix factors
+    if (n_fft > 0)
+    {
+        fft_make_twiddles(n_fft, twiddle_data);
+        if (n_fft % 2 == 0)
+            fft_make_factors(n_fft / 2, rfft_factors);
+        else
+            fft_make_factors(n_fft, fft_factors);
+    }
+
     return 0;
 }
 
@@ -115,63 +128,74 @@ int Spectrogram::forward(const Mat& bottom_blob, Mat& top_blob, const Option& op
     if (top_blob.empty())
         return -100;
 
+    // windowed frame and transform scratch per thread
+    Mat buffer(n_fft * 4 + 2, opt.num_threads, 4u, opt.workspace_allocator);
+    if (buffer.empty())
+        return -100;
+
+    float norm = 1.f;
+    if (normalized == 1)
+    {
+        norm = 1.f / sqrt(n_fft);
+    }
+    if (normalized == 2)
+    {
+        norm = window_data[n_fft];
+    }
+
     #pragma omp parallel for num_threads(opt.num_threads)
-    for (int i = 0; i < freqs_onesided; i++)
+    for (int j = 0; j < frames; j++)
     {
-        const float* ptr = bottom_blob_bordered;
-        float* outptr = power == 0 ? top_blob.channel(i) : top_blob.row(i);
+        const float* ptr = (const float*)bottom_blob_bordered + j * hoplen;
+        float* buf = buffer.row(get_omp_thread_num());
 
-        for (int j = 0; j < frames; j++)
+        // apply window
+        float* xptr = buf;
+        for (int k = 0; k < n_fft; k++)
         {
-            float re = 0.f;
-            float im = 0.f;
-            for (int k = 0; k < n_fft; k++)
-            {
-                float v = ptr[k];
-
-                // apply window
-                v *= window_data[k];
-
-                // dft
-                double angle = 2 * 3.14159265358979323846 * i * k / n_fft;
+            xptr[k] = ptr[k] * window_data[k];
+        }
 
-                re += v * cosf(angle); // + imag * sinf(angle);
-                im -= v * sinf(angle); // + imag * cosf(angle);
-            }
+        const float* re;
+        const float* im;
+        if (n_fft % 2 == 0)
+        {
+            float* outr = buf + n_fft;
+            float* outi = outr + freqs_onesided;
+            rfft(xptr, outr, outi, outi + freqs_onesided, n_fft, rfft_factors, twiddle_data);
+            re = outr;
+            im = outi;
+        }
+        else
+        {
+            float* xi = buf + n_fft;
+            memset(xi, 0, n_fft * sizeof(float));
+            fft_complex(xptr, xi, buf + n_fft * 2, buf + n_fft * 3, n_fft, fft_factors, twiddle_data, 1);
+            re = xptr;
+            im = xi;
+        }
 
-            if (normalized == 1)
-            {
-                float norm = 1.f / sqrt(n_fft);
-                re *= norm;
-                im *= norm;
-            }
-            if (normalized == 2)
-            {
-                float norm = window_data[n_fft];
-                re *= norm;
-                im *= norm;
-            }
+        for (int i = 0; i < freqs_onesided; i++)
+        {
+            const float vr = re[i] * norm;
+            const float vi = im[i] * norm;
 
             if (power == 0)
             {
                 // complex as real
-                outptr[0] = re;
-                outptr[1] = im;
-                outptr += 2;
+                float* outptr = top_blob.channel(i).row(j);
+                outptr[0] = vr;
+                outptr[1] = vi;
             }
             if (power == 1)
             {
                 // magnitude
-                outptr[0] = sqrt(re * re + im * im);
-                outptr += 1;
+                top_blob.row(i)[j] = sqrt(vr * vr + vi * vi);
             }
             if (power == 2)
             {
-                outptr[0] = re * re + im * im;
-                outptr += 1;
+                top_blob.row(i)[j] = vr * vr + vi * vi;
             }
-
-            ptr += hoplen;
         }
     }
 
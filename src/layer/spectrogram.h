@@ -29,6 +29,11 @@ public:
     int onesided;
 
     Mat window_data;
+
+    // fft plan of n_fft, radix factors of n_fft / 2 for the real transform of even n_fft
+    Mat twiddle_data;
+    std::vector<int> fft_factors;
+    std::vector<int> rfft_factors;
 };
 
 } // namespace ncnn
@@ -0,0 +1,238 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "convolution3d_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __SSSE3__
+#include <tmmintrin.h>
+#if __SSE4_1__
+#include <smmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif
+#endif // __SSE4_1__
+#endif // __SSSE3__
+#endif // __SSE2__
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+#include "cpu.h"
+#include "layer_type.h"
+
+namespace ncnn {
+
+#include "convolution_im2col_gemm.h"
+
+Convolution3D_x86::Convolution3D_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+
+    activation = 0;
+    nT = 0;
+}
+
+// the depth axis is folded into the input channels, kernel_d * num_input channels of a kernel_w x kernel_h 2d convolution
+// the im2col gemm elempack of these channels follows the same rule as convolution_im2col_gemm_transform_kernel
+static int convolution3d_gemm_elempack(int inch, const Option& opt)
+{
+    int elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        elempack = inch % 16 == 0 ? 16 : inch % 8 == 0 ? 8 : inch % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        elempack = inch % 8 == 0 ? 8 : inch % 4 == 0 ? 4 : 1;
+#else
+        elempack = inch % 4 == 0 ? 4 : 1;
+#endif
+    }
+#else
+    (void)inch;
+    (void)opt;
+#endif // __SSE2__
+
+    return elempack;
+}
+
+int Convolution3D_x86::create_pipeline(const Option& opt)
+{
+    activation = create_activation_layer(activation_type, activation_params, opt);
+    nT = opt.num_threads;
+
+    const int maxk = kernel_w * kernel_h * kernel_d;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    // src = kw-kh-kd-inch-outch
+    // dst = kw-kh-inch-kd-outch
+    Mat weight_data_r2;
+    if (kernel_d == 1)
+    {
+        weight_data_r2 = weight_data;
+    }
+    else
+    {
+        const int maxk2 = kernel_w * kernel_h;
+
+        weight_data_r2.create(maxk * num_input * num_output);
+
+        for (int q = 0; q < num_output; q++)
+        {
+            const float* kptr = (const float*)weight_data + maxk * num_input * q;
+            float* g00 = (float*)weight_data_r2 + maxk * num_input * q;
+
+            for (int z = 0; z < kernel_d; z++)
+            {
+                for (int p = 0; p < num_input; p++)
+                {
+                    memcpy(g00, kptr + maxk * p + maxk2 * z, maxk2 * sizeof(float));
+                    g00 += maxk2;
+                }
+            }
+        }
+    }
+
+    convolution_im2col_gemm_transform_kernel(weight_data_r2, weight_sgemm_data, kernel_d * num_input, num_output, kernel_w, kernel_h, opt);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int Convolution3D_x86::destroy_pipeline(const Option& opt)
+{
+    if (activation)
+    {
+        activation->destroy_pipeline(opt);
+        delete activation;
+        activation = 0;
+    }
+
+    return 0;
+}
+
+int Convolution3D_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int channels = bottom_blob.c;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    const int num_input = channels * elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+    const int kernel_extent_d = dilation_d * (kernel_d - 1) + 1;
+
+    Mat bottom_blob_bordered;
+    make_padding(bottom_blob, bottom_blob_bordered, opt);
+    if (bottom_blob_bordered.empty())
+        return -100;
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+    const int d = bottom_blob_bordered.d;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+    const int outd = (d - kernel_extent_d) / stride_d + 1;
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    top_blob.create(outw, outh, outd, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int _nT = nT ? nT : opt.num_threads;
+    if (nT != 0 && opt.num_threads > nT)
+    {
+        // force num_threads the same as in create_pipeline
+        // so we could use pre-packed A/B from the same tile config
+        NCNN_LOGE("opt.num_threads %d changed, convolution3d gemm will use load-time value %d", opt.num_threads, nT);
+    }
+
+    const int gemm_elempack = convolution3d_gemm_elempack(kernel_d * num_input, opt);
+    const size_t gemm_elemsize = elemsize / elempack * gemm_elempack;
+
+    // the kernel_d input slices contributing to one output depth, stacked along channels
+    Mat bottom_blob_slices;
+    if (kernel_d != 1)
+    {
+        bottom_blob_slices.create(w, h, kernel_d * channels, elemsize, elempack, opt.workspace_allocator);
+        if (bottom_blob_slices.empty())
+            return -100;
+    }
+
+    for (int z = 0; z < outd; z++)
+    {
+        Mat bottom_blob_z;
+        if (kernel_d == 1)
+        {
+            // view of the input slice, no copy
+            bottom_blob_z = Mat(w, h, channels, (float*)bottom_blob_bordered + z * stride_d * w * h * elempack, elemsize, elempack);
+            bottom_blob_z.cstep = bottom_blob_bordered.cstep;
+        }
+        else
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int kq = 0; kq < kernel_d * channels; kq++)
+            {
+                const int kz = kq / channels;
+                const int q = kq % channels;
+
+                const float* ptr = bottom_blob_bordered.channel(q).depth(z * stride_d + kz * dilation_d);
+                float* outptr = bottom_blob_slices.channel(kq);
+
+                memcpy(outptr, ptr, w * h * elemsize);
+            }
+
+            bottom_blob_z = bottom_blob_slices;
+        }
+
+        if (gemm_elempack != elempack)
+        {
+            Mat bottom_blob_z_packed;
+            Option opt_pack = opt;
+            opt_pack.blob_allocator = opt.workspace_allocator;
+            convert_packing(bottom_blob_z, bottom_blob_z_packed, gemm_elempack, opt_pack);
+            if (bottom_blob_z_packed.empty() || bottom_blob_z_packed.elemsize != gemm_elemsize)
+                return -100;
+
+            bottom_blob_z = bottom_blob_z_packed;
+        }
+
+        // view of the output slice, writing through to top_blob
+        Mat top_blob_z(outw, outh, num_output / out_elempack, (float*)top_blob + z * outw * outh * out_elempack, out_elemsize, out_elempack);
+        top_blob_z.cstep = top_blob.cstep;
+
+        int ret = convolution_im2col_gemm(bottom_blob_z, top_blob_z, weight_sgemm_data, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, _nT, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    if (activation)
+    {
+        activation->forward_inplace(top_blob, opt);
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,472 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// gemm_x86.h
+#if NCNN_RUNTIME_CPU && __AVX512F__
+namespace Gemm_x86_avx512_utility {
+#elif NCNN_RUNTIME_CPU && __FMA__
+namespace Gemm_x86_fma_utility {
+#elif NCNN_RUNTIME_CPU && __AVX__
+namespace Gemm_x86_avx_utility {
+#else
+namespace Gemm_x86_utility {
+#endif
+void pack_A_tile_fp32_to_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
+int get_B_tile_amx_size_bf16s(int TILE_N, int TILE_K);
+void pack_B_tile_bf16s_amx(Mat& BT, int max_jj, int max_kk);
+void gemm_tile_config_bf16s();
+void gemm_tile_release_bf16s();
+void gemm_transB_packed_tile_bf16s(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+void unpack_output_tile_fp32_to_bf16(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, float alpha, int output_transpose, int activation_type, const Mat& activation_params);
+}
+
+static int convolution_im2col_B_tile_amx_size_bf16s(int TILE_N, int TILE_K)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    return Gemm_x86_avx512_utility::get_B_tile_amx_size_bf16s(TILE_N, TILE_K);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    return Gemm_x86_fma_utility::get_B_tile_amx_size_bf16s(TILE_N, TILE_K);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    return Gemm_x86_avx_utility::get_B_tile_amx_size_bf16s(TILE_N, TILE_K);
+#else
+    return Gemm_x86_utility::get_B_tile_amx_size_bf16s(TILE_N, TILE_K);
+#endif
+}
+
+static void convolution_im2col_pack_B_tile_bf16s_amx(Mat& BT, int max_jj, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::pack_B_tile_bf16s_amx(BT, max_jj, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::pack_B_tile_bf16s_amx(BT, max_jj, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::pack_B_tile_bf16s_amx(BT, max_jj, max_kk);
+#else
+    Gemm_x86_utility::pack_B_tile_bf16s_amx(BT, max_jj, max_kk);
+#endif
+}
+
+static void convolution_gemm_tile_config_bf16s()
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_tile_config_bf16s();
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_tile_config_bf16s();
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_tile_config_bf16s();
+#else
+    Gemm_x86_utility::gemm_tile_config_bf16s();
+#endif
+}
+
+static void convolution_gemm_tile_release_bf16s()
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_tile_release_bf16s();
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_tile_release_bf16s();
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_tile_release_bf16s();
+#else
+    Gemm_x86_utility::gemm_tile_release_bf16s();
+#endif
+}
+
+static void convolution_im2col_pack_A_tile_fp32_to_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    // A = (pa, maxk, inch/pa), outch
+
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::pack_A_tile_fp32_to_bf16(A, AT, i, max_ii, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::pack_A_tile_fp32_to_bf16(A, AT, i, max_ii, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::pack_A_tile_fp32_to_bf16(A, AT, i, max_ii, k, max_kk);
+#else
+    Gemm_x86_utility::pack_A_tile_fp32_to_bf16(A, AT, i, max_ii, k, max_kk);
+#endif
+}
+
+static void convolution_gemm_transB_packed_tile_bf16s(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+    // NCNN_LOGE("convolution_gemm_transB_packed_tile_bf16s %d %d %d %d %d %d", i, max_ii, j, max_jj, k, max_kk);
+
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#else
+    Gemm_x86_utility::gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#endif
+}
+
+static void convolution_unpack_output_tile_fp32_to_bf16(const Mat& topT, const Mat& bias, Mat& top_blob, int i, int max_ii, int j, int max_jj, int activation_type, const Mat& activation_params)
+{
+    // bias broadcasts along outch as gemm C of type M
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::unpack_output_tile_fp32_to_bf16(topT, bias, top_blob, 1, i, max_ii, j, max_jj, 1.f, 0, activation_type, activation_params);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::unpack_output_tile_fp32_to_bf16(topT, bias, top_blob, 1, i, max_ii, j, max_jj, 1.f, 0, activation_type, activation_params);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::unpack_output_tile_fp32_to_bf16(topT, bias, top_blob, 1, i, max_ii, j, max_jj, 1.f, 0, activation_type, activation_params);
+#else
+    Gemm_x86_utility::unpack_output_tile_fp32_to_bf16(topT, bias, top_blob, 1, i, max_ii, j, max_jj, 1.f, 0, activation_type, activation_params);
+#endif
+}
+
+// gather cols output pixels into the gemm B tile layout, k in pairs and one k pair holding cols columns
+// elempack is 1 or 4, noffs are the pixel offsets of every column and contiguous means noffs[c] = noffs[0] + c * elempack
+static void convolution_im2col_input_tile_bf16_block(const unsigned short* p, const size_t* noffs, int cols, bool contiguous, unsigned short* pp, int k, int max_kk, size_t cstep, int w, int elempack, int kernel_w, int kernel_h, int dilation_w, int dilation_h)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    // walk the kernel taps incrementally instead of dividing for every k
+    const int kp = k / elempack;
+    int g = kp / maxk;
+    int u = kp % maxk / kernel_w;
+    int v = kp % maxk % kernel_w;
+
+    if (elempack == 4)
+    {
+        // k starts at a pixel, one pixel holds two k pairs as 32bit words
+        for (int kk = 0; kk < max_kk; kk += 4)
+        {
+            const unsigned short* sptr = p + (g * cstep + (size_t)(u * dilation_h * w + v * dilation_w)) * 4;
+
+            v++;
+            if (v == kernel_w)
+            {
+                v = 0;
+                u++;
+                if (u == kernel_h)
+                {
+                    u = 0;
+                    g++;
+                }
+            }
+
+#if __SSE2__
+            if (cols >= 4)
+            {
+                for (int c = 0; c < cols; c += 4)
+                {
+                    __m128i _r01;
+                    __m128i _r23;
+                    if (contiguous)
+                    {
+                        _r01 = _mm_loadu_si128((const __m128i*)(sptr + noffs[c]));
+                        _r23 = _mm_loadu_si128((const __m128i*)(sptr + noffs[c] + 8));
+                    }
+                    else
+                    {
+                        _r01 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(sptr + noffs[c])), _mm_loadl_epi64((const __m128i*)(sptr + noffs[c + 1])));
+                        _r23 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(sptr + noffs[c + 2])), _mm_loadl_epi64((const __m128i*)(sptr + noffs[c + 3])));
+                    }
+                    __m128 _p0 = _mm_shuffle_ps(_mm_castsi128_ps(_r01), _mm_castsi128_ps(_r23), _MM_SHUFFLE(2, 0, 2, 0));
+                    __m128 _p1 = _mm_shuffle_ps(_mm_castsi128_ps(_r01), _mm_castsi128_ps(_r23), _MM_SHUFFLE(3, 1, 3, 1));
+                    _mm_storeu_ps((float*)(pp + c * 2), _p0);
+                    _mm_storeu_ps((float*)(pp + cols * 2 + c * 2), _p1);
+                }
+                pp += cols * 4;
+                continue;
+            }
+#endif // __SSE2__
+
+            for (int c = 0; c < cols; c++)
+            {
+                const unsigned short* sptr0 = sptr + noffs[c];
+                pp[c * 2] = sptr0[0];
+                pp[c * 2 + 1] = sptr0[1];
+                pp[cols * 2 + c * 2] = sptr0[2];
+                pp[cols * 2 + c * 2 + 1] = sptr0[3];
+            }
+            pp += cols * 4;
+        }
+
+        return;
+    }
+
+    // elempack 1, the two k of a pair are two kernel taps
+    for (int kk = 0; kk < max_kk; kk += 2)
+    {
+        const unsigned short* sptr0 = p + g * cstep + (size_t)(u * dilation_h * w + v * dilation_w);
+
+        v++;
+        if (v == kernel_w)
+        {
+            v = 0;
+            u++;
+            if (u == kernel_h)
+            {
+                u = 0;
+                g++;
+            }
+        }
+
+        if (kk + 1 == max_kk)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                pp[c * 2] = sptr0[noffs[c]];
+                pp[c * 2 + 1] = 0;
+            }
+            pp += cols * 2;
+            break;
+        }
+
+        const unsigned short* sptr1 = p + g * cstep + (size_t)(u * dilation_h * w + v * dilation_w);
+
+        v++;
+        if (v == kernel_w)
+        {
+            v = 0;
+            u++;
+            if (u == kernel_h)
+            {
+                u = 0;
+                g++;
+            }
+        }
+
+#if __SSE2__
+        if (contiguous && cols >= 4)
+        {
+            // the columns are consecutive values of both taps, interleave them as 16bit pairs
+            const unsigned short* s0 = sptr0 + noffs[0];
+            const unsigned short* s1 = sptr1 + noffs[0];
+
+            int c = 0;
+            for (; c + 7 < cols; c += 8)
+            {
+                __m128i _a = _mm_loadu_si128((const __m128i*)(s0 + c));
+                __m128i _b = _mm_loadu_si128((const __m128i*)(s1 + c));
+                _mm_storeu_si128((__m128i*)(pp + c * 2), _mm_unpacklo_epi16(_a, _b));
+                _mm_storeu_si128((__m128i*)(pp + c * 2 + 8), _mm_unpackhi_epi16(_a, _b));
+            }
+            for (; c < cols; c += 4)
+            {
+                __m128i _a = _mm_loadl_epi64((const __m128i*)(s0 + c));
+                __m128i _b = _mm_loadl_epi64((const __m128i*)(s1 + c));
+                _mm_storeu_si128((__m128i*)(pp + c * 2), _mm_unpacklo_epi16(_a, _b));
+            }
+            pp += cols * 2;
+            continue;
+        }
+#endif // __SSE2__
+
+        for (int c = 0; c < cols; c++)
+        {
+            pp[c * 2] = sptr0[noffs[c]];
+            pp[c * 2 + 1] = sptr1[noffs[c]];
+        }
+        pp += cols * 2;
+    }
+}
+
+static void convolution_im2col_input_tile_bf16s(const Mat& bottom_blob, Mat& B, int j, int max_jj, int k, int max_kk, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h)
+{
+    const int w = bottom_blob.w;
+    const size_t cstep = bottom_blob.cstep;
+    const int elempack = bottom_blob.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+
+    const int max_kk2 = (max_kk + 1) / 2 * 2;
+
+    const unsigned short* p = bottom_blob;
+
+    unsigned short* pp = B;
+
+    size_t noffs[12];
+
+    int jj = 0;
+    while (jj < max_jj)
+    {
+        // the column group size of the packed layout
+        int cols = 1;
+#if __SSE2__
+        cols = max_jj - jj >= 12 ? 12 : max_jj - jj >= 4 ? 4 : 1;
+#endif // __SSE2__
+
+        int dy = (j + jj) / outw;
+        int dx = (j + jj) % outw;
+
+        bool contiguous = true;
+        for (int c = 0; c < cols; c++)
+        {
+            noffs[c] = (size_t)(stride_h * dy * w + stride_w * dx) * elempack;
+            contiguous = contiguous && noffs[c] == noffs[0] + c * elempack;
+
+            dx++;
+            if (dx == outw)
+            {
+                dx = 0;
+                dy++;
+            }
+        }
+
+        convolution_im2col_input_tile_bf16_block(p, noffs, cols, contiguous, pp, k, max_kk, cstep, w, elempack, kernel_w, kernel_h, dilation_w, dilation_h);
+
+        pp += cols * max_kk2;
+        jj += cols;
+    }
+}
+
+static void convolution_im2col_gemm_transform_kernel_bf16s(const Mat& kernel, Mat& AT, int inch, int outch, int kernel_w, int kernel_h, const Option& opt)
+{
+    // NCNN_LOGE("convolution_im2col_gemm_transform_kernel_bf16s");
+    const int maxk = kernel_w * kernel_h;
+
+    const int M = outch;
+    const int K = inch * maxk;
+
+    int TILE_M, TILE_N, TILE_K;
+    convolution_im2col_gemm_get_optimal_tile_mnk(M, 0, K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+
+    const int nn_M = (M + TILE_M - 1) / TILE_M;
+
+    int elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+        elempack = inch % 4 == 0 ? 4 : 1;
+    }
+#endif // __SSE2__
+
+    // maxk-inch-outch to pa-maxk-inch/pa-outch
+    Mat A_data;
+    if (maxk == 1)
+    {
+        A_data = kernel.reshape(maxk * inch, outch);
+    }
+    else
+    {
+        Mat weight_data_r2 = kernel.reshape(maxk, inch, outch);
+
+        A_data.create(maxk * inch, outch);
+
+        for (int q = 0; q < outch; q += 1)
+        {
+            float* g00 = A_data.row(q);
+
+            for (int p = 0; p + (elempack - 1) < inch; p += elempack)
+            {
+                for (int k = 0; k < maxk; k++)
+                {
+                    for (int i = 0; i < elempack; i++)
+                    {
+                        const float* k00 = weight_data_r2.channel(q).row(p + i);
+                        g00[0] = k00[k];
+                        g00++;
+                    }
+                }
+            }
+        }
+    }
+
+    AT.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, (M + TILE_M - 1) / TILE_M, (size_t)2u, 1);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ppj = 0; ppj < nn_M; ppj++)
+    {
+        const int i = ppj * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        for (int k = 0; k < K; k += TILE_K)
+        {
+            const int max_kk = std::min((K - k), TILE_K);
+
+            Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+            convolution_im2col_pack_A_tile_fp32_to_bf16(A_data, AT_tile, i, max_ii, k, max_kk);
+        }
+    }
+}
+
+static int convolution_im2col_gemm_bf16s(const Mat& bottom_blob, Mat& top_blob, const Mat& AT, const Mat& bias, int kernel_w, int kernel_h, int dilation_w, int dilation_h, int stride_w, int stride_h, int activation_type, const Mat& activation_params, int nT, const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h;
+
+    const int M = top_blob.c * top_blob.elempack;
+    const int N = top_blob.w * top_blob.h;
+    const int K = bottom_blob.c * bottom_blob.elempack * maxk;
+
+    int TILE_M, TILE_N, TILE_K;
+    convolution_im2col_gemm_get_optimal_tile_mnk(M, N, K, TILE_M, TILE_N, TILE_K, nT);
+
+    nT = std::min(nT, opt.num_threads);
+
+    const int nn_M = (M + TILE_M - 1) / TILE_M;
+    const int nn_N = (N + TILE_N - 1) / TILE_N;
+    const int nn_K = (K + TILE_K - 1) / TILE_K;
+
+    // NCNN_LOGE("TILE M/N/K = %d %d %d -> %d %d %d", M, N, K, TILE_M, TILE_N, TILE_K);
+
+    Mat BT(TILE_K * TILE_N + convolution_im2col_B_tile_amx_size_bf16s(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 2u, opt.workspace_allocator);
+    if (BT.empty())
+        return -100;
+
+    const int nn_NK = nn_N * nn_K;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppjk = 0; ppjk < nn_NK; ppjk++)
+    {
+        const int ppj = ppjk / nn_K;
+        const int ppk = ppjk % nn_K;
+
+        const int j = ppj * TILE_N;
+        const int k = ppk * TILE_K;
+
+        const int max_jj = std::min((N - j), TILE_N);
+        const int max_kk = std::min((K - k), TILE_K);
+
+        Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+        // im2col
+        convolution_im2col_input_tile_bf16s(bottom_blob, BT_tile, j, max_jj, k, max_kk, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h);
+
+        convolution_im2col_pack_B_tile_bf16s_amx(BT_tile, max_jj, max_kk);
+    }
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppj = 0; ppj < nn_M; ppj++)
+    {
+        const int i = ppj * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        convolution_gemm_tile_config_bf16s();
+
+        for (int j = 0; j < N; j += TILE_N)
+        {
+            const int max_jj = std::min((N - j), TILE_N);
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_kk = std::min((K - k), TILE_K);
+
+                const Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+                const Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                convolution_gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+            }
+
+            convolution_unpack_output_tile_fp32_to_bf16(topT_tile, bias, top_blob, i, max_ii, j, max_jj, activation_type, activation_params);
+        }
+
+        convolution_gemm_tile_release_bf16s();
+    }
+
+    return 0;
+}
@@ -32,9 +32,65 @@ namespace Gemm_x86_avx_utility {
 namespace Gemm_x86_utility {
 #endif
 void pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
+int get_B_tile_amx_size_int8(int TILE_N, int TILE_K);
+void pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk);
+void gemm_tile_config_int8();
+void gemm_tile_release_int8();
 void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
 }
 
+static int convolution_im2col_B_tile_amx_size_int8(int TILE_N, int TILE_K)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    return Gemm_x86_avx512_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    return Gemm_x86_fma_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    return Gemm_x86_avx_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#else
+    return Gemm_x86_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#endif
+}
+
+static void convolution_im2col_pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#else
+    Gemm_x86_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#endif
+}
+
+static void convolution_gemm_tile_config_int8()
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_tile_config_int8();
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_tile_config_int8();
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_tile_config_int8();
+#else
+    Gemm_x86_utility::gemm_tile_config_int8();
+#endif
+}
+
+static void convolution_gemm_tile_release_int8()
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_tile_release_int8();
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_tile_release_int8();
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_tile_release_int8();
+#else
+    Gemm_x86_utility::gemm_tile_release_int8();
+#endif
+}
+
 static void convolution_im2col_pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
 {
     // A = (pa, maxk, inch/pa), outch
@@ -4497,13 +4553,15 @@ static int convolution_im2col_gemm_int8(const Mat& bottom_blob, Mat& top_blob, c
     int TILE_M, TILE_N, TILE_K;
     convolution_im2col_gemm_get_optimal_tile_mnk_int8(M, N, K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     const int nn_M = (M + TILE_M - 1) / TILE_M;
     const int nn_N = (N + TILE_N - 1) / TILE_N;
     const int nn_K = (K + TILE_K - 1) / TILE_K;
 
     // NCNN_LOGE("TILE M/N/K = %d %d %d -> %d %d %d", M, N, K, TILE_M, TILE_N, TILE_K);
 
-    Mat BT(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
+    Mat BT(TILE_K * TILE_N + convolution_im2col_B_tile_amx_size_int8(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
     if (BT.empty())
         return -100;
 
@@ -4525,6 +4583,8 @@ static int convolution_im2col_gemm_int8(const Mat& bottom_blob, Mat& top_blob, c
 
         // im2col
         convolution_im2col_input_tile_int8(bottom_blob, BT_tile, j, max_jj, k, max_kk, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h);
+
+        convolution_im2col_pack_B_tile_int8_amx(BT_tile, max_jj, max_kk);
     }
 
     Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
@@ -4540,6 +4600,8 @@ static int convolution_im2col_gemm_int8(const Mat& bottom_blob, Mat& top_blob, c
 
         Mat topT_tile = topT.channel(get_omp_thread_num());
 
+        convolution_gemm_tile_config_int8();
+
         for (int j = 0; j < N; j += TILE_N)
         {
             const int max_jj = std::min((N - j), TILE_N);
@@ -4557,6 +4619,8 @@ static int convolution_im2col_gemm_int8(const Mat& bottom_blob, Mat& top_blob, c
 
             unpack_output_tile_int32(topT_tile, top_blob, i, max_ii, j, max_jj);
         }
+
+        convolution_gemm_tile_release_int8();
     }
 
     return 0;
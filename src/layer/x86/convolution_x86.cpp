@@ -31,6 +31,10 @@ namespace ncnn {
 #include "convolution_packed.h"
 #include "convolution_im2col_gemm.h"
 
+#if NCNN_BF16
+#include "convolution_im2col_gemm_bf16s.h"
+#endif // NCNN_BF16
+
 #if NCNN_INT8
 #include "convolution_3x3_int8.h"
 
@@ -60,6 +64,9 @@ Convolution_x86::Convolution_x86()
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 
     activation = 0;
     nT = 0;
@@ -266,6 +273,14 @@ static bool test_prefer_winograd23(int num_input, int num_output, int w, int h)
     return false;
 }
 
+#if NCNN_BF16
+bool Convolution_x86::prefer_winograd_fp32(int num_input, const Option& opt) const
+{
+    // fp32 winograd is faster than bf16 im2col gemm for 3x3s1, keep fp32 storage there
+    return opt.use_winograd_convolution && (opt.use_winograd23_convolution || opt.use_winograd43_convolution || opt.use_winograd63_convolution) && (num_input > 8 || num_output > 8) && kernel_w == 3 && kernel_h == 3 && dilation_w == 1 && dilation_h == 1 && stride_w == 1 && stride_h == 1;
+}
+#endif
+
 int Convolution_x86::create_pipeline(const Option& opt)
 {
     if (dynamic_weight)
@@ -277,6 +292,10 @@ int Convolution_x86::create_pipeline(const Option& opt)
 #if NCNN_INT8
     if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
     {
+#if NCNN_BF16
+        // the int8 path quantizes fp32 input
+        support_bf16_storage = false;
+#endif
         return create_pipeline_int8_x86(opt);
     }
 #endif
@@ -284,6 +303,16 @@ int Convolution_x86::create_pipeline(const Option& opt)
     int kernel_size = kernel_w * kernel_h;
     int num_input = weight_data_size / kernel_size / num_output;
 
+#if NCNN_BF16
+    if (opt.use_bf16_storage)
+    {
+        if (!prefer_winograd_fp32(num_input, opt))
+            return create_pipeline_bf16s(opt);
+
+        support_bf16_storage = false;
+    }
+#endif
+
     if (!opt.use_packing_layout && kernel_w == kernel_h && dilation_w != 1 && dilation_h == dilation_w && stride_w == 1 && stride_h == 1)
     {
         convolution_dilation1 = ncnn::create_layer_cpu(ncnn::LayerType::Convolution);
@@ -501,6 +530,96 @@ int Convolution_x86::destroy_pipeline(const Option& opt)
     return 0;
 }
 
+int Convolution_x86::save_pipeline_weights(std::vector<Mat>& weights) const
+{
+    if (dynamic_weight || convolution_dilation1)
+        return -1;
+
+#if NCNN_INT8
+    if (!scale_in_data.empty())
+        return -1;
+#endif
+
+    weights.resize(5);
+    weights[0] = weight_data_tm;
+    weights[1] = weight_sgemm_data;
+    weights[2] = weight_winograd23_data;
+    weights[3] = weight_winograd43_data;
+    weights[4] = weight_winograd63_data;
+
+    return 0;
+}
+
+int Convolution_x86::load_pipeline_weights(const std::vector<Mat>& weights, const Option& opt)
+{
+    if (dynamic_weight || weights.size() != 5)
+        return -1;
+
+#if NCNN_INT8
+    if (opt.use_int8_inference && weight_data.elemsize == (size_t)1u)
+        return -1;
+#endif
+
+    if (!opt.use_packing_layout && kernel_w == kernel_h && dilation_w != 1 && dilation_h == dilation_w && stride_w == 1 && stride_h == 1)
+        return -1;
+
+#if NCNN_BF16
+    if (opt.use_bf16_storage)
+    {
+        // repeat the storage decision of create_pipeline, the cached weights are fp32 winograd ones
+        const int num_input = weight_data_size / (kernel_w * kernel_h) / num_output;
+        if (prefer_winograd_fp32(num_input, opt))
+            support_bf16_storage = false;
+    }
+#endif
+
+    activation = create_activation_layer(activation_type, activation_params, opt);
+    nT = opt.num_threads;
+
+    weight_data_tm = weights[0];
+    weight_sgemm_data = weights[1];
+    weight_winograd23_data = weights[2];
+    weight_winograd43_data = weights[3];
+    weight_winograd63_data = weights[4];
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+const char* Convolution_x86::kernel_name() const
+{
+    if (dynamic_weight)
+        return "dynamic";
+
+    if (convolution_dilation1)
+        return "dilation";
+
+#if NCNN_INT8
+    if (!scale_in_data.empty())
+    {
+        if (!weight_winograd43_data.empty())
+            return "int8_winograd43";
+        if (!weight_winograd23_data.empty())
+            return "int8_winograd23";
+        if (!weight_sgemm_data.empty())
+            return "int8_sgemm";
+        return "int8_packed";
+    }
+#endif
+
+    if (!weight_winograd63_data.empty())
+        return "winograd63";
+    if (!weight_winograd43_data.empty())
+        return "winograd43";
+    if (!weight_winograd23_data.empty())
+        return "winograd23";
+    if (!weight_sgemm_data.empty())
+        return weight_sgemm_data.elembits() == 16 ? "bf16s_sgemm" : "sgemm";
+    return "packed";
+}
+
 int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
 #if NCNN_INT8
@@ -554,6 +673,13 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         return 0;
     }
 
+#if NCNN_BF16
+    if (opt.use_bf16_storage && bottom_blob.elembits() == 16)
+    {
+        return forward_bf16s(bottom_blob, top_blob, opt);
+    }
+#endif
+
     int w = bottom_blob.w;
     int h = bottom_blob.h;
     int channels = bottom_blob.c;
@@ -639,7 +765,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
         }
 
         int _nT = nT ? nT : opt.num_threads;
-        if (nT != 0 && opt.num_threads != nT)
+        if (nT != 0 && opt.num_threads > nT)
         {
             // force num_threads the same as in create_pipeline
             // so we could use pre-packed A/B from the same tile config
@@ -679,7 +805,7 @@ int Convolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option
     if ((opt.use_sgemm_convolution && prefer_sgemm) || (kernel_w == 1 && kernel_h == 1))
     {
         int _nT = nT ? nT : opt.num_threads;
-        if (nT != 0 && opt.num_threads != nT)
+        if (nT != 0 && opt.num_threads > nT)
         {
             // force num_threads the same as in create_pipeline
             // so we could use pre-packed A/B from the same tile config
@@ -819,7 +945,19 @@ int Convolution_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<M
     const int _num_output = _weight_data.c * _weight_data.elempack;
 
     Mat weight_data_flattened;
-    flatten(_weight_data, weight_data_flattened, opt);
+#if NCNN_BF16
+    if (_weight_data.elembits() == 16)
+    {
+        // weights are transformed from fp32
+        Mat _weight_data_fp32;
+        cast_bfloat16_to_float32(_weight_data, _weight_data_fp32, opt);
+        flatten(_weight_data_fp32, weight_data_flattened, opt);
+    }
+    else
+#endif
+    {
+        flatten(_weight_data, weight_data_flattened, opt);
+    }
     if (weight_data_flattened.empty())
         return -100;
 
@@ -832,7 +970,18 @@ int Convolution_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<M
     if (bias_term)
     {
         const Mat& _bias_data = bottom_blobs[2];
-        flatten(_bias_data, bias_data_flattened, opt);
+#if NCNN_BF16
+        if (_bias_data.elembits() == 16)
+        {
+            Mat _bias_data_fp32;
+            cast_bfloat16_to_float32(_bias_data, _bias_data_fp32, opt);
+            flatten(_bias_data_fp32, bias_data_flattened, opt);
+        }
+        else
+#endif
+        {
+            flatten(_bias_data, bias_data_flattened, opt);
+        }
         if (bias_data_flattened.empty())
             return -100;
 
@@ -873,7 +1022,19 @@ int Convolution_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<M
 
     op->create_pipeline(opt);
 
-    op->forward(bottom_blob, top_blob, opt);
+#if NCNN_BF16
+    if (bottom_blob.elembits() == 16 && !op->support_bf16_storage)
+    {
+        // the op keeps fp32 storage for winograd
+        Mat bottom_blob_fp32;
+        cast_bfloat16_to_float32(bottom_blob, bottom_blob_fp32, opt);
+        op->forward(bottom_blob_fp32, top_blob, opt);
+    }
+    else
+#endif
+    {
+        op->forward(bottom_blob, top_blob, opt);
+    }
 
     op->destroy_pipeline(opt);
 
@@ -1030,7 +1191,7 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads > nT)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -1109,6 +1270,172 @@ int Convolution_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_blob, con
 }
 #endif // NCNN_INT8
 
+#if NCNN_BF16
+int Convolution_x86::create_pipeline_bf16s(const Option& opt)
+{
+    const int maxk = kernel_w * kernel_h;
+    const int num_input = weight_data_size / maxk / num_output;
+
+    // the packed kernels keep fp32 storage, bf16 storage goes through im2col gemm
+    convolution_im2col_gemm_transform_kernel_bf16s(weight_data, weight_sgemm_data, num_input, num_output, kernel_w, kernel_h, opt);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+// copy_make_border reads packed 16bit storage as fp32, fill the border of the bf16 blob here
+static int copy_make_border_bf16s(const Mat& bottom_blob, Mat& top_blob, int top, int bottom, int left, int right, float v, const Option& opt)
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int channels = bottom_blob.c;
+    const int elempack = bottom_blob.elempack;
+
+    const int outw = w + left + right;
+    const int outh = h + top + bottom;
+
+    top_blob.create(outw, outh, channels, bottom_blob.elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const unsigned short pad_value = float32_to_bfloat16(v);
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        const Mat m = bottom_blob.channel(q);
+        Mat borderm = top_blob.channel(q);
+
+        unsigned short* outptr = borderm;
+
+        for (int i = 0; i < outh; i++)
+        {
+            if (i < top || i >= top + h)
+            {
+                for (int j = 0; j < outw * elempack; j++)
+                {
+                    outptr[j] = pad_value;
+                }
+                outptr += outw * elempack;
+                continue;
+            }
+
+            const unsigned short* ptr = m.row<const unsigned short>(i - top);
+
+            for (int j = 0; j < left * elempack; j++)
+            {
+                outptr[j] = pad_value;
+            }
+            outptr += left * elempack;
+
+            memcpy(outptr, ptr, w * elempack * sizeof(unsigned short));
+            outptr += w * elempack;
+
+            for (int j = 0; j < right * elempack; j++)
+            {
+                outptr[j] = pad_value;
+            }
+            outptr += right * elempack;
+        }
+    }
+
+    return 0;
+}
+
+int Convolution_x86::forward_bf16s(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int num_input = bottom_blob.c * bottom_blob.elempack;
+
+    // the transformed kernel interleaves input channels by the packing chosen in create_pipeline
+    int elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+        elempack = num_input % 4 == 0 ? 4 : 1;
+    }
+#endif // __SSE2__
+
+    Mat bottom_blob_packed = bottom_blob;
+    if (bottom_blob.elempack != elempack)
+    {
+        Option opt_p = opt;
+        opt_p.blob_allocator = opt.workspace_allocator;
+        convert_packing(bottom_blob, bottom_blob_packed, elempack, opt_p);
+        if (bottom_blob_packed.empty())
+            return -100;
+    }
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    int ptop = pad_top;
+    int pbottom = pad_bottom;
+    int pleft = pad_left;
+    int pright = pad_right;
+    if (pad_left == -233 && pad_right == -233 && pad_top == -233 && pad_bottom == -233)
+    {
+        // tensorflow padding=SAME or onnx padding=SAME_UPPER
+        const int wpad = std::max(0, kernel_extent_w + (bottom_blob.w - 1) / stride_w * stride_w - bottom_blob.w);
+        const int hpad = std::max(0, kernel_extent_h + (bottom_blob.h - 1) / stride_h * stride_h - bottom_blob.h);
+        ptop = hpad / 2;
+        pbottom = hpad - hpad / 2;
+        pleft = wpad / 2;
+        pright = wpad - wpad / 2;
+    }
+    else if (pad_left == -234 && pad_right == -234 && pad_top == -234 && pad_bottom == -234)
+    {
+        // onnx padding=SAME_LOWER
+        const int wpad = std::max(0, kernel_extent_w + (bottom_blob.w - 1) / stride_w * stride_w - bottom_blob.w);
+        const int hpad = std::max(0, kernel_extent_h + (bottom_blob.h - 1) / stride_h * stride_h - bottom_blob.h);
+        ptop = hpad - hpad / 2;
+        pbottom = hpad / 2;
+        pleft = wpad - wpad / 2;
+        pright = wpad / 2;
+    }
+
+    Mat bottom_blob_bordered = bottom_blob_packed;
+    if (ptop > 0 || pbottom > 0 || pleft > 0 || pright > 0)
+    {
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        int ret = copy_make_border_bf16s(bottom_blob_packed, bottom_blob_bordered, ptop, pbottom, pleft, pright, pad_value, opt_b);
+        if (ret != 0)
+            return ret;
+    }
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+    }
+#endif // __SSE2__
+    const size_t out_elemsize = 2u * out_elempack;
+
+    top_blob.create(outw, outh, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int _nT = nT ? nT : opt.num_threads;
+    if (nT != 0 && opt.num_threads > nT)
+    {
+        // force num_threads the same as in create_pipeline
+        // so we could use pre-packed A/B from the same tile config
+        NCNN_LOGE("opt.num_threads %d changed, convolution gemm will use load-time value %d", opt.num_threads, nT);
+    }
+
+    return convolution_im2col_gemm_bf16s(bottom_blob_bordered, top_blob, weight_sgemm_data, bias_data, kernel_w, kernel_h, dilation_w, dilation_h, stride_w, stride_h, activation_type, activation_params, _nT, opt);
+}
+#endif // NCNN_BF16
+
 int Convolution_x86::forwardDilation_x86(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     int w = bottom_blob.w;
@@ -0,0 +1,34 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_CONVOLUTIONDEPTHWISE1D_X86_H
+#define LAYER_CONVOLUTIONDEPTHWISE1D_X86_H
+
+#include "convolutiondepthwise1d.h"
+
+namespace ncnn {
+
+class ConvolutionDepthWise1D_x86 : public ConvolutionDepthWise1D
+{
+public:
+    ConvolutionDepthWise1D_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+    int create_group_ops(const Option& opt);
+
+public:
+    std::vector<ncnn::Layer*> group_ops;
+
+    Mat weight_data_tm;
+};
+
+} // namespace ncnn
+
+#endif // LAYER_CONVOLUTIONDEPTHWISE1D_X86_H
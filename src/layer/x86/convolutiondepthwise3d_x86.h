@@ -0,0 +1,33 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_CONVOLUTIONDEPTHWISE3D_X86_H
+#define LAYER_CONVOLUTIONDEPTHWISE3D_X86_H
+
+#include "convolutiondepthwise3d.h"
+
+namespace ncnn {
+
+class ConvolutionDepthWise3D_x86 : public ConvolutionDepthWise3D
+{
+public:
+    ConvolutionDepthWise3D_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+protected:
+    int create_group_ops(const Option& opt);
+
+public:
+    Layer* activation;
+    std::vector<ncnn::Layer*> group_ops;
+
+    Mat weight_data_tm;
+};
+
+} // namespace ncnn
+
+#endif // LAYER_CONVOLUTIONDEPTHWISE3D_X86_H
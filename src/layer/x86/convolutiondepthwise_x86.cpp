@@ -225,7 +225,10 @@ int ConvolutionDepthWise_x86::create_group_ops(const Option& opt)
             op->load_model(ModelBinFromMatArray(weights));
         }
 
-        op->create_pipeline(opt);
+        // group convolutions share the fp32 storage of this layer
+        Option opt_g = opt;
+        opt_g.use_bf16_storage = false;
+        op->create_pipeline(opt_g);
 
         group_ops[g] = op;
     }
@@ -715,6 +718,7 @@ int ConvolutionDepthWise_x86::forward(const Mat& bottom_blob, Mat& top_blob, con
 
         Option opt_g = opt;
         opt_g.blob_allocator = top_blob_unpacked.allocator;
+        opt_g.use_bf16_storage = false;
 
         // forward
         int ret = op->forward(bottom_blob_bordered_g, top_blob_g, opt_g);
@@ -801,11 +805,14 @@ int ConvolutionDepthWise_x86::forward(const std::vector<Mat>& bottom_blobs, std:
 
     op->load_model(ncnn::ModelBinFromMatArray(weights));
 
-    op->create_pipeline(opt);
+    Option opt_g = opt;
+    opt_g.use_bf16_storage = false;
+
+    op->create_pipeline(opt_g);
 
-    op->forward(bottom_blob, top_blob, opt);
+    op->forward(bottom_blob, top_blob, opt_g);
 
-    op->destroy_pipeline(opt);
+    op->destroy_pipeline(opt_g);
 
     delete op;
 
@@ -1262,6 +1269,7 @@ int ConvolutionDepthWise_x86::forward_int8_x86(const Mat& bottom_blob, Mat& top_
 
         Option opt_g = opt;
         opt_g.blob_allocator = top_blob_unpacked.allocator;
+        opt_g.use_bf16_storage = false;
 
         // forward
         int ret = op->forward(bottom_blob_bordered_g, top_blob_g, opt_g);
@@ -0,0 +1,319 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "cumulativesum_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+namespace ncnn {
+
+CumulativeSum_x86::CumulativeSum_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+// ptr[i] += prev[i]
+static void cumsum_add(float* ptr, const float* prev, int size)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        _mm512_storeu_ps(ptr + i, _mm512_add_ps(_mm512_loadu_ps(ptr + i), _mm512_loadu_ps(prev + i)));
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(ptr + i, _mm256_add_ps(_mm256_loadu_ps(ptr + i), _mm256_loadu_ps(prev + i)));
+    }
+#endif // __AVX__
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(ptr + i, _mm_add_ps(_mm_loadu_ps(ptr + i), _mm_loadu_ps(prev + i)));
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        ptr[i] += prev[i];
+    }
+}
+
+// ptr[i] += v
+static void cumsum_add_scalar(float* ptr, float v, int size)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    __m512 _v_avx512 = _mm512_set1_ps(v);
+    for (; i + 15 < size; i += 16)
+    {
+        _mm512_storeu_ps(ptr + i, _mm512_add_ps(_mm512_loadu_ps(ptr + i), _v_avx512));
+    }
+#endif // __AVX512F__
+    __m256 _v_avx = _mm256_set1_ps(v);
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(ptr + i, _mm256_add_ps(_mm256_loadu_ps(ptr + i), _v_avx));
+    }
+#endif // __AVX__
+    __m128 _v = _mm_set1_ps(v);
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(ptr + i, _mm_add_ps(_mm_loadu_ps(ptr + i), _v));
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        ptr[i] += v;
+    }
+}
+
+// scan along w of elempack interleaved independent sequences, ptr[i] += ptr[i - elempack]
+static void cumsum_lanes(float* ptr, int w, int elempack)
+{
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        __m512 _sum = _mm512_loadu_ps(ptr);
+        for (int i = 1; i < w; i++)
+        {
+            _sum = _mm512_add_ps(_sum, _mm512_loadu_ps(ptr + i * 16));
+            _mm512_storeu_ps(ptr + i * 16, _sum);
+        }
+        return;
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        __m256 _sum = _mm256_loadu_ps(ptr);
+        for (int i = 1; i < w; i++)
+        {
+            _sum = _mm256_add_ps(_sum, _mm256_loadu_ps(ptr + i * 8));
+            _mm256_storeu_ps(ptr + i * 8, _sum);
+        }
+        return;
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        __m128 _sum = _mm_loadu_ps(ptr);
+        for (int i = 1; i < w; i++)
+        {
+            _sum = _mm_add_ps(_sum, _mm_loadu_ps(ptr + i * 4));
+            _mm_storeu_ps(ptr + i * 4, _sum);
+        }
+        return;
+    }
+#endif // __SSE2__
+
+    float sum = ptr[0];
+    for (int i = 1; i < w; i++)
+    {
+        sum += ptr[i];
+        ptr[i] = sum;
+    }
+}
+
+// scan of one long contiguous sequence
+// each thread scans its own block, block totals are then propagated with a vector add
+static void cumsum_blocked(float* ptr, int size, const Option& opt)
+{
+    const int nT = opt.num_threads;
+
+    // short sequences are not worth the second pass
+    if (nT == 1 || size < nT * 1024)
+    {
+        cumsum_lanes(ptr, size, 1);
+        return;
+    }
+
+    const int block_size = (size + nT - 1) / nT;
+    const int block_count = (size + block_size - 1) / block_size;
+
+    std::vector<float> block_sums(block_count);
+
+    #pragma omp parallel for num_threads(nT)
+    for (int b = 0; b < block_count; b++)
+    {
+        const int start = b * block_size;
+        const int end = std::min(start + block_size, size);
+
+        cumsum_lanes(ptr + start, end - start, 1);
+        block_sums[b] = ptr[end - 1];
+    }
+
+    for (int b = 1; b < block_count; b++)
+    {
+        block_sums[b] += block_sums[b - 1];
+    }
+
+    #pragma omp parallel for num_threads(nT)
+    for (int b = 1; b < block_count; b++)
+    {
+        const int start = b * block_size;
+        const int end = std::min(start + block_size, size);
+
+        cumsum_add_scalar(ptr + start, block_sums[b - 1], end - start);
+    }
+}
+
+// scan along the packed outer axis, rows are groups of elempack logical rows of size elements, stride floats apart
+// the lanes of one element are scanned in order, carrying the last lane of the previous group
+static void cumsum_packed_rows(float* ptr0, size_t stride, int rows, int size, int elempack, const Option& opt)
+{
+    if (elempack == 1)
+    {
+        // split the row into column chunks so that every thread walks all rows with vector adds
+        const int chunk = std::max(64, (size + opt.num_threads - 1) / opt.num_threads);
+        const int chunk_count = (size + chunk - 1) / chunk;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ci = 0; ci < chunk_count; ci++)
+        {
+            const int start = ci * chunk;
+            const int len = std::min(chunk, size - start);
+
+            for (int i = 1; i < rows; i++)
+            {
+                const float* prev = ptr0 + stride * (i - 1);
+                float* ptr = ptr0 + stride * i;
+
+                cumsum_add(ptr + start, prev + start, len);
+            }
+        }
+
+        return;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int k = 0; k < size; k++)
+    {
+        float sum = 0.f;
+        for (int i = 0; i < rows; i++)
+        {
+            float* ptr = ptr0 + stride * i + k * elempack;
+
+            for (int l = 0; l < elempack; l++)
+            {
+                sum += ptr[l];
+                ptr[l] = sum;
+            }
+        }
+    }
+}
+
+int CumulativeSum_x86::forward_inplace(Mat& bottom_top_blob, const Option& opt) const
+{
+    const int dims = bottom_top_blob.dims;
+    const int w = bottom_top_blob.w;
+    const int h = bottom_top_blob.h;
+    const int channels = bottom_top_blob.c;
+    const int elempack = bottom_top_blob.elempack;
+    const int positive_axis = axis < 0 ? dims + axis : axis;
+
+    if (dims == 1)
+    {
+        // ignore axis, packed 1d data is the plain sequence
+        cumsum_blocked(bottom_top_blob, w * elempack, opt);
+
+        return 0;
+    }
+
+    if (dims == 2 && positive_axis == 0)
+    {
+        cumsum_packed_rows(bottom_top_blob, (size_t)w * elempack, h, w, elempack, opt);
+
+        return 0;
+    }
+
+    if (dims == 2 && positive_axis == 1)
+    {
+        if (elempack == 1 && h < opt.num_threads)
+        {
+            for (int i = 0; i < h; i++)
+            {
+                cumsum_blocked(bottom_top_blob.row(i), w, opt);
+            }
+
+            return 0;
+        }
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < h; i++)
+        {
+            cumsum_lanes(bottom_top_blob.row(i), w, elempack);
+        }
+
+        return 0;
+    }
+
+    if (dims == 3 && positive_axis == 0)
+    {
+        cumsum_packed_rows(bottom_top_blob, bottom_top_blob.cstep * elempack, channels, w * h, elempack, opt);
+
+        return 0;
+    }
+
+    if (dims == 3 && positive_axis == 1)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            Mat m = bottom_top_blob.channel(q);
+
+            for (int i = 1; i < h; i++)
+            {
+                cumsum_add(m.row(i), m.row(i - 1), w * elempack);
+            }
+        }
+
+        return 0;
+    }
+
+    if (dims == 3 && positive_axis == 2)
+    {
+        if (elempack == 1 && channels * h < opt.num_threads)
+        {
+            for (int q = 0; q < channels; q++)
+            {
+                for (int i = 0; i < h; i++)
+                {
+                    cumsum_blocked(bottom_top_blob.channel(q).row(i), w, opt);
+                }
+            }
+
+            return 0;
+        }
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < channels; q++)
+        {
+            Mat m = bottom_top_blob.channel(q);
+
+            for (int i = 0; i < h; i++)
+            {
+                cumsum_lanes(m.row(i), w, elempack);
+            }
+        }
+
+        return 0;
+    }
+
+    return -100;
+}
+
+} // namespace ncnn
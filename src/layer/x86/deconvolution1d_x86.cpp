@@ -0,0 +1,418 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "deconvolution1d_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif
+#endif // __SSE2__
+
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+#include "layer_type.h"
+
+namespace ncnn {
+
+Deconvolution1D_x86::Deconvolution1D_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+
+    gemm = 0;
+}
+
+int Deconvolution1D_x86::create_pipeline(const Option& opt)
+{
+    if (dynamic_weight)
+        return 0;
+
+    int num_input = weight_data_size / kernel_w / num_output;
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+
+    // the whole sequence is one gemm, col2im scatters the kernel_w columns of each output channel
+    gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
+
+    ncnn::ParamDict pd;
+    pd.set(2, 1);                     // transA
+    pd.set(3, 0);                     // transB
+    pd.set(4, 1);                     // constantA
+    pd.set(5, 0);                     // constantB
+    pd.set(6, 1);                     // constantC
+    pd.set(7, kernel_w * num_output); // M = kernel_w*num_output
+    pd.set(8, 0);                     // N = w
+    pd.set(9, num_input);             // K = inch
+    pd.set(10, -1);                   // constant_broadcast_type_C = null
+    pd.set(11, 0);                    // output_N1M
+    pd.set(12, out_elempack);
+
+    gemm->load_param(pd);
+
+    // kw-inch-outch to pa-kw-outch/pa-inch
+    Mat tmp;
+    {
+        Mat weight_data_r2 = weight_data.reshape(kernel_w, num_input, num_output);
+
+        tmp.create(kernel_w * num_output, num_input);
+
+        for (int p = 0; p < num_input; p += 1)
+        {
+            float* g00 = tmp.row(p);
+
+            for (int q = 0; q + (out_elempack - 1) < num_output; q += out_elempack)
+            {
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    for (int i = 0; i < out_elempack; i++)
+                    {
+                        const float* k00 = weight_data_r2.channel(q + i).row(p);
+                        g00[0] = k00[k];
+                        g00++;
+                    }
+                }
+            }
+        }
+    }
+
+    ncnn::Mat weights[1];
+    weights[0] = tmp;
+
+    gemm->load_model(ModelBinFromMatArray(weights));
+
+    // gemm shares the fp32 storage of this layer
+    Option opt_g = opt;
+    opt_g.use_bf16_storage = false;
+    gemm->create_pipeline(opt_g);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int Deconvolution1D_x86::destroy_pipeline(const Option& opt)
+{
+    if (gemm)
+    {
+        gemm->destroy_pipeline(opt);
+        delete gemm;
+        gemm = 0;
+    }
+
+    return 0;
+}
+
+int Deconvolution1D_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int w = bottom_blob.w;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+
+    int outw = (w - 1) * stride_w + kernel_extent_w + output_pad_right;
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    const int out_h = num_output / out_elempack;
+
+    Mat top_blob_bordered;
+    if (pad_left > 0 || pad_right > 0 || output_w > 0)
+    {
+        top_blob_bordered.create(outw, out_h, out_elemsize, out_elempack, opt.workspace_allocator);
+    }
+    else
+    {
+        top_blob_bordered = top_blob;
+        top_blob_bordered.create(outw, out_h, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    if (top_blob_bordered.empty())
+        return -100;
+
+    // sgemm
+    Mat top_col2im;
+    Option opt_b = opt;
+    opt_b.blob_allocator = opt.workspace_allocator;
+    opt_b.use_bf16_storage = false;
+    int ret = gemm->forward(bottom_blob, top_col2im, opt_b);
+    if (ret != 0)
+        return ret;
+
+    // col2im with bias and activation
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+        if (out_elempack == 16)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int p = 0; p < out_h; p++)
+            {
+                const float* sptr = top_col2im.row(p * kernel_w);
+                float* outptr = top_blob_bordered.row(p);
+
+                __m512 _bias = bias_term ? _mm512_loadu_ps((const float*)bias_data + p * 16) : _mm512_setzero_ps();
+
+                for (int i = 0; i < outw; i++)
+                {
+                    _mm512_storeu_ps(outptr + i * 16, _bias);
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    float* ptr = outptr + k * dilation_w * 16;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m512 _val = _mm512_loadu_ps(ptr);
+                        __m512 _s = _mm512_loadu_ps(sptr);
+                        _val = _mm512_add_ps(_val, _s);
+                        _mm512_storeu_ps(ptr, _val);
+
+                        ptr += stride_w * 16;
+                        sptr += 16;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    __m512 _out = _mm512_loadu_ps(outptr + i * 16);
+                    _out = activation_avx512(_out, activation_type, activation_params);
+                    _mm512_storeu_ps(outptr + i * 16, _out);
+                }
+            }
+        }
+#endif // __AVX512F__
+
+        if (out_elempack == 8)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int p = 0; p < out_h; p++)
+            {
+                const float* sptr = top_col2im.row(p * kernel_w);
+                float* outptr = top_blob_bordered.row(p);
+
+                __m256 _bias = bias_term ? _mm256_loadu_ps((const float*)bias_data + p * 8) : _mm256_setzero_ps();
+
+                for (int i = 0; i < outw; i++)
+                {
+                    _mm256_storeu_ps(outptr + i * 8, _bias);
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    float* ptr = outptr + k * dilation_w * 8;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m256 _val = _mm256_loadu_ps(ptr);
+                        __m256 _s = _mm256_loadu_ps(sptr);
+                        _val = _mm256_add_ps(_val, _s);
+                        _mm256_storeu_ps(ptr, _val);
+
+                        ptr += stride_w * 8;
+                        sptr += 8;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    __m256 _out = _mm256_loadu_ps(outptr + i * 8);
+                    _out = activation_avx(_out, activation_type, activation_params);
+                    _mm256_storeu_ps(outptr + i * 8, _out);
+                }
+            }
+        }
+#endif // __AVX__
+
+        if (out_elempack == 4)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int p = 0; p < out_h; p++)
+            {
+                const float* sptr = top_col2im.row(p * kernel_w);
+                float* outptr = top_blob_bordered.row(p);
+
+                __m128 _bias = bias_term ? _mm_loadu_ps((const float*)bias_data + p * 4) : _mm_setzero_ps();
+
+                for (int i = 0; i < outw; i++)
+                {
+                    _mm_storeu_ps(outptr + i * 4, _bias);
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    float* ptr = outptr + k * dilation_w * 4;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m128 _val = _mm_loadu_ps(ptr);
+                        __m128 _s = _mm_loadu_ps(sptr);
+                        _val = _mm_add_ps(_val, _s);
+                        _mm_storeu_ps(ptr, _val);
+
+                        ptr += stride_w * 4;
+                        sptr += 4;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    __m128 _out = _mm_loadu_ps(outptr + i * 4);
+                    _out = activation_sse(_out, activation_type, activation_params);
+                    _mm_storeu_ps(outptr + i * 4, _out);
+                }
+            }
+        }
+#endif // __SSE2__
+
+    if (out_elempack == 1)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < out_h; p++)
+        {
+            const float* sptr = top_col2im.row(p * kernel_w);
+            float* outptr = top_blob_bordered.row(p);
+
+            const float bias = bias_term ? bias_data[p] : 0.f;
+
+            for (int i = 0; i < outw; i++)
+            {
+                outptr[i] = bias;
+            }
+
+            for (int k = 0; k < kernel_w; k++)
+            {
+                float* ptr = outptr + k * dilation_w;
+
+                for (int j = 0; j < w; j++)
+                {
+                    *ptr += *sptr;
+
+                    ptr += stride_w;
+                    sptr += 1;
+                }
+            }
+
+            for (int i = 0; i < outw; i++)
+            {
+                outptr[i] = activation_ss(outptr[i], activation_type, activation_params);
+            }
+        }
+    }
+
+    cut_padding(top_blob_bordered, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+void Deconvolution1D_x86::cut_padding(const Mat& top_blob_bordered, Mat& top_blob, const Option& opt) const
+{
+    const int elempack = top_blob_bordered.elempack;
+    if (elempack == 1)
+    {
+        Deconvolution1D::cut_padding(top_blob_bordered, top_blob, opt);
+        return;
+    }
+
+    // copy_cut_border sees packed rows as logical rows, cut along w on the packed blob directly
+    int wcut_left = 0;
+    int wcut_right = 0;
+    if (pad_left > 0 || pad_right > 0)
+    {
+        wcut_left = pad_left;
+        wcut_right = pad_right;
+    }
+    else if (output_w > 0)
+    {
+        int wcut = top_blob_bordered.w - output_w;
+
+        if (pad_left == -233 || pad_right == -233)
+        {
+            // onnx padding=SAME_UPPER
+            wcut_left = wcut / 2;
+            wcut_right = wcut - wcut / 2;
+        }
+        else if (pad_left == -234 || pad_right == -234)
+        {
+            // onnx padding=SAME_LOWER
+            wcut_left = wcut - wcut / 2;
+            wcut_right = wcut / 2;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    if (wcut_left == 0 && wcut_right == 0)
+    {
+        top_blob = top_blob_bordered;
+        return;
+    }
+
+    const int outw = top_blob_bordered.w - wcut_left - wcut_right;
+    const int h = top_blob_bordered.h;
+    const size_t elemsize = top_blob_bordered.elemsize;
+
+    top_blob.create(outw, h, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < h; i++)
+    {
+        const float* ptr = top_blob_bordered.row(i) + wcut_left * elempack;
+        float* outptr = top_blob.row(i);
+
+        memcpy(outptr, ptr, outw * elemsize);
+    }
+}
+
+int Deconvolution1D_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    // dynamic weight, run the generic path on unpacked blobs
+    std::vector<Mat> bottom_blobs_unpacked(bottom_blobs.size());
+    for (size_t i = 0; i < bottom_blobs.size(); i++)
+    {
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+        convert_packing(bottom_blobs[i], bottom_blobs_unpacked[i], 1, opt_unpack);
+        if (bottom_blobs_unpacked[i].empty())
+            return -100;
+    }
+
+    return Deconvolution1D::forward(bottom_blobs_unpacked, top_blobs, opt);
+}
+
+} // namespace ncnn
@@ -131,7 +131,10 @@ int Deconvolution_x86::create_pipeline(const Option& opt)
 
         gemm->load_model(ModelBinFromMatArray(weights));
 
-        gemm->create_pipeline(opt);
+        // gemm shares the fp32 storage of this layer
+        Option opt_g = opt;
+        opt_g.use_bf16_storage = false;
+        gemm->create_pipeline(opt_g);
     }
     else
     {
@@ -207,6 +210,14 @@ int Deconvolution_x86::destroy_pipeline(const Option& opt)
     return 0;
 }
 
+const char* Deconvolution_x86::kernel_name() const
+{
+    if (dynamic_weight)
+        return "dynamic";
+
+    return gemm ? "sgemm" : "packed";
+}
+
 int Deconvolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
 {
     // deconvolv with NxN kernel
@@ -267,6 +278,7 @@ int Deconvolution_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Opti
         Mat top_col2im;
         Option opt_b = opt;
         opt_b.blob_allocator = top_blob_bordered.allocator;
+        opt_b.use_bf16_storage = false;
         int ret = gemm->forward(bottom_blob_2, top_col2im, opt_b);
         if (ret != 0)
             return ret;
@@ -0,0 +1,521 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "deconvolutiondepthwise1d_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif
+#endif // __SSE2__
+
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+#include "layer_type.h"
+
+namespace ncnn {
+
+DeconvolutionDepthWise1D_x86::DeconvolutionDepthWise1D_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+int DeconvolutionDepthWise1D_x86::create_pipeline(const Option& opt)
+{
+    if (dynamic_weight)
+        return 0;
+
+    int channels = (weight_data_size / group) / kernel_w / (num_output / group) * group;
+
+    // depth-wise
+    if (channels == group && group == num_output)
+    {
+        int elempack = 1;
+#if __SSE2__
+        if (opt.use_packing_layout)
+        {
+#if __AVX512F__
+            elempack = channels % 16 == 0 ? 16 : channels % 8 == 0 ? 8 : channels % 4 == 0 ? 4 : 1;
+#elif __AVX__
+            elempack = channels % 8 == 0 ? 8 : channels % 4 == 0 ? 4 : 1;
+#else
+            elempack = channels % 4 == 0 ? 4 : 1;
+#endif
+        }
+#endif // __SSE2__
+
+        if (elempack == 1)
+        {
+            weight_data_tm = weight_data;
+        }
+        else
+        {
+            Mat weight_data_r2 = weight_data.reshape(kernel_w, group);
+            convert_packing(weight_data_r2, weight_data_tm, elempack, opt);
+        }
+
+        if (opt.lightmode)
+            weight_data.release();
+
+        return 0;
+    }
+
+    // group convolution
+    create_group_ops(opt);
+
+    if (opt.lightmode)
+        weight_data.release();
+
+    return 0;
+}
+
+int DeconvolutionDepthWise1D_x86::create_group_ops(const Option& opt)
+{
+    // create Deconvolution1D op for each group
+    int channels = (weight_data_size / group) / kernel_w / (num_output / group) * group;
+
+    for (int i = 0; i < (int)group_ops.size(); i++)
+        delete group_ops[i];
+
+    group_ops.clear();
+
+    const int channels_g = channels / group;
+    const int num_output_g = num_output / group;
+
+    group_ops.resize(group);
+
+    for (int g = 0; g < group; g++)
+    {
+        Mat weight_data_g = weight_data.range(kernel_w * channels_g * num_output_g * g, kernel_w * channels_g * num_output_g).clone();
+        Mat bias_data_g;
+        if (bias_term)
+            bias_data_g = bias_data.range(num_output_g * g, num_output_g);
+
+        ncnn::Layer* op = ncnn::create_layer_cpu(ncnn::LayerType::Deconvolution1D);
+
+        // set param
+        ncnn::ParamDict pd;
+        pd.set(0, num_output_g); // num_output
+        pd.set(1, kernel_w);
+        pd.set(2, dilation_w);
+        pd.set(3, stride_w);
+        pd.set(4, 0); // pad_w
+        pd.set(18, output_pad_right);
+        pd.set(5, bias_term);
+        pd.set(6, kernel_w * channels_g * num_output_g); // weight_data_size
+        pd.set(9, activation_type);
+        pd.set(10, activation_params);
+
+        op->load_param(pd);
+
+        // set weights
+        if (bias_term)
+        {
+            ncnn::Mat weights[2];
+            weights[0] = weight_data_g;
+            weights[1] = bias_data_g;
+
+            op->load_model(ModelBinFromMatArray(weights));
+        }
+        else
+        {
+            ncnn::Mat weights[1];
+            weights[0] = weight_data_g;
+
+            op->load_model(ModelBinFromMatArray(weights));
+        }
+
+        op->create_pipeline(opt);
+
+        group_ops[g] = op;
+    }
+
+    return 0;
+}
+
+int DeconvolutionDepthWise1D_x86::destroy_pipeline(const Option& opt)
+{
+    for (int i = 0; i < (int)group_ops.size(); i++)
+    {
+        group_ops[i]->destroy_pipeline(opt);
+        delete group_ops[i];
+    }
+    group_ops.clear();
+
+    return 0;
+}
+
+int DeconvolutionDepthWise1D_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    int w = bottom_blob.w;
+    int h = bottom_blob.h;
+    size_t elemsize = bottom_blob.elemsize;
+    int elempack = bottom_blob.elempack;
+    const int channels = h;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+
+    int outw = (w - 1) * stride_w + kernel_extent_w + output_pad_right;
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = num_output % 16 == 0 ? 16 : num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = num_output % 8 == 0 ? 8 : num_output % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    Mat top_blob_bordered;
+    if (pad_left > 0 || pad_right > 0 || output_w > 0)
+    {
+        top_blob_bordered.create(outw, num_output / out_elempack, out_elemsize, out_elempack, opt.workspace_allocator);
+    }
+    else
+    {
+        top_blob_bordered = top_blob;
+        top_blob_bordered.create(outw, num_output / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    if (top_blob_bordered.empty())
+        return -100;
+
+    // depth-wise
+    if (channels * elempack == group && group == num_output)
+    {
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+        if (elempack == 16)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int g = 0; g < h; g++)
+            {
+                float* outptr = top_blob_bordered.row(g);
+                const float* kptr = (const float*)weight_data_tm + kernel_w * g * 16;
+                const float* sptr = bottom_blob.row(g);
+
+                __m512 _bias = bias_term ? _mm512_loadu_ps((const float*)bias_data + g * 16) : _mm512_setzero_ps();
+
+                for (int i = 0; i < outw; i++)
+                {
+                    _mm512_storeu_ps(outptr + i * 16, _bias);
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    __m512 _w = _mm512_loadu_ps(kptr + k * 16);
+
+                    float* ptr = outptr + k * dilation_w * 16;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m512 _val = _mm512_loadu_ps(sptr + j * 16);
+                        __m512 _out = _mm512_loadu_ps(ptr);
+                        _out = _mm512_fmadd_ps(_val, _w, _out);
+                        _mm512_storeu_ps(ptr, _out);
+
+                        ptr += stride_w * 16;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    __m512 _out = _mm512_loadu_ps(outptr + i * 16);
+                    _out = activation_avx512(_out, activation_type, activation_params);
+                    _mm512_storeu_ps(outptr + i * 16, _out);
+                }
+            }
+        }
+#endif // __AVX512F__
+
+        if (elempack == 8)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int g = 0; g < h; g++)
+            {
+                float* outptr = top_blob_bordered.row(g);
+                const float* kptr = (const float*)weight_data_tm + kernel_w * g * 8;
+                const float* sptr = bottom_blob.row(g);
+
+                __m256 _bias = bias_term ? _mm256_loadu_ps((const float*)bias_data + g * 8) : _mm256_setzero_ps();
+
+                for (int i = 0; i < outw; i++)
+                {
+                    _mm256_storeu_ps(outptr + i * 8, _bias);
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    __m256 _w = _mm256_loadu_ps(kptr + k * 8);
+
+                    float* ptr = outptr + k * dilation_w * 8;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m256 _val = _mm256_loadu_ps(sptr + j * 8);
+                        __m256 _out = _mm256_loadu_ps(ptr);
+                        _out = _mm256_comp_fmadd_ps(_val, _w, _out);
+                        _mm256_storeu_ps(ptr, _out);
+
+                        ptr += stride_w * 8;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    __m256 _out = _mm256_loadu_ps(outptr + i * 8);
+                    _out = activation_avx(_out, activation_type, activation_params);
+                    _mm256_storeu_ps(outptr + i * 8, _out);
+                }
+            }
+        }
+#endif // __AVX__
+
+        if (elempack == 4)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int g = 0; g < h; g++)
+            {
+                float* outptr = top_blob_bordered.row(g);
+                const float* kptr = (const float*)weight_data_tm + kernel_w * g * 4;
+                const float* sptr = bottom_blob.row(g);
+
+                __m128 _bias = bias_term ? _mm_loadu_ps((const float*)bias_data + g * 4) : _mm_setzero_ps();
+
+                for (int i = 0; i < outw; i++)
+                {
+                    _mm_storeu_ps(outptr + i * 4, _bias);
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    __m128 _w = _mm_loadu_ps(kptr + k * 4);
+
+                    float* ptr = outptr + k * dilation_w * 4;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        __m128 _val = _mm_loadu_ps(sptr + j * 4);
+                        __m128 _out = _mm_loadu_ps(ptr);
+                        _out = _mm_comp_fmadd_ps(_val, _w, _out);
+                        _mm_storeu_ps(ptr, _out);
+
+                        ptr += stride_w * 4;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    __m128 _out = _mm_loadu_ps(outptr + i * 4);
+                    _out = activation_sse(_out, activation_type, activation_params);
+                    _mm_storeu_ps(outptr + i * 4, _out);
+                }
+            }
+        }
+#endif // __SSE2__
+
+        if (elempack == 1)
+        {
+            #pragma omp parallel for num_threads(opt.num_threads)
+            for (int g = 0; g < h; g++)
+            {
+                float* outptr = top_blob_bordered.row(g);
+                const float* kptr = (const float*)weight_data_tm + kernel_w * g;
+                const float* sptr = bottom_blob.row(g);
+
+                const float bias = bias_term ? bias_data[g] : 0.f;
+
+                for (int i = 0; i < outw; i++)
+                {
+                    outptr[i] = bias;
+                }
+
+                for (int k = 0; k < kernel_w; k++)
+                {
+                    const float wt = kptr[k];
+
+                    float* ptr = outptr + k * dilation_w;
+
+                    for (int j = 0; j < w; j++)
+                    {
+                        *ptr += sptr[j] * wt;
+
+                        ptr += stride_w;
+                    }
+                }
+
+                for (int i = 0; i < outw; i++)
+                {
+                    outptr[i] = activation_ss(outptr[i], activation_type, activation_params);
+                }
+            }
+        }
+    }
+    else
+    {
+        // group convolution
+        const int channels_g = channels * elempack / group;
+        const int num_output_g = num_output / group;
+
+        int g_elempack = 1;
+        int out_g_elempack = 1;
+#if __SSE2__
+        if (opt.use_packing_layout)
+        {
+#if __AVX512F__
+            g_elempack = channels_g % 16 == 0 ? 16 : channels_g % 8 == 0 ? 8 : channels_g % 4 == 0 ? 4 : 1;
+            out_g_elempack = num_output_g % 16 == 0 ? 16 : num_output_g % 8 == 0 ? 8 : num_output_g % 4 == 0 ? 4 : 1;
+#elif __AVX__
+            g_elempack = channels_g % 8 == 0 ? 8 : channels_g % 4 == 0 ? 4 : 1;
+            out_g_elempack = num_output_g % 8 == 0 ? 8 : num_output_g % 4 == 0 ? 4 : 1;
+#else
+            g_elempack = channels_g % 4 == 0 ? 4 : 1;
+            out_g_elempack = num_output_g % 4 == 0 ? 4 : 1;
+#endif
+        }
+#endif // __SSE2__
+
+        // unpacking
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (elempack > g_elempack)
+        {
+            Option opt_p = opt;
+            opt_p.blob_allocator = opt.workspace_allocator;
+            convert_packing(bottom_blob, bottom_blob_unpacked, g_elempack, opt_p);
+            if (bottom_blob_unpacked.empty())
+                return -100;
+        }
+
+        Mat top_blob_bordered_unpacked = top_blob_bordered;
+        if (out_g_elempack < out_elempack)
+        {
+            top_blob_bordered_unpacked.create(outw, num_output / out_g_elempack, out_elemsize / out_elempack * out_g_elempack, out_g_elempack, opt.workspace_allocator);
+            if (top_blob_bordered_unpacked.empty())
+                return -100;
+        }
+
+        for (int g = 0; g < group; g++)
+        {
+            const Mat bottom_blob_g = bottom_blob_unpacked.row_range(channels_g * g / g_elempack, channels_g / g_elempack);
+            Mat top_blob_bordered_g = top_blob_bordered_unpacked.row_range(num_output_g * g / out_g_elempack, num_output_g / out_g_elempack);
+
+            const ncnn::Layer* op = group_ops[g];
+
+            Option opt_g = opt;
+            opt_g.blob_allocator = top_blob_bordered_unpacked.allocator;
+
+            // forward
+            int ret = op->forward(bottom_blob_g, top_blob_bordered_g, opt_g);
+            if (ret != 0)
+                return ret;
+        }
+
+        // packing
+        if (out_g_elempack < out_elempack)
+        {
+            convert_packing(top_blob_bordered_unpacked, top_blob_bordered, out_elempack, opt);
+            if (top_blob_bordered.empty())
+                return -100;
+        }
+        else
+        {
+            top_blob_bordered = top_blob_bordered_unpacked;
+        }
+    }
+
+    cut_padding(top_blob_bordered, top_blob, opt);
+    if (top_blob.empty())
+        return -100;
+
+    return 0;
+}
+
+void DeconvolutionDepthWise1D_x86::cut_padding(const Mat& top_blob_bordered, Mat& top_blob, const Option& opt) const
+{
+    const int elempack = top_blob_bordered.elempack;
+    if (elempack == 1)
+    {
+        DeconvolutionDepthWise1D::cut_padding(top_blob_bordered, top_blob, opt);
+        return;
+    }
+
+    // copy_cut_border sees packed rows as logical rows, cut along w on the packed blob directly
+    int wcut_left = 0;
+    int wcut_right = 0;
+    if (pad_left > 0 || pad_right > 0)
+    {
+        wcut_left = pad_left;
+        wcut_right = pad_right;
+    }
+    else if (output_w > 0)
+    {
+        int wcut = top_blob_bordered.w - output_w;
+
+        if (pad_left == -233 || pad_right == -233)
+        {
+            // onnx padding=SAME_UPPER
+            wcut_left = wcut / 2;
+            wcut_right = wcut - wcut / 2;
+        }
+        else if (pad_left == -234 || pad_right == -234)
+        {
+            // onnx padding=SAME_LOWER
+            wcut_left = wcut - wcut / 2;
+            wcut_right = wcut / 2;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    if (wcut_left == 0 && wcut_right == 0)
+    {
+        top_blob = top_blob_bordered;
+        return;
+    }
+
+    const int outw = top_blob_bordered.w - wcut_left - wcut_right;
+    const int h = top_blob_bordered.h;
+    const size_t elemsize = top_blob_bordered.elemsize;
+
+    top_blob.create(outw, h, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < h; i++)
+    {
+        const float* ptr = top_blob_bordered.row(i) + wcut_left * elempack;
+        float* outptr = top_blob.row(i);
+
+        memcpy(outptr, ptr, outw * elemsize);
+    }
+}
+
+int DeconvolutionDepthWise1D_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    // dynamic weight, run the generic path on unpacked blobs
+    std::vector<Mat> bottom_blobs_unpacked(bottom_blobs.size());
+    for (size_t i = 0; i < bottom_blobs.size(); i++)
+    {
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+        convert_packing(bottom_blobs[i], bottom_blobs_unpacked[i], 1, opt_unpack);
+        if (bottom_blobs_unpacked[i].empty())
+            return -100;
+    }
+
+    return DeconvolutionDepthWise1D::forward(bottom_blobs_unpacked, top_blobs, opt);
+}
+
+} // namespace ncnn
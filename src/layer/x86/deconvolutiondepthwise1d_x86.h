@@ -0,0 +1,35 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_DECONVOLUTIONDEPTHWISE1D_X86_H
+#define LAYER_DECONVOLUTIONDEPTHWISE1D_X86_H
+
+#include "deconvolutiondepthwise1d.h"
+
+namespace ncnn {
+
+class DeconvolutionDepthWise1D_x86 : public DeconvolutionDepthWise1D
+{
+public:
+    DeconvolutionDepthWise1D_x86();
+
+    virtual int create_pipeline(const Option& opt);
+    virtual int destroy_pipeline(const Option& opt);
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+    int create_group_ops(const Option& opt);
+    void cut_padding(const Mat& top_blob_bordered, Mat& top_blob, const Option& opt) const;
+
+public:
+    std::vector<ncnn::Layer*> group_ops;
+
+    Mat weight_data_tm;
+};
+
+} // namespace ncnn
+
+#endif // LAYER_DECONVOLUTIONDEPTHWISE1D_X86_H
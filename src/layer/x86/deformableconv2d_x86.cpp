@@ -181,7 +181,10 @@ int DeformableConv2D_x86::create_pipeline(const Option& opt)
             gemm->load_model(ModelBinFromMatArray(weights));
         }
 
-        gemm->create_pipeline(opt);
+        // gemm shares the fp32 storage of this layer
+        Option opt_g = opt;
+        opt_g.use_bf16_storage = false;
+        gemm->create_pipeline(opt_g);
     }
     else if (elempack == 1 && out_elempack == 1)
     {
@@ -592,6 +595,7 @@ int DeformableConv2D_x86::forward(const std::vector<Mat>& bottom_blobs, std::vec
         }
         Option opt_b = opt;
         opt_b.blob_allocator = opt.workspace_allocator;
+        opt_b.use_bf16_storage = false;
         gemm->forward(bottom_im2col, top_blob, opt_b);
         {
             top_blob.w = outw;
@@ -0,0 +1,268 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "embed_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __SSE4_1__
+#include <smmintrin.h>
+#endif // __SSE4_1__
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+#include "cpu.h"
+
+#include <string.h>
+
+namespace ncnn {
+
+Embed_x86::Embed_x86()
+{
+    one_blob_only = true;
+    support_inplace = false;
+}
+
+int Embed_x86::create_pipeline(const Option& opt)
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        const int scale_count = weight_data_int8_scales.w;
+
+        weight_data_int8_descales.create(scale_count);
+        if (weight_data_int8_descales.empty())
+            return -100;
+
+        for (int i = 0; i < scale_count; i++)
+        {
+            weight_data_int8_descales[i] = 1.f / weight_data_int8_scales[i];
+        }
+
+        return 0;
+    }
+#endif // NCNN_INT8
+
+#if NCNN_F16C && __F16C__
+    if (cpu_support_x86_f16c() && opt.use_fp16_storage)
+    {
+        cast_float32_to_float16(weight_data, weight_data_fp16, opt);
+        if (weight_data_fp16.empty())
+            return -100;
+
+        if (opt.lightmode)
+            weight_data.release();
+    }
+#else
+    (void)(opt);
+#endif // NCNN_F16C && __F16C__
+
+    return 0;
+}
+
+const char* Embed_x86::kernel_name() const
+{
+    if (int8_scale_term)
+        return "int8";
+
+    if (!weight_data_fp16.empty())
+        return "fp16s";
+
+    return "fp32";
+}
+
+static void embed_row(const float* em, const float* bias_ptr, float* outptr, int num_output)
+{
+    if (!bias_ptr)
+    {
+        memcpy(outptr, em, num_output * sizeof(float));
+        return;
+    }
+
+    int p = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; p + 15 < num_output; p += 16)
+    {
+        _mm512_storeu_ps(outptr + p, _mm512_add_ps(_mm512_loadu_ps(em + p), _mm512_loadu_ps(bias_ptr + p)));
+    }
+#endif // __AVX512F__
+    for (; p + 7 < num_output; p += 8)
+    {
+        _mm256_storeu_ps(outptr + p, _mm256_add_ps(_mm256_loadu_ps(em + p), _mm256_loadu_ps(bias_ptr + p)));
+    }
+#endif // __AVX__
+    for (; p + 3 < num_output; p += 4)
+    {
+        _mm_storeu_ps(outptr + p, _mm_add_ps(_mm_loadu_ps(em + p), _mm_loadu_ps(bias_ptr + p)));
+    }
+#endif // __SSE2__
+    for (; p < num_output; p++)
+    {
+        outptr[p] = em[p] + bias_ptr[p];
+    }
+}
+
+#if NCNN_F16C && __F16C__
+static void embed_row_fp16s(const unsigned short* em, const float* bias_ptr, float* outptr, int num_output)
+{
+    int p = 0;
+#if __AVX512F__
+    for (; p + 15 < num_output; p += 16)
+    {
+        __m512 _v = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(em + p)));
+        if (bias_ptr)
+            _v = _mm512_add_ps(_v, _mm512_loadu_ps(bias_ptr + p));
+        _mm512_storeu_ps(outptr + p, _v);
+    }
+#endif // __AVX512F__
+    for (; p + 7 < num_output; p += 8)
+    {
+        __m256 _v = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(em + p)));
+        if (bias_ptr)
+            _v = _mm256_add_ps(_v, _mm256_loadu_ps(bias_ptr + p));
+        _mm256_storeu_ps(outptr + p, _v);
+    }
+    for (; p + 3 < num_output; p += 4)
+    {
+        __m128 _v = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)(em + p)));
+        if (bias_ptr)
+            _v = _mm_add_ps(_v, _mm_loadu_ps(bias_ptr + p));
+        _mm_storeu_ps(outptr + p, _v);
+    }
+    for (; p < num_output; p++)
+    {
+        float v = float16_to_float32(em[p]);
+        if (bias_ptr)
+            v += bias_ptr[p];
+        outptr[p] = v;
+    }
+}
+#endif // NCNN_F16C && __F16C__
+
+#if NCNN_INT8
+static void embed_row_int8(const signed char* em, float descale, const float* bias_ptr, float* outptr, int num_output)
+{
+    int p = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    {
+        __m512 _descale = _mm512_set1_ps(descale);
+        for (; p + 15 < num_output; p += 16)
+        {
+            __m512 _v = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i*)(em + p))));
+            _v = _mm512_mul_ps(_v, _descale);
+            if (bias_ptr)
+                _v = _mm512_add_ps(_v, _mm512_loadu_ps(bias_ptr + p));
+            _mm512_storeu_ps(outptr + p, _v);
+        }
+    }
+#endif // __AVX512F__
+    {
+        __m256 _descale = _mm256_set1_ps(descale);
+        for (; p + 7 < num_output; p += 8)
+        {
+            __m128i _w = _mm_loadl_epi64((const __m128i*)(em + p));
+#if __AVX2__
+            __m256 _v = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_w));
+#else
+            __m128i _w0 = _mm_cvtepi8_epi32(_w);
+            __m128i _w1 = _mm_cvtepi8_epi32(_mm_srli_si128(_w, 4));
+            __m256 _v = _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_w0), _w1, 1));
+#endif
+            _v = _mm256_mul_ps(_v, _descale);
+            if (bias_ptr)
+                _v = _mm256_add_ps(_v, _mm256_loadu_ps(bias_ptr + p));
+            _mm256_storeu_ps(outptr + p, _v);
+        }
+    }
+#endif // __AVX__
+    {
+        __m128 _descale = _mm_set1_ps(descale);
+        for (; p + 3 < num_output; p += 4)
+        {
+            int w4;
+            memcpy(&w4, em + p, 4);
+            __m128i _w = _mm_cvtsi32_si128(w4);
+#if __SSE4_1__
+            _w = _mm_cvtepi8_epi32(_w);
+#else
+            _w = _mm_unpacklo_epi8(_w, _w);
+            _w = _mm_srai_epi32(_mm_unpacklo_epi16(_w, _w), 24);
+#endif
+            __m128 _v = _mm_mul_ps(_mm_cvtepi32_ps(_w), _descale);
+            if (bias_ptr)
+                _v = _mm_add_ps(_v, _mm_loadu_ps(bias_ptr + p));
+            _mm_storeu_ps(outptr + p, _v);
+        }
+    }
+#endif // __SSE2__
+    for (; p < num_output; p++)
+    {
+        float v = em[p] * descale;
+        if (bias_ptr)
+            v += bias_ptr[p];
+        outptr[p] = v;
+    }
+}
+#endif // NCNN_INT8
+
+int Embed_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int words = bottom_blob.w;
+
+    top_blob.create(num_output, words, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const int* word_ptr = bottom_blob;
+    const float* bias_ptr = bias_term ? (const float*)bias_data : 0;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < words; q++)
+    {
+        float* outptr = top_blob.row(q);
+
+        int word_index = word_ptr[q];
+
+        if (word_index < 0)
+            word_index = 0;
+        if (word_index >= input_dim)
+            word_index = input_dim - 1;
+
+#if NCNN_INT8
+        if (int8_scale_term)
+        {
+            const signed char* em = (const signed char*)weight_data + num_output * word_index;
+            const float descale = weight_data_int8_descales[weight_data_int8_descales.w == 1 ? 0 : word_index];
+
+            embed_row_int8(em, descale, bias_ptr, outptr, num_output);
+            continue;
+        }
+#endif // NCNN_INT8
+
+#if NCNN_F16C && __F16C__
+        if (!weight_data_fp16.empty())
+        {
+            const unsigned short* em = (const unsigned short*)weight_data_fp16 + num_output * word_index;
+
+            embed_row_fp16s(em, bias_ptr, outptr, num_output);
+            continue;
+        }
+#endif // NCNN_F16C && __F16C__
+
+        const float* em = (const float*)weight_data + num_output * word_index;
+
+        embed_row(em, bias_ptr, outptr, num_output);
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
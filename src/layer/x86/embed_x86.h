@@ -0,0 +1,33 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_EMBED_X86_H
+#define LAYER_EMBED_X86_H
+
+#include "embed.h"
+
+namespace ncnn {
+
+class Embed_x86 : public Embed
+{
+public:
+    Embed_x86();
+
+    virtual int create_pipeline(const Option& opt);
+
+    virtual const char* kernel_name() const;
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+public:
+    // fp16 table, used instead of weight_data when not empty
+    Mat weight_data_fp16;
+
+#if NCNN_INT8
+    Mat weight_data_int8_descales;
+#endif
+};
+
+} // namespace ncnn
+
+#endif // LAYER_EMBED_X86_H
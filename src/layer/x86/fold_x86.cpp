@@ -0,0 +1,243 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "fold_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+namespace ncnn {
+
+Fold_x86::Fold_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+// accumulate inw samples from elempack input rows sstride floats apart into packed outputs spaced step floats apart
+static void fold_row_pack(const float* sptr, size_t sstride, float* outptr, int step, int inw, int elempack)
+{
+    int j = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        for (; j + 15 < inw; j += 16)
+        {
+            __m512 _r0 = _mm512_loadu_ps(sptr + j);
+            __m512 _r1 = _mm512_loadu_ps(sptr + sstride + j);
+            __m512 _r2 = _mm512_loadu_ps(sptr + sstride * 2 + j);
+            __m512 _r3 = _mm512_loadu_ps(sptr + sstride * 3 + j);
+            __m512 _r4 = _mm512_loadu_ps(sptr + sstride * 4 + j);
+            __m512 _r5 = _mm512_loadu_ps(sptr + sstride * 5 + j);
+            __m512 _r6 = _mm512_loadu_ps(sptr + sstride * 6 + j);
+            __m512 _r7 = _mm512_loadu_ps(sptr + sstride * 7 + j);
+            __m512 _r8 = _mm512_loadu_ps(sptr + sstride * 8 + j);
+            __m512 _r9 = _mm512_loadu_ps(sptr + sstride * 9 + j);
+            __m512 _ra = _mm512_loadu_ps(sptr + sstride * 10 + j);
+            __m512 _rb = _mm512_loadu_ps(sptr + sstride * 11 + j);
+            __m512 _rc = _mm512_loadu_ps(sptr + sstride * 12 + j);
+            __m512 _rd = _mm512_loadu_ps(sptr + sstride * 13 + j);
+            __m512 _re = _mm512_loadu_ps(sptr + sstride * 14 + j);
+            __m512 _rf = _mm512_loadu_ps(sptr + sstride * 15 + j);
+            transpose16x16_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
+            _mm512_storeu_ps(outptr, _mm512_add_ps(_mm512_loadu_ps(outptr), _r0));
+            _mm512_storeu_ps(outptr + step, _mm512_add_ps(_mm512_loadu_ps(outptr + step), _r1));
+            _mm512_storeu_ps(outptr + step * 2, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 2), _r2));
+            _mm512_storeu_ps(outptr + step * 3, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 3), _r3));
+            _mm512_storeu_ps(outptr + step * 4, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 4), _r4));
+            _mm512_storeu_ps(outptr + step * 5, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 5), _r5));
+            _mm512_storeu_ps(outptr + step * 6, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 6), _r6));
+            _mm512_storeu_ps(outptr + step * 7, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 7), _r7));
+            _mm512_storeu_ps(outptr + step * 8, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 8), _r8));
+            _mm512_storeu_ps(outptr + step * 9, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 9), _r9));
+            _mm512_storeu_ps(outptr + step * 10, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 10), _ra));
+            _mm512_storeu_ps(outptr + step * 11, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 11), _rb));
+            _mm512_storeu_ps(outptr + step * 12, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 12), _rc));
+            _mm512_storeu_ps(outptr + step * 13, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 13), _rd));
+            _mm512_storeu_ps(outptr + step * 14, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 14), _re));
+            _mm512_storeu_ps(outptr + step * 15, _mm512_add_ps(_mm512_loadu_ps(outptr + step * 15), _rf));
+            outptr += step * 16;
+        }
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        for (; j + 7 < inw; j += 8)
+        {
+            __m256 _r0 = _mm256_loadu_ps(sptr + j);
+            __m256 _r1 = _mm256_loadu_ps(sptr + sstride + j);
+            __m256 _r2 = _mm256_loadu_ps(sptr + sstride * 2 + j);
+            __m256 _r3 = _mm256_loadu_ps(sptr + sstride * 3 + j);
+            __m256 _r4 = _mm256_loadu_ps(sptr + sstride * 4 + j);
+            __m256 _r5 = _mm256_loadu_ps(sptr + sstride * 5 + j);
+            __m256 _r6 = _mm256_loadu_ps(sptr + sstride * 6 + j);
+            __m256 _r7 = _mm256_loadu_ps(sptr + sstride * 7 + j);
+            transpose8x8_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+            _mm256_storeu_ps(outptr, _mm256_add_ps(_mm256_loadu_ps(outptr), _r0));
+            _mm256_storeu_ps(outptr + step, _mm256_add_ps(_mm256_loadu_ps(outptr + step), _r1));
+            _mm256_storeu_ps(outptr + step * 2, _mm256_add_ps(_mm256_loadu_ps(outptr + step * 2), _r2));
+            _mm256_storeu_ps(outptr + step * 3, _mm256_add_ps(_mm256_loadu_ps(outptr + step * 3), _r3));
+            _mm256_storeu_ps(outptr + step * 4, _mm256_add_ps(_mm256_loadu_ps(outptr + step * 4), _r4));
+            _mm256_storeu_ps(outptr + step * 5, _mm256_add_ps(_mm256_loadu_ps(outptr + step * 5), _r5));
+            _mm256_storeu_ps(outptr + step * 6, _mm256_add_ps(_mm256_loadu_ps(outptr + step * 6), _r6));
+            _mm256_storeu_ps(outptr + step * 7, _mm256_add_ps(_mm256_loadu_ps(outptr + step * 7), _r7));
+            outptr += step * 8;
+        }
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        for (; j + 3 < inw; j += 4)
+        {
+            __m128 _r0 = _mm_loadu_ps(sptr + j);
+            __m128 _r1 = _mm_loadu_ps(sptr + sstride + j);
+            __m128 _r2 = _mm_loadu_ps(sptr + sstride * 2 + j);
+            __m128 _r3 = _mm_loadu_ps(sptr + sstride * 3 + j);
+            _MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+            _mm_storeu_ps(outptr, _mm_add_ps(_mm_loadu_ps(outptr), _r0));
+            _mm_storeu_ps(outptr + step, _mm_add_ps(_mm_loadu_ps(outptr + step), _r1));
+            _mm_storeu_ps(outptr + step * 2, _mm_add_ps(_mm_loadu_ps(outptr + step * 2), _r2));
+            _mm_storeu_ps(outptr + step * 3, _mm_add_ps(_mm_loadu_ps(outptr + step * 3), _r3));
+            outptr += step * 4;
+        }
+    }
+#endif // __SSE2__
+    for (; j < inw; j++)
+    {
+        for (int l = 0; l < elempack; l++)
+        {
+            outptr[l] += sptr[sstride * l + j];
+        }
+        outptr += step;
+    }
+}
+
+int Fold_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // the column rows are channel-major with the kernel offset inner, read them unpacked
+    Mat bottom_blob_unpacked = bottom_blob;
+    if (bottom_blob.elempack != 1)
+    {
+        Option opt_pack = opt;
+        opt_pack.blob_allocator = opt.workspace_allocator;
+
+        convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack);
+        if (bottom_blob_unpacked.empty())
+            return -100;
+    }
+
+    const int size = bottom_blob_unpacked.w;
+    const int max_channels = bottom_blob_unpacked.h;
+    const size_t elemsize = bottom_blob_unpacked.elemsize;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = output_w + pad_left + pad_right;
+    const int outh = output_h + pad_top + pad_bottom;
+
+    const int inw = (outw - kernel_extent_w) / stride_w + 1;
+    const int inh = (outh - kernel_extent_h) / stride_h + 1;
+
+    // assert inw * inh == size
+
+    const int maxk = kernel_w * kernel_h;
+    const int channels = max_channels / maxk;
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = channels % 16 == 0 ? 16 : channels % 8 == 0 ? 8 : channels % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = channels % 8 == 0 ? 8 : channels % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = channels % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    const size_t out_elemsize = elemsize * out_elempack;
+
+    const bool has_padding = pad_left > 0 || pad_right > 0 || pad_top > 0 || pad_bottom > 0;
+
+    Mat top_blob_bordered;
+    if (has_padding)
+    {
+        top_blob_bordered.create(outw, outh, channels / out_elempack, out_elemsize, out_elempack, opt.workspace_allocator);
+    }
+    else
+    {
+        top_blob_bordered = top_blob;
+        top_blob_bordered.create(outw, outh, channels / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    if (top_blob_bordered.empty())
+        return -100;
+
+    // col2im, elempack channel rows maxk rows apart accumulate into one packed output channel
+    const size_t sstride = (size_t)size * maxk;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < channels / out_elempack; p++)
+    {
+        Mat outm = top_blob_bordered.channel(p);
+
+        memset(outm.data, 0, outw * outh * out_elemsize);
+
+        for (int u = 0; u < kernel_h; u++)
+        {
+            for (int v = 0; v < kernel_w; v++)
+            {
+                const float* sptr = bottom_blob_unpacked.row(p * out_elempack * maxk + u * kernel_w + v);
+
+                for (int i = 0; i < inh; i++)
+                {
+                    float* outptr = outm.row(dilation_h * u + stride_h * i) + dilation_w * v * out_elempack;
+
+                    fold_row_pack(sptr, sstride, outptr, stride_w * out_elempack, inw, out_elempack);
+
+                    sptr += inw;
+                }
+            }
+        }
+    }
+
+    if (has_padding)
+    {
+        top_blob.create(output_w, output_h, channels / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+        if (top_blob.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < channels / out_elempack; p++)
+        {
+            const Mat m = top_blob_bordered.channel(p);
+            Mat outm = top_blob.channel(p);
+
+            for (int i = 0; i < output_h; i++)
+            {
+                const float* ptr = m.row(pad_top + i) + pad_left * out_elempack;
+                float* outptr = outm.row(i);
+
+                memcpy(outptr, ptr, output_w * out_elemsize);
+            }
+        }
+    }
+    else
+    {
+        top_blob = top_blob_bordered;
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
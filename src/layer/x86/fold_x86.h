@@ -0,0 +1,21 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_FOLD_X86_H
+#define LAYER_FOLD_X86_H
+
+#include "fold.h"
+
+namespace ncnn {
+
+class Fold_x86 : public Fold
+{
+public:
+    Fold_x86();
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+};
+
+} // namespace ncnn
+
+#endif // LAYER_FOLD_X86_H
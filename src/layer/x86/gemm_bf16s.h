@@ -0,0 +1,1049 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_BF16__
+void gemm_transB_packed_tile_bf16s_amx(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+void gemm_tile_config_bf16s_amx();
+void gemm_tile_release_bf16s_amx();
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+void gemm_transB_packed_tile_bf16s_avx512bf16(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+#endif
+
+// the packed bf16 tiles keep k in pairs, one 32bit lane holds k and k+1 of the same row,
+// which is the operand layout of vdpbf16ps, an odd k tail is padded with zero
+// A rows are grouped by 16 8 4 1 and B columns by 12 4 1 according to the isa
+// topT keeps every row group as consecutive columns of fp32 row vectors
+
+#if __SSE2__
+static NCNN_FORCEINLINE __m128i load_bf16x8(const unsigned short* p)
+{
+    return _mm_loadu_si128((const __m128i*)p);
+}
+
+static NCNN_FORCEINLINE __m128i load_bf16x8(const float* p)
+{
+    return float2bfloat_sse(_mm_loadu_ps(p), _mm_loadu_ps(p + 4));
+}
+
+static NCNN_FORCEINLINE __m128i load_bf16x4(const unsigned short* p)
+{
+    return _mm_loadl_epi64((const __m128i*)p);
+}
+
+static NCNN_FORCEINLINE __m128i load_bf16x4(const float* p)
+{
+    return float2bfloat_sse(_mm_loadu_ps(p), _mm_setzero_ps());
+}
+#endif // __SSE2__
+
+static NCNN_FORCEINLINE unsigned short load_bf16(const unsigned short* p)
+{
+    return p[0];
+}
+
+static NCNN_FORCEINLINE unsigned short load_bf16(const float* p)
+{
+    return float32_to_bfloat16(p[0]);
+}
+
+// pack rows r0 ~ r0+rows of X into k pairs, T is unsigned short for bf16 X or float for fp32 X
+template<typename T>
+static void pack_tile_bf16_block(const Mat& X, int transX, unsigned short* pp, int r0, int rows, int k, int max_kk)
+{
+    const int elempack = X.elempack;
+    const size_t hstep = X.dims == 3 ? X.cstep : (size_t)X.w;
+
+    const T* p = X;
+
+#if __SSE2__
+    if (elempack == 1 && !transX && rows % 4 == 0)
+    {
+        // k is contiguous in every row, transpose 4 rows x 4 k pairs as 32bit words
+        int kk = 0;
+        for (; kk + 7 < max_kk; kk += 8)
+        {
+            for (int r = 0; r < rows; r += 4)
+            {
+                const T* p0 = p + (r0 + r) * hstep + k + kk;
+
+                __m128i _r0 = load_bf16x8(p0);
+                __m128i _r1 = load_bf16x8(p0 + hstep);
+                __m128i _r2 = load_bf16x8(p0 + hstep * 2);
+                __m128i _r3 = load_bf16x8(p0 + hstep * 3);
+                transpose4x4_epi32(_r0, _r1, _r2, _r3);
+                _mm_storeu_si128((__m128i*)(pp + r * 2), _r0);
+                _mm_storeu_si128((__m128i*)(pp + rows * 2 + r * 2), _r1);
+                _mm_storeu_si128((__m128i*)(pp + rows * 4 + r * 2), _r2);
+                _mm_storeu_si128((__m128i*)(pp + rows * 6 + r * 2), _r3);
+            }
+            pp += rows * 8;
+        }
+        for (; kk < max_kk; kk += 2)
+        {
+            for (int r = 0; r < rows; r++)
+            {
+                const T* p0 = p + (r0 + r) * hstep + k + kk;
+                pp[0] = load_bf16(p0);
+                pp[1] = kk + 1 < max_kk ? load_bf16(p0 + 1) : 0;
+                pp += 2;
+            }
+        }
+        return;
+    }
+
+    if (elempack == 1 && transX && rows % 4 == 0)
+    {
+        // rows are contiguous in every k line, interleave two k lines
+        for (int kk = 0; kk < max_kk; kk += 2)
+        {
+            const T* p0 = p + (k + kk) * hstep + r0;
+            const T* p1 = p0 + hstep;
+            const bool k1 = kk + 1 < max_kk;
+
+            int r = 0;
+            for (; r + 7 < rows; r += 8)
+            {
+                __m128i _a = load_bf16x8(p0 + r);
+                __m128i _b = k1 ? load_bf16x8(p1 + r) : _mm_setzero_si128();
+                _mm_storeu_si128((__m128i*)(pp + r * 2), _mm_unpacklo_epi16(_a, _b));
+                _mm_storeu_si128((__m128i*)(pp + r * 2 + 8), _mm_unpackhi_epi16(_a, _b));
+            }
+            for (; r < rows; r += 4)
+            {
+                __m128i _a = load_bf16x4(p0 + r);
+                __m128i _b = k1 ? load_bf16x4(p1 + r) : _mm_setzero_si128();
+                _mm_storeu_si128((__m128i*)(pp + r * 2), _mm_unpacklo_epi16(_a, _b));
+            }
+            pp += rows * 2;
+        }
+        return;
+    }
+
+    if (elempack % 4 == 0 && !transX && r0 % 4 == 0 && rows % 4 == 0)
+    {
+        // 4 rows of one k are contiguous inside a pack, interleave the k and k+1 rows
+        for (int kk = 0; kk < max_kk; kk += 2)
+        {
+            const bool k1 = kk + 1 < max_kk;
+
+            for (int r = 0; r < rows; r += 4)
+            {
+                const int ri = r0 + r;
+                const T* p0 = p + (ri / elempack * hstep + k + kk) * elempack + ri % elempack;
+
+                __m128i _a = load_bf16x4(p0);
+                __m128i _b = k1 ? load_bf16x4(p0 + elempack) : _mm_setzero_si128();
+                _mm_storeu_si128((__m128i*)(pp + r * 2), _mm_unpacklo_epi16(_a, _b));
+            }
+            pp += rows * 2;
+        }
+        return;
+    }
+
+    if (elempack == 4 && transX && k % 4 == 0 && rows % 4 == 0)
+    {
+        // one row holds a k quad as two 32bit words, split the even and odd words of 4 rows
+        int kk = 0;
+        for (; kk + 3 < max_kk; kk += 4)
+        {
+            for (int r = 0; r < rows; r += 4)
+            {
+                const T* p0 = p + ((k + kk) / 4 * hstep + r0 + r) * 4;
+
+                __m128 _r01 = _mm_castsi128_ps(load_bf16x8(p0));
+                __m128 _r23 = _mm_castsi128_ps(load_bf16x8(p0 + 8));
+                _mm_storeu_ps((float*)(pp + r * 2), _mm_shuffle_ps(_r01, _r23, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps((float*)(pp + rows * 2 + r * 2), _mm_shuffle_ps(_r01, _r23, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            pp += rows * 4;
+        }
+        for (; kk < max_kk; kk += 2)
+        {
+            for (int r = 0; r < rows; r++)
+            {
+                const T* p0 = p + ((k + kk) / 4 * hstep + r0 + r) * 4 + kk % 4;
+                pp[0] = load_bf16(p0);
+                pp[1] = kk + 1 < max_kk ? load_bf16(p0 + 1) : 0;
+                pp += 2;
+            }
+        }
+        return;
+    }
+#endif // __SSE2__
+
+    size_t roffs[16];
+    for (int r = 0; r < rows; r++)
+    {
+        const int ri = r0 + r;
+        roffs[r] = transX ? (size_t)ri * elempack : ri / elempack * hstep * elempack + ri % elempack;
+    }
+
+    // walk k by pack and lane instead of dividing for every k
+    int kq = transX ? k / elempack : k;
+    int lane = transX ? k % elempack : 0;
+
+    for (int kk = 0; kk < max_kk; kk += 2)
+    {
+        const size_t koff0 = transX ? kq * hstep * elempack + lane : (size_t)kq * elempack;
+
+        if (transX)
+        {
+            lane++;
+            if (lane == elempack)
+            {
+                lane = 0;
+                kq++;
+            }
+        }
+        else
+        {
+            kq++;
+        }
+
+        const size_t koff1 = transX ? kq * hstep * elempack + lane : (size_t)kq * elempack;
+
+        if (transX)
+        {
+            lane++;
+            if (lane == elempack)
+            {
+                lane = 0;
+                kq++;
+            }
+        }
+        else
+        {
+            kq++;
+        }
+
+        if (kk + 1 < max_kk)
+        {
+            for (int r = 0; r < rows; r++)
+            {
+                pp[0] = load_bf16(p + roffs[r] + koff0);
+                pp[1] = load_bf16(p + roffs[r] + koff1);
+                pp += 2;
+            }
+        }
+        else
+        {
+            for (int r = 0; r < rows; r++)
+            {
+                pp[0] = load_bf16(p + roffs[r] + koff0);
+                pp[1] = 0;
+                pp += 2;
+            }
+        }
+    }
+}
+
+static void pack_A_tile_bf16_impl(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk, int transA, bool from_fp32)
+{
+    const int max_kk2 = (max_kk + 1) / 2 * 2;
+
+    unsigned short* pp = AT;
+
+    int ii = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; ii + 15 < max_ii; ii += 16)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(A, transA, pp, i + ii, 16, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(A, transA, pp, i + ii, 16, k, max_kk);
+        pp += 16 * max_kk2;
+    }
+#endif // __AVX512F__
+    for (; ii + 7 < max_ii; ii += 8)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(A, transA, pp, i + ii, 8, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(A, transA, pp, i + ii, 8, k, max_kk);
+        pp += 8 * max_kk2;
+    }
+#endif // __AVX__
+    for (; ii + 3 < max_ii; ii += 4)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(A, transA, pp, i + ii, 4, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(A, transA, pp, i + ii, 4, k, max_kk);
+        pp += 4 * max_kk2;
+    }
+#endif // __SSE2__
+    for (; ii < max_ii; ii++)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(A, transA, pp, i + ii, 1, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(A, transA, pp, i + ii, 1, k, max_kk);
+        pp += max_kk2;
+    }
+}
+
+static void pack_B_tile_bf16_impl(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk, int transB, bool from_fp32)
+{
+    const int max_kk2 = (max_kk + 1) / 2 * 2;
+
+    unsigned short* pp = BT;
+
+    int jj = 0;
+#if __SSE2__
+    for (; jj + 11 < max_jj; jj += 12)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(B, transB, pp, j + jj, 12, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(B, transB, pp, j + jj, 12, k, max_kk);
+        pp += 12 * max_kk2;
+    }
+    for (; jj + 3 < max_jj; jj += 4)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(B, transB, pp, j + jj, 4, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(B, transB, pp, j + jj, 4, k, max_kk);
+        pp += 4 * max_kk2;
+    }
+#endif // __SSE2__
+    for (; jj < max_jj; jj++)
+    {
+        if (from_fp32)
+            pack_tile_bf16_block<float>(B, transB, pp, j + jj, 1, k, max_kk);
+        else
+            pack_tile_bf16_block<unsigned short>(B, transB, pp, j + jj, 1, k, max_kk);
+        pp += max_kk2;
+    }
+}
+
+static void pack_A_tile_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    pack_A_tile_bf16_impl(A, AT, i, max_ii, k, max_kk, 0, false);
+}
+
+static void transpose_pack_A_tile_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    pack_A_tile_bf16_impl(A, AT, i, max_ii, k, max_kk, 1, false);
+}
+
+static void pack_A_tile_fp32_to_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    pack_A_tile_bf16_impl(A, AT, i, max_ii, k, max_kk, 0, true);
+}
+
+static void transpose_pack_A_tile_fp32_to_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    pack_A_tile_bf16_impl(A, AT, i, max_ii, k, max_kk, 1, true);
+}
+
+static void pack_B_tile_bf16(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk)
+{
+    pack_B_tile_bf16_impl(B, BT, j, max_jj, k, max_kk, 0, false);
+}
+
+static void transpose_pack_B_tile_bf16(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk)
+{
+    pack_B_tile_bf16_impl(B, BT, j, max_jj, k, max_kk, 1, false);
+}
+
+static void pack_B_tile_fp32_to_bf16(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk)
+{
+    pack_B_tile_bf16_impl(B, BT, j, max_jj, k, max_kk, 0, true);
+}
+
+static void transpose_pack_B_tile_fp32_to_bf16(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk)
+{
+    pack_B_tile_bf16_impl(B, BT, j, max_jj, k, max_kk, 1, true);
+}
+
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+// accumulate a 16 x cols block, pA holds 16 rows and pB holds cols columns per k pair
+static NCNN_FORCEINLINE void gemm_bf16s_block_16xn(const unsigned short* pA, const unsigned short* pB, float* outptr, int cols, int max_kk2, bool k0)
+{
+    __m512 _sum[12];
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            _sum[c] = k0 ? _mm512_setzero_ps() : _mm512_loadu_ps(outptr + c * 16);
+    }
+
+    for (int kk = 0; kk < max_kk2; kk++)
+    {
+        __m512i _pA = _mm512_loadu_si512((const __m512i*)pA);
+#if __AVX512BF16__
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+                _sum[c] = _mm512_dpbf16_ps(_sum[c], (__m512bh)_pA, (__m512bh)_mm512_set1_epi32(((const int*)pB)[c]));
+        }
+#else
+        __m512 _a0 = _mm512_castsi512_ps(_mm512_slli_epi32(_pA, 16));
+        __m512 _a1 = _mm512_castsi512_ps(_mm512_and_si512(_pA, _mm512_set1_epi32((int)0xffff0000)));
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+            {
+                _sum[c] = _mm512_fmadd_ps(_a0, _mm512_set1_ps(bfloat16_to_float32(pB[c * 2])), _sum[c]);
+                _sum[c] = _mm512_fmadd_ps(_a1, _mm512_set1_ps(bfloat16_to_float32(pB[c * 2 + 1])), _sum[c]);
+            }
+        }
+#endif
+        pA += 32;
+        pB += cols * 2;
+    }
+
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            _mm512_storeu_ps(outptr + c * 16, _sum[c]);
+    }
+}
+#endif // __AVX512F__
+
+// accumulate a 8 x cols block
+static NCNN_FORCEINLINE void gemm_bf16s_block_8xn(const unsigned short* pA, const unsigned short* pB, float* outptr, int cols, int max_kk2, bool k0)
+{
+    __m256 _sum[12];
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            _sum[c] = k0 ? _mm256_setzero_ps() : _mm256_loadu_ps(outptr + c * 8);
+    }
+
+    for (int kk = 0; kk < max_kk2; kk++)
+    {
+        __m256i _pA = _mm256_loadu_si256((const __m256i*)pA);
+#if __AVX512BF16__
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+                _sum[c] = _mm256_dpbf16_ps(_sum[c], (__m256bh)_pA, (__m256bh)_mm256_set1_epi32(((const int*)pB)[c]));
+        }
+#else
+#if __AVX2__
+        __m256 _a0 = _mm256_castsi256_ps(_mm256_slli_epi32(_pA, 16));
+#else
+        __m128i _pA0 = _mm_slli_epi32(_mm256_extractf128_si256(_pA, 0), 16);
+        __m128i _pA1 = _mm_slli_epi32(_mm256_extractf128_si256(_pA, 1), 16);
+        __m256 _a0 = _mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(_pA0), _pA1, 1));
+#endif
+        __m256 _a1 = _mm256_and_ps(_mm256_castsi256_ps(_pA), _mm256_castsi256_ps(_mm256_set1_epi32((int)0xffff0000)));
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+            {
+                _sum[c] = _mm256_comp_fmadd_ps(_a0, _mm256_set1_ps(bfloat16_to_float32(pB[c * 2])), _sum[c]);
+                _sum[c] = _mm256_comp_fmadd_ps(_a1, _mm256_set1_ps(bfloat16_to_float32(pB[c * 2 + 1])), _sum[c]);
+            }
+        }
+#endif
+        pA += 16;
+        pB += cols * 2;
+    }
+
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            _mm256_storeu_ps(outptr + c * 8, _sum[c]);
+    }
+}
+#endif // __AVX__
+
+// accumulate a 4 x cols block
+static NCNN_FORCEINLINE void gemm_bf16s_block_4xn(const unsigned short* pA, const unsigned short* pB, float* outptr, int cols, int max_kk2, bool k0)
+{
+    __m128 _sum[12];
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            _sum[c] = k0 ? _mm_setzero_ps() : _mm_loadu_ps(outptr + c * 4);
+    }
+
+    for (int kk = 0; kk < max_kk2; kk++)
+    {
+        __m128i _pA = _mm_loadu_si128((const __m128i*)pA);
+#if __AVX512BF16__
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+                _sum[c] = _mm_dpbf16_ps(_sum[c], (__m128bh)_pA, (__m128bh)_mm_set1_epi32(((const int*)pB)[c]));
+        }
+#else
+        __m128 _a0 = _mm_castsi128_ps(_mm_slli_epi32(_pA, 16));
+        __m128 _a1 = _mm_and_ps(_mm_castsi128_ps(_pA), _mm_castsi128_ps(_mm_set1_epi32((int)0xffff0000)));
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+            {
+                _sum[c] = _mm_comp_fmadd_ps(_a0, _mm_set1_ps(bfloat16_to_float32(pB[c * 2])), _sum[c]);
+                _sum[c] = _mm_comp_fmadd_ps(_a1, _mm_set1_ps(bfloat16_to_float32(pB[c * 2 + 1])), _sum[c]);
+            }
+        }
+#endif
+        pA += 8;
+        pB += cols * 2;
+    }
+
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            _mm_storeu_ps(outptr + c * 4, _sum[c]);
+    }
+}
+#endif // __SSE2__
+
+// accumulate a 1 x cols block
+static NCNN_FORCEINLINE void gemm_bf16s_block_1xn(const unsigned short* pA, const unsigned short* pB, float* outptr, int cols, int max_kk2, bool k0)
+{
+    float sum[12];
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            sum[c] = k0 ? 0.f : outptr[c];
+    }
+
+    for (int kk = 0; kk < max_kk2; kk++)
+    {
+        const float a0 = bfloat16_to_float32(pA[0]);
+        const float a1 = bfloat16_to_float32(pA[1]);
+        for (int c = 0; c < 12; c++)
+        {
+            if (c < cols)
+            {
+                sum[c] += a0 * bfloat16_to_float32(pB[c * 2]);
+                sum[c] += a1 * bfloat16_to_float32(pB[c * 2 + 1]);
+            }
+        }
+        pA += 2;
+        pB += cols * 2;
+    }
+
+    for (int c = 0; c < 12; c++)
+    {
+        if (c < cols)
+            outptr[c] = sum[c];
+    }
+}
+
+// the amx kernel takes B as tile rows of k pairs, pack_B_tile_bf16s_amx stores them behind the packed B tile
+static bool gemm_bf16s_use_amx()
+{
+#if __AMX_BF16__
+    return true;
+#elif NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__
+    return ncnn::cpu_support_x86_amx_bf16();
+#else
+    return false;
+#endif
+}
+
+// extra elements of a B tile for the amx rows, 0 without amx
+static int get_B_tile_amx_size_bf16s(int TILE_N, int TILE_K)
+{
+    if (!gemm_bf16s_use_amx())
+        return 0;
+
+    const int nk = ((TILE_K + 1) / 2 + 15) / 16;
+    const int nj = (TILE_N + 15) / 16;
+    return nj * nk * 512;
+}
+
+// every B column becomes one row of nk * 16 k pairs behind the max_jj * max_kk2 packed elements
+// the rest of the row and the rows up to a multiple of 16 are zero
+static void pack_B_tile_bf16s_amx(Mat& BT, int max_jj, int max_kk)
+{
+#if __AVX512F__
+    if (!gemm_bf16s_use_amx())
+        return;
+
+    const int max_kk2 = (max_kk + 1) / 2;
+    const int nk = (max_kk2 + 15) / 16;
+
+    const int* pB = BT;
+    int* pp = (int*)((unsigned short*)BT + max_jj * max_kk2 * 2);
+
+    const int nj16 = (max_jj + 15) / 16 * 16;
+    memset(pp + max_jj * nk * 16, 0, (nj16 - max_jj) * nk * 64);
+
+    int jj = 0;
+    while (jj < max_jj)
+    {
+        const int cols = jj + 11 < max_jj ? 12 : jj + 3 < max_jj ? 4 : 1;
+
+        // one column of a group is every cols-th k pair
+        const __m512i _vindex0 = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(cols));
+        const __m512i _vstep = _mm512_set1_epi32(16 * cols);
+
+        for (int c = 0; c < cols; c++)
+        {
+            int* p = pp + (jj + c) * nk * 16;
+
+            __m512i _vindex = _vindex0;
+            for (int q = 0; q < nk * 16; q += 16)
+            {
+                const int n = std::min(std::max(max_kk2 - q, 0), 16);
+                const __mmask16 _mask = (__mmask16)((1u << n) - 1);
+                __m512i _v = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), _mask, _vindex, pB + c, sizeof(int));
+                _mm512_storeu_si512((__m512i*)(p + q), _v);
+                _vindex = _mm512_add_epi32(_vindex, _vstep);
+            }
+        }
+
+        pB += cols * max_kk2;
+        jj += cols;
+    }
+#else
+    (void)BT;
+    (void)max_jj;
+    (void)max_kk;
+#endif // __AVX512F__
+}
+
+#if __AMX_BF16__
+// the packed A row group is already an amx B tile, k pairs as rows and the 16 rows as columns
+// B rows come from pack_B_tile_bf16s_amx, the tiles are configured by gemm_tile_config_bf16s
+// the accumulator lands as the topT row group
+static void gemm_bf16s_amx_16xn(const unsigned short* pAT, const unsigned short* pBT, float* outptr, int max_ii, int max_jj, int max_kk2, bool k0)
+{
+    const int nk = (max_kk2 + 15) / 16;
+    const int nj = (max_jj + 15) / 16;
+
+    const int* pB = (const int*)(pBT + max_jj * max_kk2 * 2);
+
+    // the last k block goes through a zero padded copy when it is partial
+    const int last_kk2 = max_kk2 - (nk - 1) * 16;
+
+    int ATk[256];
+    float tmp[256];
+
+    for (int ii = 0; ii + 15 < max_ii; ii += 16)
+    {
+        const int* pA = (const int*)pAT;
+
+        if (last_kk2 != 16)
+        {
+            memset(ATk, 0, sizeof(ATk));
+            memcpy(ATk, pA + (nk - 1) * 256, last_kk2 * 64);
+        }
+
+        for (int jb = 0; jb < nj; jb++)
+        {
+            const int cols = std::min(max_jj - jb * 16, 16);
+
+            // partial column blocks go through tmp to stay inside the row group
+            float* pC = cols == 16 ? outptr + jb * 256 : tmp;
+
+            if (k0)
+            {
+                _tile_zero(0);
+            }
+            else
+            {
+                if (cols != 16)
+                {
+                    memcpy(tmp, outptr + jb * 256, cols * 64);
+                }
+                _tile_loadd(0, pC, 64);
+            }
+
+            for (int kb = 0; kb < nk; kb++)
+            {
+                const int* pa = kb == nk - 1 && last_kk2 != 16 ? ATk : pA + kb * 256;
+                _tile_loadd(1, pB + (jb * 16 * nk + kb) * 16, nk * 64);
+                _tile_loadd(2, pa, 64);
+                _tile_dpbf16ps(0, 1, 2);
+            }
+
+            _tile_stored(0, pC, 64);
+
+            if (cols != 16)
+            {
+                memcpy(outptr + jb * 256, tmp, cols * 64);
+            }
+        }
+
+        pAT += 32 * max_kk2;
+        outptr += 16 * max_jj;
+    }
+}
+#endif // __AMX_BF16__
+
+// load the amx tile config once per thread before a run of gemm_transB_packed_tile_bf16s and release it after
+static void gemm_tile_config_bf16s()
+{
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_BF16__
+    if (ncnn::cpu_support_x86_amx_bf16())
+    {
+        gemm_tile_config_bf16s_amx();
+        return;
+    }
+#endif
+
+#if __AMX_BF16__
+    amx_tile_config_16x64();
+#endif
+}
+
+static void gemm_tile_release_bf16s()
+{
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_BF16__
+    if (ncnn::cpu_support_x86_amx_bf16())
+    {
+        gemm_tile_release_bf16s_amx();
+        return;
+    }
+#endif
+
+#if __AMX_BF16__
+    _tile_release();
+#endif
+}
+
+static void gemm_transB_packed_tile_bf16s(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_BF16__
+    if (ncnn::cpu_support_x86_amx_bf16())
+    {
+        gemm_transB_packed_tile_bf16s_amx(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+        return;
+    }
+#endif
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX512BF16 && __AVX512F__ && !__AVX512BF16__
+    if (ncnn::cpu_support_x86_avx512_bf16())
+    {
+        gemm_transB_packed_tile_bf16s_avx512bf16(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+        return;
+    }
+#endif
+
+    // NCNN_LOGE("gemm_transB_packed_tile_bf16s %d %d %d %d %d %d", i, max_ii, j, max_jj, k, max_kk);
+
+    // actually we only depend the global k==0 condition
+    (void)i;
+    (void)j;
+
+    const int max_kk2 = (max_kk + 1) / 2;
+    const bool k0 = k == 0;
+
+    const unsigned short* pAT = AT_tile;
+    const unsigned short* pBT = BT_tile;
+
+    float* outptr = topT_tile;
+
+    int ii = 0;
+#if __AMX_BF16__
+    if (max_ii >= 16)
+    {
+        gemm_bf16s_amx_16xn(pAT, pBT, outptr, max_ii, max_jj, max_kk2, k0);
+
+        ii = max_ii / 16 * 16;
+        pAT += ii * 2 * max_kk2;
+        outptr += ii * max_jj;
+    }
+#endif // __AMX_BF16__
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; ii + 15 < max_ii; ii += 16)
+    {
+        const unsigned short* pB = pBT;
+
+        int jj = 0;
+        for (; jj + 11 < max_jj; jj += 12)
+        {
+            gemm_bf16s_block_16xn(pAT, pB, outptr, 12, max_kk2, k0);
+            pB += 24 * max_kk2;
+            outptr += 16 * 12;
+        }
+        for (; jj + 3 < max_jj; jj += 4)
+        {
+            gemm_bf16s_block_16xn(pAT, pB, outptr, 4, max_kk2, k0);
+            pB += 8 * max_kk2;
+            outptr += 16 * 4;
+        }
+        for (; jj < max_jj; jj++)
+        {
+            gemm_bf16s_block_16xn(pAT, pB, outptr, 1, max_kk2, k0);
+            pB += 2 * max_kk2;
+            outptr += 16;
+        }
+
+        pAT += 32 * max_kk2;
+    }
+#endif // __AVX512F__
+    for (; ii + 7 < max_ii; ii += 8)
+    {
+        const unsigned short* pB = pBT;
+
+        int jj = 0;
+        for (; jj + 11 < max_jj; jj += 12)
+        {
+            gemm_bf16s_block_8xn(pAT, pB, outptr, 12, max_kk2, k0);
+            pB += 24 * max_kk2;
+            outptr += 8 * 12;
+        }
+        for (; jj + 3 < max_jj; jj += 4)
+        {
+            gemm_bf16s_block_8xn(pAT, pB, outptr, 4, max_kk2, k0);
+            pB += 8 * max_kk2;
+            outptr += 8 * 4;
+        }
+        for (; jj < max_jj; jj++)
+        {
+            gemm_bf16s_block_8xn(pAT, pB, outptr, 1, max_kk2, k0);
+            pB += 2 * max_kk2;
+            outptr += 8;
+        }
+
+        pAT += 16 * max_kk2;
+    }
+#endif // __AVX__
+    for (; ii + 3 < max_ii; ii += 4)
+    {
+        const unsigned short* pB = pBT;
+
+        int jj = 0;
+        for (; jj + 11 < max_jj; jj += 12)
+        {
+            gemm_bf16s_block_4xn(pAT, pB, outptr, 12, max_kk2, k0);
+            pB += 24 * max_kk2;
+            outptr += 4 * 12;
+        }
+        for (; jj + 3 < max_jj; jj += 4)
+        {
+            gemm_bf16s_block_4xn(pAT, pB, outptr, 4, max_kk2, k0);
+            pB += 8 * max_kk2;
+            outptr += 4 * 4;
+        }
+        for (; jj < max_jj; jj++)
+        {
+            gemm_bf16s_block_4xn(pAT, pB, outptr, 1, max_kk2, k0);
+            pB += 2 * max_kk2;
+            outptr += 4;
+        }
+
+        pAT += 8 * max_kk2;
+    }
+#endif // __SSE2__
+    for (; ii < max_ii; ii++)
+    {
+        const unsigned short* pB = pBT;
+
+        int jj = 0;
+#if __SSE2__
+        for (; jj + 11 < max_jj; jj += 12)
+        {
+            gemm_bf16s_block_1xn(pAT, pB, outptr, 12, max_kk2, k0);
+            pB += 24 * max_kk2;
+            outptr += 12;
+        }
+        for (; jj + 3 < max_jj; jj += 4)
+        {
+            gemm_bf16s_block_1xn(pAT, pB, outptr, 4, max_kk2, k0);
+            pB += 8 * max_kk2;
+            outptr += 4;
+        }
+#endif // __SSE2__
+        for (; jj < max_jj; jj++)
+        {
+            gemm_bf16s_block_1xn(pAT, pB, outptr, 1, max_kk2, k0);
+            pB += 2 * max_kk2;
+            outptr += 1;
+        }
+
+        pAT += 2 * max_kk2;
+    }
+}
+
+static void unpack_output_tile_fp32_to_bf16(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, float alpha, int output_transpose, int activation_type, const Mat& activation_params)
+{
+    // NCNN_LOGE("unpack_output_tile_fp32_to_bf16 %d %d %d %d", i, max_ii, j, max_jj);
+
+    const int out_elempack = top_blob.elempack;
+    const size_t out_hstep = top_blob.dims == 3 ? top_blob.cstep : (size_t)top_blob.w;
+
+    // C is fp32 with elempack 1
+    const float* pC = C;
+    const int C_w = C.w;
+
+    const float* pp = topT;
+
+    unsigned short* outptr = top_blob;
+
+    int ii = 0;
+    while (ii < max_ii)
+    {
+        // the row group size of the packed layout
+        int rows = 1;
+#if __SSE2__
+        rows = max_ii - ii >= 4 ? 4 : 1;
+#if __AVX__
+        rows = max_ii - ii >= 8 ? 8 : rows;
+#if __AVX512F__
+        rows = max_ii - ii >= 16 ? 16 : rows;
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+        int g = 0;
+#if __SSE2__
+        if (!output_transpose && (out_elempack == 1 || (out_elempack == 4 && (i + ii) % 4 == 0)))
+        {
+            for (; g + 3 < rows; g += 4)
+            {
+                const int m = i + ii + g;
+
+                __m128 _c = _mm_setzero_ps();
+                if (pC)
+                {
+                    if (broadcast_type_C == 0)
+                        _c = _mm_set1_ps(pC[0]);
+                    if (broadcast_type_C == 1 || broadcast_type_C == 2)
+                        _c = _mm_loadu_ps(pC + m);
+                }
+
+                if (out_elempack == 4)
+                {
+                    unsigned short* p0 = outptr + m / 4 * out_hstep * 4 + j * 4;
+
+                    for (int jj = 0; jj < max_jj; jj++)
+                    {
+                        const int n = j + jj;
+
+                        __m128 _v = _mm_loadu_ps(pp + jj * rows + g);
+                        if (pC)
+                        {
+                            if (broadcast_type_C == 3)
+                                _c = _mm_setr_ps(pC[m * C_w + n], pC[(m + 1) * C_w + n], pC[(m + 2) * C_w + n], pC[(m + 3) * C_w + n]);
+                            if (broadcast_type_C == 4)
+                                _c = _mm_set1_ps(pC[n]);
+                            _v = _mm_add_ps(_v, _c);
+                        }
+                        _v = _mm_mul_ps(_v, _mm_set1_ps(alpha));
+                        _v = activation_sse(_v, activation_type, activation_params);
+
+                        _mm_storel_epi64((__m128i*)(p0 + jj * 4), float2bfloat_sse(_v, _v));
+                    }
+                }
+                else // if (out_elempack == 1)
+                {
+                    unsigned short* p0 = outptr + m * out_hstep + j;
+                    unsigned short* p1 = p0 + out_hstep;
+                    unsigned short* p2 = p0 + out_hstep * 2;
+                    unsigned short* p3 = p0 + out_hstep * 3;
+
+                    __m128 _c0 = _mm_shuffle_ps(_c, _c, _MM_SHUFFLE(0, 0, 0, 0));
+                    __m128 _c1 = _mm_shuffle_ps(_c, _c, _MM_SHUFFLE(1, 1, 1, 1));
+                    __m128 _c2 = _mm_shuffle_ps(_c, _c, _MM_SHUFFLE(2, 2, 2, 2));
+                    __m128 _c3 = _mm_shuffle_ps(_c, _c, _MM_SHUFFLE(3, 3, 3, 3));
+
+                    int jj = 0;
+                    for (; jj + 3 < max_jj; jj += 4)
+                    {
+                        const int n = j + jj;
+
+                        __m128 _r0 = _mm_loadu_ps(pp + jj * rows + g);
+                        __m128 _r1 = _mm_loadu_ps(pp + (jj + 1) * rows + g);
+                        __m128 _r2 = _mm_loadu_ps(pp + (jj + 2) * rows + g);
+                        __m128 _r3 = _mm_loadu_ps(pp + (jj + 3) * rows + g);
+                        _MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+
+                        if (pC)
+                        {
+                            if (broadcast_type_C == 3)
+                            {
+                                _c0 = _mm_loadu_ps(pC + m * C_w + n);
+                                _c1 = _mm_loadu_ps(pC + (m + 1) * C_w + n);
+                                _c2 = _mm_loadu_ps(pC + (m + 2) * C_w + n);
+                                _c3 = _mm_loadu_ps(pC + (m + 3) * C_w + n);
+                            }
+                            if (broadcast_type_C == 4)
+                            {
+                                _c0 = _mm_loadu_ps(pC + n);
+                                _c1 = _c0;
+                                _c2 = _c0;
+                                _c3 = _c0;
+                            }
+                            _r0 = _mm_add_ps(_r0, _c0);
+                            _r1 = _mm_add_ps(_r1, _c1);
+                            _r2 = _mm_add_ps(_r2, _c2);
+                            _r3 = _mm_add_ps(_r3, _c3);
+                        }
+
+                        __m128 _alpha = _mm_set1_ps(alpha);
+                        _r0 = activation_sse(_mm_mul_ps(_r0, _alpha), activation_type, activation_params);
+                        _r1 = activation_sse(_mm_mul_ps(_r1, _alpha), activation_type, activation_params);
+                        _r2 = activation_sse(_mm_mul_ps(_r2, _alpha), activation_type, activation_params);
+                        _r3 = activation_sse(_mm_mul_ps(_r3, _alpha), activation_type, activation_params);
+
+                        __m128i _bf01 = float2bfloat_sse(_r0, _r1);
+                        __m128i _bf23 = float2bfloat_sse(_r2, _r3);
+
+                        _mm_storel_epi64((__m128i*)(p0 + jj), _bf01);
+                        _mm_storel_epi64((__m128i*)(p1 + jj), _mm_unpackhi_epi64(_bf01, _bf01));
+                        _mm_storel_epi64((__m128i*)(p2 + jj), _bf23);
+                        _mm_storel_epi64((__m128i*)(p3 + jj), _mm_unpackhi_epi64(_bf23, _bf23));
+                    }
+                    for (; jj < max_jj; jj++)
+                    {
+                        const int n = j + jj;
+
+                        for (int r = 0; r < 4; r++)
+                        {
+                            float v = pp[jj * rows + g + r];
+                            if (pC)
+                            {
+                                if (broadcast_type_C == 0)
+                                    v += pC[0];
+                                if (broadcast_type_C == 1 || broadcast_type_C == 2)
+                                    v += pC[m + r];
+                                if (broadcast_type_C == 3)
+                                    v += pC[(m + r) * C_w + n];
+                                if (broadcast_type_C == 4)
+                                    v += pC[n];
+                            }
+                            p0[out_hstep * r + jj] = float32_to_bfloat16(activation_ss(v * alpha, activation_type, activation_params));
+                        }
+                    }
+                }
+            }
+        }
+#endif // __SSE2__
+        for (; g < rows; g++)
+        {
+            const int m = i + ii + g;
+
+            for (int jj = 0; jj < max_jj; jj++)
+            {
+                const int n = j + jj;
+
+                float v = pp[jj * rows + g];
+                if (pC)
+                {
+                    if (broadcast_type_C == 0)
+                        v += pC[0];
+                    if (broadcast_type_C == 1 || broadcast_type_C == 2)
+                        v += pC[m];
+                    if (broadcast_type_C == 3)
+                        v += pC[m * C_w + n];
+                    if (broadcast_type_C == 4)
+                        v += pC[n];
+                }
+
+                const size_t offset = output_transpose ? n / out_elempack * out_hstep * out_elempack + m * out_elempack + n % out_elempack : m / out_elempack * out_hstep * out_elempack + n * out_elempack + m % out_elempack;
+                outptr[offset] = float32_to_bfloat16(activation_ss(v * alpha, activation_type, activation_params));
+            }
+        }
+
+        pp += rows * max_jj;
+        ii += rows;
+    }
+}
@@ -1,6 +1,12 @@
 // Copyright 2024 Tencent
 // SPDX-License-Identifier: BSD-3-Clause
 
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_INT8__
+void gemm_transB_packed_tile_int8_amx(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+void gemm_tile_config_int8_amx();
+void gemm_tile_release_int8_amx();
+#endif
+
 #if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
 void pack_A_tile_int8_avx512vnni(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
 void transpose_pack_A_tile_int8_avx512vnni(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
@@ -12469,8 +12475,272 @@ static void unpack_output_tile_int32_to_fp32(const Mat& topT, const Mat& C, Mat&
     }
 }
 
+// the amx kernel takes B as tile rows of k quads, pack_B_tile_int8_amx stores them behind the packed B tile
+static bool gemm_int8_use_amx()
+{
+#if __AMX_INT8__
+    return true;
+#elif NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__
+    return ncnn::cpu_support_x86_amx_int8();
+#else
+    return false;
+#endif
+}
+
+// extra bytes of a B tile for the amx rows, 0 without amx
+static int get_B_tile_amx_size_int8(int TILE_N, int TILE_K)
+{
+    if (!gemm_int8_use_amx())
+        return 0;
+
+    const int nk = ((TILE_K + 3) / 4 + 15) / 16;
+    const int nj = (TILE_N + 15) / 16;
+    return nj * nk * 1024;
+}
+
+// every B column becomes one row of nk * 16 k quads behind the max_jj * max_kk packed bytes
+// the k tail joins as one more quad shifted like the others, the rest of the row and the rows up to a multiple of 16 are zero
+static void pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk)
+{
+#if __AVX512F__
+    if (!gemm_int8_use_amx())
+        return;
+
+    const int max_kk4 = max_kk / 4;
+    const int remain_kk = max_kk % 4;
+    const int nk = ((max_kk + 3) / 4 + 15) / 16;
+
+    const signed char* pB = BT;
+    int* pp = (int*)((signed char*)BT + max_jj * max_kk);
+
+    const int nj16 = (max_jj + 15) / 16 * 16;
+    memset(pp + max_jj * nk * 16, 0, (nj16 - max_jj) * nk * 64);
+
+    int jj = 0;
+    while (jj < max_jj)
+    {
+        const int cols = jj + 15 < max_jj ? 16 : jj + 7 < max_jj ? 8 : jj + 3 < max_jj ? 4 : jj + 1 < max_jj ? 2 : 1;
+
+        // one column of a group is every cols-th quad
+        const __m512i _vindex0 = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(cols));
+        const __m512i _vstep = _mm512_set1_epi32(16 * cols);
+
+        for (int c = 0; c < cols; c++)
+        {
+            int* p = pp + (jj + c) * nk * 16;
+            const int* p0 = (const int*)pB + c;
+
+            __m512i _vindex = _vindex0;
+            for (int q = 0; q < nk * 16; q += 16)
+            {
+                const int n = std::min(std::max(max_kk4 - q, 0), 16);
+                const __mmask16 _mask = (__mmask16)((1u << n) - 1);
+                __m512i _v = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), _mask, _vindex, p0, sizeof(int));
+                _mm512_storeu_si512((__m512i*)(p + q), _v);
+                _vindex = _mm512_add_epi32(_vindex, _vstep);
+            }
+
+            if (remain_kk)
+            {
+                // the tail is stored as plain int8, shift it like the quads
+                unsigned char* pt = (unsigned char*)(p + max_kk4);
+                const signed char* p2 = pB + cols * 4 * max_kk4;
+                int kk = 0;
+                if (remain_kk >= 2)
+                {
+                    pt[0] = (unsigned char)(p2[c * 2] + 127);
+                    pt[1] = (unsigned char)(p2[c * 2 + 1] + 127);
+                    p2 += cols * 2;
+                    kk = 2;
+                }
+                if (remain_kk % 2)
+                {
+                    pt[kk] = (unsigned char)(p2[c] + 127);
+                }
+            }
+        }
+
+        pB += cols * max_kk;
+        jj += cols;
+    }
+#else
+    (void)BT;
+    (void)max_jj;
+    (void)max_kk;
+#endif // __AVX512F__
+}
+
+#if __AMX_INT8__
+// the packed A row group keeps its k quads as amx B tile rows, followed by w_shift and the k tail
+// B rows come from pack_B_tile_int8_amx, the tiles are configured by gemm_tile_config_int8
+// the accumulator comes out in plain column order and is scattered into the register layout of the vnni kernels
+static void gemm_int8_amx_16xn(const signed char* pAT, const signed char* pBT, int* outptr, int max_ii, int max_jj, int max_kk, bool k0)
+{
+    const int max_kk4 = max_kk / 4;
+    const int remain_kk = max_kk % 4;
+    const int nq = max_kk4 + (remain_kk ? 1 : 0);
+    const int nk = (nq + 15) / 16;
+    const int nj = (max_jj + 15) / 16;
+
+    const int* pB = (const int*)(pBT + max_jj * max_kk);
+
+    // the last k block goes through a zero padded copy when it is partial or holds the tail quad
+    const bool k_tail = nq % 16 != 0 || remain_kk;
+    const int last_kq = max_kk4 - (nk - 1) * 16;
+
+    signed char ATk[1024];
+    int comp[16];
+    int CT[256];
+
+    for (int ii = 0; ii + 15 < max_ii; ii += 16)
+    {
+        const signed char* pA = pAT;
+
+        for (int r = 0; r < 16; r++)
+        {
+            comp[r] = max_kk4 ? ((const int*)(pA + max_kk4 * 64))[r] : 0;
+        }
+
+        if (k_tail)
+        {
+            memset(ATk, 0, 1024);
+            memcpy(ATk, pA + (nk - 1) * 1024, last_kq * 64);
+
+            if (remain_kk)
+            {
+                signed char* pt = ATk + last_kq * 64;
+                const signed char* p2 = pA + max_kk4 * 64 + (max_kk4 ? 64 : 0);
+                for (int r = 0; r < 16; r++)
+                {
+                    int kk = 0;
+                    const signed char* p3 = p2;
+                    if (remain_kk >= 2)
+                    {
+                        pt[r * 4] = p3[r * 2];
+                        pt[r * 4 + 1] = p3[r * 2 + 1];
+                        p3 += 32;
+                        kk = 2;
+                    }
+                    if (remain_kk % 2)
+                    {
+                        pt[r * 4 + kk] = p3[r];
+                    }
+
+                    // the shifted tail of B adds 127 times the tail of A
+                    comp[r] += 127 * (pt[r * 4] + pt[r * 4 + 1] + pt[r * 4 + 2]);
+                }
+            }
+        }
+
+        for (int jb = 0; jb < nj; jb++)
+        {
+            _tile_zero(0);
+            for (int kb = 0; kb < nk; kb++)
+            {
+                const signed char* pa = k_tail && kb == nk - 1 ? ATk : pA + kb * 1024;
+                _tile_loadd(1, pB + (jb * 16 * nk + kb) * 16, nk * 64);
+                _tile_loadd(2, pa, 64);
+                _tile_dpbusd(0, 1, 2);
+            }
+            _tile_stored(0, CT, 64);
+
+            // scatter into the diagonal layout, see the lane shuffles of the 16xn vnni kernels
+            // column groups never cross a block of 16, the groups below 16 all sit in the last block
+            int jj = jb * 16;
+            const int max_jj_block = std::min(jj + 16, max_jj);
+            while (jj < max_jj_block)
+            {
+                const int cols = jj + 15 < max_jj ? 16 : jj + 7 < max_jj ? 8 : jj + 3 < max_jj ? 4 : jj + 1 < max_jj ? 2 : 1;
+
+                const int* pC = CT + (jj - jb * 16) * 16;
+                int* pout = outptr + jj * 16;
+
+                for (int s = 0; s < cols; s++)
+                {
+                    for (int l = 0; l < 16; l++)
+                    {
+                        int row = l;
+                        int col = 0;
+                        if (cols == 16)
+                        {
+                            row = l ^ (s & 2) ^ ((s & 8) >> 1);
+                            col = ((l & ~3) | ((l + (s & 1)) & 3)) ^ ((s & 4) << 1);
+                        }
+                        if (cols == 8)
+                        {
+                            row = l ^ (s & 2);
+                            col = (((l & ~3) | ((l + (s & 1)) & 3)) & 7) ^ (s & 4);
+                        }
+                        if (cols == 4)
+                        {
+                            row = l ^ (s & 2);
+                            col = (l + (s & 1)) & 3;
+                        }
+                        if (cols == 2)
+                        {
+                            col = (l & 1) ^ s;
+                        }
+
+                        const int v = pC[col * 16 + row] - comp[row];
+                        pout[s * 16 + l] = k0 ? v : pout[s * 16 + l] + v;
+                    }
+                }
+
+                jj += cols;
+            }
+        }
+
+        pAT += max_kk * 16;
+        if (max_kk >= 4)
+        {
+            pAT += 64;
+        }
+        outptr += 16 * max_jj;
+    }
+}
+#endif // __AMX_INT8__
+
+// load the amx tile config once per thread before a run of gemm_transB_packed_tile_int8 and release it after
+static void gemm_tile_config_int8()
+{
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_INT8__
+    if (ncnn::cpu_support_x86_amx_int8())
+    {
+        gemm_tile_config_int8_amx();
+        return;
+    }
+#endif
+
+#if __AMX_INT8__
+    amx_tile_config_16x64();
+#endif
+}
+
+static void gemm_tile_release_int8()
+{
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_INT8__
+    if (ncnn::cpu_support_x86_amx_int8())
+    {
+        gemm_tile_release_int8_amx();
+        return;
+    }
+#endif
+
+#if __AMX_INT8__
+    _tile_release();
+#endif
+}
+
 static void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
 {
+#if NCNN_RUNTIME_CPU && NCNN_AMX && __AVX512F__ && !__AMX_INT8__
+    if (ncnn::cpu_support_x86_amx_int8())
+    {
+        gemm_transB_packed_tile_int8_amx(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+        return;
+    }
+#endif
+
 #if NCNN_RUNTIME_CPU && NCNN_AVX512VNNI && __AVX512F__ && !__AVX512VNNI__
     if (ncnn::cpu_support_x86_avx512_vnni())
     {
@@ -12523,6 +12793,16 @@ static void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile,
     int* outptr = topT_tile;
 
     int ii = 0;
+#if __AMX_INT8__
+    if (max_ii >= 16)
+    {
+        gemm_int8_amx_16xn(pAT, pBT, outptr, max_ii, max_jj, max_kk, k == 0);
+
+        ii = max_ii / 16 * 16;
+        pAT += ii * max_kk + (max_kk >= 4 ? ii / 16 * 64 : 0);
+        outptr += ii * max_jj;
+    }
+#endif // __AMX_INT8__
 #if __SSE2__
 #if __AVX2__
 #if __AVX512F__
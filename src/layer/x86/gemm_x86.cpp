@@ -14,23 +14,35 @@
 #endif // __AVX512F__
 #endif // __AVX__
 #endif // __SSE2__
+#include "x86_activation.h"
 #include "x86_usability.h"
 
+#include "benchmark.h"
 #include "cpu.h"
+#include "tileautotune.h"
 
 namespace ncnn {
 
 #if NCNN_INT8
 #include "gemm_int8.h"
 #endif
+#if NCNN_BF16
+#include "gemm_bf16s.h"
+#endif
 
 Gemm_x86::Gemm_x86()
 {
 #if __SSE2__
     support_packing = true;
 #endif // __SSE2__
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
 
     nT = 0;
+    tuned_TILE_M = 0;
+    tuned_TILE_N = 0;
+    tuned_TILE_K = 0;
 }
 
 static void pack_A_tile(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
@@ -6850,6 +6862,8 @@ static int gemm_x86(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -6961,6 +6975,199 @@ static int gemm_x86(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int
     return 0;
 }
 
+static double benchmark_tile_mnk(const Mat& A, const Mat& B, Mat& top_blob, int TILE_M, int TILE_N, int TILE_K, int nT, const Option& opt)
+{
+    double best = 0.0;
+    for (int r = 0; r < 2; r++)
+    {
+        double start = get_current_time();
+
+        gemm_x86(A, B, Mat(), top_blob, 0, 0, 1, 0, TILE_M, TILE_N, TILE_K, nT, opt);
+
+        double time = get_current_time() - start;
+        if (r == 0 || time < best)
+            best = time;
+    }
+
+    return best;
+}
+
+// serialize tuning so that concurrent create_pipeline do not disturb the timings
+static Mutex g_gemm_tile_autotune_lock;
+
+// nonzero while some thread is tuning, forward never waits for it
+static int g_gemm_tile_autotune_busy = 0;
+
+// forward-time shapes tuned in this process, kv cache growth must not grow the database without bound
+static int g_gemm_tile_autotune_forward_count = 0;
+static const int g_gemm_tile_autotune_forward_max = 64;
+
+// line search from the heuristic tiles by halving and doubling one tile at a time, K first
+// M or N of 0 is unknown until forward, it is benchmarked on one heuristic tile and left untuned
+// return false if the benchmark buffers cannot be allocated
+static bool search_tile_mnk(int M, int N, int K, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int* tuned, int nT, const Option& opt)
+{
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, tuned[0], tuned[1], tuned[2], nT);
+
+    Mat A(K, M > 0 ? M : tuned[0], 4u, opt.workspace_allocator);
+    Mat B(K, N > 0 ? N : tuned[1], 4u, opt.workspace_allocator);
+    Mat top_blob(B.h, A.h, 4u, opt.workspace_allocator);
+    if (A.empty() || B.empty() || top_blob.empty())
+        return false;
+
+    A.fill(0.5f);
+    B.fill(0.5f);
+
+    // warmup
+    gemm_x86(A, B, Mat(), top_blob, 0, 0, 1, 0, tuned[0], tuned[1], tuned[2], nT, opt);
+
+    double best = benchmark_tile_mnk(A, B, top_blob, tuned[0], tuned[1], tuned[2], nT, opt);
+
+    const int sizes[3] = {A.h, B.h, K};
+    const int constants[3] = {constant_TILE_M, constant_TILE_N, constant_TILE_K};
+    const int order[3] = {2, 0, 1};
+
+    for (int q = 0; q < 3; q++)
+    {
+        const int d = order[q];
+        if (constants[d] > 0 || (d == 0 && M == 0) || (d == 1 && N == 0))
+            continue;
+
+        for (int grow = 0; grow < 2; grow++)
+        {
+            while (1)
+            {
+                int candidate[3] = {tuned[0], tuned[1], tuned[2]};
+                if (grow)
+                {
+                    if (candidate[d] >= sizes[d])
+                        break;
+
+                    candidate[d] = std::min(candidate[d] * 2, sizes[d]);
+                }
+                else
+                {
+                    if (candidate[d] < 2)
+                        break;
+
+                    candidate[d] = candidate[d] / 2;
+                }
+
+                // round to the kernel tile multiple
+                get_optimal_tile_mnk(M, N, K, candidate[0], candidate[1], candidate[2], candidate[0], candidate[1], candidate[2], nT);
+                if (candidate[d] == tuned[d])
+                    break;
+
+                double time = benchmark_tile_mnk(A, B, top_blob, candidate[0], candidate[1], candidate[2], nT, opt);
+
+                // ignore improvements within timing noise
+                if (time >= best * 0.97)
+                    break;
+
+                best = time;
+                tuned[d] = candidate[d];
+            }
+        }
+    }
+
+    return true;
+}
+
+// tiles of constant weights, tuned once in create_pipeline and meant to be passed as constant_TILE_M/N/K
+static void get_autotune_tile_mnk(int M, int N, int K, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int& TILE_M, int& TILE_N, int& TILE_K, int nT, const Option& opt)
+{
+    int tuned[3];
+    if (get_tile_autotune("gemm_x86", M, N, K, nT, tuned[0], tuned[1], tuned[2]) != 0)
+    {
+        MutexLockGuard lock(g_gemm_tile_autotune_lock);
+
+        // another thread may have tuned it meanwhile
+        if (get_tile_autotune("gemm_x86", M, N, K, nT, tuned[0], tuned[1], tuned[2]) != 0)
+        {
+            NCNN_XADD(&g_gemm_tile_autotune_busy, 1);
+            const bool searched = search_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, tuned, nT, opt);
+            NCNN_XADD(&g_gemm_tile_autotune_busy, -1);
+
+            if (!searched)
+            {
+                TILE_M = constant_TILE_M;
+                TILE_N = constant_TILE_N;
+                TILE_K = constant_TILE_K;
+                return;
+            }
+
+            set_tile_autotune("gemm_x86", M, N, K, nT, tuned[0], tuned[1], tuned[2]);
+        }
+    }
+
+    TILE_M = M > 0 ? tuned[0] : constant_TILE_M;
+    TILE_N = N > 0 ? tuned[1] : constant_TILE_N;
+    TILE_K = tuned[2];
+}
+
+static int get_autotune_bucket(int size)
+{
+    int bucket = 1;
+    while (bucket < size)
+        bucket *= 2;
+    return bucket;
+}
+
+// tiles of a shape known only at forward, shared by all shapes rounding up to the same power of two
+// the heuristic tiles are used while another thread is tuning or once the forward budget is spent
+static void get_autotune_tile_mnk_dynamic(int M, int N, int K, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int& TILE_M, int& TILE_N, int& TILE_K, int nT, const Option& opt)
+{
+    TILE_M = constant_TILE_M;
+    TILE_N = constant_TILE_N;
+    TILE_K = constant_TILE_K;
+
+    const int bucket_M = get_autotune_bucket(M);
+    const int bucket_N = get_autotune_bucket(N);
+    const int bucket_K = get_autotune_bucket(K);
+
+    int tuned[3];
+    if (get_tile_autotune("gemm_x86_dynamic", bucket_M, bucket_N, bucket_K, nT, tuned[0], tuned[1], tuned[2]) != 0)
+    {
+        if (g_gemm_tile_autotune_forward_count >= g_gemm_tile_autotune_forward_max)
+            return;
+
+        if (NCNN_XADD(&g_gemm_tile_autotune_busy, 1) != 0)
+        {
+            NCNN_XADD(&g_gemm_tile_autotune_busy, -1);
+            return;
+        }
+
+        bool searched = false;
+        {
+            MutexLockGuard lock(g_gemm_tile_autotune_lock);
+
+            if (get_tile_autotune("gemm_x86_dynamic", bucket_M, bucket_N, bucket_K, nT, tuned[0], tuned[1], tuned[2]) == 0)
+            {
+                searched = true;
+            }
+            else if (search_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, tuned, nT, opt))
+            {
+                set_tile_autotune("gemm_x86_dynamic", bucket_M, bucket_N, bucket_K, nT, tuned[0], tuned[1], tuned[2]);
+                NCNN_XADD(&g_gemm_tile_autotune_forward_count, 1);
+                searched = true;
+            }
+        }
+
+        NCNN_XADD(&g_gemm_tile_autotune_busy, -1);
+
+        if (!searched)
+            return;
+    }
+
+    // tiles of a larger shape in the bucket are clamped to this one
+    int heuristic[3];
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, heuristic[0], heuristic[1], heuristic[2], nT);
+
+    TILE_M = tuned[0] >= M ? heuristic[0] : tuned[0];
+    TILE_N = tuned[1] >= N ? heuristic[1] : tuned[1];
+    TILE_K = tuned[2] >= K ? heuristic[2] : tuned[2];
+}
+
 static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int K, int transB, int output_transpose, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
     const int N = transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w;
@@ -6970,6 +7177,8 @@ static int gemm_AT_x86(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob,
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -7071,6 +7280,8 @@ static int gemm_BT_x86(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob,
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -7158,6 +7369,8 @@ static int gemm_AT_BT_x86(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_b
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -7223,17 +7436,38 @@ int Gemm_x86::create_pipeline(const Option& opt)
 #if NCNN_INT8
     if (int8_scale_term)
     {
+#if NCNN_BF16
+        // the int8 path reads fp32 input
+        support_bf16_storage = false;
+#endif
         return create_pipeline_int8(opt);
     }
 #endif
 
+#if NCNN_BF16
+    if (opt.use_bf16_storage)
+    {
+        return create_pipeline_bf16s(opt);
+    }
+#endif
+
+    tuned_TILE_M = constant_TILE_M;
+    tuned_TILE_N = constant_TILE_N;
+    tuned_TILE_K = constant_TILE_K;
+
+    if (opt.use_tile_autotune && (constantA || constantB))
+    {
+        // shared by the A and B packing, the unknown M or N keeps the heuristic in forward
+        get_autotune_tile_mnk(constantA ? constantM : 0, constantB ? constantN : 0, constantK, constant_TILE_M, constant_TILE_N, constant_TILE_K, tuned_TILE_M, tuned_TILE_N, tuned_TILE_K, opt.num_threads, opt);
+    }
+
     if (constantA)
     {
         const int M = constantM;
         const int K = constantK;
 
         int TILE_M, TILE_N, TILE_K;
-        get_optimal_tile_mnk(M, 0, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+        get_optimal_tile_mnk(M, 0, K, tuned_TILE_M, tuned_TILE_N, tuned_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
 
         const int nn_M = (M + TILE_M - 1) / TILE_M;
 
@@ -7274,7 +7508,7 @@ int Gemm_x86::create_pipeline(const Option& opt)
         const int K = constantK;
 
         int TILE_M, TILE_N, TILE_K;
-        get_optimal_tile_mnk(0, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+        get_optimal_tile_mnk(0, N, K, tuned_TILE_M, tuned_TILE_N, tuned_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
 
         const int nn_N = (N + TILE_N - 1) / TILE_N;
         const int nn_K = (K + TILE_K - 1) / TILE_K;
@@ -7358,6 +7592,66 @@ int Gemm_x86::create_pipeline(const Option& opt)
     return 0;
 }
 
+int Gemm_x86::save_pipeline_weights(std::vector<Mat>& weights) const
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+        return -1;
+#endif
+
+    // the packed A/B layout depends on the tiles picked in create_pipeline
+    Mat tiles(3, 4u, (Allocator*)0);
+    int* ptiles = tiles;
+    ptiles[0] = tuned_TILE_M;
+    ptiles[1] = tuned_TILE_N;
+    ptiles[2] = tuned_TILE_K;
+
+    weights.resize(4);
+    weights[0] = AT_data;
+    weights[1] = BT_data;
+    weights[2] = CT_data;
+    weights[3] = tiles;
+
+    return 0;
+}
+
+int Gemm_x86::load_pipeline_weights(const std::vector<Mat>& weights, const Option& opt)
+{
+#if NCNN_INT8
+    if (int8_scale_term)
+        return -1;
+#endif
+
+    if (weights.size() != 4 || weights[3].w != 3)
+        return -1;
+
+    AT_data = weights[0];
+    BT_data = weights[1];
+    CT_data = weights[2];
+
+    const int* ptiles = weights[3];
+    tuned_TILE_M = ptiles[0];
+    tuned_TILE_N = ptiles[1];
+    tuned_TILE_K = ptiles[2];
+
+    if (opt.lightmode)
+    {
+        if (constantA)
+            A_data.release();
+        if (constantB)
+            B_data.release();
+        if (constantC && constant_broadcast_type_C != -1)
+            C_data.release();
+    }
+
+    if (constantA || constantB || constantC)
+    {
+        nT = opt.num_threads;
+    }
+
+    return 0;
+}
+
 int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
 {
 #if NCNN_INT8
@@ -7368,6 +7662,13 @@ int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     }
 #endif
 
+#if NCNN_BF16
+    if (opt.use_bf16_storage)
+    {
+        return forward_bf16s(bottom_blobs, top_blobs, opt);
+    }
+#endif
+
     int M;
     int N;
     if (constantA && constantB)
@@ -7509,7 +7810,7 @@ int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads > nT)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -7519,23 +7820,34 @@ int Gemm_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& to
     int ret = 0;
     if (constantA && constantB)
     {
-        ret = gemm_AT_BT_x86(AT_data, BT_data, C, top_blob, broadcast_type_C, constantM, constantN, constantK, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_AT_BT_x86(AT_data, BT_data, C, top_blob, broadcast_type_C, constantM, constantN, constantK, output_transpose, tuned_TILE_M, tuned_TILE_N, tuned_TILE_K, _nT, opt);
     }
     else if (constantA)
     {
         const Mat& B = bottom_blobs[0];
-        ret = gemm_AT_x86(AT_data, B, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_AT_x86(AT_data, B, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, tuned_TILE_M, tuned_TILE_N, tuned_TILE_K, _nT, opt);
     }
     else if (constantB)
     {
         const Mat& A = bottom_blobs[0];
-        ret = gemm_BT_x86(A, BT_data, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+        ret = gemm_BT_x86(A, BT_data, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, tuned_TILE_M, tuned_TILE_N, tuned_TILE_K, _nT, opt);
     }
     else
     {
         const Mat& A = bottom_blobs[0];
         const Mat& B = bottom_blobs[1];
-        ret = gemm_x86(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+
+        int TILE_M = constant_TILE_M;
+        int TILE_N = constant_TILE_N;
+        int TILE_K = constant_TILE_K;
+        if (opt.use_tile_autotune)
+        {
+            // tuned on the first forward of each shape bucket
+            const int K = transA ? (A.dims == 3 ? A.c : A.h) * A.elempack : A.w;
+            get_autotune_tile_mnk_dynamic(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, _nT, opt);
+        }
+
+        ret = gemm_x86(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, TILE_M, TILE_N, TILE_K, _nT, opt);
     }
     if (ret != 0)
         return ret;
@@ -7621,6 +7933,8 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk_int8(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -7650,7 +7964,7 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
     }
     if (ATX.empty())
         return -100;
-    Mat BT(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
+    Mat BT(TILE_K * TILE_N + get_B_tile_amx_size_int8(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
     if (BT.empty())
         return -100;
 
@@ -7690,6 +8004,8 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
             pack_B_tile_quantize(B, BT_tile, j, max_jj, k, max_kk, B_int8_scale);
         else
             transpose_pack_B_tile_quantize(B, BT_tile, j, max_jj, k, max_kk, B_int8_scale);
+
+        pack_B_tile_int8_amx(BT_tile, max_jj, max_kk);
     }
 
     Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
@@ -7722,6 +8038,8 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
 
         Mat topT_tile = topT.channel(get_omp_thread_num());
 
+        gemm_tile_config_int8();
+
         for (int j = 0; j < N; j += TILE_N)
         {
             const int max_jj = std::min((N - j), TILE_N);
@@ -7759,6 +8077,8 @@ static int gemm_x86_int8(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob
 
             unpack_output_tile_dequantize(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, output_descales, alpha, beta, output_transpose);
         }
+
+        gemm_tile_release_int8();
     }
 
     return 0;
@@ -7775,13 +8095,15 @@ static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat&
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk_int8(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
     int nn_N = (N + TILE_N - 1) / TILE_N;
     int nn_K = (K + TILE_K - 1) / TILE_K;
 
-    Mat BT(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
+    Mat BT(TILE_K * TILE_N + get_B_tile_amx_size_int8(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
     if (BT.empty())
         return -100;
 
@@ -7822,6 +8144,8 @@ static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat&
             pack_B_tile_quantize(B, BT_tile, j, max_jj, k, max_kk, B_int8_scale);
         else
             transpose_pack_B_tile_quantize(B, BT_tile, j, max_jj, k, max_kk, B_int8_scale);
+
+        pack_B_tile_int8_amx(BT_tile, max_jj, max_kk);
     }
 
     Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
@@ -7849,6 +8173,8 @@ static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat&
 
         Mat topT_tile = topT.channel(get_omp_thread_num());
 
+        gemm_tile_config_int8();
+
         for (int j = 0; j < N; j += TILE_N)
         {
             const int max_jj = std::min((N - j), TILE_N);
@@ -7868,6 +8194,8 @@ static int gemm_AT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Mat&
 
             unpack_output_tile_dequantize(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, output_descales, alpha, beta, output_transpose);
         }
+
+        gemm_tile_release_int8();
     }
 
     return 0;
@@ -7884,6 +8212,8 @@ static int gemm_BT_x86_int8(const Mat& A, const Mat& BT, float B_int8_scale, con
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk_int8(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -7955,6 +8285,8 @@ static int gemm_BT_x86_int8(const Mat& A, const Mat& BT, float B_int8_scale, con
 
         Mat topT_tile = topT.channel(get_omp_thread_num());
 
+        gemm_tile_config_int8();
+
         for (int j = 0; j < N; j += TILE_N)
         {
             const int max_jj = std::min((N - j), TILE_N);
@@ -7992,6 +8324,8 @@ static int gemm_BT_x86_int8(const Mat& A, const Mat& BT, float B_int8_scale, con
 
             unpack_output_tile_dequantize(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, output_descales, alpha, beta, output_transpose);
         }
+
+        gemm_tile_release_int8();
     }
 
     return 0;
@@ -8006,6 +8340,8 @@ static int gemm_AT_BT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Ma
     int TILE_M, TILE_N, TILE_K;
     get_optimal_tile_mnk_int8(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
 
+    nT = std::min(nT, opt.num_threads);
+
     // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
 
     int nn_M = (M + TILE_M - 1) / TILE_M;
@@ -8046,6 +8382,8 @@ static int gemm_AT_BT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Ma
 
         Mat topT_tile = topT.channel(get_omp_thread_num());
 
+        gemm_tile_config_int8();
+
         for (int j = 0; j < N; j += TILE_N)
         {
             const int max_jj = std::min((N - j), TILE_N);
@@ -8065,6 +8403,8 @@ static int gemm_AT_BT_x86_int8(const Mat& AT, const Mat& A_int8_scales, const Ma
 
             unpack_output_tile_dequantize(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, output_descales, alpha, beta, output_transpose);
         }
+
+        gemm_tile_release_int8();
     }
 
     return 0;
@@ -8142,7 +8482,7 @@ int Gemm_x86::create_pipeline_int8(const Option& opt)
 
         const int nn_N = (N + TILE_N - 1) / TILE_N;
 
-        BT_data.create(TILE_K * TILE_N, (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, (Allocator*)0);
+        BT_data.create(TILE_K * TILE_N + get_B_tile_amx_size_int8(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, (Allocator*)0);
         if (BT_data.empty())
             return -100;
 
@@ -8166,6 +8506,8 @@ int Gemm_x86::create_pipeline_int8(const Option& opt)
                 {
                     transpose_pack_B_tile_int8(B_data, BT_tile, j, max_jj, k, max_kk);
                 }
+
+                pack_B_tile_int8_amx(BT_tile, max_jj, max_kk);
             }
         }
 
@@ -8326,7 +8668,7 @@ int Gemm_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
         return -100;
 
     int _nT = nT ? nT : opt.num_threads;
-    if (nT != 0 && opt.num_threads != nT)
+    if (nT != 0 && opt.num_threads > nT)
     {
         // force num_threads the same as in create_pipeline
         // so we could use pre-packed A/B from the same tile config
@@ -8359,16 +8701,764 @@ int Gemm_x86::forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat
 }
 #endif
 
-namespace Gemm_x86_utility {
-#if NCNN_INT8
-void pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+#if NCNN_BF16
+struct gemm_x86_bf16s_omp_args
 {
-    ncnn::pack_A_tile_int8(A, AT, i, max_ii, k, max_kk);
-}
+    int TILE_M;
+    int TILE_N;
+    int TILE_K;
+    int broadcast_type_C;
+    int transA;
+    int output_transpose;
+    float alpha;
+};
 
-void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+static int gemm_x86_bf16s(const Mat& A, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int transA, int transB, int output_transpose, float alpha, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
 {
-    ncnn::gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+    // NCNN_LOGE("gemm_x86_bf16s");
+
+    const int M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+    const int K = transA ? (A.dims == 3 ? A.c : A.h) * A.elempack : A.w;
+    const int N = transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w;
+
+    // NCNN_LOGE("M/N/K = %d %d %d", M, N, K);
+
+    int TILE_M, TILE_N, TILE_K;
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
+
+    nT = std::min(nT, opt.num_threads);
+
+    // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
+
+    int nn_M = (M + TILE_M - 1) / TILE_M;
+    int nn_N = (N + TILE_N - 1) / TILE_N;
+    int nn_K = (K + TILE_K - 1) / TILE_K;
+
+    Mat ATX(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, nT, 2u, opt.workspace_allocator);
+    if (ATX.empty())
+        return -100;
+    Mat BT(TILE_K * TILE_N + get_B_tile_amx_size_bf16s(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 2u, opt.workspace_allocator);
+    if (BT.empty())
+        return -100;
+
+    const int nn_NK = nn_N * nn_K;
+
+    // pack B
+    #pragma omp parallel for num_threads(nT)
+    for (int ppjk = 0; ppjk < nn_NK; ppjk++)
+    {
+        const int ppj = ppjk / nn_K;
+        const int ppk = ppjk % nn_K;
+
+        const int j = ppj * TILE_N;
+        const int k = ppk * TILE_K;
+
+        const int max_jj = std::min((N - j), TILE_N);
+        const int max_kk = std::min((K - k), TILE_K);
+
+        Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+        if (transB)
+            pack_B_tile_bf16(B, BT_tile, j, max_jj, k, max_kk);
+        else
+            transpose_pack_B_tile_bf16(B, BT_tile, j, max_jj, k, max_kk);
+
+        pack_B_tile_bf16s_amx(BT_tile, max_jj, max_kk);
+    }
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    const struct gemm_x86_bf16s_omp_args args = {TILE_M, TILE_N, TILE_K, broadcast_type_C, transA, output_transpose, alpha};
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppi = 0; ppi < nn_M; ppi++)
+    {
+        // shadowed variable for less openmp task args
+        const int TILE_M = args.TILE_M;
+        const int TILE_N = args.TILE_N;
+        const int TILE_K = args.TILE_K;
+        const int broadcast_type_C = args.broadcast_type_C;
+        const int transA = args.transA;
+        const int output_transpose = args.output_transpose;
+        const float alpha = args.alpha;
+
+        const int M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+        const int K = transA ? (A.dims == 3 ? A.c : A.h) * A.elempack : A.w;
+
+        const int i = ppi * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        gemm_tile_config_bf16s();
+
+        for (int j = 0; j < N; j += TILE_N)
+        {
+            const int max_jj = std::min((N - j), TILE_N);
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_kk = std::min((K - k), TILE_K);
+
+                // NCNN_LOGE("max_ii/jj/kk = %d %d %d", max_ii, max_jj, max_kk);
+
+                Mat AT_tile = ATX.channel(get_omp_thread_num()).row_range(k / TILE_K, 1);
+
+                Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                if (j == 0)
+                {
+                    if (transA)
+                        transpose_pack_A_tile_bf16(A, AT_tile, i, max_ii, k, max_kk);
+                    else
+                        pack_A_tile_bf16(A, AT_tile, i, max_ii, k, max_kk);
+                }
+
+                gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+            }
+
+            unpack_output_tile_fp32_to_bf16(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, alpha, output_transpose, 0, Mat());
+        }
+
+        gemm_tile_release_bf16s();
+    }
+
+    return 0;
+}
+
+static int gemm_AT_x86_bf16s(const Mat& AT, const Mat& B, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int K, int transB, int output_transpose, float alpha, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+{
+    // NCNN_LOGE("gemm_AT_x86_bf16s");
+
+    const int N = transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w;
+
+    // NCNN_LOGE("M/N/K = %d %d %d", M, N, K);
+
+    int TILE_M, TILE_N, TILE_K;
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
+
+    nT = std::min(nT, opt.num_threads);
+
+    // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
+
+    int nn_M = (M + TILE_M - 1) / TILE_M;
+    int nn_N = (N + TILE_N - 1) / TILE_N;
+    int nn_K = (K + TILE_K - 1) / TILE_K;
+
+    Mat BT(TILE_K * TILE_N + get_B_tile_amx_size_bf16s(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 2u, opt.workspace_allocator);
+    if (BT.empty())
+        return -100;
+
+    const int nn_NK = nn_N * nn_K;
+
+    // pack B
+    #pragma omp parallel for num_threads(nT)
+    for (int ppjk = 0; ppjk < nn_NK; ppjk++)
+    {
+        const int ppj = ppjk / nn_K;
+        const int ppk = ppjk % nn_K;
+
+        const int j = ppj * TILE_N;
+        const int k = ppk * TILE_K;
+
+        const int max_jj = std::min((N - j), TILE_N);
+        const int max_kk = std::min((K - k), TILE_K);
+
+        Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+        if (transB)
+            pack_B_tile_bf16(B, BT_tile, j, max_jj, k, max_kk);
+        else
+            transpose_pack_B_tile_bf16(B, BT_tile, j, max_jj, k, max_kk);
+
+        pack_B_tile_bf16s_amx(BT_tile, max_jj, max_kk);
+    }
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    const struct gemm_x86_bf16s_omp_args args = {TILE_M, TILE_N, TILE_K, broadcast_type_C, 0, output_transpose, alpha};
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppi = 0; ppi < nn_M; ppi++)
+    {
+        // shadowed variable for less openmp task args
+        const int TILE_M = args.TILE_M;
+        const int TILE_N = args.TILE_N;
+        const int TILE_K = args.TILE_K;
+        const int broadcast_type_C = args.broadcast_type_C;
+        const int output_transpose = args.output_transpose;
+        const float alpha = args.alpha;
+
+        const int i = ppi * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        gemm_tile_config_bf16s();
+
+        for (int j = 0; j < N; j += TILE_N)
+        {
+            const int max_jj = std::min((N - j), TILE_N);
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_kk = std::min((K - k), TILE_K);
+
+                // NCNN_LOGE("max_ii/jj/kk = %d %d %d", max_ii, max_jj, max_kk);
+
+                Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+                Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+            }
+
+            unpack_output_tile_fp32_to_bf16(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, alpha, output_transpose, 0, Mat());
+        }
+
+        gemm_tile_release_bf16s();
+    }
+
+    return 0;
+}
+
+static int gemm_BT_x86_bf16s(const Mat& A, const Mat& BT, const Mat& C, Mat& top_blob, int broadcast_type_C, int N, int K, int transA, int output_transpose, float alpha, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+{
+    // NCNN_LOGE("gemm_BT_x86_bf16s");
+
+    const int M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+
+    // NCNN_LOGE("M/N/K = %d %d %d", M, N, K);
+
+    int TILE_M, TILE_N, TILE_K;
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
+
+    nT = std::min(nT, opt.num_threads);
+
+    // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
+
+    int nn_M = (M + TILE_M - 1) / TILE_M;
+
+    Mat ATX(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, nT, 2u, opt.workspace_allocator);
+    if (ATX.empty())
+        return -100;
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    const struct gemm_x86_bf16s_omp_args args = {TILE_M, TILE_N, TILE_K, broadcast_type_C, transA, output_transpose, alpha};
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppi = 0; ppi < nn_M; ppi++)
+    {
+        // shadowed variable for less openmp task args
+        const int TILE_M = args.TILE_M;
+        const int TILE_N = args.TILE_N;
+        const int TILE_K = args.TILE_K;
+        const int broadcast_type_C = args.broadcast_type_C;
+        const int transA = args.transA;
+        const int output_transpose = args.output_transpose;
+        const float alpha = args.alpha;
+
+        const int M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+
+        const int i = ppi * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        gemm_tile_config_bf16s();
+
+        for (int j = 0; j < N; j += TILE_N)
+        {
+            const int max_jj = std::min((N - j), TILE_N);
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_kk = std::min((K - k), TILE_K);
+
+                // NCNN_LOGE("max_ii/jj/kk = %d %d %d", max_ii, max_jj, max_kk);
+
+                Mat AT_tile = ATX.channel(get_omp_thread_num()).row_range(k / TILE_K, 1);
+
+                Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                if (j == 0)
+                {
+                    if (transA)
+                        transpose_pack_A_tile_bf16(A, AT_tile, i, max_ii, k, max_kk);
+                    else
+                        pack_A_tile_bf16(A, AT_tile, i, max_ii, k, max_kk);
+                }
+
+                gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+            }
+
+            unpack_output_tile_fp32_to_bf16(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, alpha, output_transpose, 0, Mat());
+        }
+
+        gemm_tile_release_bf16s();
+    }
+
+    return 0;
+}
+
+static int gemm_AT_BT_x86_bf16s(const Mat& AT, const Mat& BT, const Mat& C, Mat& top_blob, int broadcast_type_C, int M, int N, int K, int output_transpose, float alpha, int constant_TILE_M, int constant_TILE_N, int constant_TILE_K, int nT, const Option& opt)
+{
+    // NCNN_LOGE("gemm_AT_BT_x86_bf16s");
+
+    // NCNN_LOGE("M/N/K = %d %d %d", M, N, K);
+
+    int TILE_M, TILE_N, TILE_K;
+    get_optimal_tile_mnk(M, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, nT);
+
+    nT = std::min(nT, opt.num_threads);
+
+    // NCNN_LOGE("TILE M/N/K = %d %d %d", TILE_M, TILE_N, TILE_K);
+
+    int nn_M = (M + TILE_M - 1) / TILE_M;
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppi = 0; ppi < nn_M; ppi++)
+    {
+        const int i = ppi * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        gemm_tile_config_bf16s();
+
+        for (int j = 0; j < N; j += TILE_N)
+        {
+            const int max_jj = std::min((N - j), TILE_N);
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_kk = std::min((K - k), TILE_K);
+
+                // NCNN_LOGE("max_ii/jj/kk = %d %d %d", max_ii, max_jj, max_kk);
+
+                Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+                Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+            }
+
+            unpack_output_tile_fp32_to_bf16(topT_tile, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, alpha, output_transpose, 0, Mat());
+        }
+
+        gemm_tile_release_bf16s();
+    }
+
+    return 0;
+}
+
+int Gemm_x86::create_pipeline_bf16s(const Option& opt)
+{
+    if (constantA)
+    {
+        const int M = constantM;
+        const int K = constantK;
+
+        int TILE_M, TILE_N, TILE_K;
+        get_optimal_tile_mnk(M, 0, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+
+        const int nn_M = (M + TILE_M - 1) / TILE_M;
+
+        AT_data.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, (M + TILE_M - 1) / TILE_M, 2u, (Allocator*)0);
+        if (AT_data.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ppj = 0; ppj < nn_M; ppj++)
+        {
+            const int i = ppj * TILE_M;
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_ii = std::min((M - i), TILE_M);
+                const int max_kk = std::min((K - k), TILE_K);
+
+                Mat AT_tile = AT_data.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+                if (transA)
+                {
+                    transpose_pack_A_tile_fp32_to_bf16(A_data, AT_tile, i, max_ii, k, max_kk);
+                }
+                else
+                {
+                    pack_A_tile_fp32_to_bf16(A_data, AT_tile, i, max_ii, k, max_kk);
+                }
+            }
+        }
+
+        if (opt.lightmode)
+            A_data.release();
+    }
+
+    if (constantB)
+    {
+        const int N = constantN;
+        const int K = constantK;
+
+        int TILE_M, TILE_N, TILE_K;
+        get_optimal_tile_mnk(0, N, K, constant_TILE_M, constant_TILE_N, constant_TILE_K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+
+        const int nn_N = (N + TILE_N - 1) / TILE_N;
+
+        BT_data.create(TILE_K * TILE_N + get_B_tile_amx_size_bf16s(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 2u, (Allocator*)0);
+        if (BT_data.empty())
+            return -100;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int ppj = 0; ppj < nn_N; ppj++)
+        {
+            const int j = ppj * TILE_N;
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_jj = std::min((N - j), TILE_N);
+                const int max_kk = std::min((K - k), TILE_K);
+
+                Mat BT_tile = BT_data.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                if (transB)
+                {
+                    pack_B_tile_fp32_to_bf16(B_data, BT_tile, j, max_jj, k, max_kk);
+                }
+                else
+                {
+                    transpose_pack_B_tile_fp32_to_bf16(B_data, BT_tile, j, max_jj, k, max_kk);
+                }
+
+                pack_B_tile_bf16s_amx(BT_tile, max_jj, max_kk);
+            }
+        }
+
+        if (opt.lightmode)
+            B_data.release();
+    }
+
+    if (constantC && constant_broadcast_type_C != -1)
+    {
+        // C stays fp32 and unpacked, it is added in the output unpack step
+        CT_data = C_data;
+
+        // pre-multiply C with beta
+        if (beta != 1.f)
+        {
+            Mat C2;
+            C2.create_like(CT_data);
+
+            const int size = CT_data.total() * CT_data.elempack;
+            for (int i = 0; i < size; i++)
+            {
+                C2[i] = CT_data[i] * beta;
+            }
+
+            CT_data = C2;
+        }
+
+        if (opt.lightmode)
+            C_data.release();
+    }
+
+    if (constantA || constantB || constantC)
+    {
+        nT = opt.num_threads;
+    }
+
+    return 0;
+}
+
+int Gemm_x86::forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    int M;
+    int N;
+    if (constantA && constantB)
+    {
+        M = constantM;
+        N = constantN;
+    }
+    else if (constantA)
+    {
+        const Mat& B = bottom_blobs[0];
+        M = constantM;
+        N = transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w;
+    }
+    else if (constantB)
+    {
+        const Mat& A = bottom_blobs[0];
+        M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+        N = constantN;
+    }
+    else
+    {
+        const Mat& A = bottom_blobs[0];
+        const Mat& B = bottom_blobs[1];
+        M = transA ? A.w : (A.dims == 3 ? A.c : A.h) * A.elempack;
+        N = transB ? (B.dims == 3 ? B.c : B.h) * B.elempack : B.w;
+    }
+
+    Mat C;
+    int broadcast_type_C = 0;
+    if (constantC)
+    {
+        C = CT_data;
+        broadcast_type_C = constant_broadcast_type_C;
+    }
+    else
+    {
+        if (constantA && constantB)
+        {
+            C = bottom_blobs.size() == 1 ? bottom_blobs[0] : Mat();
+        }
+        else if (constantA)
+        {
+            C = bottom_blobs.size() == 2 ? bottom_blobs[1] : Mat();
+        }
+        else if (constantB)
+        {
+            C = bottom_blobs.size() == 2 ? bottom_blobs[1] : Mat();
+        }
+        else
+        {
+            C = bottom_blobs.size() == 3 ? bottom_blobs[2] : Mat();
+        }
+
+        if (!C.empty())
+        {
+            if (C.dims == 1 && C.w == 1)
+            {
+                // scalar
+                broadcast_type_C = 0;
+            }
+            if (C.dims == 1 && C.w * C.elempack == M)
+            {
+                // M
+                // auto broadcast from h to w is the ncnn-style convention
+                broadcast_type_C = 1;
+            }
+            if (C.dims == 1 && C.w * C.elempack == N)
+            {
+                // N
+                broadcast_type_C = 4;
+            }
+            if (C.dims == 2 && C.w == 1 && C.h * C.elempack == M)
+            {
+                // Mx1
+                broadcast_type_C = 2;
+            }
+            if (C.dims == 2 && C.w == N && C.h * C.elempack == M)
+            {
+                // MxN
+                broadcast_type_C = 3;
+            }
+            if (C.dims == 2 && C.w == N && C.h * C.elempack == 1)
+            {
+                // 1xN
+                broadcast_type_C = 4;
+            }
+
+            // cast to fp32
+            if (C.elembits() == 16)
+            {
+                Mat C_fp32;
+                cast_bfloat16_to_float32(C, C_fp32, opt);
+                if (C_fp32.empty())
+                    return -100;
+
+                C = C_fp32;
+            }
+
+            // the output unpack step reads C unpacked
+            if (C.elempack != 1)
+            {
+                Mat C_unpacked;
+                convert_packing(C, C_unpacked, 1, opt);
+                if (C_unpacked.empty())
+                    return -100;
+
+                C = C_unpacked;
+            }
+
+            // pre-multiply C with beta
+            if (beta != 1.f)
+            {
+                Mat C2;
+                C2.create_like(C, opt.workspace_allocator);
+
+                const int size = C.total() * C.elempack;
+                for (int i = 0; i < size; i++)
+                {
+                    C2[i] = C[i] * beta;
+                }
+
+                C = C2;
+            }
+        }
+    }
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+        int outh = output_transpose ? N : M;
+        out_elempack = outh % 4 == 0 ? 4 : 1;
+    }
+#endif // __SSE2__
+    if (output_elempack)
+        out_elempack = output_elempack;
+    size_t out_elemsize = 2u * out_elempack;
+
+    Mat& top_blob = top_blobs[0];
+    if (output_transpose)
+    {
+        if (output_N1M)
+            top_blob.create(M, 1, N / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+        else
+            top_blob.create(M, N / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    else
+    {
+        if (output_N1M)
+            top_blob.create(N, 1, M / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+        else
+            top_blob.create(N, M / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    }
+    if (top_blob.empty())
+        return -100;
+
+    int _nT = nT ? nT : opt.num_threads;
+    if (nT != 0 && opt.num_threads > nT)
+    {
+        // force num_threads the same as in create_pipeline
+        // so we could use pre-packed A/B from the same tile config
+        NCNN_LOGE("opt.num_threads %d changed, gemm will use load-time value %d", opt.num_threads, nT);
+    }
+
+    int ret = 0;
+    if (constantA && constantB)
+    {
+        ret = gemm_AT_BT_x86_bf16s(AT_data, BT_data, C, top_blob, broadcast_type_C, constantM, constantN, constantK, output_transpose, alpha, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+    }
+    else if (constantA)
+    {
+        const Mat& B = bottom_blobs[0];
+        ret = gemm_AT_x86_bf16s(AT_data, B, C, top_blob, broadcast_type_C, constantM, constantK, transB, output_transpose, alpha, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+    }
+    else if (constantB)
+    {
+        const Mat& A = bottom_blobs[0];
+        ret = gemm_BT_x86_bf16s(A, BT_data, C, top_blob, broadcast_type_C, constantN, constantK, transA, output_transpose, alpha, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+    }
+    else
+    {
+        const Mat& A = bottom_blobs[0];
+        const Mat& B = bottom_blobs[1];
+        ret = gemm_x86_bf16s(A, B, C, top_blob, broadcast_type_C, transA, transB, output_transpose, alpha, constant_TILE_M, constant_TILE_N, constant_TILE_K, _nT, opt);
+    }
+
+    return ret;
+}
+#endif // NCNN_BF16
+
+namespace Gemm_x86_utility {
+#if NCNN_INT8
+void get_optimal_tile_mnk_int8(int M, int N, int K, int& TILE_M, int& TILE_N, int& TILE_K, int nT)
+{
+    ncnn::get_optimal_tile_mnk_int8(M, N, K, 0, 0, 0, TILE_M, TILE_N, TILE_K, nT);
+}
+
+void pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    ncnn::pack_A_tile_int8(A, AT, i, max_ii, k, max_kk);
+}
+
+void pack_B_tile_int8(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk)
+{
+    ncnn::pack_B_tile_int8(B, BT, j, max_jj, k, max_kk);
+}
+
+int get_B_tile_amx_size_int8(int TILE_N, int TILE_K)
+{
+    return ncnn::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+}
+
+void pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk)
+{
+    ncnn::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+}
+
+void gemm_tile_config_int8()
+{
+    ncnn::gemm_tile_config_int8();
+}
+
+void gemm_tile_release_int8()
+{
+    ncnn::gemm_tile_release_int8();
+}
+
+void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+    ncnn::gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+}
+
+void unpack_output_tile_int32_to_fp32(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, const Mat& descales, float alpha, float beta, int output_transpose)
+{
+    ncnn::unpack_output_tile_int32_to_fp32(topT, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, descales, alpha, beta, output_transpose);
+}
+#endif
+
+#if NCNN_BF16
+void pack_A_tile_fp32_to_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+    ncnn::pack_A_tile_fp32_to_bf16(A, AT, i, max_ii, k, max_kk);
+}
+
+int get_B_tile_amx_size_bf16s(int TILE_N, int TILE_K)
+{
+    return ncnn::get_B_tile_amx_size_bf16s(TILE_N, TILE_K);
+}
+
+void pack_B_tile_bf16s_amx(Mat& BT, int max_jj, int max_kk)
+{
+    ncnn::pack_B_tile_bf16s_amx(BT, max_jj, max_kk);
+}
+
+void gemm_tile_config_bf16s()
+{
+    ncnn::gemm_tile_config_bf16s();
+}
+
+void gemm_tile_release_bf16s()
+{
+    ncnn::gemm_tile_release_bf16s();
+}
+
+void gemm_transB_packed_tile_bf16s(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+    ncnn::gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+}
+
+void unpack_output_tile_fp32_to_bf16(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, float alpha, int output_transpose, int activation_type, const Mat& activation_params)
+{
+    ncnn::unpack_output_tile_fp32_to_bf16(topT, C, top_blob, broadcast_type_C, i, max_ii, j, max_jj, alpha, output_transpose, activation_type, activation_params);
 }
 #endif
 } // namespace Gemm_x86_utility
@@ -15,6 +15,9 @@ public:
 
     virtual int create_pipeline(const Option& opt);
 
+    virtual int save_pipeline_weights(std::vector<Mat>& weights) const;
+    virtual int load_pipeline_weights(const std::vector<Mat>& weights, const Option& opt);
+
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
 protected:
@@ -22,19 +25,45 @@ protected:
     int create_pipeline_int8(const Option& opt);
     int forward_int8(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 #endif
+#if NCNN_BF16
+    int create_pipeline_bf16s(const Option& opt);
+    int forward_bf16s(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+#endif
 
 public:
     int nT;
+
+    // constant_TILE_M/N/K or the autotuned tiles of the fp32 path
+    int tuned_TILE_M;
+    int tuned_TILE_N;
+    int tuned_TILE_K;
+
     Mat AT_data;
     Mat BT_data;
     Mat CT_data;
 };
 
-// expose some gemm internal routines for convolution uses
+// expose some gemm internal routines for convolution and innerproduct uses
 namespace Gemm_x86_utility {
 #if NCNN_INT8
+void get_optimal_tile_mnk_int8(int M, int N, int K, int& TILE_M, int& TILE_N, int& TILE_K, int nT);
 void pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
+void pack_B_tile_int8(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk);
+int get_B_tile_amx_size_int8(int TILE_N, int TILE_K);
+void pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk);
+void gemm_tile_config_int8();
+void gemm_tile_release_int8();
 void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+void unpack_output_tile_int32_to_fp32(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, const Mat& descales, float alpha, float beta, int output_transpose);
+#endif
+#if NCNN_BF16
+void pack_A_tile_fp32_to_bf16(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
+int get_B_tile_amx_size_bf16s(int TILE_N, int TILE_K);
+void pack_B_tile_bf16s_amx(Mat& BT, int max_jj, int max_kk);
+void gemm_tile_config_bf16s();
+void gemm_tile_release_bf16s();
+void gemm_transB_packed_tile_bf16s(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+void unpack_output_tile_fp32_to_bf16(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, float alpha, int output_transpose, int activation_type, const Mat& activation_params);
 #endif
 } // namespace Gemm_x86_utility
 
@@ -0,0 +1,64 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "cpu.h"
+#include "layer.h"
+#include "mat.h"
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+namespace ncnn {
+
+#if NCNN_INT8
+#include "gemm_int8.h"
+#endif
+#if NCNN_BF16
+#include "gemm_bf16s.h"
+#endif
+
+#if NCNN_INT8
+void gemm_transB_packed_tile_int8_amx(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+    gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+}
+
+void gemm_tile_config_int8_amx()
+{
+    gemm_tile_config_int8();
+}
+
+void gemm_tile_release_int8_amx()
+{
+    gemm_tile_release_int8();
+}
+#endif // NCNN_INT8
+
+#if NCNN_BF16
+void gemm_transB_packed_tile_bf16s_amx(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+    gemm_transB_packed_tile_bf16s(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+}
+
+void gemm_tile_config_bf16s_amx()
+{
+    gemm_tile_config_bf16s();
+}
+
+void gemm_tile_release_bf16s_amx()
+{
+    gemm_tile_release_bf16s();
+}
+#endif // NCNN_BF16
+
+} // namespace ncnn
@@ -0,0 +1,39 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_GRU_X86_H
+#define LAYER_GRU_X86_H
+
+#include "gru.h"
+
+namespace ncnn {
+
+class GRU_x86 : public GRU
+{
+public:
+    GRU_x86();
+
+    virtual int create_pipeline(const Option& opt);
+
+    virtual const char* kernel_name() const;
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+
+    virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
+
+protected:
+    int forward_directions(const Mat& bottom_blob, Mat& top_blob, Mat& hidden, const Option& opt) const;
+
+public:
+    Mat weight_xc_data_packed;
+    Mat weight_hc_data_packed;
+
+#if NCNN_INT8
+    Mat weight_xc_data_int8_descales;
+    Mat weight_hc_data_int8_descales;
+#endif
+};
+
+} // namespace ncnn
+
+#endif // LAYER_GRU_X86_H
@@ -0,0 +1,23 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "cpu.h"
+#include "mat.h"
+#include "layer.h"
+#include "x86_usability.h"
+
+namespace ncnn {
+
+#include "recurrent_gemm_int8.h"
+
+void gru_transform_weight_int8_avx2(const Mat& weight, Mat& weight_tm, int M, int K)
+{
+    recurrent_transform_weight_int8(weight, weight_tm, M, K);
+}
+
+void gru_gemm_int8_avx2(const Mat& X, const Mat& weight_tm, Mat& Y, int M, const Option& opt)
+{
+    recurrent_gemm_int8(X, weight_tm, Y, M, opt);
+}
+
+} // namespace ncnn
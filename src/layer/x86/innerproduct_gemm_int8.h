@@ -0,0 +1,316 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// gemm_x86.h
+#if NCNN_RUNTIME_CPU && __AVX512F__
+namespace Gemm_x86_avx512_utility {
+#elif NCNN_RUNTIME_CPU && __FMA__
+namespace Gemm_x86_fma_utility {
+#elif NCNN_RUNTIME_CPU && __AVX__
+namespace Gemm_x86_avx_utility {
+#else
+namespace Gemm_x86_utility {
+#endif
+void get_optimal_tile_mnk_int8(int M, int N, int K, int& TILE_M, int& TILE_N, int& TILE_K, int nT);
+void pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk);
+void pack_B_tile_int8(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk);
+int get_B_tile_amx_size_int8(int TILE_N, int TILE_K);
+void pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk);
+void gemm_tile_config_int8();
+void gemm_tile_release_int8();
+void gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk);
+void unpack_output_tile_int32_to_fp32(const Mat& topT, const Mat& C, Mat& top_blob, int broadcast_type_C, int i, int max_ii, int j, int max_jj, const Mat& descales, float alpha, float beta, int output_transpose);
+}
+
+static void innerproduct_gemm_get_optimal_tile_mnk_int8(int M, int N, int K, int& TILE_M, int& TILE_N, int& TILE_K, int nT)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::get_optimal_tile_mnk_int8(M, N, K, TILE_M, TILE_N, TILE_K, nT);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::get_optimal_tile_mnk_int8(M, N, K, TILE_M, TILE_N, TILE_K, nT);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::get_optimal_tile_mnk_int8(M, N, K, TILE_M, TILE_N, TILE_K, nT);
+#else
+    Gemm_x86_utility::get_optimal_tile_mnk_int8(M, N, K, TILE_M, TILE_N, TILE_K, nT);
+#endif
+}
+
+static void innerproduct_gemm_pack_A_tile_int8(const Mat& A, Mat& AT, int i, int max_ii, int k, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::pack_A_tile_int8(A, AT, i, max_ii, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::pack_A_tile_int8(A, AT, i, max_ii, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::pack_A_tile_int8(A, AT, i, max_ii, k, max_kk);
+#else
+    Gemm_x86_utility::pack_A_tile_int8(A, AT, i, max_ii, k, max_kk);
+#endif
+}
+
+static void innerproduct_gemm_pack_B_tile_int8(const Mat& B, Mat& BT, int j, int max_jj, int k, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::pack_B_tile_int8(B, BT, j, max_jj, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::pack_B_tile_int8(B, BT, j, max_jj, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::pack_B_tile_int8(B, BT, j, max_jj, k, max_kk);
+#else
+    Gemm_x86_utility::pack_B_tile_int8(B, BT, j, max_jj, k, max_kk);
+#endif
+}
+
+static int innerproduct_gemm_B_tile_amx_size_int8(int TILE_N, int TILE_K)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    return Gemm_x86_avx512_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    return Gemm_x86_fma_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    return Gemm_x86_avx_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#else
+    return Gemm_x86_utility::get_B_tile_amx_size_int8(TILE_N, TILE_K);
+#endif
+}
+
+static void innerproduct_gemm_pack_B_tile_int8_amx(Mat& BT, int max_jj, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#else
+    Gemm_x86_utility::pack_B_tile_int8_amx(BT, max_jj, max_kk);
+#endif
+}
+
+static void innerproduct_gemm_tile_config_int8()
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_tile_config_int8();
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_tile_config_int8();
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_tile_config_int8();
+#else
+    Gemm_x86_utility::gemm_tile_config_int8();
+#endif
+}
+
+static void innerproduct_gemm_tile_release_int8()
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_tile_release_int8();
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_tile_release_int8();
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_tile_release_int8();
+#else
+    Gemm_x86_utility::gemm_tile_release_int8();
+#endif
+}
+
+static void innerproduct_gemm_transB_packed_tile_int8(const Mat& AT_tile, const Mat& BT_tile, Mat& topT_tile, int i, int max_ii, int j, int max_jj, int k, int max_kk)
+{
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#else
+    Gemm_x86_utility::gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+#endif
+}
+
+static void innerproduct_gemm_unpack_output_tile_int32_to_fp32(const Mat& topT, const Mat& bias, Mat& top_blob, int i, int max_ii, int j, int max_jj, const Mat& descales)
+{
+    // bias broadcasts along num_output as gemm C of type M, top_blob is the transposed output
+#if NCNN_RUNTIME_CPU && __AVX512F__
+    Gemm_x86_avx512_utility::unpack_output_tile_int32_to_fp32(topT, bias, top_blob, 1, i, max_ii, j, max_jj, descales, 1.f, 1.f, 1);
+#elif NCNN_RUNTIME_CPU && __FMA__
+    Gemm_x86_fma_utility::unpack_output_tile_int32_to_fp32(topT, bias, top_blob, 1, i, max_ii, j, max_jj, descales, 1.f, 1.f, 1);
+#elif NCNN_RUNTIME_CPU && __AVX__
+    Gemm_x86_avx_utility::unpack_output_tile_int32_to_fp32(topT, bias, top_blob, 1, i, max_ii, j, max_jj, descales, 1.f, 1.f, 1);
+#else
+    Gemm_x86_utility::unpack_output_tile_int32_to_fp32(topT, bias, top_blob, 1, i, max_ii, j, max_jj, descales, 1.f, 1.f, 1);
+#endif
+}
+
+static void innerproduct_gemm_activation_int8(float* ptr, int size, int activation_type, const Mat& activation_params)
+{
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        _mm512_storeu_ps(ptr, activation_avx512(_mm512_loadu_ps(ptr), activation_type, activation_params));
+        ptr += 16;
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        _mm256_storeu_ps(ptr, activation_avx(_mm256_loadu_ps(ptr), activation_type, activation_params));
+        ptr += 8;
+    }
+#endif // __AVX__
+    for (; i + 3 < size; i += 4)
+    {
+        _mm_storeu_ps(ptr, activation_sse(_mm_loadu_ps(ptr), activation_type, activation_params));
+        ptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *ptr = activation_ss(*ptr, activation_type, activation_params);
+        ptr++;
+    }
+}
+
+static void innerproduct_gemm_transform_kernel_int8(const Mat& kernel, Mat& AT, int num_input, int num_output, const Option& opt)
+{
+    const int M = num_output;
+    const int K = num_input;
+
+    int TILE_M, TILE_N, TILE_K;
+    innerproduct_gemm_get_optimal_tile_mnk_int8(M, 0, K, TILE_M, TILE_N, TILE_K, opt.num_threads);
+
+    const int nn_M = (M + TILE_M - 1) / TILE_M;
+
+    // inch-outch
+    Mat A_data = kernel.reshape(K, M);
+
+#if NCNN_AVX512VNNI || NCNN_AVXVNNI
+    bool has_w_shift = false;
+    if (TILE_K >= 4)
+    {
+        has_w_shift = ncnn::cpu_support_x86_avx512_vnni() || ncnn::cpu_support_x86_avx_vnni();
+#if NCNN_AVXVNNIINT8
+        if (ncnn::cpu_support_x86_avx_vnni_int8())
+            has_w_shift = false;
+#endif // NCNN_AVXVNNIINT8
+    }
+    if (has_w_shift)
+    {
+        int w_shift_count = TILE_M >= 16 ? 16 : TILE_M >= 8 ? 8 : TILE_M >= 4 ? 4 : TILE_M >= 2 ? 2 : 1;
+        AT.create((TILE_K + w_shift_count * 4) * TILE_M, (K + TILE_K - 1) / TILE_K, (M + TILE_M - 1) / TILE_M, (size_t)1u, 1);
+    }
+    else
+#endif // NCNN_AVX512VNNI || NCNN_AVXVNNI
+    {
+        AT.create(TILE_K * TILE_M, (K + TILE_K - 1) / TILE_K, (M + TILE_M - 1) / TILE_M, (size_t)1u, 1);
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ppj = 0; ppj < nn_M; ppj++)
+    {
+        const int i = ppj * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        for (int k = 0; k < K; k += TILE_K)
+        {
+            const int max_kk = std::min((K - k), TILE_K);
+
+            Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+            innerproduct_gemm_pack_A_tile_int8(A_data, AT_tile, i, max_ii, k, max_kk);
+        }
+    }
+}
+
+// bottom_blob holds h rows of num_input int8, top_blob takes h rows of num_output floats packed along h
+// num_output is gemm M and h is gemm N, so the unpack writes the output transposed
+static int innerproduct_gemm_int8(const Mat& bottom_blob, Mat& top_blob, const Mat& AT, const Mat& bias_data, const Mat& scale_in_data, int activation_type, const Mat& activation_params, int nT, const Option& opt)
+{
+    const int M = top_blob.w;
+    const int N = bottom_blob.h;
+    const int K = bottom_blob.w;
+
+    int TILE_M, TILE_N, TILE_K;
+    innerproduct_gemm_get_optimal_tile_mnk_int8(M, N, K, TILE_M, TILE_N, TILE_K, nT);
+
+    nT = std::min(nT, opt.num_threads);
+
+    const int nn_M = (M + TILE_M - 1) / TILE_M;
+    const int nn_N = (N + TILE_N - 1) / TILE_N;
+    const int nn_K = (K + TILE_K - 1) / TILE_K;
+
+    Mat BT(TILE_K * TILE_N + innerproduct_gemm_B_tile_amx_size_int8(TILE_N, TILE_K), (K + TILE_K - 1) / TILE_K, (N + TILE_N - 1) / TILE_N, 1u, opt.workspace_allocator);
+    if (BT.empty())
+        return -100;
+
+    const int nn_NK = nn_N * nn_K;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppjk = 0; ppjk < nn_NK; ppjk++)
+    {
+        const int ppj = ppjk / nn_K;
+        const int ppk = ppjk % nn_K;
+
+        const int j = ppj * TILE_N;
+        const int k = ppk * TILE_K;
+
+        const int max_jj = std::min((N - j), TILE_N);
+        const int max_kk = std::min((K - k), TILE_K);
+
+        Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+        innerproduct_gemm_pack_B_tile_int8(bottom_blob, BT_tile, j, max_jj, k, max_kk);
+
+        innerproduct_gemm_pack_B_tile_int8_amx(BT_tile, max_jj, max_kk);
+    }
+
+    Mat topT(TILE_N * TILE_M, 1, nT, 4u, opt.workspace_allocator);
+    if (topT.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(nT)
+    for (int ppj = 0; ppj < nn_M; ppj++)
+    {
+        const int i = ppj * TILE_M;
+
+        const int max_ii = std::min((M - i), TILE_M);
+
+        Mat topT_tile = topT.channel(get_omp_thread_num());
+
+        innerproduct_gemm_tile_config_int8();
+
+        for (int j = 0; j < N; j += TILE_N)
+        {
+            const int max_jj = std::min((N - j), TILE_N);
+
+            for (int k = 0; k < K; k += TILE_K)
+            {
+                const int max_kk = std::min((K - k), TILE_K);
+
+                const Mat AT_tile = AT.channel(i / TILE_M).row_range(k / TILE_K, 1);
+
+                const Mat BT_tile = BT.channel(j / TILE_N).row_range(k / TILE_K, 1);
+
+                innerproduct_gemm_transB_packed_tile_int8(AT_tile, BT_tile, topT_tile, i, max_ii, j, max_jj, k, max_kk);
+            }
+
+            innerproduct_gemm_unpack_output_tile_int32_to_fp32(topT_tile, bias_data, top_blob, i, max_ii, j, max_jj, scale_in_data);
+
+            if (activation_type)
+            {
+                // the tile covers max_ii outputs of every packed row
+                const int out_elempack = top_blob.elempack;
+                for (int jj = 0; jj < max_jj; jj += out_elempack)
+                {
+                    float* outptr = top_blob.row((j + jj) / out_elempack) + i * out_elempack;
+                    innerproduct_gemm_activation_int8(outptr, max_ii * out_elempack, activation_type, activation_params);
+                }
+            }
+        }
+
+        innerproduct_gemm_tile_release_int8();
+    }
+
+    return 0;
+}
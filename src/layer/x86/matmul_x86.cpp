@@ -9,6 +9,10 @@ namespace ncnn {
 
 MatMul_x86::MatMul_x86()
 {
+#if NCNN_BF16
+    support_bf16_storage = true;
+#endif
+
     gemm = 0;
 }
 
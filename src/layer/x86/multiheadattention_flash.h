@@ -0,0 +1,569 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// fused scaled dot product attention for one head and one block of queries
+// the scores of a query block against a tile of keys stay in registers and are folded into
+// the output with an online softmax, the full score matrix is never materialized
+//
+// q, k and v are stored transposed as produced by the projection gemm, row k of q holds
+// feature k of consecutive queries, so every vector spans consecutive queries
+// mptr points to the additive mask row of the first query, lane l reads mptr + mstride * l
+// with causal set, lane l attends to keys j <= qpos + l only
+// obuf holds embed_dim_per_head * elempack floats of scratch
+
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+static void flash_attention_pack16(const float* qptr, size_t qstride, const float* kptr, size_t kstride, const float* vptr, size_t vstride, const float* mptr, size_t mstride, float* outptr, size_t ostride, int embed_dim_per_head, int kv_len, int causal, int qpos, float* obuf)
+{
+    const __m512 _neg = _mm512_set1_ps(-FLT_MAX);
+    const __m512 _qpos = _mm512_add_ps(_mm512_set1_ps((float)qpos), _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f));
+
+    __m512 _max = _neg;
+    __m512 _sum = _mm512_setzero_ps();
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        _mm512_storeu_ps(obuf + k * 16, _mm512_setzero_ps());
+    }
+
+    int j = 0;
+    for (; j + 15 < kv_len; j += 16)
+    {
+        // score tile, one vector of 16 queries per key
+        __m512 _s0 = _mm512_setzero_ps();
+        __m512 _s1 = _mm512_setzero_ps();
+        __m512 _s2 = _mm512_setzero_ps();
+        __m512 _s3 = _mm512_setzero_ps();
+        __m512 _s4 = _mm512_setzero_ps();
+        __m512 _s5 = _mm512_setzero_ps();
+        __m512 _s6 = _mm512_setzero_ps();
+        __m512 _s7 = _mm512_setzero_ps();
+        __m512 _s8 = _mm512_setzero_ps();
+        __m512 _s9 = _mm512_setzero_ps();
+        __m512 _sa = _mm512_setzero_ps();
+        __m512 _sb = _mm512_setzero_ps();
+        __m512 _sc = _mm512_setzero_ps();
+        __m512 _sd = _mm512_setzero_ps();
+        __m512 _se = _mm512_setzero_ps();
+        __m512 _sf = _mm512_setzero_ps();
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m512 _q = _mm512_loadu_ps(qptr + qstride * k);
+            const float* kp = kptr + kstride * k + j;
+            _s0 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[0]), _s0);
+            _s1 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[1]), _s1);
+            _s2 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[2]), _s2);
+            _s3 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[3]), _s3);
+            _s4 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[4]), _s4);
+            _s5 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[5]), _s5);
+            _s6 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[6]), _s6);
+            _s7 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[7]), _s7);
+            _s8 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[8]), _s8);
+            _s9 = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[9]), _s9);
+            _sa = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[10]), _sa);
+            _sb = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[11]), _sb);
+            _sc = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[12]), _sc);
+            _sd = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[13]), _sd);
+            _se = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[14]), _se);
+            _sf = _mm512_fmadd_ps(_q, _mm512_set1_ps(kp[15]), _sf);
+        }
+
+        if (mptr)
+        {
+            __m512 _m0 = _mm512_loadu_ps(mptr + j);
+            __m512 _m1 = _mm512_loadu_ps(mptr + mstride * 1 + j);
+            __m512 _m2 = _mm512_loadu_ps(mptr + mstride * 2 + j);
+            __m512 _m3 = _mm512_loadu_ps(mptr + mstride * 3 + j);
+            __m512 _m4 = _mm512_loadu_ps(mptr + mstride * 4 + j);
+            __m512 _m5 = _mm512_loadu_ps(mptr + mstride * 5 + j);
+            __m512 _m6 = _mm512_loadu_ps(mptr + mstride * 6 + j);
+            __m512 _m7 = _mm512_loadu_ps(mptr + mstride * 7 + j);
+            __m512 _m8 = _mm512_loadu_ps(mptr + mstride * 8 + j);
+            __m512 _m9 = _mm512_loadu_ps(mptr + mstride * 9 + j);
+            __m512 _ma = _mm512_loadu_ps(mptr + mstride * 10 + j);
+            __m512 _mb = _mm512_loadu_ps(mptr + mstride * 11 + j);
+            __m512 _mc = _mm512_loadu_ps(mptr + mstride * 12 + j);
+            __m512 _md = _mm512_loadu_ps(mptr + mstride * 13 + j);
+            __m512 _me = _mm512_loadu_ps(mptr + mstride * 14 + j);
+            __m512 _mf = _mm512_loadu_ps(mptr + mstride * 15 + j);
+            transpose16x16_ps(_m0, _m1, _m2, _m3, _m4, _m5, _m6, _m7, _m8, _m9, _ma, _mb, _mc, _md, _me, _mf);
+            _s0 = _mm512_add_ps(_s0, _m0);
+            _s1 = _mm512_add_ps(_s1, _m1);
+            _s2 = _mm512_add_ps(_s2, _m2);
+            _s3 = _mm512_add_ps(_s3, _m3);
+            _s4 = _mm512_add_ps(_s4, _m4);
+            _s5 = _mm512_add_ps(_s5, _m5);
+            _s6 = _mm512_add_ps(_s6, _m6);
+            _s7 = _mm512_add_ps(_s7, _m7);
+            _s8 = _mm512_add_ps(_s8, _m8);
+            _s9 = _mm512_add_ps(_s9, _m9);
+            _sa = _mm512_add_ps(_sa, _ma);
+            _sb = _mm512_add_ps(_sb, _mb);
+            _sc = _mm512_add_ps(_sc, _mc);
+            _sd = _mm512_add_ps(_sd, _md);
+            _se = _mm512_add_ps(_se, _me);
+            _sf = _mm512_add_ps(_sf, _mf);
+        }
+
+        if (causal && j + 15 > qpos)
+        {
+            _s0 = _mm512_mask_mov_ps(_s0, _mm512_cmp_ps_mask(_mm512_set1_ps((float)j), _qpos, _CMP_GT_OQ), _neg);
+            _s1 = _mm512_mask_mov_ps(_s1, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 1)), _qpos, _CMP_GT_OQ), _neg);
+            _s2 = _mm512_mask_mov_ps(_s2, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 2)), _qpos, _CMP_GT_OQ), _neg);
+            _s3 = _mm512_mask_mov_ps(_s3, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 3)), _qpos, _CMP_GT_OQ), _neg);
+            _s4 = _mm512_mask_mov_ps(_s4, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 4)), _qpos, _CMP_GT_OQ), _neg);
+            _s5 = _mm512_mask_mov_ps(_s5, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 5)), _qpos, _CMP_GT_OQ), _neg);
+            _s6 = _mm512_mask_mov_ps(_s6, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 6)), _qpos, _CMP_GT_OQ), _neg);
+            _s7 = _mm512_mask_mov_ps(_s7, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 7)), _qpos, _CMP_GT_OQ), _neg);
+            _s8 = _mm512_mask_mov_ps(_s8, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 8)), _qpos, _CMP_GT_OQ), _neg);
+            _s9 = _mm512_mask_mov_ps(_s9, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 9)), _qpos, _CMP_GT_OQ), _neg);
+            _sa = _mm512_mask_mov_ps(_sa, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 10)), _qpos, _CMP_GT_OQ), _neg);
+            _sb = _mm512_mask_mov_ps(_sb, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 11)), _qpos, _CMP_GT_OQ), _neg);
+            _sc = _mm512_mask_mov_ps(_sc, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 12)), _qpos, _CMP_GT_OQ), _neg);
+            _sd = _mm512_mask_mov_ps(_sd, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 13)), _qpos, _CMP_GT_OQ), _neg);
+            _se = _mm512_mask_mov_ps(_se, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 14)), _qpos, _CMP_GT_OQ), _neg);
+            _sf = _mm512_mask_mov_ps(_sf, _mm512_cmp_ps_mask(_mm512_set1_ps((float)(j + 15)), _qpos, _CMP_GT_OQ), _neg);
+        }
+
+        // online softmax, rescale the running sum and output by exp(old max - new max)
+        __m512 _max1 = _max;
+        _max1 = _mm512_max_ps(_max1, _s0);
+        _max1 = _mm512_max_ps(_max1, _s1);
+        _max1 = _mm512_max_ps(_max1, _s2);
+        _max1 = _mm512_max_ps(_max1, _s3);
+        _max1 = _mm512_max_ps(_max1, _s4);
+        _max1 = _mm512_max_ps(_max1, _s5);
+        _max1 = _mm512_max_ps(_max1, _s6);
+        _max1 = _mm512_max_ps(_max1, _s7);
+        _max1 = _mm512_max_ps(_max1, _s8);
+        _max1 = _mm512_max_ps(_max1, _s9);
+        _max1 = _mm512_max_ps(_max1, _sa);
+        _max1 = _mm512_max_ps(_max1, _sb);
+        _max1 = _mm512_max_ps(_max1, _sc);
+        _max1 = _mm512_max_ps(_max1, _sd);
+        _max1 = _mm512_max_ps(_max1, _se);
+        _max1 = _mm512_max_ps(_max1, _sf);
+        const __m512 _alpha = exp512_ps(_mm512_sub_ps(_max, _max1));
+        _max = _max1;
+        _s0 = exp512_ps(_mm512_sub_ps(_s0, _max));
+        _s1 = exp512_ps(_mm512_sub_ps(_s1, _max));
+        _s2 = exp512_ps(_mm512_sub_ps(_s2, _max));
+        _s3 = exp512_ps(_mm512_sub_ps(_s3, _max));
+        _s4 = exp512_ps(_mm512_sub_ps(_s4, _max));
+        _s5 = exp512_ps(_mm512_sub_ps(_s5, _max));
+        _s6 = exp512_ps(_mm512_sub_ps(_s6, _max));
+        _s7 = exp512_ps(_mm512_sub_ps(_s7, _max));
+        _s8 = exp512_ps(_mm512_sub_ps(_s8, _max));
+        _s9 = exp512_ps(_mm512_sub_ps(_s9, _max));
+        _sa = exp512_ps(_mm512_sub_ps(_sa, _max));
+        _sb = exp512_ps(_mm512_sub_ps(_sb, _max));
+        _sc = exp512_ps(_mm512_sub_ps(_sc, _max));
+        _sd = exp512_ps(_mm512_sub_ps(_sd, _max));
+        _se = exp512_ps(_mm512_sub_ps(_se, _max));
+        _sf = exp512_ps(_mm512_sub_ps(_sf, _max));
+        _sum = _mm512_mul_ps(_sum, _alpha);
+        _sum = _mm512_add_ps(_sum, _s0);
+        _sum = _mm512_add_ps(_sum, _s1);
+        _sum = _mm512_add_ps(_sum, _s2);
+        _sum = _mm512_add_ps(_sum, _s3);
+        _sum = _mm512_add_ps(_sum, _s4);
+        _sum = _mm512_add_ps(_sum, _s5);
+        _sum = _mm512_add_ps(_sum, _s6);
+        _sum = _mm512_add_ps(_sum, _s7);
+        _sum = _mm512_add_ps(_sum, _s8);
+        _sum = _mm512_add_ps(_sum, _s9);
+        _sum = _mm512_add_ps(_sum, _sa);
+        _sum = _mm512_add_ps(_sum, _sb);
+        _sum = _mm512_add_ps(_sum, _sc);
+        _sum = _mm512_add_ps(_sum, _sd);
+        _sum = _mm512_add_ps(_sum, _se);
+        _sum = _mm512_add_ps(_sum, _sf);
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m512 _o = _mm512_mul_ps(_mm512_loadu_ps(obuf + k * 16), _alpha);
+            const float* vp = vptr + vstride * k + j;
+            _o = _mm512_fmadd_ps(_s0, _mm512_set1_ps(vp[0]), _o);
+            _o = _mm512_fmadd_ps(_s1, _mm512_set1_ps(vp[1]), _o);
+            _o = _mm512_fmadd_ps(_s2, _mm512_set1_ps(vp[2]), _o);
+            _o = _mm512_fmadd_ps(_s3, _mm512_set1_ps(vp[3]), _o);
+            _o = _mm512_fmadd_ps(_s4, _mm512_set1_ps(vp[4]), _o);
+            _o = _mm512_fmadd_ps(_s5, _mm512_set1_ps(vp[5]), _o);
+            _o = _mm512_fmadd_ps(_s6, _mm512_set1_ps(vp[6]), _o);
+            _o = _mm512_fmadd_ps(_s7, _mm512_set1_ps(vp[7]), _o);
+            _o = _mm512_fmadd_ps(_s8, _mm512_set1_ps(vp[8]), _o);
+            _o = _mm512_fmadd_ps(_s9, _mm512_set1_ps(vp[9]), _o);
+            _o = _mm512_fmadd_ps(_sa, _mm512_set1_ps(vp[10]), _o);
+            _o = _mm512_fmadd_ps(_sb, _mm512_set1_ps(vp[11]), _o);
+            _o = _mm512_fmadd_ps(_sc, _mm512_set1_ps(vp[12]), _o);
+            _o = _mm512_fmadd_ps(_sd, _mm512_set1_ps(vp[13]), _o);
+            _o = _mm512_fmadd_ps(_se, _mm512_set1_ps(vp[14]), _o);
+            _o = _mm512_fmadd_ps(_sf, _mm512_set1_ps(vp[15]), _o);
+            _mm512_storeu_ps(obuf + k * 16, _o);
+        }
+    }
+    for (; j < kv_len; j++)
+    {
+        __m512 _s = _mm512_setzero_ps();
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            _s = _mm512_fmadd_ps(_mm512_loadu_ps(qptr + qstride * k), _mm512_set1_ps(kptr[kstride * k + j]), _s);
+        }
+
+        if (mptr)
+        {
+            __m512 _m = _mm512_setr_ps(mptr[j], mptr[mstride * 1 + j], mptr[mstride * 2 + j], mptr[mstride * 3 + j], mptr[mstride * 4 + j], mptr[mstride * 5 + j], mptr[mstride * 6 + j], mptr[mstride * 7 + j], mptr[mstride * 8 + j], mptr[mstride * 9 + j], mptr[mstride * 10 + j], mptr[mstride * 11 + j], mptr[mstride * 12 + j], mptr[mstride * 13 + j], mptr[mstride * 14 + j], mptr[mstride * 15 + j]);
+            _s = _mm512_add_ps(_s, _m);
+        }
+
+        if (causal && j > qpos)
+        {
+            _s = _mm512_mask_mov_ps(_s, _mm512_cmp_ps_mask(_mm512_set1_ps((float)j), _qpos, _CMP_GT_OQ), _neg);
+        }
+
+        const __m512 _max1 = _mm512_max_ps(_max, _s);
+        const __m512 _alpha = exp512_ps(_mm512_sub_ps(_max, _max1));
+        _max = _max1;
+        _s = exp512_ps(_mm512_sub_ps(_s, _max));
+        _sum = _mm512_add_ps(_mm512_mul_ps(_sum, _alpha), _s);
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m512 _o = _mm512_mul_ps(_mm512_loadu_ps(obuf + k * 16), _alpha);
+            _o = _mm512_fmadd_ps(_s, _mm512_set1_ps(vptr[vstride * k + j]), _o);
+            _mm512_storeu_ps(obuf + k * 16, _o);
+        }
+    }
+
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        _mm512_storeu_ps(outptr + ostride * k, _mm512_div_ps(_mm512_loadu_ps(obuf + k * 16), _sum));
+    }
+}
+#endif // __AVX512F__
+
+static void flash_attention_pack8(const float* qptr, size_t qstride, const float* kptr, size_t kstride, const float* vptr, size_t vstride, const float* mptr, size_t mstride, float* outptr, size_t ostride, int embed_dim_per_head, int kv_len, int causal, int qpos, float* obuf)
+{
+    const __m256 _neg = _mm256_set1_ps(-FLT_MAX);
+    const __m256 _qpos = _mm256_add_ps(_mm256_set1_ps((float)qpos), _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f));
+
+    __m256 _max = _neg;
+    __m256 _sum = _mm256_setzero_ps();
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        _mm256_storeu_ps(obuf + k * 8, _mm256_setzero_ps());
+    }
+
+    int j = 0;
+    for (; j + 7 < kv_len; j += 8)
+    {
+        // score tile, one vector of 8 queries per key
+        __m256 _s0 = _mm256_setzero_ps();
+        __m256 _s1 = _mm256_setzero_ps();
+        __m256 _s2 = _mm256_setzero_ps();
+        __m256 _s3 = _mm256_setzero_ps();
+        __m256 _s4 = _mm256_setzero_ps();
+        __m256 _s5 = _mm256_setzero_ps();
+        __m256 _s6 = _mm256_setzero_ps();
+        __m256 _s7 = _mm256_setzero_ps();
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m256 _q = _mm256_loadu_ps(qptr + qstride * k);
+            const float* kp = kptr + kstride * k + j;
+            _s0 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[0]), _s0);
+            _s1 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[1]), _s1);
+            _s2 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[2]), _s2);
+            _s3 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[3]), _s3);
+            _s4 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[4]), _s4);
+            _s5 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[5]), _s5);
+            _s6 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[6]), _s6);
+            _s7 = _mm256_comp_fmadd_ps(_q, _mm256_set1_ps(kp[7]), _s7);
+        }
+
+        if (mptr)
+        {
+            __m256 _m0 = _mm256_loadu_ps(mptr + j);
+            __m256 _m1 = _mm256_loadu_ps(mptr + mstride * 1 + j);
+            __m256 _m2 = _mm256_loadu_ps(mptr + mstride * 2 + j);
+            __m256 _m3 = _mm256_loadu_ps(mptr + mstride * 3 + j);
+            __m256 _m4 = _mm256_loadu_ps(mptr + mstride * 4 + j);
+            __m256 _m5 = _mm256_loadu_ps(mptr + mstride * 5 + j);
+            __m256 _m6 = _mm256_loadu_ps(mptr + mstride * 6 + j);
+            __m256 _m7 = _mm256_loadu_ps(mptr + mstride * 7 + j);
+            transpose8x8_ps(_m0, _m1, _m2, _m3, _m4, _m5, _m6, _m7);
+            _s0 = _mm256_add_ps(_s0, _m0);
+            _s1 = _mm256_add_ps(_s1, _m1);
+            _s2 = _mm256_add_ps(_s2, _m2);
+            _s3 = _mm256_add_ps(_s3, _m3);
+            _s4 = _mm256_add_ps(_s4, _m4);
+            _s5 = _mm256_add_ps(_s5, _m5);
+            _s6 = _mm256_add_ps(_s6, _m6);
+            _s7 = _mm256_add_ps(_s7, _m7);
+        }
+
+        if (causal && j + 7 > qpos)
+        {
+            _s0 = _mm256_blendv_ps(_s0, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)j), _qpos, _CMP_GT_OQ));
+            _s1 = _mm256_blendv_ps(_s1, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 1)), _qpos, _CMP_GT_OQ));
+            _s2 = _mm256_blendv_ps(_s2, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 2)), _qpos, _CMP_GT_OQ));
+            _s3 = _mm256_blendv_ps(_s3, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 3)), _qpos, _CMP_GT_OQ));
+            _s4 = _mm256_blendv_ps(_s4, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 4)), _qpos, _CMP_GT_OQ));
+            _s5 = _mm256_blendv_ps(_s5, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 5)), _qpos, _CMP_GT_OQ));
+            _s6 = _mm256_blendv_ps(_s6, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 6)), _qpos, _CMP_GT_OQ));
+            _s7 = _mm256_blendv_ps(_s7, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)(j + 7)), _qpos, _CMP_GT_OQ));
+        }
+
+        // online softmax, rescale the running sum and output by exp(old max - new max)
+        __m256 _max1 = _max;
+        _max1 = _mm256_max_ps(_max1, _s0);
+        _max1 = _mm256_max_ps(_max1, _s1);
+        _max1 = _mm256_max_ps(_max1, _s2);
+        _max1 = _mm256_max_ps(_max1, _s3);
+        _max1 = _mm256_max_ps(_max1, _s4);
+        _max1 = _mm256_max_ps(_max1, _s5);
+        _max1 = _mm256_max_ps(_max1, _s6);
+        _max1 = _mm256_max_ps(_max1, _s7);
+        const __m256 _alpha = exp256_ps(_mm256_sub_ps(_max, _max1));
+        _max = _max1;
+        _s0 = exp256_ps(_mm256_sub_ps(_s0, _max));
+        _s1 = exp256_ps(_mm256_sub_ps(_s1, _max));
+        _s2 = exp256_ps(_mm256_sub_ps(_s2, _max));
+        _s3 = exp256_ps(_mm256_sub_ps(_s3, _max));
+        _s4 = exp256_ps(_mm256_sub_ps(_s4, _max));
+        _s5 = exp256_ps(_mm256_sub_ps(_s5, _max));
+        _s6 = exp256_ps(_mm256_sub_ps(_s6, _max));
+        _s7 = exp256_ps(_mm256_sub_ps(_s7, _max));
+        _sum = _mm256_mul_ps(_sum, _alpha);
+        _sum = _mm256_add_ps(_sum, _s0);
+        _sum = _mm256_add_ps(_sum, _s1);
+        _sum = _mm256_add_ps(_sum, _s2);
+        _sum = _mm256_add_ps(_sum, _s3);
+        _sum = _mm256_add_ps(_sum, _s4);
+        _sum = _mm256_add_ps(_sum, _s5);
+        _sum = _mm256_add_ps(_sum, _s6);
+        _sum = _mm256_add_ps(_sum, _s7);
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m256 _o = _mm256_mul_ps(_mm256_loadu_ps(obuf + k * 8), _alpha);
+            const float* vp = vptr + vstride * k + j;
+            _o = _mm256_comp_fmadd_ps(_s0, _mm256_set1_ps(vp[0]), _o);
+            _o = _mm256_comp_fmadd_ps(_s1, _mm256_set1_ps(vp[1]), _o);
+            _o = _mm256_comp_fmadd_ps(_s2, _mm256_set1_ps(vp[2]), _o);
+            _o = _mm256_comp_fmadd_ps(_s3, _mm256_set1_ps(vp[3]), _o);
+            _o = _mm256_comp_fmadd_ps(_s4, _mm256_set1_ps(vp[4]), _o);
+            _o = _mm256_comp_fmadd_ps(_s5, _mm256_set1_ps(vp[5]), _o);
+            _o = _mm256_comp_fmadd_ps(_s6, _mm256_set1_ps(vp[6]), _o);
+            _o = _mm256_comp_fmadd_ps(_s7, _mm256_set1_ps(vp[7]), _o);
+            _mm256_storeu_ps(obuf + k * 8, _o);
+        }
+    }
+    for (; j < kv_len; j++)
+    {
+        __m256 _s = _mm256_setzero_ps();
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            _s = _mm256_comp_fmadd_ps(_mm256_loadu_ps(qptr + qstride * k), _mm256_set1_ps(kptr[kstride * k + j]), _s);
+        }
+
+        if (mptr)
+        {
+            __m256 _m = _mm256_setr_ps(mptr[j], mptr[mstride * 1 + j], mptr[mstride * 2 + j], mptr[mstride * 3 + j], mptr[mstride * 4 + j], mptr[mstride * 5 + j], mptr[mstride * 6 + j], mptr[mstride * 7 + j]);
+            _s = _mm256_add_ps(_s, _m);
+        }
+
+        if (causal && j > qpos)
+        {
+            _s = _mm256_blendv_ps(_s, _neg, _mm256_cmp_ps(_mm256_set1_ps((float)j), _qpos, _CMP_GT_OQ));
+        }
+
+        const __m256 _max1 = _mm256_max_ps(_max, _s);
+        const __m256 _alpha = exp256_ps(_mm256_sub_ps(_max, _max1));
+        _max = _max1;
+        _s = exp256_ps(_mm256_sub_ps(_s, _max));
+        _sum = _mm256_add_ps(_mm256_mul_ps(_sum, _alpha), _s);
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m256 _o = _mm256_mul_ps(_mm256_loadu_ps(obuf + k * 8), _alpha);
+            _o = _mm256_comp_fmadd_ps(_s, _mm256_set1_ps(vptr[vstride * k + j]), _o);
+            _mm256_storeu_ps(obuf + k * 8, _o);
+        }
+    }
+
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        _mm256_storeu_ps(outptr + ostride * k, _mm256_div_ps(_mm256_loadu_ps(obuf + k * 8), _sum));
+    }
+}
+#endif // __AVX__
+
+static void flash_attention_pack4(const float* qptr, size_t qstride, const float* kptr, size_t kstride, const float* vptr, size_t vstride, const float* mptr, size_t mstride, float* outptr, size_t ostride, int embed_dim_per_head, int kv_len, int causal, int qpos, float* obuf)
+{
+    const __m128 _neg = _mm_set1_ps(-FLT_MAX);
+    const __m128 _qpos = _mm_add_ps(_mm_set1_ps((float)qpos), _mm_setr_ps(0.f, 1.f, 2.f, 3.f));
+
+    __m128 _max = _neg;
+    __m128 _sum = _mm_setzero_ps();
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        _mm_storeu_ps(obuf + k * 4, _mm_setzero_ps());
+    }
+
+    int j = 0;
+    for (; j + 3 < kv_len; j += 4)
+    {
+        // score tile, one vector of 4 queries per key
+        __m128 _s0 = _mm_setzero_ps();
+        __m128 _s1 = _mm_setzero_ps();
+        __m128 _s2 = _mm_setzero_ps();
+        __m128 _s3 = _mm_setzero_ps();
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m128 _q = _mm_loadu_ps(qptr + qstride * k);
+            const float* kp = kptr + kstride * k + j;
+            _s0 = _mm_comp_fmadd_ps(_q, _mm_set1_ps(kp[0]), _s0);
+            _s1 = _mm_comp_fmadd_ps(_q, _mm_set1_ps(kp[1]), _s1);
+            _s2 = _mm_comp_fmadd_ps(_q, _mm_set1_ps(kp[2]), _s2);
+            _s3 = _mm_comp_fmadd_ps(_q, _mm_set1_ps(kp[3]), _s3);
+        }
+
+        if (mptr)
+        {
+            __m128 _m0 = _mm_loadu_ps(mptr + j);
+            __m128 _m1 = _mm_loadu_ps(mptr + mstride * 1 + j);
+            __m128 _m2 = _mm_loadu_ps(mptr + mstride * 2 + j);
+            __m128 _m3 = _mm_loadu_ps(mptr + mstride * 3 + j);
+            _MM_TRANSPOSE4_PS(_m0, _m1, _m2, _m3);
+            _s0 = _mm_add_ps(_s0, _m0);
+            _s1 = _mm_add_ps(_s1, _m1);
+            _s2 = _mm_add_ps(_s2, _m2);
+            _s3 = _mm_add_ps(_s3, _m3);
+        }
+
+        if (causal && j + 3 > qpos)
+        {
+            __m128 _gt0 = _mm_cmpgt_ps(_mm_set1_ps((float)j), _qpos);
+            _s0 = _mm_or_ps(_mm_andnot_ps(_gt0, _s0), _mm_and_ps(_gt0, _neg));
+            __m128 _gt1 = _mm_cmpgt_ps(_mm_set1_ps((float)(j + 1)), _qpos);
+            _s1 = _mm_or_ps(_mm_andnot_ps(_gt1, _s1), _mm_and_ps(_gt1, _neg));
+            __m128 _gt2 = _mm_cmpgt_ps(_mm_set1_ps((float)(j + 2)), _qpos);
+            _s2 = _mm_or_ps(_mm_andnot_ps(_gt2, _s2), _mm_and_ps(_gt2, _neg));
+            __m128 _gt3 = _mm_cmpgt_ps(_mm_set1_ps((float)(j + 3)), _qpos);
+            _s3 = _mm_or_ps(_mm_andnot_ps(_gt3, _s3), _mm_and_ps(_gt3, _neg));
+        }
+
+        // online softmax, rescale the running sum and output by exp(old max - new max)
+        __m128 _max1 = _max;
+        _max1 = _mm_max_ps(_max1, _s0);
+        _max1 = _mm_max_ps(_max1, _s1);
+        _max1 = _mm_max_ps(_max1, _s2);
+        _max1 = _mm_max_ps(_max1, _s3);
+        const __m128 _alpha = exp_ps(_mm_sub_ps(_max, _max1));
+        _max = _max1;
+        _s0 = exp_ps(_mm_sub_ps(_s0, _max));
+        _s1 = exp_ps(_mm_sub_ps(_s1, _max));
+        _s2 = exp_ps(_mm_sub_ps(_s2, _max));
+        _s3 = exp_ps(_mm_sub_ps(_s3, _max));
+        _sum = _mm_mul_ps(_sum, _alpha);
+        _sum = _mm_add_ps(_sum, _s0);
+        _sum = _mm_add_ps(_sum, _s1);
+        _sum = _mm_add_ps(_sum, _s2);
+        _sum = _mm_add_ps(_sum, _s3);
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m128 _o = _mm_mul_ps(_mm_loadu_ps(obuf + k * 4), _alpha);
+            const float* vp = vptr + vstride * k + j;
+            _o = _mm_comp_fmadd_ps(_s0, _mm_set1_ps(vp[0]), _o);
+            _o = _mm_comp_fmadd_ps(_s1, _mm_set1_ps(vp[1]), _o);
+            _o = _mm_comp_fmadd_ps(_s2, _mm_set1_ps(vp[2]), _o);
+            _o = _mm_comp_fmadd_ps(_s3, _mm_set1_ps(vp[3]), _o);
+            _mm_storeu_ps(obuf + k * 4, _o);
+        }
+    }
+    for (; j < kv_len; j++)
+    {
+        __m128 _s = _mm_setzero_ps();
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            _s = _mm_comp_fmadd_ps(_mm_loadu_ps(qptr + qstride * k), _mm_set1_ps(kptr[kstride * k + j]), _s);
+        }
+
+        if (mptr)
+        {
+            __m128 _m = _mm_setr_ps(mptr[j], mptr[mstride * 1 + j], mptr[mstride * 2 + j], mptr[mstride * 3 + j]);
+            _s = _mm_add_ps(_s, _m);
+        }
+
+        if (causal && j > qpos)
+        {
+            __m128 _gt = _mm_cmpgt_ps(_mm_set1_ps((float)j), _qpos);
+            _s = _mm_or_ps(_mm_andnot_ps(_gt, _s), _mm_and_ps(_gt, _neg));
+        }
+
+        const __m128 _max1 = _mm_max_ps(_max, _s);
+        const __m128 _alpha = exp_ps(_mm_sub_ps(_max, _max1));
+        _max = _max1;
+        _s = exp_ps(_mm_sub_ps(_s, _max));
+        _sum = _mm_add_ps(_mm_mul_ps(_sum, _alpha), _s);
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            __m128 _o = _mm_mul_ps(_mm_loadu_ps(obuf + k * 4), _alpha);
+            _o = _mm_comp_fmadd_ps(_s, _mm_set1_ps(vptr[vstride * k + j]), _o);
+            _mm_storeu_ps(obuf + k * 4, _o);
+        }
+    }
+
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        _mm_storeu_ps(outptr + ostride * k, _mm_div_ps(_mm_loadu_ps(obuf + k * 4), _sum));
+    }
+}
+#endif // __SSE2__
+
+static void flash_attention(const float* qptr, size_t qstride, const float* kptr, size_t kstride, const float* vptr, size_t vstride, const float* mptr, float* outptr, size_t ostride, int embed_dim_per_head, int kv_len, int causal, int qpos, float* obuf)
+{
+    float max = -FLT_MAX;
+    float sum = 0.f;
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        obuf[k] = 0.f;
+    }
+
+    for (int j = 0; j < kv_len; j++)
+    {
+        float s = 0.f;
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            s += qptr[qstride * k] * kptr[kstride * k + j];
+        }
+
+        if (mptr)
+        {
+            s += mptr[j];
+        }
+
+        if (causal && j > qpos)
+        {
+            s = -FLT_MAX;
+        }
+
+        const float max1 = std::max(max, s);
+        const float alpha = expf(max - max1);
+        max = max1;
+        s = expf(s - max);
+        sum = sum * alpha + s;
+
+        for (int k = 0; k < embed_dim_per_head; k++)
+        {
+            obuf[k] = obuf[k] * alpha + s * vptr[vstride * k + j];
+        }
+    }
+
+    for (int k = 0; k < embed_dim_per_head; k++)
+    {
+        outptr[ostride * k] = obuf[k] / sum;
+    }
+}
@@ -3,10 +3,28 @@
 
 #include "multiheadattention_x86.h"
 
+#include <float.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+#include "cpu.h"
 #include "layer_type.h"
 
 namespace ncnn {
 
+#include "multiheadattention_flash.h"
+
 MultiHeadAttention_x86::MultiHeadAttention_x86()
 {
 #if __SSE2__
@@ -28,6 +46,7 @@ MultiHeadAttention_x86::MultiHeadAttention_x86()
 int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
 {
     Option opt = _opt;
+    opt.use_bf16_storage = false; // the sub gemms share the fp32 storage of this layer
     if (int8_scale_term)
     {
         support_packing = false;
@@ -35,6 +54,8 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         opt.use_packing_layout = false; // TODO enable packing
     }
 
+    // fp32 attention runs the fused kernel, the score gemm and softmax are only needed for int8
+    if (int8_scale_term)
     {
         qk_softmax = ncnn::create_layer_cpu(ncnn::LayerType::Softmax);
         ncnn::ParamDict pd;
@@ -189,6 +210,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         }
     }
 
+    if (int8_scale_term)
     {
         qk_gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
         ncnn::ParamDict pd;
@@ -213,6 +235,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
         qk_gemm->create_pipeline(opt1);
     }
 
+    if (int8_scale_term)
     {
         qkv_gemm = ncnn::create_layer_cpu(ncnn::LayerType::Gemm);
         ncnn::ParamDict pd;
@@ -244,6 +267,7 @@ int MultiHeadAttention_x86::create_pipeline(const Option& _opt)
 int MultiHeadAttention_x86::destroy_pipeline(const Option& _opt)
 {
     Option opt = _opt;
+    opt.use_bf16_storage = false; // the sub gemms share the fp32 storage of this layer
     if (int8_scale_term)
     {
         opt.use_packing_layout = false; // TODO enable packing
@@ -300,14 +324,45 @@ int MultiHeadAttention_x86::destroy_pipeline(const Option& _opt)
     return 0;
 }
 
+// append the new affine(k) or affine(v) columns after the cached sequence positions
+static int concat_kv_cache(const Mat& cache_blob, const Mat& affine, Mat& top_cache_blob, const Option& opt)
+{
+    const int past_seqlen = cache_blob.empty() ? 0 : cache_blob.w;
+    const int cur_seqlen = affine.w;
+    const size_t elemsize = affine.elemsize;
+
+    top_cache_blob.create(past_seqlen + cur_seqlen, affine.h, elemsize, opt.blob_allocator);
+    if (top_cache_blob.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int i = 0; i < affine.h; i++)
+    {
+        unsigned char* outptr = top_cache_blob.row<unsigned char>(i);
+
+        if (past_seqlen > 0)
+        {
+            memcpy(outptr, cache_blob.row<const unsigned char>(i), past_seqlen * elemsize);
+        }
+
+        memcpy(outptr + past_seqlen * elemsize, affine.row<const unsigned char>(i), cur_seqlen * elemsize);
+    }
+
+    return 0;
+}
+
 int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& _opt) const
 {
+    // the cached k v blobs always come last
+    const size_t bottom_blob_count = kv_cache ? bottom_blobs.size() - 2 : bottom_blobs.size();
+
     const Mat& q_blob = bottom_blobs[0];
-    const Mat& k_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
-    const Mat& v_blob = (bottom_blobs.size() == 1 || (bottom_blobs.size() == 2 && attn_mask)) ? q_blob : (bottom_blobs.size() == 2 || (bottom_blobs.size() == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
-    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blobs.size() - 1] : Mat();
+    const Mat& k_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : bottom_blobs[1];
+    const Mat& v_blob = (bottom_blob_count == 1 || (bottom_blob_count == 2 && attn_mask)) ? q_blob : (bottom_blob_count == 2 || (bottom_blob_count == 3 && attn_mask)) ? k_blob : bottom_blobs[2];
+    const Mat& attn_mask_blob = attn_mask ? bottom_blobs[bottom_blob_count - 1] : Mat();
 
     Option opt = _opt;
+    opt.use_bf16_storage = false; // the sub gemms share the fp32 storage of this layer
     if (int8_scale_term)
     {
         opt.use_packing_layout = false; // TODO enable packing
@@ -325,9 +380,21 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
         attn_mask_blob_unpacked = attn_mask_blob;
     }
 
+    Mat cache_k_blob_unpacked;
+    Mat cache_v_blob_unpacked;
+    if (kv_cache)
+    {
+        // the cache is stored unpacked, rows are the features of all heads
+        Option opt_unpack = opt;
+        opt_unpack.blob_allocator = opt.workspace_allocator;
+
+        convert_packing(bottom_blobs[bottom_blob_count], cache_k_blob_unpacked, 1, opt_unpack);
+        convert_packing(bottom_blobs[bottom_blob_count + 1], cache_v_blob_unpacked, 1, opt_unpack);
+    }
+
     const int embed_dim_per_head = embed_dim / num_heads;
     const int src_seqlen = q_blob.h * q_blob.elempack;
-    const int dst_seqlen = k_blob.h * k_blob.elempack;
+    const int dst_seqlen = (cache_k_blob_unpacked.empty() ? 0 : cache_k_blob_unpacked.w) + k_blob.h * k_blob.elempack;
 
     Mat q_affine;
     int retq = q_gemm->forward(q_blob, q_affine, opt);
@@ -339,6 +406,46 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retk != 0)
         return retk;
 
+    if (kv_cache)
+    {
+        int retkc = concat_kv_cache(cache_k_blob_unpacked, k_affine, top_blobs[1], opt);
+        if (retkc != 0)
+            return retkc;
+
+        k_affine = top_blobs[1];
+    }
+
+    if (!int8_scale_term)
+    {
+        Mat v_affine;
+        int retv = v_gemm->forward(v_blob, v_affine, opt);
+        if (retv != 0)
+            return retv;
+
+        if (kv_cache)
+        {
+            int retvc = concat_kv_cache(cache_v_blob_unpacked, v_affine, top_blobs[2], opt);
+            if (retvc != 0)
+                return retvc;
+
+            v_affine = top_blobs[2];
+        }
+
+        Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, 4u, opt.blob_allocator);
+        if (qkv_cross.empty())
+            return -100;
+
+        int retqkv = forward_flash(q_affine, k_affine, v_affine, attn_mask_blob_unpacked, qkv_cross, opt);
+        if (retqkv != 0)
+            return retqkv;
+
+        q_affine.release();
+        k_affine.release();
+        v_affine.release();
+
+        return o_gemm->forward(qkv_cross, top_blobs[0], opt);
+    }
+
     Mat qk_cross(dst_seqlen, src_seqlen * num_heads, 4u, opt.blob_allocator);
     if (qk_cross.empty())
         return -100;
@@ -371,6 +478,20 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     q_affine.release();
     k_affine.release();
 
+    if (causal)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < num_heads * src_seqlen; i++)
+        {
+            float* ptr = qk_cross.row(i);
+
+            for (int j = std::max(i % src_seqlen + dst_seqlen - src_seqlen + 1, 0); j < dst_seqlen; j++)
+            {
+                ptr[j] = -FLT_MAX;
+            }
+        }
+    }
+
     int retqk = qk_softmax->forward_inplace(qk_cross, opt);
     if (retqk != 0)
         return retqk;
@@ -380,6 +501,15 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     if (retv != 0)
         return retv;
 
+    if (kv_cache)
+    {
+        int retvc = concat_kv_cache(cache_v_blob_unpacked, v_affine, top_blobs[2], opt);
+        if (retvc != 0)
+            return retvc;
+
+        v_affine = top_blobs[2];
+    }
+
     Mat qkv_cross(src_seqlen, embed_dim_per_head * num_heads, 4u, opt.blob_allocator);
     if (qkv_cross.empty())
         return -100;
@@ -413,4 +543,97 @@ int MultiHeadAttention_x86::forward(const std::vector<Mat>& bottom_blobs, std::v
     return 0;
 }
 
+int MultiHeadAttention_x86::forward_flash(const Mat& q_affine, const Mat& k_affine, const Mat& v_affine, const Mat& attn_mask_blob, Mat& qkv_cross, const Option& opt) const
+{
+    const int embed_dim_per_head = embed_dim / num_heads;
+    const int src_seqlen = q_affine.w;
+    const int dst_seqlen = k_affine.w;
+
+    // the affine outputs are stored transposed, rows are features and columns are sequence positions
+    const size_t qstride = q_affine.w;
+    const size_t kstride = k_affine.w;
+    const size_t vstride = v_affine.w;
+    const size_t ostride = qkv_cross.w;
+
+    int block = 1;
+#if __SSE2__
+    block = 4;
+#if __AVX__
+    block = 8;
+#if __AVX512F__
+    block = 16;
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+    Mat obuf(embed_dim_per_head * block, opt.num_threads, 4u, opt.workspace_allocator);
+    if (obuf.empty())
+        return -100;
+
+    const int nn_block = (src_seqlen + block - 1) / block;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = 0; ii < num_heads * nn_block; ii++)
+    {
+        const int q = ii / nn_block;
+        const int i0 = ii % nn_block * block;
+        const int i1 = std::min(i0 + block, src_seqlen);
+
+        const float* qptr = q_affine.row(q * embed_dim_per_head);
+        const float* kptr = k_affine.row(q * embed_dim_per_head);
+        const float* vptr = v_affine.row(q * embed_dim_per_head);
+        float* outptr = qkv_cross.row(q * embed_dim_per_head);
+
+        Mat maskm;
+        if (attn_mask)
+            maskm = attn_mask_blob.dims == 3 ? attn_mask_blob.channel(q) : attn_mask_blob;
+        const size_t mstride = maskm.w;
+
+        float* bufptr = obuf.row(get_omp_thread_num());
+
+        int i = i0;
+        while (i < i1)
+        {
+            const int rest = i1 - i;
+            const int elempack = rest >= 16 ? 16 : rest >= 8 ? 8 : rest >= 4 ? 4 : 1;
+
+            // with causal set only the keys up to the last query of the block contribute
+            // queries ahead of every key attend to all of them with equal weight
+            const int qpos = i + dst_seqlen - src_seqlen;
+            const int kv_len = causal && qpos >= 0 ? std::min(qpos + elempack, dst_seqlen) : dst_seqlen;
+
+            const float* mptr = attn_mask ? maskm.row(i) : 0;
+
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+            if (elempack == 16)
+            {
+                flash_attention_pack16(qptr + i, qstride, kptr, kstride, vptr, vstride, mptr, mstride, outptr + i, ostride, embed_dim_per_head, kv_len, causal, qpos, bufptr);
+                i += 16;
+                continue;
+            }
+#endif // __AVX512F__
+            if (elempack >= 8)
+            {
+                flash_attention_pack8(qptr + i, qstride, kptr, kstride, vptr, vstride, mptr, mstride, outptr + i, ostride, embed_dim_per_head, kv_len, causal, qpos, bufptr);
+                i += 8;
+                continue;
+            }
+#endif // __AVX__
+            if (elempack >= 4)
+            {
+                flash_attention_pack4(qptr + i, qstride, kptr, kstride, vptr, vstride, mptr, mstride, outptr + i, ostride, embed_dim_per_head, kv_len, causal, qpos, bufptr);
+                i += 4;
+                continue;
+            }
+#endif // __SSE2__
+            flash_attention(qptr + i, qstride, kptr, kstride, vptr, vstride, mptr, outptr + i, ostride, embed_dim_per_head, causal && qpos >= 0 ? std::min(qpos + 1, dst_seqlen) : dst_seqlen, causal, qpos, bufptr);
+            i += 1;
+        }
+    }
+
+    return 0;
+}
+
 } // namespace ncnn
@@ -18,6 +18,9 @@ public:
 
     virtual int forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const;
 
+protected:
+    int forward_flash(const Mat& q_affine, const Mat& k_affine, const Mat& v_affine, const Mat& attn_mask_blob, Mat& qkv_cross, const Option& opt) const;
+
 public:
     Layer* q_gemm;
     Layer* k_gemm;
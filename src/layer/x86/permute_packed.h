@@ -0,0 +1,232 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// axis permutation of 2d, 3d and 4d fp32 blobs on packed layouts
+// logical axes are numbered w=0 h=1 (d=2) and the outermost packed axis last
+// axes[k] names the bottom axis that becomes the k-th top axis
+// top_blob must already be created with the permuted shape and its own elempack
+
+// float offset of index x along bottom axis a
+static NCNN_FORCEINLINE size_t permute_offset(int a, int x, int outer_axis, int elempack, size_t gstride, const size_t* strides)
+{
+    if (a == outer_axis)
+        return (x / elempack) * gstride + x % elempack;
+
+    return x * strides[a];
+}
+
+#if __SSE2__
+// gather elempack rows of elempack contiguous floats from ptr + lane_offsets[l] and store them transposed
+static void permute_transpose_block(const float* ptr, const size_t* lane_offsets, float* outptr, int elempack)
+{
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        __m512 _r0 = _mm512_loadu_ps(ptr + lane_offsets[0]);
+        __m512 _r1 = _mm512_loadu_ps(ptr + lane_offsets[1]);
+        __m512 _r2 = _mm512_loadu_ps(ptr + lane_offsets[2]);
+        __m512 _r3 = _mm512_loadu_ps(ptr + lane_offsets[3]);
+        __m512 _r4 = _mm512_loadu_ps(ptr + lane_offsets[4]);
+        __m512 _r5 = _mm512_loadu_ps(ptr + lane_offsets[5]);
+        __m512 _r6 = _mm512_loadu_ps(ptr + lane_offsets[6]);
+        __m512 _r7 = _mm512_loadu_ps(ptr + lane_offsets[7]);
+        __m512 _r8 = _mm512_loadu_ps(ptr + lane_offsets[8]);
+        __m512 _r9 = _mm512_loadu_ps(ptr + lane_offsets[9]);
+        __m512 _ra = _mm512_loadu_ps(ptr + lane_offsets[10]);
+        __m512 _rb = _mm512_loadu_ps(ptr + lane_offsets[11]);
+        __m512 _rc = _mm512_loadu_ps(ptr + lane_offsets[12]);
+        __m512 _rd = _mm512_loadu_ps(ptr + lane_offsets[13]);
+        __m512 _re = _mm512_loadu_ps(ptr + lane_offsets[14]);
+        __m512 _rf = _mm512_loadu_ps(ptr + lane_offsets[15]);
+        transpose16x16_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
+        _mm512_storeu_ps(outptr, _r0);
+        _mm512_storeu_ps(outptr + 16, _r1);
+        _mm512_storeu_ps(outptr + 16 * 2, _r2);
+        _mm512_storeu_ps(outptr + 16 * 3, _r3);
+        _mm512_storeu_ps(outptr + 16 * 4, _r4);
+        _mm512_storeu_ps(outptr + 16 * 5, _r5);
+        _mm512_storeu_ps(outptr + 16 * 6, _r6);
+        _mm512_storeu_ps(outptr + 16 * 7, _r7);
+        _mm512_storeu_ps(outptr + 16 * 8, _r8);
+        _mm512_storeu_ps(outptr + 16 * 9, _r9);
+        _mm512_storeu_ps(outptr + 16 * 10, _ra);
+        _mm512_storeu_ps(outptr + 16 * 11, _rb);
+        _mm512_storeu_ps(outptr + 16 * 12, _rc);
+        _mm512_storeu_ps(outptr + 16 * 13, _rd);
+        _mm512_storeu_ps(outptr + 16 * 14, _re);
+        _mm512_storeu_ps(outptr + 16 * 15, _rf);
+        return;
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        __m256 _r0 = _mm256_loadu_ps(ptr + lane_offsets[0]);
+        __m256 _r1 = _mm256_loadu_ps(ptr + lane_offsets[1]);
+        __m256 _r2 = _mm256_loadu_ps(ptr + lane_offsets[2]);
+        __m256 _r3 = _mm256_loadu_ps(ptr + lane_offsets[3]);
+        __m256 _r4 = _mm256_loadu_ps(ptr + lane_offsets[4]);
+        __m256 _r5 = _mm256_loadu_ps(ptr + lane_offsets[5]);
+        __m256 _r6 = _mm256_loadu_ps(ptr + lane_offsets[6]);
+        __m256 _r7 = _mm256_loadu_ps(ptr + lane_offsets[7]);
+        transpose8x8_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+        _mm256_storeu_ps(outptr, _r0);
+        _mm256_storeu_ps(outptr + 8, _r1);
+        _mm256_storeu_ps(outptr + 8 * 2, _r2);
+        _mm256_storeu_ps(outptr + 8 * 3, _r3);
+        _mm256_storeu_ps(outptr + 8 * 4, _r4);
+        _mm256_storeu_ps(outptr + 8 * 5, _r5);
+        _mm256_storeu_ps(outptr + 8 * 6, _r6);
+        _mm256_storeu_ps(outptr + 8 * 7, _r7);
+        return;
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        __m128 _r0 = _mm_loadu_ps(ptr + lane_offsets[0]);
+        __m128 _r1 = _mm_loadu_ps(ptr + lane_offsets[1]);
+        __m128 _r2 = _mm_loadu_ps(ptr + lane_offsets[2]);
+        __m128 _r3 = _mm_loadu_ps(ptr + lane_offsets[3]);
+        _MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+        _mm_storeu_ps(outptr, _r0);
+        _mm_storeu_ps(outptr + 4, _r1);
+        _mm_storeu_ps(outptr + 4 * 2, _r2);
+        _mm_storeu_ps(outptr + 4 * 3, _r3);
+        return;
+    }
+}
+
+static void permute_copy_vector(const float* ptr, float* outptr, int elempack)
+{
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        _mm512_storeu_ps(outptr, _mm512_loadu_ps(ptr));
+        return;
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        _mm256_storeu_ps(outptr, _mm256_loadu_ps(ptr));
+        return;
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        _mm_storeu_ps(outptr, _mm_loadu_ps(ptr));
+        return;
+    }
+
+    outptr[0] = ptr[0];
+}
+#endif // __SSE2__
+
+static void permute_packed(const Mat& bottom_blob, Mat& top_blob, const int* axes, const Option& opt)
+{
+    const int dims = bottom_blob.dims;
+    const int elempack = bottom_blob.elempack;
+    const int out_elempack = top_blob.elempack;
+    const int outer_axis = dims - 1;
+
+    // bottom extents and float strides per axis, the outer axis is addressed by group stride
+    int sizes[4] = {bottom_blob.w, 1, 1, 1};
+    size_t strides[4] = {(size_t)elempack, 0, 0, 0};
+    if (dims == 2)
+    {
+        sizes[1] = bottom_blob.h * elempack;
+    }
+    if (dims == 3)
+    {
+        sizes[1] = bottom_blob.h;
+        sizes[2] = bottom_blob.c * elempack;
+        strides[1] = (size_t)bottom_blob.w * elempack;
+    }
+    if (dims == 4)
+    {
+        sizes[1] = bottom_blob.h;
+        sizes[2] = bottom_blob.d;
+        sizes[3] = bottom_blob.c * elempack;
+        strides[1] = (size_t)bottom_blob.w * elempack;
+        strides[2] = (size_t)bottom_blob.w * bottom_blob.h * elempack;
+    }
+    const size_t gstride = dims == 2 ? (size_t)bottom_blob.w * elempack : bottom_blob.cstep * elempack;
+
+    const int outw = sizes[axes[0]];
+    const int outh = dims >= 3 ? sizes[axes[1]] : 1;
+    const int outd = dims == 4 ? sizes[axes[2]] : 1;
+    const int out_groups = sizes[axes[outer_axis]] / out_elempack;
+    const size_t out_gstride = dims == 2 ? (size_t)outw * out_elempack : top_blob.cstep * out_elempack;
+
+    // the top lanes walk bottom axis lane_axis, the top rows walk bottom axis row_axis
+    const int lane_axis = axes[outer_axis];
+    const int row_axis = axes[0];
+
+    // elempack x elempack register transposes when the row axis is contiguous in runs of out_elempack
+    const bool transpose_block = out_elempack > 1 && ((row_axis == outer_axis && elempack == out_elempack) || (row_axis == 0 && elempack == 1));
+    // every top vector is one bottom vector when the packed axis stays outermost
+    const bool copy_vector = out_elempack > 1 && lane_axis == outer_axis && elempack == out_elempack;
+    // plain row copy when neither side is packed and w stays innermost
+    const bool copy_row = out_elempack == 1 && elempack == 1 && row_axis == 0;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int g = 0; g < out_groups; g++)
+    {
+        size_t lane_offsets[16];
+        for (int l = 0; l < out_elempack; l++)
+        {
+            lane_offsets[l] = permute_offset(lane_axis, g * out_elempack + l, outer_axis, elempack, gstride, strides);
+        }
+
+        float* outptr = (float*)top_blob + g * out_gstride;
+
+        for (int z = 0; z < outd; z++)
+        {
+            for (int i = 0; i < outh; i++)
+            {
+                const float* ptr = bottom_blob;
+                if (dims == 4)
+                    ptr += permute_offset(axes[2], z, outer_axis, elempack, gstride, strides);
+                if (dims >= 3)
+                    ptr += permute_offset(axes[1], i, outer_axis, elempack, gstride, strides);
+
+                int j = 0;
+#if __SSE2__
+                if (transpose_block)
+                {
+                    for (; j + out_elempack - 1 < outw; j += out_elempack)
+                    {
+                        const float* p0 = ptr + permute_offset(row_axis, j, outer_axis, elempack, gstride, strides);
+                        permute_transpose_block(p0, lane_offsets, outptr, out_elempack);
+                        outptr += out_elempack * out_elempack;
+                    }
+                }
+                if (copy_vector)
+                {
+                    for (; j < outw; j++)
+                    {
+                        const float* p0 = ptr + lane_offsets[0] + permute_offset(row_axis, j, outer_axis, elempack, gstride, strides);
+                        permute_copy_vector(p0, outptr, out_elempack);
+                        outptr += out_elempack;
+                    }
+                }
+#endif // __SSE2__
+                if (copy_row)
+                {
+                    memcpy(outptr, ptr + lane_offsets[0], outw * sizeof(float));
+                    outptr += outw;
+                    j = outw;
+                }
+                for (; j < outw; j++)
+                {
+                    const float* p0 = ptr + permute_offset(row_axis, j, outer_axis, elempack, gstride, strides);
+                    for (int l = 0; l < out_elempack; l++)
+                    {
+                        outptr[l] = p0[lane_offsets[l]];
+                    }
+                    outptr += out_elempack;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "permute_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+#include <string.h>
+
+namespace ncnn {
+
+#include "permute_packed.h"
+
+Permute_x86::Permute_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+int Permute_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    // bottom axis of every top axis, w=0 h=1 d=2 c=3
+    static const int axes_3d[6][3] = {
+        {0, 1, 2}, // w h c
+        {1, 0, 2}, // h w c
+        {0, 2, 1}, // w c h
+        {2, 0, 1}, // c w h
+        {1, 2, 0}, // h c w
+        {2, 1, 0}, // c h w
+    };
+
+    static const int axes_4d[24][4] = {
+        {0, 1, 2, 3}, // w h d c
+        {1, 0, 2, 3}, // h w d c
+        {0, 2, 1, 3}, // w d h c
+        {2, 0, 1, 3}, // d w h c
+        {1, 2, 0, 3}, // h d w c
+        {2, 1, 0, 3}, // d h w c
+        {0, 1, 3, 2}, // w h c d
+        {1, 0, 3, 2}, // h w c d
+        {0, 3, 1, 2}, // w c h d
+        {3, 0, 1, 2}, // c w h d
+        {1, 3, 0, 2}, // h c w d
+        {3, 1, 0, 2}, // c h w d
+        {0, 2, 3, 1}, // w d c h
+        {2, 0, 3, 1}, // d w c h
+        {0, 3, 2, 1}, // w c d h
+        {3, 0, 2, 1}, // c w d h
+        {2, 3, 0, 1}, // d c w h
+        {3, 2, 0, 1}, // c d w h
+        {1, 2, 3, 0}, // h d c w
+        {2, 1, 3, 0}, // d h c w
+        {1, 3, 2, 0}, // h c d w
+        {3, 1, 2, 0}, // c h d w
+        {2, 3, 1, 0}, // d c h w
+        {3, 2, 1, 0}, // c d h w
+    };
+
+    static const int axes_2d[2][2] = {
+        {0, 1}, // w h
+        {1, 0}, // h w
+    };
+
+    const int dims = bottom_blob.dims;
+    const int elempack = bottom_blob.elempack;
+
+    if (dims == 1 || order_type == 0)
+    {
+        top_blob = bottom_blob;
+        return 0;
+    }
+
+    const int* axes = 0;
+    if (dims == 2 && order_type < 2)
+        axes = axes_2d[order_type];
+    if (dims == 3 && order_type < 6)
+        axes = axes_3d[order_type];
+    if (dims == 4 && order_type < 24)
+        axes = axes_4d[order_type];
+
+    if (!axes || bottom_blob.elembits() != 32)
+    {
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (elempack != 1)
+        {
+            Option opt_pack = opt;
+            opt_pack.blob_allocator = opt.workspace_allocator;
+
+            convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack);
+            if (bottom_blob_unpacked.empty())
+                return -100;
+        }
+
+        return Permute::forward(bottom_blob_unpacked, top_blob, opt);
+    }
+
+    // permuted extents
+    const int sizes[4] = {bottom_blob.w, bottom_blob.h, dims == 4 ? bottom_blob.d : bottom_blob.c, bottom_blob.c};
+    int out_sizes[4];
+    for (int k = 0; k < dims; k++)
+    {
+        // the outer axis carries the packed lanes
+        const int a = axes[k];
+        out_sizes[k] = a == dims - 1 ? sizes[dims == 2 ? 1 : dims == 3 ? 2 : 3] * elempack : sizes[a];
+    }
+
+    const int outer = out_sizes[dims - 1];
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = outer % 16 == 0 ? 16 : outer % 8 == 0 ? 8 : outer % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = outer % 8 == 0 ? 8 : outer % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = outer % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    const size_t out_elemsize = bottom_blob.elemsize / elempack * out_elempack;
+
+    if (dims == 2)
+        top_blob.create(out_sizes[0], outer / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (dims == 3)
+        top_blob.create(out_sizes[0], out_sizes[1], outer / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (dims == 4)
+        top_blob.create(out_sizes[0], out_sizes[1], out_sizes[2], outer / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    permute_packed(bottom_blob, top_blob, axes, opt);
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,314 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "pixelshuffle_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+namespace ncnn {
+
+PixelShuffle_x86::PixelShuffle_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+#if __SSE2__
+// mode 1, every sub-pixel plane is a run of whole input pack groups
+static void pixelshuffle_copy_pack(const float* sptr, float* outptr, int w, int elempack, int out_step)
+{
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            _mm512_storeu_ps(outptr, _mm512_loadu_ps(sptr));
+            sptr += 16;
+            outptr += out_step;
+        }
+        return;
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            _mm256_storeu_ps(outptr, _mm256_loadu_ps(sptr));
+            sptr += 8;
+            outptr += out_step;
+        }
+        return;
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            _mm_storeu_ps(outptr, _mm_loadu_ps(sptr));
+            sptr += 4;
+            outptr += out_step;
+        }
+        return;
+    }
+}
+
+// mode 0 with upscale_factor 2, the four sub-pixels of elempack output channels live in four consecutive input pack groups
+static void pixelshuffle_2x2_pack(const float* sptr, size_t cstep, float* outptr0, float* outptr1, int w, int elempack)
+{
+    const float* sptr0 = sptr;
+    const float* sptr1 = sptr + cstep;
+    const float* sptr2 = sptr + cstep * 2;
+    const float* sptr3 = sptr + cstep * 3;
+
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            __m512 _v0 = _mm512_loadu_ps(sptr0);
+            __m512 _v1 = _mm512_loadu_ps(sptr1);
+            __m512 _v2 = _mm512_loadu_ps(sptr2);
+            __m512 _v3 = _mm512_loadu_ps(sptr3);
+
+            // gather the 128bit block of each output channel quartet
+            __m512 _a0 = _mm512_shuffle_f32x4(_v0, _v1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 _a1 = _mm512_shuffle_f32x4(_v0, _v1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m512 _a2 = _mm512_shuffle_f32x4(_v2, _v3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 _a3 = _mm512_shuffle_f32x4(_v2, _v3, _MM_SHUFFLE(3, 2, 3, 2));
+            __m512 _r0 = _mm512_shuffle_f32x4(_a0, _a2, _MM_SHUFFLE(2, 0, 2, 0));
+            __m512 _r1 = _mm512_shuffle_f32x4(_a0, _a2, _MM_SHUFFLE(3, 1, 3, 1));
+            __m512 _r2 = _mm512_shuffle_f32x4(_a1, _a3, _MM_SHUFFLE(2, 0, 2, 0));
+            __m512 _r3 = _mm512_shuffle_f32x4(_a1, _a3, _MM_SHUFFLE(3, 1, 3, 1));
+
+            // 4x4 transpose inside every 128bit lane
+            __m512 _t0 = _mm512_unpacklo_ps(_r0, _r1);
+            __m512 _t1 = _mm512_unpackhi_ps(_r0, _r1);
+            __m512 _t2 = _mm512_unpacklo_ps(_r2, _r3);
+            __m512 _t3 = _mm512_unpackhi_ps(_r2, _r3);
+            __m512 _k0 = _mm512_shuffle_ps(_t0, _t2, _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 _k1 = _mm512_shuffle_ps(_t0, _t2, _MM_SHUFFLE(3, 2, 3, 2));
+            __m512 _k2 = _mm512_shuffle_ps(_t1, _t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m512 _k3 = _mm512_shuffle_ps(_t1, _t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm512_storeu_ps(outptr0, _k0);
+            _mm512_storeu_ps(outptr0 + 16, _k1);
+            _mm512_storeu_ps(outptr1, _k2);
+            _mm512_storeu_ps(outptr1 + 16, _k3);
+
+            sptr0 += 16;
+            sptr1 += 16;
+            sptr2 += 16;
+            sptr3 += 16;
+            outptr0 += 32;
+            outptr1 += 32;
+        }
+        return;
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            __m256 _v0 = _mm256_loadu_ps(sptr0);
+            __m256 _v1 = _mm256_loadu_ps(sptr1);
+            __m256 _v2 = _mm256_loadu_ps(sptr2);
+            __m256 _v3 = _mm256_loadu_ps(sptr3);
+
+            // pair output channel l with l + 4 across the two 128bit lanes
+            __m256 _r0 = _mm256_permute2f128_ps(_v0, _v2, _MM_SHUFFLE(0, 2, 0, 0));
+            __m256 _r1 = _mm256_permute2f128_ps(_v0, _v2, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256 _r2 = _mm256_permute2f128_ps(_v1, _v3, _MM_SHUFFLE(0, 2, 0, 0));
+            __m256 _r3 = _mm256_permute2f128_ps(_v1, _v3, _MM_SHUFFLE(0, 3, 0, 1));
+
+            // 4x4 transpose inside every 128bit lane
+            __m256 _t0 = _mm256_unpacklo_ps(_r0, _r1);
+            __m256 _t1 = _mm256_unpackhi_ps(_r0, _r1);
+            __m256 _t2 = _mm256_unpacklo_ps(_r2, _r3);
+            __m256 _t3 = _mm256_unpackhi_ps(_r2, _r3);
+            __m256 _k0 = _mm256_shuffle_ps(_t0, _t2, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 _k1 = _mm256_shuffle_ps(_t0, _t2, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 _k2 = _mm256_shuffle_ps(_t1, _t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 _k3 = _mm256_shuffle_ps(_t1, _t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            _mm256_storeu_ps(outptr0, _k0);
+            _mm256_storeu_ps(outptr0 + 8, _k1);
+            _mm256_storeu_ps(outptr1, _k2);
+            _mm256_storeu_ps(outptr1 + 8, _k3);
+
+            sptr0 += 8;
+            sptr1 += 8;
+            sptr2 += 8;
+            sptr3 += 8;
+            outptr0 += 16;
+            outptr1 += 16;
+        }
+        return;
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        for (int j = 0; j < w; j++)
+        {
+            __m128 _k0 = _mm_loadu_ps(sptr0);
+            __m128 _k1 = _mm_loadu_ps(sptr1);
+            __m128 _k2 = _mm_loadu_ps(sptr2);
+            __m128 _k3 = _mm_loadu_ps(sptr3);
+            _MM_TRANSPOSE4_PS(_k0, _k1, _k2, _k3);
+
+            _mm_storeu_ps(outptr0, _k0);
+            _mm_storeu_ps(outptr0 + 4, _k1);
+            _mm_storeu_ps(outptr1, _k2);
+            _mm_storeu_ps(outptr1 + 4, _k3);
+
+            sptr0 += 4;
+            sptr1 += 4;
+            sptr2 += 4;
+            sptr3 += 4;
+            outptr0 += 8;
+            outptr1 += 8;
+        }
+        return;
+    }
+}
+#endif // __SSE2__
+
+int PixelShuffle_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int channels = bottom_blob.c;
+    const size_t elemsize = bottom_blob.elemsize;
+    const int elempack = bottom_blob.elempack;
+
+    const int r = upscale_factor;
+    const int outw = w * r;
+    const int outh = h * r;
+    const int outc = channels * elempack / (r * r);
+
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout)
+    {
+#if __AVX512F__
+        out_elempack = outc % 16 == 0 ? 16 : outc % 8 == 0 ? 8 : outc % 4 == 0 ? 4 : 1;
+#elif __AVX__
+        out_elempack = outc % 8 == 0 ? 8 : outc % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = outc % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    const size_t out_elemsize = elemsize / elempack * out_elempack;
+
+    top_blob.create(outw, outh, outc / out_elempack, out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+#if __SSE2__
+    if (mode == 1 && elempack > 1 && elempack == out_elempack)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < outc / out_elempack; p++)
+        {
+            Mat m = top_blob.channel(p);
+
+            for (int sh = 0; sh < r; sh++)
+            {
+                for (int sw = 0; sw < r; sw++)
+                {
+                    const int q = (sh * r + sw) * (outc / elempack) + p;
+
+                    const float* sptr = bottom_blob.channel(q);
+
+                    for (int i = 0; i < h; i++)
+                    {
+                        float* outptr = m.row(i * r + sh) + sw * elempack;
+
+                        pixelshuffle_copy_pack(sptr, outptr, w, elempack, r * elempack);
+
+                        sptr += w * elempack;
+                    }
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    if (mode == 0 && r == 2 && elempack > 1 && elempack == out_elempack)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < outc / out_elempack; p++)
+        {
+            Mat m = top_blob.channel(p);
+
+            const float* sptr = bottom_blob.channel(p * 4);
+
+            for (int i = 0; i < h; i++)
+            {
+                float* outptr0 = m.row(i * 2);
+                float* outptr1 = m.row(i * 2 + 1);
+
+                pixelshuffle_2x2_pack(sptr, bottom_blob.cstep * elempack, outptr0, outptr1, w, elempack);
+
+                sptr += w * elempack;
+            }
+        }
+
+        return 0;
+    }
+#endif // __SSE2__
+
+    // gather every output lane from its input lane
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < outc / out_elempack; p++)
+    {
+        Mat m = top_blob.channel(p);
+
+        for (int sh = 0; sh < r; sh++)
+        {
+            for (int sw = 0; sw < r; sw++)
+            {
+                for (int l = 0; l < out_elempack; l++)
+                {
+                    const int pp = p * out_elempack + l;
+
+                    int q;
+                    if (mode == 0)
+                        q = pp * r * r + sh * r + sw;
+                    else // if (mode == 1)
+                        q = (sh * r + sw) * outc + pp;
+
+                    const float* sptr = (const float*)bottom_blob.channel(q / elempack) + q % elempack;
+
+                    for (int i = 0; i < h; i++)
+                    {
+                        float* outptr = m.row(i * r + sh) + sw * out_elempack + l;
+
+                        for (int j = 0; j < w; j++)
+                        {
+                            outptr[0] = sptr[0];
+
+                            sptr += elempack;
+                            outptr += r * out_elempack;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
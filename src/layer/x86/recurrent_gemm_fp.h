@@ -0,0 +1,336 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// rows of the M x K weight are grouped by 16, 8, 4 and 1
+// each group stores its rows interleaved, k-th column of the group at kptr + k * group_size
+// the group starting at row ii begins at ii * K
+
+#if NCNN_IMPL_FP16S
+static void recurrent_transform_weight_fp16s(const Mat& weight, Mat& weight_tm, int M, int K)
+#else
+static void recurrent_transform_weight(const Mat& weight, Mat& weight_tm, int M, int K)
+#endif
+{
+#if NCNN_IMPL_FP16S
+    unsigned short* pp = weight_tm;
+#else
+    float* pp = weight_tm;
+#endif
+
+    int ii = 0;
+    int group_size = 1;
+    for (; ii < M; ii += group_size)
+    {
+        group_size = 1;
+#if __SSE2__
+        if (ii + 3 < M)
+            group_size = 4;
+#if __AVX__
+        if (ii + 7 < M)
+            group_size = 8;
+#if __AVX512F__
+        if (ii + 15 < M)
+            group_size = 16;
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+        for (int k = 0; k < K; k++)
+        {
+            for (int i = 0; i < group_size; i++)
+            {
+                const float* p0 = weight.row(ii + i);
+#if NCNN_IMPL_FP16S
+                *pp++ = float32_to_float16(p0[k]);
+#else
+                *pp++ = p0[k];
+#endif
+            }
+        }
+    }
+}
+
+// Y = bias + X * weight^T
+// X is K x T, Y is M x T, bias may be null
+#if NCNN_IMPL_FP16S
+static void recurrent_gemm_fp16s(const Mat& X, const Mat& weight_tm, const float* bias, Mat& Y, int M, const Option& opt)
+#else
+static void recurrent_gemm(const Mat& X, const Mat& weight_tm, const float* bias, Mat& Y, int M, const Option& opt)
+#endif
+{
+    const int K = X.w;
+    const int T = X.h;
+
+#if NCNN_IMPL_FP16S
+    const unsigned short* weight_ptr = weight_tm;
+#else
+    const float* weight_ptr = weight_tm;
+#endif
+
+    int remain_M_start = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    {
+        const int nn_M = (M - remain_M_start) / 16;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int pp = 0; pp < nn_M; pp++)
+        {
+            const int ii = remain_M_start + pp * 16;
+
+            __m512 _bias = bias ? _mm512_loadu_ps(bias + ii) : _mm512_setzero_ps();
+
+            int t = 0;
+            for (; t + 3 < T; t += 4)
+            {
+                const float* x0 = X.row(t);
+                const float* x1 = X.row(t + 1);
+                const float* x2 = X.row(t + 2);
+                const float* x3 = X.row(t + 3);
+
+                __m512 _sum0 = _bias;
+                __m512 _sum1 = _bias;
+                __m512 _sum2 = _bias;
+                __m512 _sum3 = _bias;
+
+#if NCNN_IMPL_FP16S
+                const unsigned short* kptr = weight_ptr + ii * K;
+#else
+                const float* kptr = weight_ptr + ii * K;
+#endif
+                for (int k = 0; k < K; k++)
+                {
+#if NCNN_IMPL_FP16S
+                    __m512 _w = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)kptr));
+#else
+                    __m512 _w = _mm512_loadu_ps(kptr);
+#endif
+                    _sum0 = _mm512_fmadd_ps(_mm512_set1_ps(x0[k]), _w, _sum0);
+                    _sum1 = _mm512_fmadd_ps(_mm512_set1_ps(x1[k]), _w, _sum1);
+                    _sum2 = _mm512_fmadd_ps(_mm512_set1_ps(x2[k]), _w, _sum2);
+                    _sum3 = _mm512_fmadd_ps(_mm512_set1_ps(x3[k]), _w, _sum3);
+
+                    kptr += 16;
+                }
+
+                _mm512_storeu_ps(Y.row(t) + ii, _sum0);
+                _mm512_storeu_ps(Y.row(t + 1) + ii, _sum1);
+                _mm512_storeu_ps(Y.row(t + 2) + ii, _sum2);
+                _mm512_storeu_ps(Y.row(t + 3) + ii, _sum3);
+            }
+            for (; t < T; t++)
+            {
+                const float* x0 = X.row(t);
+
+                __m512 _sum0 = _bias;
+
+#if NCNN_IMPL_FP16S
+                const unsigned short* kptr = weight_ptr + ii * K;
+#else
+                const float* kptr = weight_ptr + ii * K;
+#endif
+                for (int k = 0; k < K; k++)
+                {
+#if NCNN_IMPL_FP16S
+                    __m512 _w = _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)kptr));
+#else
+                    __m512 _w = _mm512_loadu_ps(kptr);
+#endif
+                    _sum0 = _mm512_fmadd_ps(_mm512_set1_ps(x0[k]), _w, _sum0);
+
+                    kptr += 16;
+                }
+
+                _mm512_storeu_ps(Y.row(t) + ii, _sum0);
+            }
+        }
+
+        remain_M_start += nn_M * 16;
+    }
+#endif // __AVX512F__
+    {
+        const int nn_M = (M - remain_M_start) / 8;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int pp = 0; pp < nn_M; pp++)
+        {
+            const int ii = remain_M_start + pp * 8;
+
+            __m256 _bias = bias ? _mm256_loadu_ps(bias + ii) : _mm256_setzero_ps();
+
+            int t = 0;
+            for (; t + 3 < T; t += 4)
+            {
+                const float* x0 = X.row(t);
+                const float* x1 = X.row(t + 1);
+                const float* x2 = X.row(t + 2);
+                const float* x3 = X.row(t + 3);
+
+                __m256 _sum0 = _bias;
+                __m256 _sum1 = _bias;
+                __m256 _sum2 = _bias;
+                __m256 _sum3 = _bias;
+
+#if NCNN_IMPL_FP16S
+                const unsigned short* kptr = weight_ptr + ii * K;
+#else
+                const float* kptr = weight_ptr + ii * K;
+#endif
+                for (int k = 0; k < K; k++)
+                {
+#if NCNN_IMPL_FP16S
+                    __m256 _w = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)kptr));
+#else
+                    __m256 _w = _mm256_loadu_ps(kptr);
+#endif
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_set1_ps(x0[k]), _w, _sum0);
+                    _sum1 = _mm256_comp_fmadd_ps(_mm256_set1_ps(x1[k]), _w, _sum1);
+                    _sum2 = _mm256_comp_fmadd_ps(_mm256_set1_ps(x2[k]), _w, _sum2);
+                    _sum3 = _mm256_comp_fmadd_ps(_mm256_set1_ps(x3[k]), _w, _sum3);
+
+                    kptr += 8;
+                }
+
+                _mm256_storeu_ps(Y.row(t) + ii, _sum0);
+                _mm256_storeu_ps(Y.row(t + 1) + ii, _sum1);
+                _mm256_storeu_ps(Y.row(t + 2) + ii, _sum2);
+                _mm256_storeu_ps(Y.row(t + 3) + ii, _sum3);
+            }
+            for (; t < T; t++)
+            {
+                const float* x0 = X.row(t);
+
+                __m256 _sum0 = _bias;
+
+#if NCNN_IMPL_FP16S
+                const unsigned short* kptr = weight_ptr + ii * K;
+#else
+                const float* kptr = weight_ptr + ii * K;
+#endif
+                for (int k = 0; k < K; k++)
+                {
+#if NCNN_IMPL_FP16S
+                    __m256 _w = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)kptr));
+#else
+                    __m256 _w = _mm256_loadu_ps(kptr);
+#endif
+                    _sum0 = _mm256_comp_fmadd_ps(_mm256_set1_ps(x0[k]), _w, _sum0);
+
+                    kptr += 8;
+                }
+
+                _mm256_storeu_ps(Y.row(t) + ii, _sum0);
+            }
+        }
+
+        remain_M_start += nn_M * 8;
+    }
+#endif // __AVX__
+    {
+        const int nn_M = (M - remain_M_start) / 4;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int pp = 0; pp < nn_M; pp++)
+        {
+            const int ii = remain_M_start + pp * 4;
+
+            __m128 _bias = bias ? _mm_loadu_ps(bias + ii) : _mm_setzero_ps();
+
+            int t = 0;
+            for (; t + 3 < T; t += 4)
+            {
+                const float* x0 = X.row(t);
+                const float* x1 = X.row(t + 1);
+                const float* x2 = X.row(t + 2);
+                const float* x3 = X.row(t + 3);
+
+                __m128 _sum0 = _bias;
+                __m128 _sum1 = _bias;
+                __m128 _sum2 = _bias;
+                __m128 _sum3 = _bias;
+
+#if NCNN_IMPL_FP16S
+                const unsigned short* kptr = weight_ptr + ii * K;
+#else
+                const float* kptr = weight_ptr + ii * K;
+#endif
+                for (int k = 0; k < K; k++)
+                {
+#if NCNN_IMPL_FP16S
+                    __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
+#else
+                    __m128 _w = _mm_loadu_ps(kptr);
+#endif
+                    _sum0 = _mm_comp_fmadd_ps(_mm_set1_ps(x0[k]), _w, _sum0);
+                    _sum1 = _mm_comp_fmadd_ps(_mm_set1_ps(x1[k]), _w, _sum1);
+                    _sum2 = _mm_comp_fmadd_ps(_mm_set1_ps(x2[k]), _w, _sum2);
+                    _sum3 = _mm_comp_fmadd_ps(_mm_set1_ps(x3[k]), _w, _sum3);
+
+                    kptr += 4;
+                }
+
+                _mm_storeu_ps(Y.row(t) + ii, _sum0);
+                _mm_storeu_ps(Y.row(t + 1) + ii, _sum1);
+                _mm_storeu_ps(Y.row(t + 2) + ii, _sum2);
+                _mm_storeu_ps(Y.row(t + 3) + ii, _sum3);
+            }
+            for (; t < T; t++)
+            {
+                const float* x0 = X.row(t);
+
+                __m128 _sum0 = _bias;
+
+#if NCNN_IMPL_FP16S
+                const unsigned short* kptr = weight_ptr + ii * K;
+#else
+                const float* kptr = weight_ptr + ii * K;
+#endif
+                for (int k = 0; k < K; k++)
+                {
+#if NCNN_IMPL_FP16S
+                    __m128 _w = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)kptr));
+#else
+                    __m128 _w = _mm_loadu_ps(kptr);
+#endif
+                    _sum0 = _mm_comp_fmadd_ps(_mm_set1_ps(x0[k]), _w, _sum0);
+
+                    kptr += 4;
+                }
+
+                _mm_storeu_ps(Y.row(t) + ii, _sum0);
+            }
+        }
+
+        remain_M_start += nn_M * 4;
+    }
+#endif // __SSE2__
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = remain_M_start; ii < M; ii++)
+    {
+        const float b = bias ? bias[ii] : 0.f;
+
+        for (int t = 0; t < T; t++)
+        {
+            const float* x0 = X.row(t);
+
+#if NCNN_IMPL_FP16S
+            const unsigned short* kptr = weight_ptr + ii * K;
+#else
+            const float* kptr = weight_ptr + ii * K;
+#endif
+
+            float sum = b;
+            for (int k = 0; k < K; k++)
+            {
+#if NCNN_IMPL_FP16S
+                sum += x0[k] * float16_to_float32(kptr[k]);
+#else
+                sum += x0[k] * kptr[k];
+#endif
+            }
+
+            Y.row(t)[ii] = sum;
+        }
+    }
+}
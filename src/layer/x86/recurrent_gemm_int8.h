@@ -0,0 +1,192 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+// rows of the M x K int8 weight are grouped by 16, 8, 4 and 1
+// each group stores two columns of its rows at a time, k-th column pair of the group at kptr + k * group_size
+// the column count is padded to even with zero, the group starting at row ii begins at ii * K2 with K2 = (K + 1) / 2 * 2
+
+static void recurrent_transform_weight_int8(const Mat& weight, Mat& weight_tm, int M, int K)
+{
+    signed char* pp = weight_tm;
+
+    int ii = 0;
+    int group_size = 1;
+    for (; ii < M; ii += group_size)
+    {
+        group_size = 1;
+#if __SSE2__
+        if (ii + 3 < M)
+            group_size = 4;
+#if __AVX2__
+        if (ii + 7 < M)
+            group_size = 8;
+#if __AVX512F__
+        if (ii + 15 < M)
+            group_size = 16;
+#endif // __AVX512F__
+#endif // __AVX2__
+#endif // __SSE2__
+
+        for (int k = 0; k < K; k += 2)
+        {
+            for (int i = 0; i < group_size; i++)
+            {
+                const signed char* p0 = weight.row<const signed char>(ii + i);
+                pp[0] = p0[k];
+                pp[1] = k + 1 < K ? p0[k + 1] : 0;
+                pp += 2;
+            }
+        }
+    }
+}
+
+static NCNN_FORCEINLINE int recurrent_int8_pair(signed char x0, signed char x1)
+{
+    return (int)((unsigned short)(short)x0 | ((unsigned int)(unsigned short)(short)x1 << 16));
+}
+
+// Y = X * weight^T in int32
+// X is K x T int8, Y is M x T int32
+static void recurrent_gemm_int8(const Mat& X, const Mat& weight_tm, Mat& Y, int M, const Option& opt)
+{
+    const int K = X.w;
+    const int T = X.h;
+    const int K2 = (K + 1) / 2 * 2;
+
+    const signed char* weight_ptr = weight_tm;
+
+    int remain_M_start = 0;
+#if __SSE2__
+#if __AVX2__
+#if __AVX512F__
+    {
+        const int nn_M = (M - remain_M_start) / 16;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int pp = 0; pp < nn_M; pp++)
+        {
+            const int ii = remain_M_start + pp * 16;
+
+            for (int t = 0; t < T; t++)
+            {
+                const signed char* x0 = X.row<const signed char>(t);
+                const signed char* kptr = weight_ptr + ii * K2;
+
+                __m512i _sum = _mm512_setzero_si512();
+
+                int k = 0;
+                for (; k + 1 < K; k += 2)
+                {
+                    __m512i _w = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)kptr));
+                    __m512i _x = _mm512_set1_epi32(recurrent_int8_pair(x0[k], x0[k + 1]));
+                    _sum = _mm512_add_epi32(_sum, _mm512_madd_epi16(_w, _x));
+                    kptr += 32;
+                }
+                if (k < K)
+                {
+                    __m512i _w = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)kptr));
+                    __m512i _x = _mm512_set1_epi32(recurrent_int8_pair(x0[k], 0));
+                    _sum = _mm512_add_epi32(_sum, _mm512_madd_epi16(_w, _x));
+                }
+
+                _mm512_storeu_si512((__m512i*)(Y.row<int>(t) + ii), _sum);
+            }
+        }
+
+        remain_M_start += nn_M * 16;
+    }
+#endif // __AVX512F__
+    {
+        const int nn_M = (M - remain_M_start) / 8;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int pp = 0; pp < nn_M; pp++)
+        {
+            const int ii = remain_M_start + pp * 8;
+
+            for (int t = 0; t < T; t++)
+            {
+                const signed char* x0 = X.row<const signed char>(t);
+                const signed char* kptr = weight_ptr + ii * K2;
+
+                __m256i _sum = _mm256_setzero_si256();
+
+                int k = 0;
+                for (; k + 1 < K; k += 2)
+                {
+                    __m256i _w = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr));
+                    __m256i _x = _mm256_set1_epi32(recurrent_int8_pair(x0[k], x0[k + 1]));
+                    _sum = _mm256_add_epi32(_sum, _mm256_madd_epi16(_w, _x));
+                    kptr += 16;
+                }
+                if (k < K)
+                {
+                    __m256i _w = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)kptr));
+                    __m256i _x = _mm256_set1_epi32(recurrent_int8_pair(x0[k], 0));
+                    _sum = _mm256_add_epi32(_sum, _mm256_madd_epi16(_w, _x));
+                }
+
+                _mm256_storeu_si256((__m256i*)(Y.row<int>(t) + ii), _sum);
+            }
+        }
+
+        remain_M_start += nn_M * 8;
+    }
+#endif // __AVX2__
+    {
+        const int nn_M = (M - remain_M_start) / 4;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int pp = 0; pp < nn_M; pp++)
+        {
+            const int ii = remain_M_start + pp * 4;
+
+            for (int t = 0; t < T; t++)
+            {
+                const signed char* x0 = X.row<const signed char>(t);
+                const signed char* kptr = weight_ptr + ii * K2;
+
+                __m128i _sum = _mm_setzero_si128();
+
+                int k = 0;
+                for (; k + 1 < K; k += 2)
+                {
+                    __m128i _w = _mm_loadl_epi64((const __m128i*)kptr);
+                    _w = _mm_srai_epi16(_mm_unpacklo_epi8(_w, _w), 8);
+                    __m128i _x = _mm_set1_epi32(recurrent_int8_pair(x0[k], x0[k + 1]));
+                    _sum = _mm_add_epi32(_sum, _mm_madd_epi16(_w, _x));
+                    kptr += 8;
+                }
+                if (k < K)
+                {
+                    __m128i _w = _mm_loadl_epi64((const __m128i*)kptr);
+                    _w = _mm_srai_epi16(_mm_unpacklo_epi8(_w, _w), 8);
+                    __m128i _x = _mm_set1_epi32(recurrent_int8_pair(x0[k], 0));
+                    _sum = _mm_add_epi32(_sum, _mm_madd_epi16(_w, _x));
+                }
+
+                _mm_storeu_si128((__m128i*)(Y.row<int>(t) + ii), _sum);
+            }
+        }
+
+        remain_M_start += nn_M * 4;
+    }
+#endif // __SSE2__
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int ii = remain_M_start; ii < M; ii++)
+    {
+        for (int t = 0; t < T; t++)
+        {
+            const signed char* x0 = X.row<const signed char>(t);
+            const signed char* kptr = weight_ptr + ii * K2;
+
+            int sum = 0;
+            for (int k = 0; k < K; k++)
+            {
+                sum += x0[k] * kptr[k];
+            }
+
+            Y.row<int>(t)[ii] = sum;
+        }
+    }
+}
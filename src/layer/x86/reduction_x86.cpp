@@ -0,0 +1,823 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "reduction_x86.h"
+
+#include <float.h>
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+#include "x86_usability.h"
+
+namespace ncnn {
+
+Reduction_x86::Reduction_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+namespace Reduction_x86_functor {
+
+struct reduction_op_add
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return x + y;
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_add_ps(x, y);
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_add_ps(x, y);
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_add_ps(x, y);
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+struct reduction_op_mul
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return x * y;
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_mul_ps(x, y);
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_mul_ps(x, y);
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_mul_ps(x, y);
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+struct reduction_op_asum
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return x + fabsf(y);
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_add_ps(x, abs_ps(y));
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_add_ps(x, abs256_ps(y));
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_add_ps(x, abs512_ps(y));
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+struct reduction_op_sumsq
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return x + y * y;
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_comp_fmadd_ps(y, y, x);
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_comp_fmadd_ps(y, y, x);
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_fmadd_ps(y, y, x);
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+struct reduction_op_sumexp
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return x + expf(y);
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_add_ps(x, exp_ps(y));
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_add_ps(x, exp256_ps(y));
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_add_ps(x, exp512_ps(y));
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+struct reduction_op_max
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return std::max(x, y);
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_max_ps(x, y);
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_max_ps(x, y);
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_max_ps(x, y);
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+struct reduction_op_min
+{
+    NCNN_FORCEINLINE float func(const float& x, const float& y) const
+    {
+        return std::min(x, y);
+    }
+#if __SSE2__
+    NCNN_FORCEINLINE __m128 func_pack4(const __m128& x, const __m128& y) const
+    {
+        return _mm_min_ps(x, y);
+    }
+#if __AVX__
+    NCNN_FORCEINLINE __m256 func_pack8(const __m256& x, const __m256& y) const
+    {
+        return _mm256_min_ps(x, y);
+    }
+#if __AVX512F__
+    NCNN_FORCEINLINE __m512 func_pack16(const __m512& x, const __m512& y) const
+    {
+        return _mm512_min_ps(x, y);
+    }
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+};
+
+} // namespace Reduction_x86_functor
+
+// outptr[i] = op(outptr[i], ptr[i])
+template<typename Op>
+static void reduction_vertical(float* outptr, const float* ptr, int size)
+{
+    Op op;
+
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; i + 15 < size; i += 16)
+    {
+        __m512 _p = _mm512_loadu_ps(ptr);
+        __m512 _out = _mm512_loadu_ps(outptr);
+        _out = op.func_pack16(_out, _p);
+        _mm512_storeu_ps(outptr, _out);
+        ptr += 16;
+        outptr += 16;
+    }
+#endif // __AVX512F__
+    for (; i + 7 < size; i += 8)
+    {
+        __m256 _p = _mm256_loadu_ps(ptr);
+        __m256 _out = _mm256_loadu_ps(outptr);
+        _out = op.func_pack8(_out, _p);
+        _mm256_storeu_ps(outptr, _out);
+        ptr += 8;
+        outptr += 8;
+    }
+#endif // __AVX__
+    for (; i + 3 < size; i += 4)
+    {
+        __m128 _p = _mm_loadu_ps(ptr);
+        __m128 _out = _mm_loadu_ps(outptr);
+        _out = op.func_pack4(_out, _p);
+        _mm_storeu_ps(outptr, _out);
+        ptr += 4;
+        outptr += 4;
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        *outptr = op.func(*outptr, *ptr);
+        ptr++;
+        outptr++;
+    }
+}
+
+// fold ptr[0..size) into v0 with op, partial vector sums are combined with op2
+template<typename Op, typename Op2>
+static float reduction_horizontal(float v0, const float* ptr, int size)
+{
+    Op op;
+    Op2 op2;
+
+    float sum = v0;
+
+    int i = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    if (i + 15 < size)
+    {
+        __m512 _sum = _mm512_set1_ps(v0);
+        for (; i + 15 < size; i += 16)
+        {
+            __m512 _p = _mm512_loadu_ps(ptr);
+            _sum = op.func_pack16(_sum, _p);
+            ptr += 16;
+        }
+
+        float tmp[16];
+        _mm512_storeu_ps(tmp, _sum);
+        for (int j = 0; j < 16; j++)
+        {
+            sum = op2.func(sum, tmp[j]);
+        }
+    }
+#endif // __AVX512F__
+    if (i + 7 < size)
+    {
+        __m256 _sum = _mm256_set1_ps(v0);
+        for (; i + 7 < size; i += 8)
+        {
+            __m256 _p = _mm256_loadu_ps(ptr);
+            _sum = op.func_pack8(_sum, _p);
+            ptr += 8;
+        }
+
+        float tmp[8];
+        _mm256_storeu_ps(tmp, _sum);
+        for (int j = 0; j < 8; j++)
+        {
+            sum = op2.func(sum, tmp[j]);
+        }
+    }
+#endif // __AVX__
+    if (i + 3 < size)
+    {
+        __m128 _sum = _mm_set1_ps(v0);
+        for (; i + 3 < size; i += 4)
+        {
+            __m128 _p = _mm_loadu_ps(ptr);
+            _sum = op.func_pack4(_sum, _p);
+            ptr += 4;
+        }
+
+        float tmp[4];
+        _mm_storeu_ps(tmp, _sum);
+        for (int j = 0; j < 4; j++)
+        {
+            sum = op2.func(sum, tmp[j]);
+        }
+    }
+#endif // __SSE2__
+    for (; i < size; i++)
+    {
+        sum = op.func(sum, *ptr);
+        ptr++;
+    }
+
+    return sum;
+}
+
+// one axis of the blob, strides are in floats
+// reduced axes have out_stride 0
+struct reduction_axis
+{
+    int size;
+    size_t in_stride;
+    size_t out_stride;
+    int reduce;
+};
+
+static reduction_axis reduction_make_axis(int size, size_t in_stride, int reduce)
+{
+    reduction_axis axis;
+    axis.size = size;
+    axis.in_stride = in_stride;
+    axis.out_stride = 0;
+    axis.reduce = reduce;
+    return axis;
+}
+
+// drop unit axes and merge neighbours that are contiguous in both input and output
+static int reduction_merge_axes(reduction_axis* axes, int naxes)
+{
+    int n = 0;
+    for (int i = 0; i < naxes; i++)
+    {
+        if (axes[i].size == 1)
+            continue;
+
+        if (n > 0)
+        {
+            reduction_axis& a = axes[n - 1];
+            const reduction_axis& b = axes[i];
+            if (a.reduce == b.reduce && a.in_stride == b.size * b.in_stride && a.out_stride == b.size * b.out_stride)
+            {
+                a.size *= b.size;
+                a.in_stride = b.in_stride;
+                a.out_stride = b.out_stride;
+                continue;
+            }
+        }
+
+        axes[n++] = axes[i];
+    }
+
+    if (n == 0)
+    {
+        // all unit axes
+        axes[0] = axes[naxes - 1];
+        n = 1;
+    }
+
+    return n;
+}
+
+// accumulate the strided input into out, which must be initialized with v0
+// the innermost axis is contiguous, threads are spread over the outermost kept axis
+template<typename Op, typename Op2>
+static void reduction(const float* in, float* out, const reduction_axis* _axes, int _naxes, float v0, const Option& opt)
+{
+    reduction_axis axes[6];
+    for (int i = 0; i < _naxes; i++)
+    {
+        axes[i] = _axes[i];
+    }
+    int naxes = reduction_merge_axes(axes, _naxes);
+
+    if (axes[naxes - 1].in_stride != 1 || (!axes[naxes - 1].reduce && axes[naxes - 1].out_stride != 1))
+    {
+        // strided innermost axis, such as channels of 1x1 blobs
+        axes[naxes].size = 1;
+        axes[naxes].in_stride = 1;
+        axes[naxes].out_stride = axes[naxes - 1].reduce ? 0 : 1;
+        axes[naxes].reduce = axes[naxes - 1].reduce;
+        naxes++;
+    }
+
+    const reduction_axis& inner = axes[naxes - 1];
+
+    int parallel_axis = -1;
+    for (int i = 0; i < naxes; i++)
+    {
+        if (!axes[i].reduce)
+        {
+            parallel_axis = i;
+            break;
+        }
+    }
+
+    // the innermost kept axis is split into blocks so that each thread owns its output range
+    int nn = 1;
+    int block = inner.size;
+    if (parallel_axis == naxes - 1)
+    {
+        block = (inner.size + opt.num_threads - 1) / opt.num_threads;
+        block = std::max((block + 15) / 16 * 16, 64);
+        nn = (inner.size + block - 1) / block;
+    }
+    else if (parallel_axis >= 0)
+    {
+        nn = axes[parallel_axis].size;
+    }
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int pp = 0; pp < nn; pp++)
+    {
+        Op2 op2;
+
+        const float* ptr0 = in;
+        float* outptr0 = out;
+        int size = inner.size;
+        if (parallel_axis == naxes - 1)
+        {
+            const int start = pp * block;
+            size = std::min(block, inner.size - start);
+            ptr0 += start;
+            outptr0 += start;
+        }
+        else if (parallel_axis >= 0)
+        {
+            ptr0 += pp * axes[parallel_axis].in_stride;
+            outptr0 += pp * axes[parallel_axis].out_stride;
+        }
+
+        int index[6] = {0};
+        for (;;)
+        {
+            const float* ptr = ptr0;
+            float* outptr = outptr0;
+            for (int i = 0; i < naxes - 1; i++)
+            {
+                ptr += index[i] * axes[i].in_stride;
+                outptr += index[i] * axes[i].out_stride;
+            }
+
+            if (inner.reduce)
+            {
+                outptr[0] = op2.func(outptr[0], reduction_horizontal<Op, Op2>(v0, ptr, size));
+            }
+            else
+            {
+                reduction_vertical<Op>(outptr, ptr, size);
+            }
+
+            // step to the next row of the outer axes
+            int i = naxes - 2;
+            for (; i >= 0; i--)
+            {
+                if (i == parallel_axis)
+                    continue;
+
+                index[i]++;
+                if (index[i] < axes[i].size)
+                    break;
+
+                index[i] = 0;
+            }
+
+            if (i < 0)
+                break;
+        }
+    }
+}
+
+template<typename Op, typename Op2>
+static void reduction_op(const float* in, float* out, const reduction_axis* axes, int naxes, float v0, const Option& opt)
+{
+    reduction<Op, Op2>(in, out, axes, naxes, v0, opt);
+}
+
+static void reduction_op(const float* in, float* out, const reduction_axis* axes, int naxes, float v0, int op_type, const Option& opt)
+{
+    using namespace Reduction_x86_functor;
+
+    if (op_type == Reduction::ReductionOp_SUM) return reduction_op<reduction_op_add, reduction_op_add>(in, out, axes, naxes, v0, opt);
+    if (op_type == Reduction::ReductionOp_ASUM) return reduction_op<reduction_op_asum, reduction_op_add>(in, out, axes, naxes, v0, opt);
+    if (op_type == Reduction::ReductionOp_SUMSQ) return reduction_op<reduction_op_sumsq, reduction_op_add>(in, out, axes, naxes, v0, opt);
+    if (op_type == Reduction::ReductionOp_PROD) return reduction_op<reduction_op_mul, reduction_op_mul>(in, out, axes, naxes, v0, opt);
+    if (op_type == Reduction::ReductionOp_MAX) return reduction_op<reduction_op_max, reduction_op_max>(in, out, axes, naxes, v0, opt);
+    if (op_type == Reduction::ReductionOp_MIN) return reduction_op<reduction_op_min, reduction_op_min>(in, out, axes, naxes, v0, opt);
+    if (op_type == Reduction::ReductionOp_LogSumExp) return reduction_op<reduction_op_sumexp, reduction_op_add>(in, out, axes, naxes, v0, opt);
+}
+
+static void reduction_fill(Mat& m, float v)
+{
+    float* ptr = m;
+    const size_t size = m.total() * m.elempack;
+    for (size_t i = 0; i < size; i++)
+    {
+        ptr[i] = v;
+    }
+}
+
+int Reduction_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+    const int elempack = bottom_blob.elempack;
+
+    bool reduce_w = false;
+    bool reduce_h = false;
+    bool reduce_d = false;
+    bool reduce_c = false;
+
+    if (reduce_all)
+    {
+        reduce_w = true;
+        reduce_h = true;
+        reduce_d = true;
+        reduce_c = true;
+    }
+    else
+    {
+        int axes_flag[4] = {0};
+
+        const int* axes_ptr = axes;
+        for (int i = 0; i < axes.w; i++)
+        {
+            int axis = axes_ptr[i];
+            // handle negative axis
+            if (axis < 0)
+                axis += dims;
+            axes_flag[axis] = 1;
+        }
+
+        if (dims == 1)
+        {
+            reduce_w = true;
+        }
+        else if (dims == 2)
+        {
+            if (axes_flag[0] == 1) reduce_h = true;
+            if (axes_flag[1] == 1) reduce_w = true;
+        }
+        else if (dims == 3)
+        {
+            if (axes_flag[0] == 1) reduce_c = true;
+            if (axes_flag[1] == 1) reduce_h = true;
+            if (axes_flag[2] == 1) reduce_w = true;
+        }
+        else if (dims == 4)
+        {
+            if (axes_flag[0] == 1) reduce_c = true;
+            if (axes_flag[1] == 1) reduce_d = true;
+            if (axes_flag[2] == 1) reduce_h = true;
+            if (axes_flag[3] == 1) reduce_w = true;
+        }
+    }
+
+    int op_type = Reduction::ReductionOp_SUM;
+    int op2_type = Reduction::ReductionOp_SUM;
+    float v0 = 0.f;
+
+    switch (operation)
+    {
+    case Reduction::ReductionOp_ASUM:
+    case Reduction::ReductionOp_L1:
+        op_type = Reduction::ReductionOp_ASUM;
+        break;
+    case Reduction::ReductionOp_SUMSQ:
+    case Reduction::ReductionOp_L2:
+        op_type = Reduction::ReductionOp_SUMSQ;
+        break;
+    case Reduction::ReductionOp_MAX:
+        op_type = Reduction::ReductionOp_MAX;
+        op2_type = Reduction::ReductionOp_MAX;
+        v0 = -FLT_MAX;
+        break;
+    case Reduction::ReductionOp_MIN:
+        op_type = Reduction::ReductionOp_MIN;
+        op2_type = Reduction::ReductionOp_MIN;
+        v0 = FLT_MAX;
+        break;
+    case Reduction::ReductionOp_PROD:
+        op_type = Reduction::ReductionOp_PROD;
+        op2_type = Reduction::ReductionOp_PROD;
+        v0 = 1.f;
+        break;
+    case Reduction::ReductionOp_LogSumExp:
+        op_type = Reduction::ReductionOp_LogSumExp;
+        break;
+    default:
+        break;
+    }
+
+    // axes of the blob from outermost to innermost, the outermost one is the packed one
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int d = bottom_blob.d;
+    const int channels = bottom_blob.c;
+
+    reduction_axis axes[5];
+    int naxes = 0;
+    if (dims == 4)
+    {
+        axes[naxes++] = reduction_make_axis(channels, bottom_blob.cstep * elempack, reduce_c);
+        axes[naxes++] = reduction_make_axis(d, (size_t)w * h * elempack, reduce_d);
+    }
+    if (dims == 3)
+    {
+        axes[naxes++] = reduction_make_axis(channels, bottom_blob.cstep * elempack, reduce_c);
+    }
+    if (dims >= 2)
+    {
+        axes[naxes++] = reduction_make_axis(h, (size_t)w * elempack, reduce_h);
+    }
+    axes[naxes++] = reduction_make_axis(w, (size_t)elempack, reduce_w);
+
+    // output keeps the packing when the packed axis survives
+    const int out_elempack = axes[0].reduce ? 1 : elempack;
+    const size_t out_elemsize = out_elempack * 4u;
+
+    int outshape[4];
+    int out_axis[4];
+    int out_dims = 0;
+    for (int i = 0; i < naxes; i++)
+    {
+        if (keepdims || !axes[i].reduce)
+        {
+            outshape[out_dims] = axes[i].reduce ? 1 : axes[i].size;
+            out_axis[out_dims] = i;
+            out_dims++;
+        }
+    }
+    if (out_dims == 0)
+    {
+        outshape[0] = 1;
+        out_axis[0] = -1;
+        out_dims = 1;
+    }
+
+    if (out_dims == 1)
+        top_blob.create(outshape[0], out_elemsize, out_elempack, opt.blob_allocator);
+    if (out_dims == 2)
+        top_blob.create(outshape[1], outshape[0], out_elemsize, out_elempack, opt.blob_allocator);
+    if (out_dims == 3)
+        top_blob.create(outshape[2], outshape[1], outshape[0], out_elemsize, out_elempack, opt.blob_allocator);
+    if (out_dims == 4)
+        top_blob.create(outshape[3], outshape[2], outshape[1], outshape[0], out_elemsize, out_elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    {
+        size_t out_stride = out_elempack;
+        for (int i = out_dims - 1; i >= 0; i--)
+        {
+            if (i == 0 && out_dims >= 3)
+                out_stride = top_blob.cstep * out_elempack;
+
+            if (out_axis[i] >= 0 && !axes[out_axis[i]].reduce)
+                axes[out_axis[i]].out_stride = out_stride;
+
+            out_stride *= outshape[i];
+        }
+    }
+
+    const bool lane_reduced = elempack > 1 && axes[0].reduce;
+
+    bool all_reduced = true;
+    for (int i = 0; i < naxes; i++)
+    {
+        if (!axes[i].reduce)
+            all_reduced = false;
+    }
+
+    if (elempack > 1)
+    {
+        axes[naxes] = reduction_make_axis(elempack, 1, lane_reduced);
+        axes[naxes].out_stride = lane_reduced ? 0 : 1;
+        naxes++;
+    }
+
+    // the element count folded into each output, for mean
+    int count = 1;
+    for (int i = 0; i < naxes; i++)
+    {
+        if (axes[i].reduce)
+            count *= axes[i].size;
+    }
+
+    bool staged = lane_reduced;
+    if (all_reduced)
+    {
+        // a blob that is contiguous as a whole is folded in one go
+        reduction_axis merged[5];
+        for (int i = 0; i < naxes; i++)
+        {
+            merged[i] = axes[i];
+        }
+        staged = reduction_merge_axes(merged, naxes) > 1;
+    }
+
+    if (!staged)
+    {
+        reduction_fill(top_blob, v0);
+
+        reduction_op(bottom_blob, top_blob, axes, naxes, v0, op_type, opt);
+    }
+    else
+    {
+        // reduce into a workspace that keeps the lanes and the outermost axis apart,
+        // then fold them with op2, so the hot loop never reduces across lanes
+        reduction_axis axes1[5];
+        for (int i = 0; i < naxes; i++)
+        {
+            axes1[i] = axes[i];
+        }
+        if (all_reduced)
+            axes1[0].reduce = 0;
+        if (elempack > 1)
+            axes1[naxes - 1].reduce = 0;
+
+        size_t ws_size = 1;
+        for (int i = naxes - 1; i >= 0; i--)
+        {
+            if (axes1[i].reduce)
+                continue;
+
+            axes1[i].out_stride = ws_size;
+            ws_size *= axes1[i].size;
+        }
+
+        Mat ws((int)ws_size, 4u, opt.workspace_allocator);
+        if (ws.empty())
+            return -100;
+
+        reduction_fill(ws, v0);
+
+        reduction_op(bottom_blob, ws, axes1, naxes, v0, op_type, opt);
+
+        reduction_axis axes2[5];
+        for (int i = 0; i < naxes; i++)
+        {
+            axes2[i].size = axes1[i].reduce ? 1 : axes[i].size;
+            axes2[i].in_stride = axes1[i].reduce ? 0 : axes1[i].out_stride;
+            axes2[i].out_stride = axes[i].out_stride;
+            axes2[i].reduce = axes[i].reduce;
+        }
+
+        reduction_fill(top_blob, v0);
+
+        reduction_op(ws, top_blob, axes2, naxes, v0, op2_type, opt);
+    }
+
+    const int size = (int)(top_blob.total() * out_elempack);
+    float* outptr = top_blob;
+
+    if (operation == Reduction::ReductionOp_LogSum || operation == Reduction::ReductionOp_LogSumExp)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < size; i++)
+        {
+            outptr[i] = logf(outptr[i]);
+        }
+    }
+
+    if (operation == Reduction::ReductionOp_L2)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < size; i++)
+        {
+            // flush subnormal input to zero as the reference implementation does
+            outptr[i] = sqrtf(outptr[i] < FLT_MIN ? 0.f : outptr[i]);
+        }
+    }
+
+    float scale = coeff;
+    if (operation == Reduction::ReductionOp_MEAN)
+    {
+        scale = coeff / count;
+    }
+
+    if (scale != 1.f)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int i = 0; i < size; i++)
+        {
+            outptr[i] = outptr[i] * scale;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,459 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "rnn_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#include "sse_mathfun.h"
+#if __AVX__
+#include <immintrin.h>
+#include "avx_mathfun.h"
+#if __AVX512F__
+#include "avx512_mathfun.h"
+#endif // __AVX512F__
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_activation.h"
+#include "x86_usability.h"
+
+#include "cpu.h"
+
+namespace ncnn {
+
+#include "recurrent_gemm_fp.h"
+
+#if NCNN_F16C && __F16C__
+#define NCNN_IMPL_FP16S 1
+#include "recurrent_gemm_fp.h"
+#undef NCNN_IMPL_FP16S
+#endif
+
+#if NCNN_INT8
+#include "recurrent_gemm_int8.h"
+
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__
+void rnn_transform_weight_int8_avx2(const Mat& weight, Mat& weight_tm, int M, int K);
+void rnn_gemm_int8_avx2(const Mat& X, const Mat& weight_tm, Mat& Y, int M, const Option& opt);
+#endif
+
+static void rnn_transform_weight_int8(const Mat& weight, Mat& weight_tm, int M, int K)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        rnn_transform_weight_int8_avx2(weight, weight_tm, M, K);
+        return;
+    }
+#endif
+
+    recurrent_transform_weight_int8(weight, weight_tm, M, K);
+}
+
+static void rnn_gemm_int8(const Mat& X, const Mat& weight_tm, Mat& Y, int M, const Option& opt)
+{
+#if NCNN_RUNTIME_CPU && NCNN_AVX2 && __AVX__ && !__AVX2__
+    if (ncnn::cpu_support_x86_avx2())
+    {
+        rnn_gemm_int8_avx2(X, weight_tm, Y, M, opt);
+        return;
+    }
+#endif
+
+    recurrent_gemm_int8(X, weight_tm, Y, M, opt);
+}
+#endif // NCNN_INT8
+
+RNN_x86::RNN_x86()
+{
+    one_blob_only = false;
+    support_inplace = false;
+}
+
+int RNN_x86::create_pipeline(const Option& opt)
+{
+    const int num_directions = direction == 2 ? 2 : 1;
+    const int size = weight_data_size / num_directions / num_output;
+
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        const int size2 = (size + 1) / 2 * 2;
+        const int num_output2 = (num_output + 1) / 2 * 2;
+
+        weight_xc_data_packed.create(size2 * num_output, 1, num_directions, (size_t)1u);
+        weight_hc_data_packed.create(num_output2 * num_output, 1, num_directions, (size_t)1u);
+        weight_xc_data_int8_descales.create(num_output, num_directions);
+        weight_hc_data_int8_descales.create(num_output, num_directions);
+        if (weight_xc_data_packed.empty() || weight_hc_data_packed.empty() || weight_xc_data_int8_descales.empty() || weight_hc_data_int8_descales.empty())
+            return -100;
+
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
+            Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
+
+            rnn_transform_weight_int8(weight_xc_data.channel(dr), weight_xc_data_packed_dr, num_output, size);
+            rnn_transform_weight_int8(weight_hc_data.channel(dr), weight_hc_data_packed_dr, num_output, num_output);
+
+            const float* weight_xc_int8_scales = weight_xc_data_int8_scales.row(dr);
+            const float* weight_hc_int8_scales = weight_hc_data_int8_scales.row(dr);
+            float* weight_xc_int8_descales = weight_xc_data_int8_descales.row(dr);
+            float* weight_hc_int8_descales = weight_hc_data_int8_descales.row(dr);
+            for (int i = 0; i < num_output; i++)
+            {
+                weight_xc_int8_descales[i] = 1.f / weight_xc_int8_scales[i];
+                weight_hc_int8_descales[i] = 1.f / weight_hc_int8_scales[i];
+            }
+        }
+
+        if (opt.lightmode)
+        {
+            weight_xc_data.release();
+            weight_hc_data.release();
+        }
+
+        return 0;
+    }
+#endif // NCNN_INT8
+
+#if NCNN_F16C && __F16C__
+    if (cpu_support_x86_f16c() && opt.use_fp16_storage)
+    {
+        weight_xc_data_packed.create(size * num_output, 1, num_directions, (size_t)2u);
+        weight_hc_data_packed.create(num_output * num_output, 1, num_directions, (size_t)2u);
+        if (weight_xc_data_packed.empty() || weight_hc_data_packed.empty())
+            return -100;
+
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
+            Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
+
+            recurrent_transform_weight_fp16s(weight_xc_data.channel(dr), weight_xc_data_packed_dr, num_output, size);
+            recurrent_transform_weight_fp16s(weight_hc_data.channel(dr), weight_hc_data_packed_dr, num_output, num_output);
+        }
+    }
+    else
+#endif // NCNN_F16C && __F16C__
+    {
+        weight_xc_data_packed.create(size * num_output, 1, num_directions, (size_t)4u);
+        weight_hc_data_packed.create(num_output * num_output, 1, num_directions, (size_t)4u);
+        if (weight_xc_data_packed.empty() || weight_hc_data_packed.empty())
+            return -100;
+
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            Mat weight_xc_data_packed_dr = weight_xc_data_packed.channel(dr);
+            Mat weight_hc_data_packed_dr = weight_hc_data_packed.channel(dr);
+
+            recurrent_transform_weight(weight_xc_data.channel(dr), weight_xc_data_packed_dr, num_output, size);
+            recurrent_transform_weight(weight_hc_data.channel(dr), weight_hc_data_packed_dr, num_output, num_output);
+        }
+    }
+
+    if (opt.lightmode)
+    {
+        weight_xc_data.release();
+        weight_hc_data.release();
+    }
+
+    return 0;
+}
+
+const char* RNN_x86::kernel_name() const
+{
+    if (weight_xc_data_packed.elembits() == 8)
+        return "int8_packed";
+
+    if (weight_xc_data_packed.elembits() == 16)
+        return "fp16s_packed";
+
+    return "packed";
+}
+
+// h_t := tanh(gates_x + gates_h), gates_x holds x projections plus bias
+static void rnn_gates(const float* gates_x, const float* gates_h, Mat& hidden_state, float* outptr, int num_output)
+{
+    float* hidden_ptr = hidden_state;
+
+    int q = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    for (; q + 15 < num_output; q += 16)
+    {
+        __m512 _H = tanh_avx512(_mm512_add_ps(_mm512_loadu_ps(gates_x + q), _mm512_loadu_ps(gates_h + q)));
+        _mm512_storeu_ps(hidden_ptr + q, _H);
+        _mm512_storeu_ps(outptr + q, _H);
+    }
+#endif // __AVX512F__
+    for (; q + 7 < num_output; q += 8)
+    {
+        __m256 _H = tanh_avx(_mm256_add_ps(_mm256_loadu_ps(gates_x + q), _mm256_loadu_ps(gates_h + q)));
+        _mm256_storeu_ps(hidden_ptr + q, _H);
+        _mm256_storeu_ps(outptr + q, _H);
+    }
+#endif // __AVX__
+    for (; q + 3 < num_output; q += 4)
+    {
+        __m128 _H = tanh_sse(_mm_add_ps(_mm_loadu_ps(gates_x + q), _mm_loadu_ps(gates_h + q)));
+        _mm_storeu_ps(hidden_ptr + q, _H);
+        _mm_storeu_ps(outptr + q, _H);
+    }
+#endif // __SSE2__
+    for (; q < num_output; q++)
+    {
+        float H = tanhf(gates_x[q] + gates_h[q]);
+
+        hidden_ptr[q] = H;
+        outptr[q] = H;
+    }
+}
+
+static int rnn(const Mat& bottom_blob, Mat& top_blob, int out_offset, int reverse, const Mat& weight_xc_packed, const Mat& bias_c, const Mat& weight_hc_packed, Mat& hidden_state, const Option& opt)
+{
+    const int T = bottom_blob.h;
+    const int num_output = hidden_state.w;
+
+    Mat gates_x(num_output, T, 4u, opt.workspace_allocator);
+    if (gates_x.empty())
+        return -100;
+
+    Mat gates_h(num_output, 4u, opt.workspace_allocator);
+    if (gates_h.empty())
+        return -100;
+
+    // input projection of all timesteps at once
+#if NCNN_F16C && __F16C__
+    if (weight_xc_packed.elembits() == 16)
+        recurrent_gemm_fp16s(bottom_blob, weight_xc_packed, bias_c, gates_x, num_output, opt);
+    else
+#endif
+        recurrent_gemm(bottom_blob, weight_xc_packed, bias_c, gates_x, num_output, opt);
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+#if NCNN_F16C && __F16C__
+        if (weight_hc_packed.elembits() == 16)
+            recurrent_gemm_fp16s(hidden_state, weight_hc_packed, 0, gates_h, num_output, opt);
+        else
+#endif
+            recurrent_gemm(hidden_state, weight_hc_packed, 0, gates_h, num_output, opt);
+
+        rnn_gates(gates_x.row(ti), gates_h, hidden_state, top_blob.row(ti) + out_offset, num_output);
+    }
+
+    return 0;
+}
+
+#if NCNN_INT8
+static int rnn_int8(const Mat& bottom_blob_int8, const Mat& bottom_blob_int8_scales, Mat& top_blob, int out_offset, int reverse, const Mat& weight_xc_packed, const float* weight_xc_int8_descales, const Mat& bias_c, const Mat& weight_hc_packed, const float* weight_hc_int8_descales, Mat& hidden_state, const Option& opt)
+{
+    const int T = bottom_blob_int8.h;
+    const int num_output = hidden_state.w;
+
+    Mat gates_x(num_output, T, 4u, opt.workspace_allocator);
+    if (gates_x.empty())
+        return -100;
+
+    Mat gates_h(num_output, 4u, opt.workspace_allocator);
+    if (gates_h.empty())
+        return -100;
+
+    Mat gates_int32(num_output, T, 4u, opt.workspace_allocator);
+    if (gates_int32.empty())
+        return -100;
+
+    // input projection of all timesteps at once
+    rnn_gemm_int8(bottom_blob_int8, weight_xc_packed, gates_int32, num_output, opt);
+
+    const float* bias_c_ptr = bias_c;
+    for (int t = 0; t < T; t++)
+    {
+        const int* sum = gates_int32.row<const int>(t);
+        float* gates_x_ptr = gates_x.row(t);
+
+        const float descale_x = 1.f / bottom_blob_int8_scales[t];
+        for (int i = 0; i < num_output; i++)
+        {
+            gates_x_ptr[i] = bias_c_ptr[i] + sum[i] * (descale_x * weight_xc_int8_descales[i]);
+        }
+    }
+
+    Mat hidden_state_int8(num_output, 1, (size_t)1u, 1, opt.workspace_allocator);
+    Mat hidden_state_int8_scales(1, (size_t)4u, 1, opt.workspace_allocator);
+    if (hidden_state_int8.empty() || hidden_state_int8_scales.empty())
+        return -100;
+
+    Option opt_quant = opt;
+    opt_quant.blob_allocator = opt.workspace_allocator;
+    opt_quant.use_packing_layout = false;
+
+    // unroll
+    for (int t = 0; t < T; t++)
+    {
+        int ti = reverse ? T - 1 - t : t;
+
+        // dynamic quantize hidden_state
+        {
+            const float* hidden_ptr = hidden_state;
+
+            float absmax = 0.f;
+            for (int i = 0; i < num_output; i++)
+            {
+                absmax = std::max(absmax, (float)fabs(hidden_ptr[i]));
+            }
+
+            if (absmax == 0.f)
+            {
+                hidden_state_int8_scales[0] = 1.f;
+                hidden_state_int8.fill<signed char>(0);
+            }
+            else
+            {
+                hidden_state_int8_scales[0] = 127.f / absmax;
+
+                quantize_to_int8(hidden_state, hidden_state_int8, hidden_state_int8_scales, opt_quant);
+            }
+        }
+
+        rnn_gemm_int8(hidden_state_int8, weight_hc_packed, gates_int32, num_output, opt);
+
+        const int* sum = gates_int32;
+        float* gates_h_ptr = gates_h;
+
+        const float descale_h = 1.f / hidden_state_int8_scales[0];
+        for (int i = 0; i < num_output; i++)
+        {
+            gates_h_ptr[i] = sum[i] * (descale_h * weight_hc_int8_descales[i]);
+        }
+
+        rnn_gates(gates_x.row(ti), gates_h, hidden_state, top_blob.row(ti) + out_offset, num_output);
+    }
+
+    return 0;
+}
+#endif // NCNN_INT8
+
+int RNN_x86::forward_directions(const Mat& bottom_blob, Mat& top_blob, Mat& hidden, const Option& opt) const
+{
+    const int T = bottom_blob.h;
+    const int num_directions = direction == 2 ? 2 : 1;
+
+#if NCNN_INT8
+    if (int8_scale_term)
+    {
+        const int size = bottom_blob.w;
+
+        // dynamic quantize bottom_blob
+        Mat bottom_blob_int8(size, T, (size_t)1u, 1, opt.workspace_allocator);
+        Mat bottom_blob_int8_scales(T, (size_t)4u, 1, opt.workspace_allocator);
+        if (bottom_blob_int8.empty() || bottom_blob_int8_scales.empty())
+            return -100;
+
+        for (int t = 0; t < T; t++)
+        {
+            const float* x = bottom_blob.row(t);
+
+            float absmax = 0.f;
+            for (int i = 0; i < size; i++)
+            {
+                absmax = std::max(absmax, (float)fabs(x[i]));
+            }
+
+            bottom_blob_int8_scales[t] = 127.f / absmax;
+        }
+
+        Option opt_quant = opt;
+        opt_quant.blob_allocator = opt.workspace_allocator;
+        opt_quant.use_packing_layout = false;
+        quantize_to_int8(bottom_blob, bottom_blob_int8, bottom_blob_int8_scales, opt_quant);
+
+        for (int dr = 0; dr < num_directions; dr++)
+        {
+            int reverse = direction == 2 ? dr : direction;
+
+            Mat hidden_dr = hidden.row_range(dr, 1);
+            int ret = rnn_int8(bottom_blob_int8, bottom_blob_int8_scales, top_blob, num_output * dr, reverse, weight_xc_data_packed.channel(dr), weight_xc_data_int8_descales.row(dr), bias_c_data.channel(dr), weight_hc_data_packed.channel(dr), weight_hc_data_int8_descales.row(dr), hidden_dr, opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        return 0;
+    }
+#endif // NCNN_INT8
+
+    for (int dr = 0; dr < num_directions; dr++)
+    {
+        int reverse = direction == 2 ? dr : direction;
+
+        Mat hidden_dr = hidden.row_range(dr, 1);
+        int ret = rnn(bottom_blob, top_blob, num_output * dr, reverse, weight_xc_data_packed.channel(dr), bias_c_data.channel(dr), weight_hc_data_packed.channel(dr), hidden_dr, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+int RNN_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int T = bottom_blob.h;
+    const int num_directions = direction == 2 ? 2 : 1;
+
+    // initial hidden state
+    Mat hidden(num_output, num_directions, 4u, opt.workspace_allocator);
+    if (hidden.empty())
+        return -100;
+    hidden.fill(0.f);
+
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    return forward_directions(bottom_blob, top_blob, hidden, opt);
+}
+
+int RNN_x86::forward(const std::vector<Mat>& bottom_blobs, std::vector<Mat>& top_blobs, const Option& opt) const
+{
+    const Mat& bottom_blob = bottom_blobs[0];
+    const int T = bottom_blob.h;
+    const int num_directions = direction == 2 ? 2 : 1;
+
+    Mat hidden;
+    Allocator* hidden_allocator = top_blobs.size() == 2 ? opt.blob_allocator : opt.workspace_allocator;
+    if (bottom_blobs.size() == 2)
+    {
+        hidden = bottom_blobs[1].clone(hidden_allocator);
+    }
+    else
+    {
+        hidden.create(num_output, num_directions, 4u, hidden_allocator);
+        if (hidden.empty())
+            return -100;
+        hidden.fill(0.f);
+    }
+
+    Mat& top_blob = top_blobs[0];
+    top_blob.create(num_output * num_directions, T, 4u, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    int ret = forward_directions(bottom_blob, top_blob, hidden, opt);
+    if (ret != 0)
+        return ret;
+
+    if (top_blobs.size() == 2)
+    {
+        top_blobs[1] = hidden;
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,192 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tile_x86.h"
+
+namespace ncnn {
+
+Tile_x86::Tile_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+int Tile_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    const int dims = bottom_blob.dims;
+    int repeat_w = 1;
+    int repeat_h = 1;
+    int repeat_d = 1;
+    int repeat_c = 1;
+
+    const int repeats_num = repeats.w;
+
+    if (repeats.empty())
+    {
+        if (dims == 1) // axis == 0
+        {
+            repeat_w = tiles;
+        }
+        else if (dims == 2)
+        {
+            if (axis == 0) repeat_h = tiles;
+            if (axis == 1) repeat_w = tiles;
+        }
+        else if (dims == 3)
+        {
+            if (axis == 0) repeat_c = tiles;
+            if (axis == 1) repeat_h = tiles;
+            if (axis == 2) repeat_w = tiles;
+        }
+        else if (dims == 4)
+        {
+            if (axis == 0) repeat_c = tiles;
+            if (axis == 1) repeat_d = tiles;
+            if (axis == 2) repeat_h = tiles;
+            if (axis == 3) repeat_w = tiles;
+        }
+    }
+    else
+    {
+        // numpy style tile
+        const int* repeats_ptr = repeats;
+
+        if (repeats_num == 1)
+        {
+            repeat_w = repeats_ptr[0];
+        }
+        if (repeats_num == 2)
+        {
+            repeat_h = repeats_ptr[0];
+            repeat_w = repeats_ptr[1];
+        }
+        if (repeats_num == 3)
+        {
+            if (dims == 4)
+            {
+                repeat_d = repeats_ptr[0];
+                repeat_h = repeats_ptr[1];
+                repeat_w = repeats_ptr[2];
+            }
+            else
+            {
+                repeat_c = repeats_ptr[0];
+                repeat_h = repeats_ptr[1];
+                repeat_w = repeats_ptr[2];
+            }
+        }
+        if (repeats_num == 4)
+        {
+            repeat_c = repeats_ptr[0];
+            repeat_d = repeats_ptr[1];
+            repeat_h = repeats_ptr[2];
+            repeat_w = repeats_ptr[3];
+        }
+    }
+
+    if (repeats_num > dims)
+    {
+        // new leading axes change which axis is packed, tile the unpacked blob
+        Mat bottom_blob_unpacked = bottom_blob;
+        if (bottom_blob.elempack != 1)
+        {
+            Option opt_pack = opt;
+            opt_pack.blob_allocator = opt.workspace_allocator;
+
+            convert_packing(bottom_blob, bottom_blob_unpacked, 1, opt_pack);
+            if (bottom_blob_unpacked.empty())
+                return -100;
+        }
+
+        return Tile::forward(bottom_blob_unpacked, top_blob, opt);
+    }
+
+    if (repeat_w == 1 && repeat_h == 1 && repeat_d == 1 && repeat_c == 1)
+    {
+        top_blob = bottom_blob;
+        return 0;
+    }
+
+    const int w = bottom_blob.w;
+    const int h = bottom_blob.h;
+    const int d = bottom_blob.d;
+    const int channels = bottom_blob.c;
+    const size_t elemsize = bottom_blob.elemsize;
+    const int elempack = bottom_blob.elempack;
+
+    // the outermost axis keeps its elempack, repeating whole pack groups stays a plain copy
+    if (dims == 1)
+        top_blob.create(w * repeat_w, elemsize, elempack, opt.blob_allocator);
+    if (dims == 2)
+        top_blob.create(w * repeat_w, h * repeat_h, elemsize, elempack, opt.blob_allocator);
+    if (dims == 3)
+        top_blob.create(w * repeat_w, h * repeat_h, channels * repeat_c, elemsize, elempack, opt.blob_allocator);
+    if (dims == 4)
+        top_blob.create(w * repeat_w, h * repeat_h, d * repeat_d, channels * repeat_c, elemsize, elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    const size_t row_size = w * elemsize;
+
+    if (dims == 1)
+    {
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int p = 0; p < repeat_w; p++)
+        {
+            memcpy((unsigned char*)top_blob.data + row_size * p, bottom_blob.data, row_size);
+        }
+
+        return 0;
+    }
+
+    if (dims == 2)
+    {
+        const int outh = h * repeat_h;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int y = 0; y < outh; y++)
+        {
+            const unsigned char* ptr = bottom_blob.row<const unsigned char>(y % h);
+            unsigned char* outptr = top_blob.row<unsigned char>(y);
+
+            for (int p = 0; p < repeat_w; p++)
+            {
+                memcpy(outptr, ptr, row_size);
+                outptr += row_size;
+            }
+        }
+
+        return 0;
+    }
+
+    const int outh = h * repeat_h;
+    const int outd = d * repeat_d;
+    const int outc = channels * repeat_c;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < outc; q++)
+    {
+        const Mat m = bottom_blob.channel(q % channels);
+        Mat outm = top_blob.channel(q);
+
+        for (int z = 0; z < outd; z++)
+        {
+            for (int y = 0; y < outh; y++)
+            {
+                const unsigned char* ptr = (const unsigned char*)m.data + ((z % d) * h + y % h) * row_size;
+                unsigned char* outptr = (unsigned char*)outm.data + (z * outh + y) * row_size * repeat_w;
+
+                for (int p = 0; p < repeat_w; p++)
+                {
+                    memcpy(outptr, ptr, row_size);
+                    outptr += row_size;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,189 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "unfold_x86.h"
+
+#if __SSE2__
+#include <emmintrin.h>
+#if __AVX__
+#include <immintrin.h>
+#endif // __AVX__
+#endif // __SSE2__
+
+#include "x86_usability.h"
+
+namespace ncnn {
+
+Unfold_x86::Unfold_x86()
+{
+#if __SSE2__
+    support_packing = true;
+#endif // __SSE2__
+}
+
+// scatter outw packed samples spaced step floats apart into elempack output rows outstride floats apart
+static void unfold_row_pack(const float* sptr, int step, float* outptr, size_t outstride, int outw, int elempack)
+{
+    int j = 0;
+#if __SSE2__
+#if __AVX__
+#if __AVX512F__
+    if (elempack == 16)
+    {
+        for (; j + 15 < outw; j += 16)
+        {
+            __m512 _r0 = _mm512_loadu_ps(sptr);
+            __m512 _r1 = _mm512_loadu_ps(sptr + step);
+            __m512 _r2 = _mm512_loadu_ps(sptr + step * 2);
+            __m512 _r3 = _mm512_loadu_ps(sptr + step * 3);
+            __m512 _r4 = _mm512_loadu_ps(sptr + step * 4);
+            __m512 _r5 = _mm512_loadu_ps(sptr + step * 5);
+            __m512 _r6 = _mm512_loadu_ps(sptr + step * 6);
+            __m512 _r7 = _mm512_loadu_ps(sptr + step * 7);
+            __m512 _r8 = _mm512_loadu_ps(sptr + step * 8);
+            __m512 _r9 = _mm512_loadu_ps(sptr + step * 9);
+            __m512 _ra = _mm512_loadu_ps(sptr + step * 10);
+            __m512 _rb = _mm512_loadu_ps(sptr + step * 11);
+            __m512 _rc = _mm512_loadu_ps(sptr + step * 12);
+            __m512 _rd = _mm512_loadu_ps(sptr + step * 13);
+            __m512 _re = _mm512_loadu_ps(sptr + step * 14);
+            __m512 _rf = _mm512_loadu_ps(sptr + step * 15);
+            transpose16x16_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7, _r8, _r9, _ra, _rb, _rc, _rd, _re, _rf);
+            _mm512_storeu_ps(outptr + j, _r0);
+            _mm512_storeu_ps(outptr + outstride + j, _r1);
+            _mm512_storeu_ps(outptr + outstride * 2 + j, _r2);
+            _mm512_storeu_ps(outptr + outstride * 3 + j, _r3);
+            _mm512_storeu_ps(outptr + outstride * 4 + j, _r4);
+            _mm512_storeu_ps(outptr + outstride * 5 + j, _r5);
+            _mm512_storeu_ps(outptr + outstride * 6 + j, _r6);
+            _mm512_storeu_ps(outptr + outstride * 7 + j, _r7);
+            _mm512_storeu_ps(outptr + outstride * 8 + j, _r8);
+            _mm512_storeu_ps(outptr + outstride * 9 + j, _r9);
+            _mm512_storeu_ps(outptr + outstride * 10 + j, _ra);
+            _mm512_storeu_ps(outptr + outstride * 11 + j, _rb);
+            _mm512_storeu_ps(outptr + outstride * 12 + j, _rc);
+            _mm512_storeu_ps(outptr + outstride * 13 + j, _rd);
+            _mm512_storeu_ps(outptr + outstride * 14 + j, _re);
+            _mm512_storeu_ps(outptr + outstride * 15 + j, _rf);
+            sptr += step * 16;
+        }
+    }
+#endif // __AVX512F__
+    if (elempack == 8)
+    {
+        for (; j + 7 < outw; j += 8)
+        {
+            __m256 _r0 = _mm256_loadu_ps(sptr);
+            __m256 _r1 = _mm256_loadu_ps(sptr + step);
+            __m256 _r2 = _mm256_loadu_ps(sptr + step * 2);
+            __m256 _r3 = _mm256_loadu_ps(sptr + step * 3);
+            __m256 _r4 = _mm256_loadu_ps(sptr + step * 4);
+            __m256 _r5 = _mm256_loadu_ps(sptr + step * 5);
+            __m256 _r6 = _mm256_loadu_ps(sptr + step * 6);
+            __m256 _r7 = _mm256_loadu_ps(sptr + step * 7);
+            transpose8x8_ps(_r0, _r1, _r2, _r3, _r4, _r5, _r6, _r7);
+            _mm256_storeu_ps(outptr + j, _r0);
+            _mm256_storeu_ps(outptr + outstride + j, _r1);
+            _mm256_storeu_ps(outptr + outstride * 2 + j, _r2);
+            _mm256_storeu_ps(outptr + outstride * 3 + j, _r3);
+            _mm256_storeu_ps(outptr + outstride * 4 + j, _r4);
+            _mm256_storeu_ps(outptr + outstride * 5 + j, _r5);
+            _mm256_storeu_ps(outptr + outstride * 6 + j, _r6);
+            _mm256_storeu_ps(outptr + outstride * 7 + j, _r7);
+            sptr += step * 8;
+        }
+    }
+#endif // __AVX__
+    if (elempack == 4)
+    {
+        for (; j + 3 < outw; j += 4)
+        {
+            __m128 _r0 = _mm_loadu_ps(sptr);
+            __m128 _r1 = _mm_loadu_ps(sptr + step);
+            __m128 _r2 = _mm_loadu_ps(sptr + step * 2);
+            __m128 _r3 = _mm_loadu_ps(sptr + step * 3);
+            _MM_TRANSPOSE4_PS(_r0, _r1, _r2, _r3);
+            _mm_storeu_ps(outptr + j, _r0);
+            _mm_storeu_ps(outptr + outstride + j, _r1);
+            _mm_storeu_ps(outptr + outstride * 2 + j, _r2);
+            _mm_storeu_ps(outptr + outstride * 3 + j, _r3);
+            sptr += step * 4;
+        }
+    }
+#endif // __SSE2__
+    if (elempack == 1 && step == 1)
+    {
+        memcpy(outptr + j, sptr, (outw - j) * sizeof(float));
+        return;
+    }
+    for (; j < outw; j++)
+    {
+        for (int l = 0; l < elempack; l++)
+        {
+            outptr[outstride * l + j] = sptr[l];
+        }
+        sptr += step;
+    }
+}
+
+int Unfold_x86::forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const
+{
+    Mat bottom_blob_bordered;
+    {
+        Option opt_b = opt;
+        opt_b.blob_allocator = opt.workspace_allocator;
+        make_padding(bottom_blob, bottom_blob_bordered, opt_b);
+        if (bottom_blob_bordered.empty())
+            return -100;
+    }
+
+    const int w = bottom_blob_bordered.w;
+    const int h = bottom_blob_bordered.h;
+    const int channels = bottom_blob_bordered.c;
+    const size_t elemsize = bottom_blob_bordered.elemsize;
+    const int elempack = bottom_blob_bordered.elempack;
+
+    const int kernel_extent_w = dilation_w * (kernel_w - 1) + 1;
+    const int kernel_extent_h = dilation_h * (kernel_h - 1) + 1;
+
+    const int outw = (w - kernel_extent_w) / stride_w + 1;
+    const int outh = (h - kernel_extent_h) / stride_h + 1;
+
+    const int size = outw * outh;
+    const int maxk = kernel_w * kernel_h;
+
+    // rows are channel-major with the kernel offset inner, keep them unpacked for the following gemm
+    top_blob.create(size, maxk * channels * elempack, elemsize / elempack, opt.blob_allocator);
+    if (top_blob.empty())
+        return -100;
+
+    // im2col, the lanes of one input pack group go to elempack rows maxk rows apart
+    const size_t outstride = (size_t)size * maxk;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int p = 0; p < channels; p++)
+    {
+        const Mat img = bottom_blob_bordered.channel(p);
+
+        for (int u = 0; u < kernel_h; u++)
+        {
+            for (int v = 0; v < kernel_w; v++)
+            {
+                float* outptr = top_blob.row(p * elempack * maxk + u * kernel_w + v);
+
+                for (int i = 0; i < outh; i++)
+                {
+                    const float* sptr = img.row(dilation_h * u + stride_h * i) + dilation_w * v * elempack;
+
+                    unfold_row_pack(sptr, stride_w * elempack, outptr, outstride, outw, elempack);
+
+                    outptr += outw;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+} // namespace ncnn
@@ -0,0 +1,21 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef LAYER_UNFOLD_X86_H
+#define LAYER_UNFOLD_X86_H
+
+#include "unfold.h"
+
+namespace ncnn {
+
+class Unfold_x86 : public Unfold
+{
+public:
+    Unfold_x86();
+
+    virtual int forward(const Mat& bottom_blob, Mat& top_blob, const Option& opt) const;
+};
+
+} // namespace ncnn
+
+#endif // LAYER_UNFOLD_X86_H
@@ -1819,6 +1819,30 @@ static NCNN_FORCEINLINE __m512i float2bfloat_avx512(const __m512& v0, const __m5
     return _v;
 }
 
+#if __AMX_TILE__
+// palette 1 with all eight tiles shaped as 16 rows of 64 bytes
+// the config lives in static storage, gcc may drop stores to a local one before ldtilecfg
+struct amx_tile_config_t
+{
+    unsigned char palette_id;
+    unsigned char start_row;
+    unsigned char reserved[14];
+    unsigned short colsb[16];
+    unsigned char rows[16];
+};
+
+static NCNN_FORCEINLINE void amx_tile_config_16x64()
+{
+    static const amx_tile_config_t cfg = {
+        1, 0, {0},
+        {64, 64, 64, 64, 64, 64, 64, 64},
+        {16, 16, 16, 16, 16, 16, 16, 16}
+    };
+
+    _tile_loadconfig(&cfg);
+}
+#endif // __AMX_TILE__
+
 #endif // __AVX512F__
 #endif // __AVX2__
 #endif // __AVX__
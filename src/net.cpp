@@ -9,13 +9,23 @@
 #include "modelbin.h"
 #include "paramdict.h"
 
+#include "layer/convolution.h"
+#include "layer/gemm.h"
+#include "layer/innerproduct.h"
+
 #include <stdarg.h>
 #include <stdint.h>
 #include <string.h>
 
-#if NCNN_BENCHMARK
+#if NCNN_STDIO
+#if _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#endif // NCNN_STDIO
+
 #include "benchmark.h"
-#endif // NCNN_BENCHMARK
 
 #if NCNN_VULKAN
 #include "command.h"
@@ -24,6 +34,245 @@
 
 namespace ncnn {
 
+#if NCNN_THREADS
+class ParallelForwardContext;
+class ParallelCreatePipelineContext;
+#endif // NCNN_THREADS
+class BranchWorkerPool;
+class LayerProfiler;
+
+class BatchForwardContext
+{
+public:
+    BatchForwardContext()
+        : profiler(0)
+    {
+    }
+
+    void clear()
+    {
+        blob_mats.clear();
+        stacked_mats.clear();
+        stacked_rows.clear();
+        stacked_dims.clear();
+    }
+
+    // blob mats of each batch item
+    std::vector<std::vector<Mat> > blob_mats;
+
+    // blobs kept as one 2d mat for the whole batch
+    // item b owns rows [b * stacked_rows, (b + 1) * stacked_rows) of the unpacked mat
+    // stacked_rows is 0 if the blob lives in blob_mats
+    std::vector<Mat> stacked_mats;
+    std::vector<int> stacked_rows;
+    // dims of each item, 1 or 2
+    std::vector<int> stacked_dims;
+
+    // records the layer runs when profiling
+    LayerProfiler* profiler;
+};
+
+// counts the workspace memory allocated by profiled layers
+class ProfileWorkspaceAllocator : public Allocator
+{
+public:
+    ProfileWorkspaceAllocator()
+        : allocator(0), allocated(0)
+    {
+    }
+
+    virtual void* fastMalloc(size_t size)
+    {
+        lock.lock();
+        allocated += size;
+        lock.unlock();
+
+        return allocator ? allocator->fastMalloc(size) : ncnn::fastMalloc(size);
+    }
+
+    virtual void fastFree(void* ptr)
+    {
+        if (allocator)
+            allocator->fastFree(ptr);
+        else
+            ncnn::fastFree(ptr);
+    }
+
+    size_t allocated_bytes()
+    {
+        MutexLockGuard guard(lock);
+        return allocated;
+    }
+
+public:
+    // the extractor workspace allocator, null for fastMalloc
+    Allocator* allocator;
+
+private:
+    Mutex lock;
+    size_t allocated;
+};
+
+class LayerProfiler
+{
+public:
+    LayerProfiler()
+        : origin(get_current_time())
+    {
+    }
+
+    ~LayerProfiler()
+    {
+        for (size_t i = 0; i < workspace_allocators.size(); i++)
+        {
+            delete workspace_allocators[i];
+        }
+    }
+
+    // the workspace allocator of one branch worker, a worker runs one layer at a time
+    ProfileWorkspaceAllocator* get_workspace_allocator(int worker)
+    {
+        MutexLockGuard guard(lock);
+
+        if ((int)workspace_allocators.size() <= worker)
+            workspace_allocators.resize(worker + 1, 0);
+
+        if (!workspace_allocators[worker])
+            workspace_allocators[worker] = new ProfileWorkspaceAllocator;
+
+        return workspace_allocators[worker];
+    }
+
+    double origin;
+
+    Mutex lock;
+    std::vector<LayerProfile> profiles;
+
+private:
+    LayerProfiler(const LayerProfiler&);
+    LayerProfiler& operator=(const LayerProfiler&);
+
+    // kept until destruction, blobs may come from them
+    std::vector<ProfileWorkspaceAllocator*> workspace_allocators;
+};
+
+#if NCNN_STDIO
+// https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function#FNV-1a_hash
+static uint32_t fnv1a_32(uint32_t h, const void* data, size_t size)
+{
+    const unsigned char* p = (const unsigned char*)data;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= (uint32_t)p[i];
+        h *= 0x01000193;
+    }
+
+    return h;
+}
+
+// hash every param of one layer, arrays and strings by value
+static uint32_t fnv1a_32(uint32_t h, const ParamDict& pd)
+{
+    for (int id = 0; id < NCNN_MAX_PARAM_COUNT; id++)
+    {
+        const int type = pd.type(id);
+        if (type == 0)
+            continue;
+
+        int param_desc[2];
+        param_desc[0] = id;
+        param_desc[1] = type;
+        h = fnv1a_32(h, param_desc, sizeof(param_desc));
+
+        if (type == 1 || type == 2 || type == 3)
+        {
+            // int and float share the storage, hash the bits
+            const int i = pd.get(id, 0);
+            h = fnv1a_32(h, &i, sizeof(i));
+        }
+        if (type == 4 || type == 5 || type == 6)
+        {
+            const Mat v = pd.get(id, Mat());
+            h = fnv1a_32(h, &v.w, sizeof(v.w));
+            h = fnv1a_32(h, v.data, v.w * v.elemsize);
+        }
+        if (type == 7)
+        {
+            const std::string str = pd.get(id, std::string());
+            h = fnv1a_32(h, str.data(), str.size());
+        }
+    }
+
+    return h;
+}
+
+// hash the model data passing through
+class DataReaderWithHash : public DataReader
+{
+public:
+    explicit DataReaderWithHash(const DataReader& _dr)
+        : dr(_dr), hash(0x811c9dc5), size(0)
+    {
+    }
+
+    virtual size_t read(void* buf, size_t _size) const
+    {
+        size_t nread = dr.read(buf, _size);
+        hash = fnv1a_32(hash, buf, nread);
+        size += nread;
+        return nread;
+    }
+
+    virtual size_t reference(size_t _size, const void** buf) const
+    {
+        size_t nref = dr.reference(_size, buf);
+        if (nref)
+        {
+            hash = fnv1a_32(hash, *buf, nref);
+            size += nref;
+        }
+        return nref;
+    }
+
+public:
+    const DataReader& dr;
+    mutable uint32_t hash;
+    mutable size_t size;
+};
+
+// identifies the model, cpu and option the transformed weights were made for
+struct weight_cache_key
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t model_hash;
+    uint32_t param_hash;
+    uint64_t model_size;
+    uint32_t layer_hash;
+    uint32_t layer_count;
+    uint32_t isa;
+    uint32_t option;
+    int32_t num_threads;
+    int32_t l2_cache_size;
+    int32_t l3_cache_size;
+    uint32_t reserved;
+};
+
+// one cached mat, followed by its data at the next 64 byte aligned offset
+struct weight_cache_mat
+{
+    int32_t dims;
+    int32_t w;
+    int32_t h;
+    int32_t d;
+    int32_t c;
+    int32_t elemsize;
+    int32_t elempack;
+    int32_t cstep;
+};
+#endif // NCNN_STDIO
+
 class NetPrivate
 {
 public:
@@ -38,15 +287,41 @@ public:
 #endif // NCNN_VULKAN
 
     friend class Extractor;
-    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const;
+    int forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, LayerProfiler* profiler = 0) const;
+
+    // run independent branches concurrently on branch_count workers
+    // the calling thread is one of them, the others come from workers
+    int forward_layer_parallel(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, int branch_count, BranchWorkerPool* workers, LayerProfiler* profiler = 0) const;
+#if NCNN_THREADS
+    void forward_layer_worker(ParallelForwardContext* ctx) const;
+#endif // NCNN_THREADS
+
+    // run all batch items through the graph in one walk
+    int forward_layer_batch(int layer_index, BatchForwardContext& ctx, const Option& opt) const;
+    int get_batch_type(const Layer* layer, const BatchForwardContext& ctx) const;
+    int unstack_batch_blob(int blob_index, BatchForwardContext& ctx, const Option& opt) const;
 
 #if NCNN_VULKAN
     int forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
 #endif // NCNN_VULKAN
 
+    int create_pipeline(int layer_index, const Option& opt);
+    // create pipelines of all layers on num_threads workers
+    int create_pipeline_parallel(const Option& opt);
+#if NCNN_STDIO
+    void get_weight_cache_key(const DataReaderWithHash& dr, const Option& opt, weight_cache_key& key) const;
+    int load_weight_cache(const weight_cache_key& key);
+    int save_weight_cache(const weight_cache_key& key) const;
+#endif // NCNN_STDIO
+#if NCNN_THREADS
+    void create_pipeline_worker(ParallelCreatePipelineContext* ctx);
+#endif // NCNN_THREADS
+
     int convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const;
 
     int do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats, const Option& opt) const;
+    // do_forward_layer and record the run when profiler is set
+    int do_forward_layer_profiled(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, LayerProfiler* profiler, int worker = 0) const;
 #if NCNN_VULKAN
     int do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const;
 #endif // NCNN_VULKAN
@@ -59,6 +334,9 @@ public:
     std::vector<Blob> blobs;
     std::vector<Layer*> layers;
 
+    // milliseconds spent in create_pipeline of each layer
+    std::vector<double> create_pipeline_times;
+
     std::vector<int> input_blob_indexes;
     std::vector<int> output_blob_indexes;
 #if NCNN_STRING
@@ -72,6 +350,20 @@ public:
     PoolAllocator* local_blob_allocator;
     PoolAllocator* local_workspace_allocator;
 
+#if NCNN_STDIO
+    // weight data referenced by layers loaded with load_model_mmap
+    // a failed load leaves layers on both the old and the new mapping, all are kept until clear
+    std::vector<DataReaderFromMmap*> model_mmaps;
+
+    // transformed weights referenced by layers restored from the weight cache
+    std::string weight_cache_path;
+    DataReaderFromMmap* weight_cache_mmap;
+    std::vector<std::vector<Mat> > weight_cache_weights;
+
+    // params of all layers, the weight transforms depend on them
+    uint32_t param_hash;
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     const VulkanDevice* vkdev;
 
@@ -88,6 +380,11 @@ NetPrivate::NetPrivate(Option& _opt)
     local_blob_allocator = 0;
     local_workspace_allocator = 0;
 
+#if NCNN_STDIO
+    weight_cache_mmap = 0;
+    param_hash = 0x811c9dc5;
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     vkdev = 0;
     weight_vkallocator = 0;
@@ -96,6 +393,62 @@ NetPrivate::NetPrivate(Option& _opt)
 #endif // NCNN_VULKAN
 }
 
+// numa node the openmp workers of the calling thread are bound to, plus one
+static ThreadLocalStorage tls_bound_numa_node;
+
+// binds the calling thread and its openmp workers to the cpus of a numa node
+// the calling thread gets its own affinity back when the binding goes out of scope
+class NumaNodeBinding
+{
+public:
+    NumaNodeBinding(int numa_node);
+    ~NumaNodeBinding();
+
+private:
+    bool restore;
+    CpuSet caller_mask;
+};
+
+NumaNodeBinding::NumaNodeBinding(int numa_node)
+    : restore(false)
+{
+    if (numa_node < 0)
+        return;
+
+    // no way to give the caller its affinity back, leave it alone
+    if (get_current_thread_affinity(caller_mask) != 0)
+        return;
+
+    restore = true;
+
+    const CpuSet& node_mask = get_numa_node_thread_affinity_mask(numa_node);
+
+    // binding spins up the openmp workers, do it once per thread and node
+    int ret = 0;
+    if ((size_t)tls_bound_numa_node.get() == (size_t)numa_node + 1)
+    {
+        ret = set_current_thread_affinity(node_mask);
+    }
+    else
+    {
+        ret = set_cpu_thread_affinity(node_mask);
+        if (ret == 0)
+            tls_bound_numa_node.set((void*)((size_t)numa_node + 1));
+    }
+    if (ret != 0)
+    {
+        NCNN_LOGE("bind numa node %d failed", numa_node);
+    }
+}
+
+NumaNodeBinding::~NumaNodeBinding()
+{
+    if (restore)
+    {
+        set_current_thread_affinity(caller_mask);
+    }
+}
+
 static Option get_masked_option(const Option& opt, int featmask)
 {
     // mask option usage as layer specific featmask
@@ -157,7 +510,7 @@ int NetPrivate::upload_model()
 }
 #endif // NCNN_VULKAN
 
-int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt) const
+int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, LayerProfiler* profiler) const
 {
     const Layer* layer = layers[layer_index];
 
@@ -170,7 +523,7 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, cons
 
         if (blob_mats[bottom_blob_index].dims == 0)
         {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt);
+            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, opt, profiler);
             if (ret != 0)
                 return ret;
         }
@@ -194,11 +547,11 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, cons
     int ret = 0;
     if (layer->featmask)
     {
-        ret = do_forward_layer(layer, blob_mats, get_masked_option(opt, layer->featmask));
+        ret = do_forward_layer_profiled(layer_index, blob_mats, get_masked_option(opt, layer->featmask), profiler);
     }
     else
     {
-        ret = do_forward_layer(layer, blob_mats, opt);
+        ret = do_forward_layer_profiled(layer_index, blob_mats, opt, profiler);
     }
 #if NCNN_BENCHMARK
     double end = get_current_time();
@@ -222,95 +575,842 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, cons
     return 0;
 }
 
-#if NCNN_VULKAN
-int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+#if NCNN_THREADS
+class ParallelForwardContext
 {
-    const Layer* layer = layers[layer_index];
+public:
+    const NetPrivate* net;
+    std::vector<Mat>* blob_mats;
+    const Option* opt;
+    int branch_count;
+    LayerProfiler* profiler;
 
-    //     NCNN_LOGE("forward_layer %d %d %s", layer->support_vulkan, layer_index, layer->name.c_str());
+    Mutex lock;
+    ConditionVariable condition;
 
-    bool cmd_submit_and_wait = false;
+    // id of the next worker joining
+    int next_worker;
 
-    // load bottom blobs
-    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    // layers whose bottom blobs are all ready
+    std::vector<int> ready_layers;
+    size_t ready_head;
+
+    // per layer count of bottom blobs not produced yet
+    std::vector<int> pending_bottoms;
+    // per layer index of needed layers consuming its top blobs
+    std::vector<std::vector<int> > dependents;
+
+    int remaining_count;
+    int running_count;
+    int ret;
+};
+
+static void* parallel_forward_worker(void* args)
+{
+    ParallelForwardContext* ctx = (ParallelForwardContext*)args;
+
+    // denormal flags and affinity are per thread state
+    set_flush_denormals(ctx->opt->flush_denormals);
+
+    NumaNodeBinding numa_binding(ctx->opt->numa_node);
+
+    ctx->net->forward_layer_worker(ctx);
+
+    return 0;
+}
+
+// threads kept by an extractor for set_branch_parallel
+// they sleep between extract calls instead of being created on each one
+class BranchWorkerPool
+{
+public:
+    BranchWorkerPool(int thread_count);
+    ~BranchWorkerPool();
+
+    int thread_count() const
     {
-        int bottom_blob_index = layer->bottoms[i];
+        return (int)threads.size();
+    }
 
-        if (blob_mats_gpu[bottom_blob_index].dims == 0 && blob_mats[bottom_blob_index].dims == 0)
-        {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, blob_mats_gpu, cmd, opt);
-            if (ret != 0)
-                return ret;
-        }
+    // let worker_count pooled threads join ctx
+    void start(ParallelForwardContext* ctx, int worker_count);
 
-        if (layer->support_vulkan)
-        {
-            if (blob_mats_gpu[bottom_blob_index].dims == 0)
-            {
-                // host to buffer
-                cmd.record_upload(blob_mats[bottom_blob_index], blob_mats_gpu[bottom_blob_index], opt);
+    // wait for the threads of the last start to leave ctx
+    void wait();
 
-                if (opt.lightmode)
-                {
-                    // delete after taken in light mode
-                    blob_mats[bottom_blob_index].release();
-                }
-            }
-        }
-        else
-        {
-            if (blob_mats[bottom_blob_index].dims == 0)
-            {
-                Option opt_download = opt;
-                opt_download.use_packing_layout = layer->support_packing;
+private:
+    static void* worker_main(void* args);
 
-                // buffer to host
-                cmd.record_download(blob_mats_gpu[bottom_blob_index], blob_mats[bottom_blob_index], opt_download);
+    Mutex lock;
+    ConditionVariable job_condition;
+    ConditionVariable done_condition;
 
-                if (opt.lightmode)
-                {
-                    // delete after taken in light mode
-                    blob_mats_gpu[bottom_blob_index].release();
-                }
+    std::vector<Thread*> threads;
 
-                cmd_submit_and_wait = true;
-            }
-        }
+    ParallelForwardContext* job;
+    // threads still to join the job
+    int job_slots;
+    // threads not done with the job yet
+    int job_running;
+    bool quit;
+};
+
+BranchWorkerPool::BranchWorkerPool(int thread_count)
+    : job(0), job_slots(0), job_running(0), quit(false)
+{
+    threads.resize(thread_count);
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads[i] = new Thread(worker_main, this);
     }
+}
 
-    int ret;
-    if (cmd_submit_and_wait)
+BranchWorkerPool::~BranchWorkerPool()
+{
+    lock.lock();
+    quit = true;
+    job_condition.broadcast();
+    lock.unlock();
+
+    for (size_t i = 0; i < threads.size(); i++)
     {
-        ret = cmd.submit_and_wait();
+        threads[i]->join();
+        delete threads[i];
+    }
+}
 
-#if NCNN_BENCHMARK
-        std::vector<uint64_t> results(layer_index * 2);
-        cmd.get_query_pool_results(0, layer_index * 2, results);
-        for (int i = 0; i < layer_index; i++)
-        {
-            uint64_t start = results[i * 2];
-            uint64_t end = results[i * 2 + 1];
-            if (start == 0 || end == 0)
-                continue;
+void BranchWorkerPool::start(ParallelForwardContext* ctx, int worker_count)
+{
+    worker_count = std::min(worker_count, thread_count());
 
-            double duration_us = (end - start) * vkdev->info.timestamp_period() / 1000;
-            NCNN_LOGE("%-24s %-30s %8.2lfus    |", layers[i]->type.c_str(), layers[i]->name.c_str(), duration_us);
-        }
-#endif // NCNN_BENCHMARK
+    lock.lock();
 
-        cmd.reset();
-        if (ret != 0)
-            return ret;
+    job = ctx;
+    job_slots = worker_count;
+    job_running = worker_count;
+    job_condition.broadcast();
+
+    lock.unlock();
+}
+
+void BranchWorkerPool::wait()
+{
+    lock.lock();
+
+    while (job_running > 0)
+    {
+        done_condition.wait(lock);
     }
 
-    if (layer->support_vulkan)
+    job = 0;
+
+    lock.unlock();
+}
+
+void* BranchWorkerPool::worker_main(void* args)
+{
+    BranchWorkerPool* pool = (BranchWorkerPool*)args;
+
+    pool->lock.lock();
+    for (;;)
     {
-#if NCNN_BENCHMARK
-        cmd.record_write_timestamp(layer_index * 2);
-#endif
-        if (layer->featmask)
+        while (!pool->quit && pool->job_slots == 0)
         {
-            ret = do_forward_layer(layer, blob_mats_gpu, cmd, get_masked_option(opt, layer->featmask));
+            pool->job_condition.wait(pool->lock);
+        }
+
+        if (pool->quit)
+            break;
+
+        pool->job_slots--;
+        ParallelForwardContext* ctx = pool->job;
+
+        pool->lock.unlock();
+
+        parallel_forward_worker(ctx);
+
+        pool->lock.lock();
+
+        pool->job_running--;
+        if (pool->job_running == 0)
+            pool->done_condition.signal();
+    }
+    pool->lock.unlock();
+
+    return 0;
+}
+#endif // NCNN_THREADS
+
+int NetPrivate::forward_layer_parallel(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, int branch_count, BranchWorkerPool* workers, LayerProfiler* profiler) const
+{
+#if NCNN_THREADS
+    if (branch_count <= 1 || !workers)
+        return forward_layer(layer_index, blob_mats, opt, profiler);
+
+    ParallelForwardContext ctx;
+    ctx.net = this;
+    ctx.blob_mats = &blob_mats;
+    ctx.opt = &opt;
+    ctx.branch_count = branch_count;
+    ctx.profiler = profiler;
+    ctx.next_worker = 0;
+    ctx.ready_head = 0;
+    ctx.pending_bottoms.resize(layers.size(), -1);
+    ctx.dependents.resize(layers.size());
+    ctx.remaining_count = 0;
+    ctx.running_count = 0;
+    ctx.ret = 0;
+
+    // collect the layers needed for producing the target from blob producer/consumer graph
+    std::vector<int> layer_stack;
+    layer_stack.push_back(layer_index);
+    ctx.pending_bottoms[layer_index] = 0;
+    while (!layer_stack.empty())
+    {
+        int i = layer_stack.back();
+        layer_stack.pop_back();
+
+        ctx.remaining_count++;
+
+        const Layer* layer = layers[i];
+        for (size_t j = 0; j < layer->bottoms.size(); j++)
+        {
+            int bottom_blob_index = layer->bottoms[j];
+            if (blob_mats[bottom_blob_index].dims != 0)
+                continue;
+
+            int producer = blobs[bottom_blob_index].producer;
+            if (producer == -1)
+            {
+                NCNN_LOGE("blob %d has no producer", bottom_blob_index);
+                return -1;
+            }
+
+            ctx.pending_bottoms[i]++;
+            ctx.dependents[producer].push_back(i);
+
+            if (ctx.pending_bottoms[producer] == -1)
+            {
+                ctx.pending_bottoms[producer] = 0;
+                layer_stack.push_back(producer);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        if (ctx.pending_bottoms[i] == 0)
+            ctx.ready_layers.push_back((int)i);
+    }
+
+    const int worker_count = std::min(branch_count, ctx.remaining_count);
+
+    workers->start(&ctx, worker_count - 1);
+
+    // the calling thread works too
+    forward_layer_worker(&ctx);
+
+    workers->wait();
+
+    return ctx.ret;
+#else  // NCNN_THREADS
+    (void)branch_count;
+    (void)workers;
+    return forward_layer(layer_index, blob_mats, opt, profiler);
+#endif // NCNN_THREADS
+}
+
+#if NCNN_THREADS
+void NetPrivate::forward_layer_worker(ParallelForwardContext* ctx) const
+{
+    const Option& opt = *ctx->opt;
+
+    ctx->lock.lock();
+
+    const int worker = ctx->next_worker++;
+
+    for (;;)
+    {
+        while (ctx->ready_head == ctx->ready_layers.size() && ctx->remaining_count > 0 && ctx->ret == 0)
+        {
+            ctx->condition.wait(ctx->lock);
+        }
+
+        if (ctx->remaining_count == 0 || ctx->ret != 0)
+            break;
+
+        int layer_index = ctx->ready_layers[ctx->ready_head++];
+
+        // share cpu threads among the layers running at the same time
+        int concurrency = ctx->running_count + 1 + (int)(ctx->ready_layers.size() - ctx->ready_head);
+        concurrency = std::min(concurrency, ctx->branch_count);
+
+        ctx->running_count++;
+
+        ctx->lock.unlock();
+
+        const Layer* layer = layers[layer_index];
+
+        Option opt1 = layer->featmask ? get_masked_option(opt, layer->featmask) : opt;
+        opt1.num_threads = std::max(opt1.num_threads / concurrency, 1);
+
+#if NCNN_BENCHMARK
+        double start = get_current_time();
+#endif
+        int ret = do_forward_layer_profiled(layer_index, *ctx->blob_mats, opt1, ctx->profiler, worker);
+#if NCNN_BENCHMARK
+        double end = get_current_time();
+        benchmark(layer, start, end);
+#endif
+
+        ctx->lock.lock();
+
+        ctx->running_count--;
+        ctx->remaining_count--;
+
+        if (ret != 0)
+        {
+            ctx->ret = ret;
+            ctx->condition.broadcast();
+            break;
+        }
+
+        const std::vector<int>& dependents = ctx->dependents[layer_index];
+        for (size_t i = 0; i < dependents.size(); i++)
+        {
+            int dependent = dependents[i];
+            ctx->pending_bottoms[dependent]--;
+            if (ctx->pending_bottoms[dependent] == 0)
+                ctx->ready_layers.push_back(dependent);
+        }
+
+        ctx->condition.broadcast();
+    }
+    ctx->lock.unlock();
+}
+#endif // NCNN_THREADS
+
+// how a layer runs over a batch
+enum
+{
+    // each item on its own
+    BATCH_NONE = 0,
+    // items stacked as rows of one 2d blob, InnerProduct and Gemm
+    BATCH_ROWS = 1,
+    // bottoms already stacked, layer does not care about the row layout
+    BATCH_ELEMENTWISE = 2,
+    // items stacked along height with zero rows in between
+    BATCH_CONVOLUTION = 3
+};
+
+static bool is_batch_elementwise_layer(int typeindex)
+{
+    switch (typeindex)
+    {
+    case LayerType::AbsVal:
+    case LayerType::BinaryOp:
+    case LayerType::BNLL:
+    case LayerType::CELU:
+    case LayerType::Clip:
+    case LayerType::Dropout:
+    case LayerType::ELU:
+    case LayerType::Erf:
+    case LayerType::Exp:
+    case LayerType::GELU:
+    case LayerType::HardSigmoid:
+    case LayerType::HardSwish:
+    case LayerType::Log:
+    case LayerType::Mish:
+    case LayerType::Power:
+    case LayerType::ReLU:
+    case LayerType::SELU:
+    case LayerType::Shrink:
+    case LayerType::Sigmoid:
+    case LayerType::Softplus:
+    case LayerType::Split:
+    case LayerType::Swish:
+    case LayerType::TanH:
+    case LayerType::Threshold:
+    case LayerType::UnaryOp:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// all items are vectors of row_size or matrices of row_size columns with the same shape
+static bool is_batch_row_stackable(const BatchForwardContext& ctx, int blob_index, int row_size, bool allow_1d)
+{
+    const Mat& m0 = ctx.blob_mats[0][blob_index];
+
+    if (m0.dims == 1 && (!allow_1d || m0.w * m0.elempack != row_size))
+        return false;
+
+    if (m0.dims == 2 && m0.w != row_size)
+        return false;
+
+    if (m0.dims != 1 && m0.dims != 2)
+        return false;
+
+    for (size_t b = 1; b < ctx.blob_mats.size(); b++)
+    {
+        const Mat& m = ctx.blob_mats[b][blob_index];
+        if (m.dims != m0.dims || m.w != m0.w || m.h != m0.h || m.elemsize != m0.elemsize || m.elempack != m0.elempack)
+            return false;
+    }
+
+    return true;
+}
+
+static int stack_batch_rows(BatchForwardContext& ctx, int blob_index, const Option& opt)
+{
+    const int batch_size = (int)ctx.blob_mats.size();
+
+    const Mat& m0 = ctx.blob_mats[0][blob_index];
+    const int dims = m0.dims;
+    const int w = dims == 1 ? m0.w * m0.elempack : m0.w;
+    const int rows = dims == 1 ? 1 : m0.h * m0.elempack;
+    const size_t elemsize = m0.elemsize / m0.elempack;
+
+    Option opt_unpack = opt;
+    opt_unpack.blob_allocator = opt.workspace_allocator;
+
+    Mat stacked(w, rows * batch_size, elemsize, opt.blob_allocator);
+    if (stacked.empty())
+        return -100;
+
+    for (int b = 0; b < batch_size; b++)
+    {
+        Mat m;
+        convert_packing(ctx.blob_mats[b][blob_index], m, 1, opt_unpack);
+        if (m.empty())
+            return -100;
+
+        memcpy((unsigned char*)stacked.data + (size_t)w * rows * b * elemsize, m.data, (size_t)w * rows * elemsize);
+    }
+
+    ctx.stacked_mats[blob_index] = stacked;
+    ctx.stacked_rows[blob_index] = rows;
+    ctx.stacked_dims[blob_index] = dims;
+
+    return 0;
+}
+
+// the gap between items must read as the zero padding of every item
+static bool is_batch_convolution_stackable(const BatchForwardContext& ctx, int blob_index, const Convolution* convolution)
+{
+    if (convolution->dynamic_weight || convolution->pad_value != 0.f)
+        return false;
+
+    if (convolution->pad_left < 0 || convolution->pad_right < 0 || convolution->pad_top < 0 || convolution->pad_bottom < 0)
+        return false;
+
+    const Mat& m0 = ctx.blob_mats[0][blob_index];
+    if (m0.dims != 3)
+        return false;
+
+    const int kernel_extent_h = convolution->dilation_h * (convolution->kernel_h - 1) + 1;
+    const int padded_h = m0.h + convolution->pad_top + convolution->pad_bottom;
+    if (padded_h < kernel_extent_h || padded_h % convolution->stride_h != 0)
+        return false;
+
+    for (size_t b = 1; b < ctx.blob_mats.size(); b++)
+    {
+        const Mat& m = ctx.blob_mats[b][blob_index];
+        if (m.dims != m0.dims || m.w != m0.w || m.h != m0.h || m.c != m0.c || m.elemsize != m0.elemsize || m.elempack != m0.elempack)
+            return false;
+    }
+
+    return true;
+}
+
+int NetPrivate::get_batch_type(const Layer* layer, const BatchForwardContext& ctx) const
+{
+    const int typeindex = layer->typeindex;
+
+    // overwritten builtin layers do not share the builtin params
+    for (size_t i = 0; i < overwrite_builtin_layer_registry.size(); i++)
+    {
+        if (overwrite_builtin_layer_registry[i].typeindex == typeindex)
+            return BATCH_NONE;
+    }
+
+    if (typeindex == LayerType::InnerProduct)
+    {
+        const InnerProduct* innerproduct = (const InnerProduct*)layer;
+        const int num_input = innerproduct->weight_data_size / innerproduct->num_output;
+
+        const int bottom_blob_index = layer->bottoms[0];
+        if (ctx.stacked_rows[bottom_blob_index])
+            return ctx.stacked_mats[bottom_blob_index].w == num_input ? BATCH_ROWS : BATCH_NONE;
+
+        return is_batch_row_stackable(ctx, bottom_blob_index, num_input, true) ? BATCH_ROWS : BATCH_NONE;
+    }
+
+    if (typeindex == LayerType::Gemm)
+    {
+        const Gemm* gemm = (const Gemm*)layer;
+
+        // A rows map to output rows, B and C are shared by all rows
+        if (!layer->one_blob_only || gemm->constantA || !gemm->constantB || gemm->transA || gemm->output_transpose || gemm->output_N1M)
+            return BATCH_NONE;
+
+        if (gemm->constantC && gemm->constant_broadcast_type_C != -1 && gemm->constant_broadcast_type_C != 0 && gemm->constant_broadcast_type_C != 4)
+            return BATCH_NONE;
+
+        const int bottom_blob_index = layer->bottoms[0];
+        if (ctx.stacked_rows[bottom_blob_index])
+            return ctx.stacked_dims[bottom_blob_index] == 2 && ctx.stacked_mats[bottom_blob_index].w == gemm->constantK ? BATCH_ROWS : BATCH_NONE;
+
+        return is_batch_row_stackable(ctx, bottom_blob_index, gemm->constantK, false) ? BATCH_ROWS : BATCH_NONE;
+    }
+
+    if (typeindex == LayerType::Convolution)
+    {
+        const int bottom_blob_index = layer->bottoms[0];
+        if (ctx.blob_mats.size() == 1 || ctx.stacked_rows[bottom_blob_index] || !layer->one_blob_only)
+            return BATCH_NONE;
+
+        return is_batch_convolution_stackable(ctx, bottom_blob_index, (const Convolution*)layer) ? BATCH_CONVOLUTION : BATCH_NONE;
+    }
+
+    if (is_batch_elementwise_layer(typeindex))
+    {
+        const int bottom_blob_index = layer->bottoms[0];
+        if (!ctx.stacked_rows[bottom_blob_index])
+            return BATCH_NONE;
+
+        // no broadcasting between stacked blobs
+        const Mat& m0 = ctx.stacked_mats[bottom_blob_index];
+        for (size_t i = 1; i < layer->bottoms.size(); i++)
+        {
+            const int blob_index = layer->bottoms[i];
+            const Mat& m = ctx.stacked_mats[blob_index];
+            if (ctx.stacked_rows[blob_index] != ctx.stacked_rows[bottom_blob_index] || ctx.stacked_dims[blob_index] != ctx.stacked_dims[bottom_blob_index])
+                return BATCH_NONE;
+
+            if (m.dims != m0.dims || m.w != m0.w || m.h != m0.h || m.elempack != m0.elempack)
+                return BATCH_NONE;
+        }
+
+        return BATCH_ELEMENTWISE;
+    }
+
+    return BATCH_NONE;
+}
+
+int NetPrivate::unstack_batch_blob(int blob_index, BatchForwardContext& ctx, const Option& opt) const
+{
+    if (!ctx.stacked_rows[blob_index] || ctx.blob_mats[0][blob_index].dims != 0)
+        return 0;
+
+    const int batch_size = (int)ctx.blob_mats.size();
+    const int rows = ctx.stacked_rows[blob_index];
+    const int dims = ctx.stacked_dims[blob_index];
+
+    Option opt_unpack = opt;
+    opt_unpack.blob_allocator = opt.workspace_allocator;
+
+    Mat stacked;
+    convert_packing(ctx.stacked_mats[blob_index], stacked, 1, opt_unpack);
+    if (stacked.empty())
+        return -100;
+
+    const int w = stacked.w;
+    const size_t elemsize = stacked.elemsize;
+
+    for (int b = 0; b < batch_size; b++)
+    {
+        Mat m;
+        if (dims == 1)
+            m.create(w, elemsize, opt.blob_allocator);
+        else
+            m.create(w, rows, elemsize, opt.blob_allocator);
+        if (m.empty())
+            return -100;
+
+        memcpy(m.data, (const unsigned char*)stacked.data + (size_t)w * rows * b * elemsize, (size_t)w * rows * elemsize);
+
+        ctx.blob_mats[b][blob_index] = m;
+    }
+
+    if (opt.lightmode)
+    {
+        ctx.stacked_mats[blob_index].release();
+        ctx.stacked_rows[blob_index] = 0;
+    }
+
+    return 0;
+}
+
+static int forward_convolution_batch(int layer_index, BatchForwardContext& ctx, const NetPrivate* net, const Option& opt)
+{
+    const Layer* layer = net->layers[layer_index];
+    const Convolution* convolution = (const Convolution*)layer;
+
+    const int batch_size = (int)ctx.blob_mats.size();
+    const int bottom_blob_index = layer->bottoms[0];
+    const int top_blob_index = layer->tops[0];
+
+    const Mat& m0 = ctx.blob_mats[0][bottom_blob_index];
+    const int w = m0.w;
+    const int h = m0.h;
+    const int channels = m0.c;
+    const size_t elemsize = m0.elemsize;
+    const int elempack = m0.elempack;
+
+    // pad_bottom of one item and pad_top of the next one
+    const int gap = convolution->pad_top + convolution->pad_bottom;
+    const int padded_h = h + gap;
+
+    Mat stacked(w, h * batch_size + gap * (batch_size - 1), channels, elemsize, elempack, opt.blob_allocator);
+    if (stacked.empty())
+        return -100;
+
+    #pragma omp parallel for num_threads(opt.num_threads)
+    for (int q = 0; q < channels; q++)
+    {
+        unsigned char* outptr = stacked.channel(q);
+
+        for (int b = 0; b < batch_size; b++)
+        {
+            const Mat m = ctx.blob_mats[b][bottom_blob_index].channel(q);
+
+            memcpy(outptr, m.data, (size_t)w * h * elemsize);
+            outptr += (size_t)w * h * elemsize;
+
+            if (b != batch_size - 1)
+            {
+                memset(outptr, 0, (size_t)w * gap * elemsize);
+                outptr += (size_t)w * gap * elemsize;
+            }
+        }
+    }
+
+    if (opt.lightmode)
+    {
+        for (int b = 0; b < batch_size; b++)
+        {
+            ctx.blob_mats[b][bottom_blob_index].release();
+        }
+    }
+
+    ctx.stacked_mats[bottom_blob_index] = stacked;
+    stacked.release();
+
+    int ret = net->do_forward_layer_profiled(layer_index, ctx.stacked_mats, opt, ctx.profiler);
+    ctx.stacked_mats[bottom_blob_index].release();
+    if (ret != 0)
+        return ret;
+
+    Mat top_blob = ctx.stacked_mats[top_blob_index];
+    ctx.stacked_mats[top_blob_index].release();
+
+    const int kernel_extent_h = convolution->dilation_h * (convolution->kernel_h - 1) + 1;
+    const int outw = top_blob.w;
+    const int outh = (padded_h - kernel_extent_h) / convolution->stride_h + 1;
+    const int out_channels = top_blob.c;
+    const size_t out_elemsize = top_blob.elemsize;
+    const int out_elempack = top_blob.elempack;
+
+    for (int b = 0; b < batch_size; b++)
+    {
+        Mat m(outw, outh, out_channels, out_elemsize, out_elempack, opt.blob_allocator);
+        if (m.empty())
+            return -100;
+
+        const int y0 = b * padded_h / convolution->stride_h;
+
+        #pragma omp parallel for num_threads(opt.num_threads)
+        for (int q = 0; q < out_channels; q++)
+        {
+            const unsigned char* ptr = (const unsigned char*)top_blob.channel(q).data + (size_t)outw * y0 * out_elemsize;
+            memcpy(m.channel(q).data, ptr, (size_t)outw * outh * out_elemsize);
+        }
+
+        ctx.blob_mats[b][top_blob_index] = m;
+    }
+
+    return 0;
+}
+
+int NetPrivate::forward_layer_batch(int layer_index, BatchForwardContext& ctx, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+
+    const int batch_size = (int)ctx.blob_mats.size();
+
+    // load bottom blobs
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (!ctx.stacked_rows[bottom_blob_index] && ctx.blob_mats[0][bottom_blob_index].dims == 0)
+        {
+            int ret = forward_layer_batch(blobs[bottom_blob_index].producer, ctx, opt);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    const Option opt1 = layer->featmask ? get_masked_option(opt, layer->featmask) : opt;
+
+    const int batch_type = get_batch_type(layer, ctx);
+
+    if (batch_type == BATCH_NONE)
+    {
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
+        {
+            int ret = unstack_batch_blob(layer->bottoms[i], ctx, opt1);
+            if (ret != 0)
+                return ret;
+        }
+
+        for (int b = 0; b < batch_size; b++)
+        {
+            int ret = do_forward_layer_profiled(layer_index, ctx.blob_mats[b], opt1, ctx.profiler);
+            if (ret != 0)
+                return ret;
+        }
+
+        return 0;
+    }
+
+    if (batch_type == BATCH_CONVOLUTION)
+    {
+        return forward_convolution_batch(layer_index, ctx, this, opt1);
+    }
+
+    // the whole batch runs as one blob
+    const int bottom_blob_index = layer->bottoms[0];
+    if (batch_type == BATCH_ROWS && !ctx.stacked_rows[bottom_blob_index])
+    {
+        int ret = stack_batch_rows(ctx, bottom_blob_index, opt1);
+        if (ret != 0)
+            return ret;
+    }
+
+    const int rows = ctx.stacked_rows[bottom_blob_index];
+    const int dims = ctx.stacked_dims[bottom_blob_index];
+
+    int ret = do_forward_layer_profiled(layer_index, ctx.stacked_mats, opt1, ctx.profiler);
+    if (ret != 0)
+        return ret;
+
+    if (opt.lightmode)
+    {
+        for (size_t i = 0; i < layer->bottoms.size(); i++)
+        {
+            int blob_index = layer->bottoms[i];
+
+            ctx.stacked_rows[blob_index] = 0;
+            for (int b = 0; b < batch_size; b++)
+            {
+                ctx.blob_mats[b][blob_index].release();
+            }
+        }
+    }
+
+    for (size_t i = 0; i < layer->tops.size(); i++)
+    {
+        int top_blob_index = layer->tops[i];
+
+        ctx.stacked_rows[top_blob_index] = rows;
+        ctx.stacked_dims[top_blob_index] = dims;
+    }
+
+    return 0;
+}
+
+#if NCNN_VULKAN
+int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
+{
+    const Layer* layer = layers[layer_index];
+
+    //     NCNN_LOGE("forward_layer %d %d %s", layer->support_vulkan, layer_index, layer->name.c_str());
+
+    bool cmd_submit_and_wait = false;
+
+    // load bottom blobs
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        int bottom_blob_index = layer->bottoms[i];
+
+        if (blob_mats_gpu[bottom_blob_index].dims == 0 && blob_mats[bottom_blob_index].dims == 0)
+        {
+            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_mats, blob_mats_gpu, cmd, opt);
+            if (ret != 0)
+                return ret;
+        }
+
+        if (layer->support_vulkan)
+        {
+            if (blob_mats_gpu[bottom_blob_index].dims == 0)
+            {
+                // host to buffer
+                cmd.record_upload(blob_mats[bottom_blob_index], blob_mats_gpu[bottom_blob_index], opt);
+
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    blob_mats[bottom_blob_index].release();
+                }
+            }
+        }
+        else
+        {
+            if (blob_mats[bottom_blob_index].dims == 0)
+            {
+                Option opt_download = opt;
+                opt_download.use_packing_layout = layer->support_packing;
+
+                // buffer to host
+                cmd.record_download(blob_mats_gpu[bottom_blob_index], blob_mats[bottom_blob_index], opt_download);
+
+                if (opt.lightmode)
+                {
+                    // delete after taken in light mode
+                    blob_mats_gpu[bottom_blob_index].release();
+                }
+
+                cmd_submit_and_wait = true;
+            }
+        }
+    }
+
+    int ret;
+    if (cmd_submit_and_wait)
+    {
+        ret = cmd.submit_and_wait();
+
+#if NCNN_BENCHMARK
+        std::vector<uint64_t> results(layer_index * 2);
+        cmd.get_query_pool_results(0, layer_index * 2, results);
+        for (int i = 0; i < layer_index; i++)
+        {
+            uint64_t start = results[i * 2];
+            uint64_t end = results[i * 2 + 1];
+            if (start == 0 || end == 0)
+                continue;
+
+            double duration_us = (end - start) * vkdev->info.timestamp_period() / 1000;
+            NCNN_LOGE("%-24s %-30s %8.2lfus    |", layers[i]->type.c_str(), layers[i]->name.c_str(), duration_us);
+        }
+#endif // NCNN_BENCHMARK
+
+        cmd.reset();
+        if (ret != 0)
+            return ret;
+    }
+
+    if (layer->support_vulkan)
+    {
+#if NCNN_BENCHMARK
+        cmd.record_write_timestamp(layer_index * 2);
+#endif
+        if (layer->featmask)
+        {
+            ret = do_forward_layer(layer, blob_mats_gpu, cmd, get_masked_option(opt, layer->featmask));
         }
         else
         {
@@ -348,21 +1448,437 @@ int NetPrivate::forward_layer(int layer_index, std::vector<Mat>& blob_mats, std:
         }
         else
         {
-            benchmark(layer, start, end);
+            benchmark(layer, start, end);
+        }
+#endif
+    }
+    if (ret != 0)
+        return ret;
+
+    //     NCNN_LOGE("forward_layer %d %d %s done", layer->support_vulkan, layer_index, layer->name.c_str());
+
+    return 0;
+}
+#endif // NCNN_VULKAN
+
+int NetPrivate::create_pipeline(int layer_index, const Option& opt)
+{
+    Layer* layer = layers[layer_index];
+
+    Option opt1 = get_masked_option(opt, layer->featmask);
+
+    double start = get_current_time();
+
+    int cret = -1;
+#if NCNN_STDIO
+    if (layer_index < (int)weight_cache_weights.size() && !weight_cache_weights[layer_index].empty())
+    {
+        cret = layer->load_pipeline_weights(weight_cache_weights[layer_index], opt1);
+    }
+    if (cret != 0)
+#endif // NCNN_STDIO
+    {
+        cret = layer->create_pipeline(opt1);
+    }
+
+    double end = get_current_time();
+
+    create_pipeline_times[layer_index] = end - start;
+
+    if (cret != 0)
+    {
+#if NCNN_STRING
+        NCNN_LOGE("layer create_pipeline %d %s failed", layer_index, layer->name.c_str());
+#else
+        NCNN_LOGE("layer create_pipeline %d failed", layer_index);
+#endif
+        return -1;
+    }
+
+    return 0;
+}
+
+#if NCNN_THREADS
+class ParallelCreatePipelineContext
+{
+public:
+    NetPrivate* net;
+    const Option* opt;
+
+    Mutex lock;
+    int next_layer_index;
+    int ret;
+};
+
+static void* parallel_create_pipeline_worker(void* args)
+{
+    ParallelCreatePipelineContext* ctx = (ParallelCreatePipelineContext*)args;
+
+    // denormal flags and affinity are per thread state
+    set_flush_denormals(ctx->opt->flush_denormals);
+
+    NumaNodeBinding numa_binding(ctx->opt->numa_node);
+
+    ctx->net->create_pipeline_worker(ctx);
+
+    return 0;
+}
+
+void NetPrivate::create_pipeline_worker(ParallelCreatePipelineContext* ctx)
+{
+    const int layer_count = (int)layers.size();
+
+    for (;;)
+    {
+        ctx->lock.lock();
+        int layer_index = ctx->ret == 0 ? ctx->next_layer_index++ : layer_count;
+        ctx->lock.unlock();
+
+        if (layer_index >= layer_count)
+            break;
+
+        int ret = create_pipeline(layer_index, *ctx->opt);
+        if (ret != 0)
+        {
+            ctx->lock.lock();
+            ctx->ret = ret;
+            ctx->lock.unlock();
+            break;
+        }
+    }
+}
+#endif // NCNN_THREADS
+
+int NetPrivate::create_pipeline_parallel(const Option& opt)
+{
+#if NCNN_THREADS
+    const int layer_count = (int)layers.size();
+
+    ParallelCreatePipelineContext ctx;
+    ctx.net = this;
+    ctx.opt = &opt;
+    ctx.next_layer_index = 0;
+    ctx.ret = 0;
+
+    // every layer transform may open its own openmp team of opt.num_threads,
+    // so only run as many layers at once as the cpus can hold such teams
+    const int team_count = std::max(get_cpu_count() / std::max(opt.num_threads, 1), 1);
+    const int worker_count = std::max(std::min(team_count, layer_count), 1);
+
+    std::vector<Thread*> workers(worker_count - 1);
+    for (int i = 0; i < worker_count - 1; i++)
+    {
+        workers[i] = new Thread(parallel_create_pipeline_worker, &ctx);
+    }
+
+    // the calling thread works too
+    create_pipeline_worker(&ctx);
+
+    for (int i = 0; i < worker_count - 1; i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+
+    return ctx.ret;
+#else  // NCNN_THREADS
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        int ret = create_pipeline((int)i, opt);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
+#endif // NCNN_THREADS
+}
+
+#if NCNN_STDIO
+void NetPrivate::get_weight_cache_key(const DataReaderWithHash& dr, const Option& opt, weight_cache_key& key) const
+{
+    memset(&key, 0, sizeof(key));
+    key.magic = 0x6e637763; // ncwc
+    key.version = 3;
+    key.model_hash = dr.hash;
+    key.param_hash = param_hash;
+    key.model_size = (uint64_t)dr.size;
+
+    // the graph shape around each layer
+    uint32_t layer_hash = 0x811c9dc5;
+    for (size_t i = 0; i < layers.size(); i++)
+    {
+        const Layer* layer = layers[i];
+
+        int layer_desc[4];
+        layer_desc[0] = layer->typeindex;
+        layer_desc[1] = layer->featmask;
+        layer_desc[2] = (int)layer->bottoms.size();
+        layer_desc[3] = (int)layer->tops.size();
+        layer_hash = fnv1a_32(layer_hash, layer_desc, sizeof(layer_desc));
+    }
+    key.layer_hash = layer_hash;
+    key.layer_count = (uint32_t)layers.size();
+
+    // the layer implementation dispatched for this cpu
+    const int isa_support[] = {
+        cpu_support_x86_avx(),
+        cpu_support_x86_fma(),
+        cpu_support_x86_xop(),
+        cpu_support_x86_f16c(),
+        cpu_support_x86_avx2(),
+        cpu_support_x86_avx_vnni(),
+        cpu_support_x86_avx_vnni_int8(),
+        cpu_support_x86_avx_vnni_int16(),
+        cpu_support_x86_avx_ne_convert(),
+        cpu_support_x86_avx512(),
+        cpu_support_x86_avx512_vnni(),
+        cpu_support_x86_avx512_bf16(),
+        cpu_support_x86_avx512_fp16(),
+        cpu_support_x86_amx_tile(),
+        cpu_support_x86_amx_int8(),
+        cpu_support_x86_amx_bf16(),
+        cpu_support_arm_asimdhp(),
+        cpu_support_arm_asimddp(),
+        cpu_support_arm_asimdfhm(),
+        cpu_support_arm_bf16(),
+        cpu_support_arm_i8mm(),
+        cpu_support_arm_sve(),
+        cpu_support_arm_sve2()
+    };
+    for (int i = 0; i < (int)(sizeof(isa_support) / sizeof(int)); i++)
+    {
+        if (isa_support[i])
+            key.isa |= 1u << i;
+    }
+
+    // options that change the weight transforms
+    const bool option_bits[] = {
+        opt.use_winograd_convolution,
+        opt.use_sgemm_convolution,
+        opt.use_int8_inference,
+        opt.use_bf16_storage,
+        opt.use_fp16_packed,
+        opt.use_fp16_storage,
+        opt.use_fp16_arithmetic,
+        opt.use_int8_packed,
+        opt.use_int8_storage,
+        opt.use_int8_arithmetic,
+        opt.use_packing_layout,
+        opt.use_winograd23_convolution,
+        opt.use_winograd43_convolution,
+        opt.use_winograd63_convolution,
+        opt.use_a53_a55_optimized_kernel
+    };
+    for (int i = 0; i < (int)(sizeof(option_bits) / sizeof(bool)); i++)
+    {
+        if (option_bits[i])
+            key.option |= 1u << i;
+    }
+
+    // tile sizes follow the thread count and cache sizes
+    key.num_threads = opt.num_threads;
+    key.l2_cache_size = get_cpu_level2_cache_size();
+    key.l3_cache_size = get_cpu_level3_cache_size();
+}
+
+int NetPrivate::load_weight_cache(const weight_cache_key& key)
+{
+    weight_cache_weights.clear();
+
+    // no cache file yet is the usual first run
+    FILE* fp = fopen(weight_cache_path.c_str(), "rb");
+    if (!fp)
+        return -1;
+
+    fclose(fp);
+
+    DataReaderFromMmap* dr = new DataReaderFromMmap(weight_cache_path.c_str());
+    if (!dr->mapped())
+    {
+        delete dr;
+        return -1;
+    }
+
+    weight_cache_key cache_key;
+    if (dr->read(&cache_key, sizeof(cache_key)) != sizeof(cache_key) || memcmp(&cache_key, &key, sizeof(key)) != 0)
+    {
+        // made for another model, cpu or option
+        delete dr;
+        return -1;
+    }
+
+    size_t offset = sizeof(cache_key);
+
+    std::vector<std::vector<Mat> > weights(layers.size());
+    for (;;)
+    {
+        int layer_desc[2];
+        if (dr->read(layer_desc, sizeof(layer_desc)) != sizeof(layer_desc))
+            break;
+
+        offset += sizeof(layer_desc);
+
+        const int layer_index = layer_desc[0];
+        const int weight_count = layer_desc[1];
+        if (layer_index < 0 || layer_index >= (int)layers.size() || weight_count <= 0)
+        {
+            NCNN_LOGE("weight cache %s corrupted", weight_cache_path.c_str());
+            delete dr;
+            return -1;
+        }
+
+        std::vector<Mat>& layer_weights = weights[layer_index];
+        layer_weights.resize(weight_count);
+
+        for (int i = 0; i < weight_count; i++)
+        {
+            weight_cache_mat wm;
+            if (dr->read(&wm, sizeof(wm)) != sizeof(wm))
+            {
+                NCNN_LOGE("weight cache %s corrupted", weight_cache_path.c_str());
+                delete dr;
+                return -1;
+            }
+
+            offset += sizeof(wm);
+
+            if (wm.dims == 0)
+                continue;
+
+            const void* pad = 0;
+            size_t pad_size = alignSize(offset, 64) - offset;
+            size_t data_size = (size_t)wm.cstep * wm.c * wm.elemsize;
+            const void* data = 0;
+            if (dr->reference(pad_size, &pad) != pad_size || dr->reference(data_size, &data) != data_size)
+            {
+                NCNN_LOGE("weight cache %s corrupted", weight_cache_path.c_str());
+                delete dr;
+                return -1;
+            }
+
+            offset += pad_size + data_size;
+
+            Mat& m = layer_weights[i];
+            if (wm.dims == 1)
+                m = Mat(wm.w, (void*)data, (size_t)wm.elemsize, wm.elempack);
+            if (wm.dims == 2)
+                m = Mat(wm.w, wm.h, (void*)data, (size_t)wm.elemsize, wm.elempack);
+            if (wm.dims == 3)
+                m = Mat(wm.w, wm.h, wm.c, (void*)data, (size_t)wm.elemsize, wm.elempack);
+            if (wm.dims == 4)
+                m = Mat(wm.w, wm.h, wm.d, wm.c, (void*)data, (size_t)wm.elemsize, wm.elempack);
+            m.cstep = wm.cstep;
+        }
+    }
+
+    // the restored weights stay mapped
+    delete weight_cache_mmap;
+    weight_cache_mmap = dr;
+
+    weight_cache_weights.swap(weights);
+    return 0;
+}
+
+int NetPrivate::save_weight_cache(const weight_cache_key& key) const
+{
+    // write aside and rename, processes mapping the old cache keep their pages
+    // a unique name keeps processes and nets saving at the same time apart
+    static int tmp_serial = 0;
+    const int serial = NCNN_XADD(&tmp_serial, 1);
+#if _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = (int)getpid();
+#endif
+    const unsigned int salt = (unsigned int)(get_current_time() * 1000) ^ (unsigned int)(size_t)this;
+
+    char suffix[64];
+    sprintf(suffix, ".%d.%08x.%d.tmp", pid, salt, serial);
+    std::string tmppath = weight_cache_path + suffix;
+
+    FILE* fp = fopen(tmppath.c_str(), "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", tmppath.c_str());
+        return -1;
+    }
+
+    static const unsigned char zeros[64] = {0};
+
+    bool ok = fwrite(&key, sizeof(key), 1, fp) == 1;
+    size_t offset = sizeof(key);
+
+    for (size_t i = 0; ok && i < layers.size(); i++)
+    {
+        std::vector<Mat> layer_weights;
+        if (layers[i]->save_pipeline_weights(layer_weights) != 0 || layer_weights.empty())
+            continue;
+
+        int layer_desc[2];
+        layer_desc[0] = (int)i;
+        layer_desc[1] = (int)layer_weights.size();
+        ok = fwrite(layer_desc, sizeof(layer_desc), 1, fp) == 1;
+        offset += sizeof(layer_desc);
+
+        for (size_t j = 0; ok && j < layer_weights.size(); j++)
+        {
+            const Mat& m = layer_weights[j];
+
+            weight_cache_mat wm;
+            memset(&wm, 0, sizeof(wm));
+            if (!m.empty())
+            {
+                wm.dims = m.dims;
+                wm.w = m.w;
+                wm.h = m.h;
+                wm.d = m.d;
+                wm.c = m.c;
+                wm.elemsize = (int32_t)m.elemsize;
+                wm.elempack = m.elempack;
+                wm.cstep = (int32_t)m.cstep;
+            }
+
+            ok = fwrite(&wm, sizeof(wm), 1, fp) == 1;
+            offset += sizeof(wm);
+
+            if (!ok || wm.dims == 0)
+                continue;
+
+            size_t pad_size = alignSize(offset, 64) - offset;
+            size_t data_size = m.cstep * m.c * m.elemsize;
+            ok = fwrite(zeros, 1, pad_size, fp) == pad_size && fwrite(m.data, 1, data_size, fp) == data_size;
+            offset += pad_size + data_size;
         }
-#endif
     }
-    if (ret != 0)
-        return ret;
 
-    //     NCNN_LOGE("forward_layer %d %d %s done", layer->support_vulkan, layer_index, layer->name.c_str());
+    ok = fclose(fp) == 0 && ok;
+    if (!ok)
+    {
+        NCNN_LOGE("write %s failed", tmppath.c_str());
+        remove(tmppath.c_str());
+        return -1;
+    }
+
+#if _WIN32
+    remove(weight_cache_path.c_str());
+#endif
+    if (rename(tmppath.c_str(), weight_cache_path.c_str()) != 0)
+    {
+        NCNN_LOGE("rename %s failed", tmppath.c_str());
+        remove(tmppath.c_str());
+        return -1;
+    }
 
     return 0;
 }
-#endif // NCNN_VULKAN
+#endif // NCNN_STDIO
 
 int NetPrivate::convert_layout(Mat& bottom_blob, const Layer* layer, const Option& opt) const
 {
+    // zero-length blob carries its shape only, such as an empty kv cache on the first step
+    if (bottom_blob.dims != 0 && bottom_blob.total() == 0)
+        return 0;
+
     if (bottom_blob.elembits() == 32)
     {
         // clang-format off
@@ -679,6 +2195,86 @@ int NetPrivate::do_forward_layer(const Layer* layer, std::vector<Mat>& blob_mats
     return 0;
 }
 
+// shape of blob without referencing its data
+static Mat get_blob_shape(const Mat& m)
+{
+    Mat shape;
+    shape.dims = m.dims;
+    shape.w = m.w;
+    shape.h = m.h;
+    shape.d = m.d;
+    shape.c = m.c;
+    shape.elemsize = m.elemsize;
+    shape.elempack = m.elempack;
+    shape.cstep = m.cstep;
+    return shape;
+}
+
+int NetPrivate::do_forward_layer_profiled(int layer_index, std::vector<Mat>& blob_mats, const Option& opt, LayerProfiler* profiler, int worker) const
+{
+    const Layer* layer = layers[layer_index];
+
+    if (!profiler)
+        return do_forward_layer(layer, blob_mats, opt);
+
+    LayerProfile profile;
+    profile.layer_index = layer_index;
+    profile.worker = worker;
+    profile.kernel = layer->kernel_name();
+
+    std::vector<const void*> bottom_datas(layer->bottoms.size());
+    profile.bottom_shapes.resize(layer->bottoms.size());
+    for (size_t i = 0; i < layer->bottoms.size(); i++)
+    {
+        const Mat& bottom_blob = blob_mats[layer->bottoms[i]];
+        bottom_datas[i] = bottom_blob.data;
+        profile.bottom_shapes[i] = get_blob_shape(bottom_blob);
+    }
+
+    // count what the layer allocates from workspace
+    ProfileWorkspaceAllocator& workspace_allocator = *profiler->get_workspace_allocator(worker);
+    workspace_allocator.allocator = opt.workspace_allocator;
+
+    Option opt1 = opt;
+    opt1.workspace_allocator = &workspace_allocator;
+
+    const size_t workspace_start = workspace_allocator.allocated_bytes();
+    profile.start = get_current_time() - profiler->origin;
+
+    int ret = do_forward_layer(layer, blob_mats, opt1);
+
+    profile.end = get_current_time() - profiler->origin;
+    const size_t workspace_end = workspace_allocator.allocated_bytes();
+
+    if (ret != 0)
+        return ret;
+
+    profile.allocated_bytes = workspace_end - workspace_start;
+
+    profile.top_shapes.resize(layer->tops.size());
+    for (size_t i = 0; i < layer->tops.size(); i++)
+    {
+        const Mat& top_blob = blob_mats[layer->tops[i]];
+        profile.top_shapes[i] = get_blob_shape(top_blob);
+
+        // inplace and passthrough tops allocate nothing
+        bool is_new_blob = true;
+        for (size_t j = 0; j < bottom_datas.size(); j++)
+        {
+            if (top_blob.data == bottom_datas[j])
+                is_new_blob = false;
+        }
+
+        if (is_new_blob)
+            profile.allocated_bytes += top_blob.total() * top_blob.elemsize;
+    }
+
+    MutexLockGuard guard(profiler->lock);
+    profiler->profiles.push_back(profile);
+
+    return 0;
+}
+
 #if NCNN_VULKAN
 int NetPrivate::do_forward_layer(const Layer* layer, std::vector<VkMat>& blob_mats_gpu, VkCompute& cmd, const Option& opt) const
 {
@@ -995,6 +2591,10 @@ int Net::load_param(const DataReader& dr)
     d->layers.resize((size_t)layer_count);
     d->blobs.resize((size_t)blob_count);
 
+#if NCNN_STDIO
+    d->param_hash = 0x811c9dc5;
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     // TODO enable gpu when bf16 conversion implemented
     if (opt.use_bf16_storage)
@@ -1144,6 +2744,10 @@ int Net::load_param(const DataReader& dr)
             continue;
         }
 
+#if NCNN_STDIO
+        d->param_hash = fnv1a_32(d->param_hash, pd);
+#endif // NCNN_STDIO
+
         // pull out top shape hints
         Mat shape_hints = pd.get(30, Mat());
         if (!shape_hints.empty())
@@ -1294,6 +2898,10 @@ int Net::load_param_bin(const DataReader& dr)
     d->layers.resize(layer_count);
     d->blobs.resize(blob_count);
 
+#if NCNN_STDIO
+    d->param_hash = 0x811c9dc5;
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     // TODO enable gpu when bf16 conversion implemented
     if (opt.use_bf16_storage)
@@ -1426,6 +3034,10 @@ int Net::load_param_bin(const DataReader& dr)
             continue;
         }
 
+#if NCNN_STDIO
+        d->param_hash = fnv1a_32(d->param_hash, pd);
+#endif // NCNN_STDIO
+
         // pull out top blob shape hints
         Mat shape_hints = pd.get(30, Mat());
         if (!shape_hints.empty())
@@ -1538,6 +3150,9 @@ int Net::load_model(const DataReader& dr)
         return -1;
     }
 
+    // weights are allocated and first touched by this thread and the openmp workers
+    NumaNodeBinding numa_binding(opt.numa_node);
+
     int layer_count = (int)d->layers.size();
 
     // load file
@@ -1555,7 +3170,30 @@ int Net::load_model(const DataReader& dr)
     }
 #endif // NCNN_VULKAN
 
+    d->create_pipeline_times.clear();
+    d->create_pipeline_times.resize(layer_count, 0.0);
+
+#if NCNN_VULKAN
+    const bool parallel_create_pipeline = opt.use_parallel_create_pipeline && !opt.use_vulkan_compute;
+#else
+    const bool parallel_create_pipeline = opt.use_parallel_create_pipeline;
+#endif
+
+#if NCNN_STDIO
+#if NCNN_VULKAN
+    const bool use_weight_cache = !d->weight_cache_path.empty() && !opt.use_vulkan_compute;
+#else
+    const bool use_weight_cache = !d->weight_cache_path.empty();
+#endif
+
+    // the cache key needs the hash of all weights before any pipeline is created
+    DataReaderWithHash hdr(dr);
+    ModelBinFromDataReader mb(use_weight_cache ? (const DataReader&)hdr : dr);
+#else
+    const bool use_weight_cache = false;
+
     ModelBinFromDataReader mb(dr);
+#endif // NCNN_STDIO
     for (int i = 0; i < layer_count; i++)
     {
         Layer* layer = d->layers[i];
@@ -1580,21 +3218,55 @@ int Net::load_model(const DataReader& dr)
             break;
         }
 
-        Option opt1 = get_masked_option(opt, layer->featmask);
+        if (parallel_create_pipeline || use_weight_cache)
+            continue;
 
-        int cret = layer->create_pipeline(opt1);
+        int cret = d->create_pipeline(i, opt);
         if (cret != 0)
         {
-#if NCNN_STRING
-            NCNN_LOGE("layer create_pipeline %d %s failed", i, layer->name.c_str());
-#else
-            NCNN_LOGE("layer create_pipeline %d failed", i);
-#endif
             ret = -1;
             break;
         }
     }
 
+#if NCNN_STDIO
+    weight_cache_key cache_key;
+    bool weight_cache_hit = false;
+    if (ret == 0 && use_weight_cache)
+    {
+        d->get_weight_cache_key(hdr, opt, cache_key);
+        weight_cache_hit = d->load_weight_cache(cache_key) == 0;
+    }
+#endif // NCNN_STDIO
+
+    if (ret == 0 && parallel_create_pipeline)
+    {
+        // all weights are loaded, the transforms do not depend on each other
+        ret = d->create_pipeline_parallel(opt);
+    }
+    else if (ret == 0 && use_weight_cache)
+    {
+        for (int i = 0; i < layer_count; i++)
+        {
+            int cret = d->create_pipeline(i, opt);
+            if (cret != 0)
+            {
+                ret = -1;
+                break;
+            }
+        }
+    }
+
+#if NCNN_STDIO
+    // layers reference the restored weights from now on
+    d->weight_cache_weights.clear();
+
+    if (ret == 0 && use_weight_cache && !weight_cache_hit)
+    {
+        d->save_weight_cache(cache_key);
+    }
+#endif // NCNN_STDIO
+
     if (opt.use_local_pool_allocator)
     {
         if (opt.blob_allocator == 0)
@@ -1694,6 +3366,39 @@ int Net::load_model(const char* modelpath)
     fclose(fp);
     return ret;
 }
+
+int Net::load_model_mmap(const char* modelpath)
+{
+    DataReaderFromMmap* dr = new DataReaderFromMmap(modelpath);
+    if (!dr->mapped())
+    {
+        delete dr;
+        return -1;
+    }
+
+    int ret = load_model(*dr);
+    if (ret != 0)
+    {
+        // layers loaded before the failure reference the new mapping
+        d->model_mmaps.push_back(dr);
+        return ret;
+    }
+
+    // weights of the previous model are replaced now
+    for (size_t i = 0; i < d->model_mmaps.size(); i++)
+    {
+        delete d->model_mmaps[i];
+    }
+    d->model_mmaps.clear();
+    d->model_mmaps.push_back(dr);
+
+    return 0;
+}
+
+void Net::set_weight_cache(const char* cachepath)
+{
+    d->weight_cache_path = cachepath ? cachepath : "";
+}
 #endif // NCNN_STDIO
 
 int Net::load_param(const unsigned char* _mem)
@@ -1831,6 +3536,7 @@ void Net::clear()
         }
     }
     d->layers.clear();
+    d->create_pipeline_times.clear();
 
     if (d->local_blob_allocator)
     {
@@ -1843,6 +3549,19 @@ void Net::clear()
         d->local_workspace_allocator = 0;
     }
 
+#if NCNN_STDIO
+    for (size_t i = 0; i < d->model_mmaps.size(); i++)
+    {
+        delete d->model_mmaps[i];
+    }
+    d->model_mmaps.clear();
+    if (d->weight_cache_mmap)
+    {
+        delete d->weight_cache_mmap;
+        d->weight_cache_mmap = 0;
+    }
+#endif // NCNN_STDIO
+
 #if NCNN_VULKAN
     if (d->weight_vkallocator)
     {
@@ -1905,6 +3624,11 @@ std::vector<Blob>& Net::mutable_blobs()
     return d->blobs;
 }
 
+const std::vector<double>& Net::create_pipeline_times() const
+{
+    return d->create_pipeline_times;
+}
+
 std::vector<Layer*>& Net::mutable_layers()
 {
     return d->layers;
@@ -2031,16 +3755,37 @@ Layer* Net::create_overwrite_builtin_layer(int typeindex)
     return layer;
 }
 
+LayerProfile::LayerProfile()
+    : layer_index(-1), start(0.0), end(0.0), worker(0), allocated_bytes(0), kernel(0)
+{
+}
+
 class ExtractorPrivate
 {
 public:
     ExtractorPrivate(const Net* _net)
-        : net(_net)
+        : net(_net), branch_workers(0), profiling(false), profiler(0), reuse_allocator(0), arena_allocator(0)
     {
     }
     const Net* net;
     std::vector<Mat> blob_mats;
     Option opt;
+    int branch_parallel;
+
+    // branch_parallel - 1 threads kept between extract calls, created on first use
+    BranchWorkerPool* branch_workers;
+
+    // kept until destruction, blobs may come from its workspace allocator
+    bool profiling;
+    LayerProfiler* profiler;
+
+    // blob and workspace pool for set_reuse_memory, kept until destruction
+    SizeClassPoolAllocator* reuse_allocator;
+
+    // blob and workspace arena for set_arena_memory, kept until destruction
+    ArenaAllocator* arena_allocator;
+
+    BatchForwardContext batch;
 
 #if NCNN_VULKAN
     VkAllocator* local_blob_vkallocator;
@@ -2055,6 +3800,7 @@ Extractor::Extractor(const Net* _net, size_t blob_count)
 {
     d->blob_mats.resize(blob_count);
     d->opt = d->net->opt;
+    d->branch_parallel = 0;
 
 #if NCNN_VULKAN
     if (d->net->opt.use_vulkan_compute)
@@ -2071,6 +3817,12 @@ Extractor::~Extractor()
 {
     clear();
 
+#if NCNN_THREADS
+    delete d->branch_workers;
+#endif // NCNN_THREADS
+    delete d->profiler;
+    delete d->reuse_allocator;
+    delete d->arena_allocator;
     delete d;
 }
 
@@ -2078,8 +3830,61 @@ Extractor::Extractor(const Extractor& rhs)
     : d(new ExtractorPrivate(0))
 {
     d->net = rhs.d->net;
-    d->blob_mats = rhs.d->blob_mats;
     d->opt = rhs.d->opt;
+    d->branch_parallel = rhs.d->branch_parallel;
+
+    if (rhs.d->reuse_allocator || rhs.d->arena_allocator)
+    {
+        // blobs of rhs may live in its pool or arena, which are destroyed with rhs
+        // so the copy starts without blobs
+        d->blob_mats.resize(rhs.d->blob_mats.size());
+    }
+    else
+    {
+        d->blob_mats = rhs.d->blob_mats;
+        d->batch = rhs.d->batch;
+    }
+
+    if (rhs.d->profiling)
+        set_profiling(true);
+
+    if (rhs.d->reuse_allocator)
+    {
+        // bind a pool of our own in place of the one of rhs
+        bool reuse = false;
+        if (d->opt.blob_allocator == rhs.d->reuse_allocator)
+        {
+            d->opt.blob_allocator = 0;
+            reuse = true;
+        }
+        if (d->opt.workspace_allocator == rhs.d->reuse_allocator)
+        {
+            d->opt.workspace_allocator = 0;
+            reuse = true;
+        }
+
+        if (reuse)
+            set_reuse_memory(true);
+    }
+
+    if (rhs.d->arena_allocator)
+    {
+        // bind an arena of our own, it records the next request again
+        bool arena = false;
+        if (d->opt.blob_allocator == rhs.d->arena_allocator)
+        {
+            d->opt.blob_allocator = 0;
+            arena = true;
+        }
+        if (d->opt.workspace_allocator == rhs.d->arena_allocator)
+        {
+            d->opt.workspace_allocator = 0;
+            arena = true;
+        }
+
+        if (arena)
+            set_arena_memory(true);
+    }
 
 #if NCNN_VULKAN
     d->local_blob_vkallocator = 0;
@@ -2095,8 +3900,62 @@ Extractor& Extractor::operator=(const Extractor& rhs)
         return *this;
 
     d->net = rhs.d->net;
-    d->blob_mats = rhs.d->blob_mats;
     d->opt = rhs.d->opt;
+    d->branch_parallel = rhs.d->branch_parallel;
+
+    if (rhs.d->reuse_allocator || rhs.d->arena_allocator)
+    {
+        // blobs of rhs may live in its pool or arena, which are destroyed with rhs
+        // so the copy starts without blobs
+        d->blob_mats.clear();
+        d->blob_mats.resize(rhs.d->blob_mats.size());
+        d->batch.clear();
+    }
+    else
+    {
+        d->blob_mats = rhs.d->blob_mats;
+        d->batch = rhs.d->batch;
+    }
+
+    set_profiling(rhs.d->profiling);
+
+    if (rhs.d->reuse_allocator)
+    {
+        // bind a pool of our own in place of the one of rhs
+        bool reuse = false;
+        if (d->opt.blob_allocator == rhs.d->reuse_allocator)
+        {
+            d->opt.blob_allocator = 0;
+            reuse = true;
+        }
+        if (d->opt.workspace_allocator == rhs.d->reuse_allocator)
+        {
+            d->opt.workspace_allocator = 0;
+            reuse = true;
+        }
+
+        if (reuse)
+            set_reuse_memory(true);
+    }
+
+    if (rhs.d->arena_allocator)
+    {
+        // bind an arena of our own, it records the next request again
+        bool arena = false;
+        if (d->opt.blob_allocator == rhs.d->arena_allocator)
+        {
+            d->opt.blob_allocator = 0;
+            arena = true;
+        }
+        if (d->opt.workspace_allocator == rhs.d->arena_allocator)
+        {
+            d->opt.workspace_allocator = 0;
+            arena = true;
+        }
+
+        if (arena)
+            set_arena_memory(true);
+    }
 
 #if NCNN_VULKAN
     d->local_blob_vkallocator = 0;
@@ -2111,6 +3970,7 @@ Extractor& Extractor::operator=(const Extractor& rhs)
 void Extractor::clear()
 {
     d->blob_mats.clear();
+    d->batch.clear();
 
 #if NCNN_VULKAN
     if (d->opt.use_vulkan_compute)
@@ -2122,13 +3982,98 @@ void Extractor::clear()
             d->net->vulkan_device()->reclaim_blob_allocator(d->local_blob_vkallocator);
             d->local_blob_vkallocator = 0;
         }
-        if (d->local_staging_vkallocator)
+        if (d->local_staging_vkallocator)
+        {
+            d->net->vulkan_device()->reclaim_staging_allocator(d->local_staging_vkallocator);
+            d->local_staging_vkallocator = 0;
+        }
+    }
+#endif // NCNN_VULKAN
+}
+
+void Extractor::reset()
+{
+    for (size_t i = 0; i < d->blob_mats.size(); i++)
+    {
+        d->blob_mats[i].release();
+    }
+
+    d->batch.clear();
+
+    if (d->arena_allocator)
+    {
+        // plan the recorded request on first reset, then replay the plan
+        d->arena_allocator->rewind();
+    }
+
+#if NCNN_VULKAN
+    for (size_t i = 0; i < d->blob_mats_gpu.size(); i++)
+    {
+        d->blob_mats_gpu[i].release();
+    }
+#endif // NCNN_VULKAN
+}
+
+void Extractor::set_reuse_memory(bool enable)
+{
+    if (enable)
+    {
+        if (!d->reuse_allocator)
+        {
+            d->reuse_allocator = new SizeClassPoolAllocator;
+        }
+
+        if (!d->opt.blob_allocator)
+        {
+            d->opt.blob_allocator = d->reuse_allocator;
+        }
+        if (!d->opt.workspace_allocator)
+        {
+            d->opt.workspace_allocator = d->reuse_allocator;
+        }
+    }
+    else
+    {
+        if (d->opt.blob_allocator && d->opt.blob_allocator == d->reuse_allocator)
+        {
+            d->opt.blob_allocator = d->net->opt.blob_allocator;
+        }
+        if (d->opt.workspace_allocator && d->opt.workspace_allocator == d->reuse_allocator)
+        {
+            d->opt.workspace_allocator = d->net->opt.workspace_allocator;
+        }
+    }
+}
+
+void Extractor::set_arena_memory(bool enable)
+{
+    if (enable)
+    {
+        if (!d->arena_allocator)
+        {
+            d->arena_allocator = new ArenaAllocator;
+        }
+
+        if (!d->opt.blob_allocator)
+        {
+            d->opt.blob_allocator = d->arena_allocator;
+        }
+        if (!d->opt.workspace_allocator)
+        {
+            d->opt.workspace_allocator = d->arena_allocator;
+        }
+    }
+    else
+    {
+        if (d->opt.blob_allocator && d->opt.blob_allocator == d->arena_allocator)
+        {
+            d->opt.blob_allocator = d->net->opt.blob_allocator;
+        }
+        if (d->opt.workspace_allocator && d->opt.workspace_allocator == d->arena_allocator)
         {
-            d->net->vulkan_device()->reclaim_staging_allocator(d->local_staging_vkallocator);
-            d->local_staging_vkallocator = 0;
+            d->opt.workspace_allocator = d->net->opt.workspace_allocator;
         }
     }
-#endif // NCNN_VULKAN
 }
 
 void Extractor::set_light_mode(bool enable)
@@ -2142,6 +4087,127 @@ void Extractor::set_num_threads(int num_threads)
     NCNN_LOGE("If you want to use single thread for only some layer, see https://github.com/Tencent/ncnn/wiki/layer-feat-mask");
 }
 
+void Extractor::set_branch_parallel(int branch_count)
+{
+    d->branch_parallel = branch_count;
+}
+
+void Extractor::set_profiling(bool enable)
+{
+    if (enable && !d->profiler)
+    {
+        d->profiler = new LayerProfiler;
+    }
+
+    if (enable && !d->profiling)
+    {
+        d->profiler->origin = get_current_time();
+    }
+
+    if (!enable && d->profiler)
+    {
+        d->profiler->profiles.clear();
+    }
+
+    d->profiling = enable;
+}
+
+const std::vector<LayerProfile>& Extractor::layer_profiles() const
+{
+    static const std::vector<LayerProfile> empty_profiles;
+
+    return d->profiler ? d->profiler->profiles : empty_profiles;
+}
+
+#if NCNN_STDIO
+static void write_json_string(FILE* fp, const char* str)
+{
+    fputc('"', fp);
+    for (const char* p = str; *p; p++)
+    {
+        if (*p == '"' || *p == '\\')
+            fprintf(fp, "\\%c", *p);
+        else if ((unsigned char)*p < 0x20)
+            fprintf(fp, "\\u%04x", (unsigned char)*p);
+        else
+            fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+
+static void write_json_shapes(FILE* fp, const std::vector<Mat>& shapes)
+{
+    fputc('"', fp);
+    for (size_t i = 0; i < shapes.size(); i++)
+    {
+        const Mat& m = shapes[i];
+
+        if (i != 0)
+            fprintf(fp, " ");
+
+        if (m.dims == 1)
+            fprintf(fp, "[%d]", m.w);
+        if (m.dims == 2)
+            fprintf(fp, "[%d,%d]", m.w, m.h);
+        if (m.dims == 3)
+            fprintf(fp, "[%d,%d,%d]", m.w, m.h, m.c);
+        if (m.dims == 4)
+            fprintf(fp, "[%d,%d,%d,%d]", m.w, m.h, m.d, m.c);
+
+        if (m.dims != 0)
+            fprintf(fp, "p%d/%d", m.elempack, (int)m.elemsize);
+    }
+    fputc('"', fp);
+}
+
+int Extractor::save_profile_chrome_trace(const char* path) const
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", path);
+        return -1;
+    }
+
+    const std::vector<LayerProfile>& profiles = layer_profiles();
+    const std::vector<Layer*>& layers = d->net->layers();
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < profiles.size(); i++)
+    {
+        const LayerProfile& profile = profiles[i];
+        const Layer* layer = layers[profile.layer_index];
+
+        // trace event timestamps are microseconds
+        fprintf(fp, "{\"name\":");
+#if NCNN_STRING
+        write_json_string(fp, layer->name.c_str());
+        fprintf(fp, ",\"cat\":");
+        write_json_string(fp, layer->type.c_str());
+#else
+        fprintf(fp, "\"%d\",\"cat\":\"%d\"", profile.layer_index, layer->typeindex);
+#endif
+        fprintf(fp, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f", profile.worker, profile.start * 1000, (profile.end - profile.start) * 1000);
+        fprintf(fp, ",\"args\":{\"layer\":%d,\"kernel\":", profile.layer_index);
+        write_json_string(fp, profile.kernel ? profile.kernel : "");
+        fprintf(fp, ",\"allocated_bytes\":%lu,\"bottoms\":", (unsigned long)profile.allocated_bytes);
+        write_json_shapes(fp, profile.bottom_shapes);
+        fprintf(fp, ",\"tops\":");
+        write_json_shapes(fp, profile.top_shapes);
+        fprintf(fp, "}}%s\n", i + 1 == profiles.size() ? "" : ",");
+    }
+    fprintf(fp, "]}\n");
+
+    int ret = ferror(fp) ? -1 : 0;
+    fclose(fp);
+
+    if (ret != 0)
+        NCNN_LOGE("write %s failed", path);
+
+    return ret;
+}
+#endif // NCNN_STDIO
+
 void Extractor::set_blob_allocator(Allocator* allocator)
 {
     d->opt.blob_allocator = allocator;
@@ -2175,6 +4241,99 @@ void Extractor::set_staging_vkallocator(VkAllocator* allocator)
 }
 #endif // NCNN_VULKAN
 
+static int convert_extract_output(Mat& feat, int type, const Option& opt, const Allocator* local_blob_allocator, const Allocator* reuse_allocator, const Allocator* arena_allocator)
+{
+    if (opt.use_packing_layout && (type == 0) && feat.elempack != 1)
+    {
+        Mat bottom_blob_unpacked;
+        convert_packing(feat, bottom_blob_unpacked, 1, opt);
+        feat = bottom_blob_unpacked;
+        if (feat.empty())
+            return -100;
+    }
+
+    // clang-format off
+    // *INDENT-OFF*
+#if NCNN_ARM82
+    if (opt.use_fp16_storage && cpu_support_arm_asimdhp() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ARM82
+#if NCNN_VFPV4
+    if (opt.use_fp16_storage && !opt.use_bf16_storage && cpu_support_arm_vfpv4() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_VFPV4
+#if NCNN_ZVFH
+    if (opt.use_fp16_storage && cpu_support_riscv_zvfh() && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_float16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_ZVFH
+#if NCNN_BF16
+    if (opt.use_bf16_storage && (type == 0))
+    {
+        if (feat.elembits() == 16)
+        {
+            Mat feat_fp32;
+            cast_bfloat16_to_float32(feat, feat_fp32, opt);
+            feat = feat_fp32;
+        }
+    }
+    else
+#endif // NCNN_BF16
+    if (feat.elembits() == 8 && (type == 0))
+    {
+        Mat feat_fp32;
+        cast_int8_to_float32(feat, feat_fp32, opt);
+        feat = feat_fp32;
+    }
+    // *INDENT-ON*
+    // clang-format on
+    if (feat.empty())
+        return -100;
+
+    if (opt.use_local_pool_allocator && feat.allocator == local_blob_allocator)
+    {
+        // detach the returned mat from local pool allocator
+        // so we could destroy net instance much earlier
+        feat = feat.clone();
+        if (feat.empty())
+            return -100;
+    }
+    else if ((reuse_allocator && feat.allocator == reuse_allocator) || (arena_allocator && feat.allocator == arena_allocator))
+    {
+        // the reuse pool and the arena are destroyed with the extractor
+        // and the arena is overwritten by the next request
+        // while the returned mat may live longer
+        feat = feat.clone();
+        if (feat.empty())
+            return -100;
+    }
+
+    return 0;
+}
+
 #if NCNN_STRING
 int Extractor::input(const char* blob_name, const Mat& in)
 {
@@ -2211,6 +4370,41 @@ int Extractor::extract(const char* blob_name, Mat& feat, int type)
 
     return extract(blob_index, feat, type);
 }
+int Extractor::input(const char* blob_name, const std::vector<Mat>& in)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+    {
+        NCNN_LOGE("Try");
+        const std::vector<const char*>& input_names = d->net->input_names();
+        for (size_t i = 0; i < input_names.size(); i++)
+        {
+            NCNN_LOGE("    ex.input(\"%s\", in%d);", input_names[i], (int)i);
+        }
+
+        return -1;
+    }
+
+    return input(blob_index, in);
+}
+
+int Extractor::extract(const char* blob_name, std::vector<Mat>& feats, int type)
+{
+    int blob_index = d->net->find_blob_index_by_name(blob_name);
+    if (blob_index == -1)
+    {
+        NCNN_LOGE("Try");
+        const std::vector<const char*>& output_names = d->net->output_names();
+        for (size_t i = 0; i < output_names.size(); i++)
+        {
+            NCNN_LOGE("    ex.extract(\"%s\", out%d);", output_names[i], (int)i);
+        }
+
+        return -1;
+    }
+
+    return extract(blob_index, feats, type);
+}
 #endif // NCNN_STRING
 
 int Extractor::input(int blob_index, const Mat& in)
@@ -2228,6 +4422,8 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
     if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
         return -1;
 
+    NumaNodeBinding numa_binding(d->opt.numa_node);
+
     int old_blocktime = get_kmp_blocktime();
     set_kmp_blocktime(d->opt.openmp_blocktime);
 
@@ -2253,6 +4449,14 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
             }
         }
 
+#if NCNN_THREADS
+        if (d->branch_parallel > 1 && (!d->branch_workers || d->branch_workers->thread_count() != d->branch_parallel - 1))
+        {
+            delete d->branch_workers;
+            d->branch_workers = new BranchWorkerPool(d->branch_parallel - 1);
+        }
+#endif // NCNN_THREADS
+
 #if NCNN_VULKAN
         if (d->opt.use_vulkan_compute)
         {
@@ -2304,95 +4508,146 @@ int Extractor::extract(int blob_index, Mat& feat, int type)
         }
         else
         {
-            ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
+            ret = d->net->d->forward_layer_parallel(layer_index, d->blob_mats, d->opt, d->branch_parallel, d->branch_workers, d->profiling ? d->profiler : 0);
         }
 #else
-        ret = d->net->d->forward_layer(layer_index, d->blob_mats, d->opt);
+        ret = d->net->d->forward_layer_parallel(layer_index, d->blob_mats, d->opt, d->branch_parallel, d->branch_workers, d->profiling ? d->profiler : 0);
 #endif // NCNN_VULKAN
     }
 
     feat = d->blob_mats[blob_index];
 
     // empty is valid for outputs
-    if (!feat.empty())
+    if (ret == 0 && !feat.empty())
     {
-        if (d->opt.use_packing_layout && (type == 0) && feat.elempack != 1)
-        {
-            Mat bottom_blob_unpacked;
-            convert_packing(feat, bottom_blob_unpacked, 1, d->opt);
-            feat = bottom_blob_unpacked;
-            if (feat.empty())
-                return -100;
-        }
+        ret = convert_extract_output(feat, type, d->opt, d->net->d->local_blob_allocator, d->reuse_allocator, d->arena_allocator);
+    }
 
-        // clang-format off
-        // *INDENT-OFF*
-#if NCNN_ARM82
-        if (d->opt.use_fp16_storage && cpu_support_arm_asimdhp() && (type == 0))
+    set_kmp_blocktime(old_blocktime);
+    set_flush_denormals(old_flush_denormals);
+
+    return ret;
+}
+
+int Extractor::input(int blob_index, const std::vector<Mat>& in)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    if (in.empty())
+        return -1;
+
+    BatchForwardContext& batch = d->batch;
+
+    if (batch.blob_mats.empty())
+    {
+        const size_t blob_count = d->blob_mats.size();
+
+        batch.blob_mats.resize(in.size());
+        for (size_t b = 0; b < in.size(); b++)
         {
-            if (feat.elembits() == 16)
-            {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
-            }
+            batch.blob_mats[b].resize(blob_count);
         }
-        else
-#endif // NCNN_ARM82
-#if NCNN_VFPV4
-        if (d->opt.use_fp16_storage && !d->opt.use_bf16_storage && cpu_support_arm_vfpv4() && (type == 0))
+
+        batch.stacked_mats.resize(blob_count);
+        batch.stacked_rows.resize(blob_count, 0);
+        batch.stacked_dims.resize(blob_count, 0);
+    }
+
+    if (batch.blob_mats.size() != in.size())
+    {
+        NCNN_LOGE("batch size %d mismatch with previous input batch size %d", (int)in.size(), (int)batch.blob_mats.size());
+        return -1;
+    }
+
+    for (size_t b = 0; b < in.size(); b++)
+    {
+        batch.blob_mats[b][blob_index] = in[b];
+    }
+
+    return 0;
+}
+
+int Extractor::extract(int blob_index, std::vector<Mat>& feats, int type)
+{
+    if (blob_index < 0 || blob_index >= (int)d->blob_mats.size())
+        return -1;
+
+    BatchForwardContext& batch = d->batch;
+
+    const int batch_size = (int)batch.blob_mats.size();
+    if (batch_size == 0)
+    {
+        NCNN_LOGE("no batch input, set input with std::vector<Mat> first");
+        return -1;
+    }
+
+    feats.resize(batch_size);
+
+#if NCNN_VULKAN
+    if (d->opt.use_vulkan_compute)
+    {
+        // no batched gpu path, run items one by one
+        for (int b = 0; b < batch_size; b++)
         {
-            if (feat.elembits() == 16)
-            {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
-            }
+            d->blob_mats_gpu.clear();
+            d->blob_mats_gpu.resize(d->blob_mats.size());
+
+            d->blob_mats.swap(batch.blob_mats[b]);
+            int ret = extract(blob_index, feats[b], type);
+            d->blob_mats.swap(batch.blob_mats[b]);
+            if (ret != 0)
+                return ret;
         }
-        else
-#endif // NCNN_VFPV4
-#if NCNN_ZVFH
-        if (d->opt.use_fp16_storage && cpu_support_riscv_zvfh() && (type == 0))
+
+        return 0;
+    }
+#endif // NCNN_VULKAN
+
+    NumaNodeBinding numa_binding(d->opt.numa_node);
+
+    int old_blocktime = get_kmp_blocktime();
+    set_kmp_blocktime(d->opt.openmp_blocktime);
+
+    int old_flush_denormals = get_flush_denormals();
+    set_flush_denormals(d->opt.flush_denormals);
+
+    int ret = 0;
+
+    if (!batch.stacked_rows[blob_index] && batch.blob_mats[0][blob_index].dims == 0)
+    {
+        int layer_index = d->net->blobs()[blob_index].producer;
+
+        // use local allocator
+        if (d->opt.use_local_pool_allocator)
         {
-            if (feat.elembits() == 16)
+            if (!d->opt.blob_allocator)
             {
-                Mat feat_fp32;
-                cast_float16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
+                d->opt.blob_allocator = d->net->d->local_blob_allocator;
             }
-        }
-        else
-#endif // NCNN_ZVFH
-#if NCNN_BF16
-        if (d->opt.use_bf16_storage && (type == 0))
-        {
-            if (feat.elembits() == 16)
+            if (!d->opt.workspace_allocator)
             {
-                Mat feat_fp32;
-                cast_bfloat16_to_float32(feat, feat_fp32, d->opt);
-                feat = feat_fp32;
+                d->opt.workspace_allocator = d->net->d->local_workspace_allocator;
             }
         }
-        else
-#endif // NCNN_BF16
-        if (feat.elembits() == 8 && (type == 0))
-        {
-            Mat feat_fp32;
-            cast_int8_to_float32(feat, feat_fp32, d->opt);
-            feat = feat_fp32;
-        }
-        // *INDENT-ON*
-        // clang-format on
-        if (feat.empty())
-            return -100;
 
-        if (d->opt.use_local_pool_allocator && feat.allocator == d->net->d->local_blob_allocator)
+        batch.profiler = d->profiling ? d->profiler : 0;
+        ret = d->net->d->forward_layer_batch(layer_index, batch, d->opt);
+    }
+
+    if (ret == 0)
+    {
+        ret = d->net->d->unstack_batch_blob(blob_index, batch, d->opt);
+    }
+
+    for (int b = 0; b < batch_size && ret == 0; b++)
+    {
+        feats[b] = batch.blob_mats[b][blob_index];
+
+        // empty is valid for outputs
+        if (!feats[b].empty())
         {
-            // detach the returned mat from local pool allocator
-            // so we could destroy net instance much earlier
-            feat = feat.clone();
-            if (feat.empty())
-                return -100;
+            ret = convert_extract_output(feats[b], type, d->opt, d->net->d->local_blob_allocator, d->reuse_allocator, d->arena_allocator);
         }
     }
 
@@ -81,6 +81,22 @@ public:
     // return 0 if success
     int load_model(FILE* fp);
     int load_model(const char* modelpath);
+
+    // map network weight data from model file
+    // weight data is referenced from the mapped file instead of copied
+    // so processes loading the same model share its pages
+    // the mapping is released by clear()
+    // return 0 if success
+    int load_model_mmap(const char* modelpath);
+
+    // cache the weights transformed by create_pipeline in a file
+    // load_model maps the transformed weights back from the cache file and skips their transforms
+    // when the cache file was made for the same model weights, cpu isa and option
+    // otherwise load_model transforms the weights and rewrites the cache file
+    // the mapping is released by clear()
+    // ignored for vulkan
+    // null or empty path disables the cache
+    void set_weight_cache(const char* cachepath);
 #endif // NCNN_STDIO
 
     // load network structure from external memory
@@ -129,6 +145,9 @@ public:
     const std::vector<Blob>& blobs() const;
     const std::vector<Layer*>& layers() const;
 
+    // milliseconds spent in create_pipeline of each layer during the last load_model
+    const std::vector<double>& create_pipeline_times() const;
+
     std::vector<Blob>& mutable_blobs();
     std::vector<Layer*>& mutable_layers();
 
@@ -151,6 +170,33 @@ private:
     NetPrivate* const d;
 };
 
+// one layer run recorded by extractor profiling
+class NCNN_EXPORT LayerProfile
+{
+public:
+    LayerProfile();
+
+    // index into net.layers()
+    int layer_index;
+
+    // milliseconds since profiling was enabled
+    double start;
+    double end;
+
+    // branch worker running the layer, 0 is the extracting thread
+    int worker;
+
+    // bottom and top blob shapes, elempack and elemsize, without data
+    std::vector<Mat> bottom_shapes;
+    std::vector<Mat> top_shapes;
+
+    // bytes of the new top blobs and the workspace allocated by the layer
+    size_t allocated_bytes;
+
+    // kernel chosen by the layer implementation, null if it has no kernel choice
+    const char* kernel;
+};
+
 class ExtractorPrivate;
 class NCNN_EXPORT Extractor
 {
@@ -166,6 +212,29 @@ public:
     // clear blob mats and alloctors
     void clear();
 
+    // release blob data of the previous request and keep the extractor for the next one
+    // blob slots, options, allocators and profiling stay bound
+    // so a pool of extractors can serve requests instead of net.create_extractor() per request
+    void reset();
+
+    // allocate blobs and workspace from a pool owned by this extractor
+    // memory released by reset() is recycled by the next request
+    // so requests with the same shapes stop reaching the system allocator
+    // allocators set by set_blob_allocator / set_workspace_allocator or net.opt are kept
+    // extracted mats must be released before the extractor is destroyed
+    // default is false
+    void set_reuse_memory(bool enable);
+
+    // allocate blobs and workspace from one arena planned for this extractor
+    // the first request after enabling runs on the heap and records every allocation
+    // the first reset() packs the recorded blobs into one arena by their lifetimes
+    // following requests with the same input shapes take all blobs from the arena
+    // allocations that do not fit the plan, eg. other input shapes, fall back to the heap
+    // allocators set by set_blob_allocator / set_workspace_allocator or net.opt are kept
+    // extracted mats are copied out of the arena
+    // default is false
+    void set_arena_memory(bool enable);
+
     // enable light mode
     // intermediate blob will be recycled when enabled
     // enabled by default
@@ -175,6 +244,34 @@ public:
     // instead, set net.opt.num_threads before net.load_param()
     void set_num_threads(int num_threads);
 
+    // run independent branches of the graph at the same time
+    // layers whose inputs are ready are picked by branch_count workers
+    // and net.opt.num_threads is divided among the layers running concurrently
+    // x86 layers with pre-packed weights run the load-time tile config on fewer threads
+    // other layers with pre-packed weights keep the thread count used at load time
+    // the workers are kept by the extractor and reused by the following extract calls
+    // layers running concurrently allocate from opt.blob_allocator and opt.workspace_allocator at the same time
+    // so custom allocators must be thread-safe, UnlockedPoolAllocator is not allowed here
+    // 0 or 1 walks the graph one layer at a time
+    // default is 0
+    void set_branch_parallel(int branch_count);
+
+    // record every cpu layer run of this extractor
+    // recording costs two clock reads and a few small copies per layer
+    // disabling drops the records
+    // default is false
+    void set_profiling(bool enable);
+
+    // layer runs recorded since profiling was enabled, in completion order
+    const std::vector<LayerProfile>& layer_profiles() const;
+
+#if NCNN_STDIO
+    // write the layer runs as chrome trace event json
+    // open in chrome://tracing or ui.perfetto.dev
+    // return 0 if success
+    int save_profile_chrome_trace(const char* path) const;
+#endif // NCNN_STDIO
+
     // set blob memory allocator
     void set_blob_allocator(Allocator* allocator);
 
@@ -203,6 +300,20 @@ public:
     // type = 0, default
     // type = 1, do not convert fp16/bf16 or / and packing
     int extract(const char* blob_name, Mat& feat, int type = 0);
+
+    // set inputs of a batch by blob name
+    // all batch items go through the graph in one walk
+    // InnerProduct, Gemm, Convolution and element-wise layers run once for the whole batch
+    // other layers run once per item
+    // every batch input of one extractor must have the same batch size
+    // return 0 if success
+    int input(const char* blob_name, const std::vector<Mat>& in);
+
+    // get results of a batch by blob name
+    // return 0 if success
+    // type = 0, default
+    // type = 1, do not convert fp16/bf16 or / and packing
+    int extract(const char* blob_name, std::vector<Mat>& feats, int type = 0);
 #endif // NCNN_STRING
 
     // set input by blob index
@@ -215,6 +326,16 @@ public:
     // type = 1, do not convert fp16/bf16 or / and packing
     int extract(int blob_index, Mat& feat, int type = 0);
 
+    // set inputs of a batch by blob index
+    // return 0 if success
+    int input(int blob_index, const std::vector<Mat>& in);
+
+    // get results of a batch by blob index
+    // return 0 if success
+    // type = 0, default
+    // type = 1, do not convert fp16/bf16 or / and packing
+    int extract(int blob_index, std::vector<Mat>& feats, int type = 0);
+
 #if NCNN_VULKAN
 #if NCNN_STRING
     // set input by blob name
@@ -67,9 +67,11 @@ Option::Option()
     use_fp16_uniform = true;
     use_int8_uniform = true;
 
-    use_reserved_9 = false;
-    use_reserved_10 = false;
+    use_parallel_create_pipeline = false;
+    use_tile_autotune = false;
     use_reserved_11 = false;
+
+    numa_node = -1;
 }
 
 } // namespace ncnn
@@ -141,9 +141,28 @@ public:
     bool use_fp16_uniform;
     bool use_int8_uniform;
 
-    bool use_reserved_9;
-    bool use_reserved_10;
+    // run create_pipeline of different layers concurrently in load_model
+    // each layer still sees num_threads, so the packed weights are the same as sequential loading
+    // up to cpu count / num_threads layers run at once
+    // ignored for vulkan compute
+    // disabled by default
+    bool use_parallel_create_pipeline;
+
+    // benchmark candidate gemm tile sizes once per shape instead of deriving them from the cache size
+    // the fastest tiles are kept in the process-wide database, see set_tile_autotune_database() in tileautotune.h
+    // shapes known only at forward are tuned per power-of-two bucket, up to a fixed number of buckets
+    // changes should be applied before loading network weight
+    // disabled by default
+    bool use_tile_autotune;
     bool use_reserved_11;
+
+    // bind the loading and inference threads to the cpus of this numa node
+    // weights and packed weights are then first touched and allocated on the node memory
+    // load one net per node with different numa_node to replicate the packed weights on every node
+    // see get_numa_node_count()
+    // changes should be applied before loading network weight
+    // -1 = no binding(default)
+    int numa_node;
 };
 
 } // namespace ncnn
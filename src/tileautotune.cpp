@@ -0,0 +1,437 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "tileautotune.h"
+
+#include "allocator.h"
+#include "benchmark.h"
+#include "cpu.h"
+
+#include <string.h>
+
+#if NCNN_STDIO
+#include <stdio.h>
+#if _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#endif // NCNN_STDIO
+
+namespace ncnn {
+
+// many forward threads look up tiles while tuning adds an entry once in a while
+#if NCNN_THREADS
+#if defined _WIN32
+class TileAutotuneRWLock
+{
+public:
+    TileAutotuneRWLock()
+    {
+        InitializeSRWLock(&srwlock);
+    }
+    void lock_shared()
+    {
+        AcquireSRWLockShared(&srwlock);
+    }
+    void unlock_shared()
+    {
+        ReleaseSRWLockShared(&srwlock);
+    }
+    void lock()
+    {
+        AcquireSRWLockExclusive(&srwlock);
+    }
+    void unlock()
+    {
+        ReleaseSRWLockExclusive(&srwlock);
+    }
+
+private:
+    SRWLOCK srwlock;
+};
+#else  // defined _WIN32
+class TileAutotuneRWLock
+{
+public:
+    TileAutotuneRWLock()
+    {
+        pthread_rwlock_init(&rwlock, 0);
+    }
+    ~TileAutotuneRWLock()
+    {
+        pthread_rwlock_destroy(&rwlock);
+    }
+    void lock_shared()
+    {
+        pthread_rwlock_rdlock(&rwlock);
+    }
+    void unlock_shared()
+    {
+        pthread_rwlock_unlock(&rwlock);
+    }
+    void lock()
+    {
+        pthread_rwlock_wrlock(&rwlock);
+    }
+    void unlock()
+    {
+        pthread_rwlock_unlock(&rwlock);
+    }
+
+private:
+    pthread_rwlock_t rwlock;
+};
+#endif // defined _WIN32
+#else  // NCNN_THREADS
+class TileAutotuneRWLock
+{
+public:
+    void lock_shared()
+    {
+    }
+    void unlock_shared()
+    {
+    }
+    void lock()
+    {
+    }
+    void unlock()
+    {
+    }
+};
+#endif // NCNN_THREADS
+
+class TileAutotuneReadGuard
+{
+public:
+    TileAutotuneReadGuard(TileAutotuneRWLock& _rwlock)
+        : rwlock(_rwlock)
+    {
+        rwlock.lock_shared();
+    }
+    ~TileAutotuneReadGuard()
+    {
+        rwlock.unlock_shared();
+    }
+
+private:
+    TileAutotuneRWLock& rwlock;
+};
+
+class TileAutotuneWriteGuard
+{
+public:
+    TileAutotuneWriteGuard(TileAutotuneRWLock& _rwlock)
+        : rwlock(_rwlock)
+    {
+        rwlock.lock();
+    }
+    ~TileAutotuneWriteGuard()
+    {
+        rwlock.unlock();
+    }
+
+private:
+    TileAutotuneRWLock& rwlock;
+};
+
+struct tile_autotune_entry
+{
+    char kernel[32];
+    unsigned int isa;
+    int nT;
+    int M;
+    int N;
+    int K;
+    int TILE_M;
+    int TILE_N;
+    int TILE_K;
+};
+
+// hash buckets of entries, the bucket count is a power of two and doubles with the entry count
+static TileAutotuneRWLock g_tile_autotune_lock;
+static std::vector<std::vector<tile_autotune_entry> > g_tile_autotune_buckets;
+static size_t g_tile_autotune_count = 0;
+
+// only one writer of the database file at a time, so that an older snapshot never replaces a newer one
+static Mutex g_tile_autotune_file_lock;
+static std::string g_tile_autotune_path;
+
+static unsigned int g_tile_autotune_isa = 0;
+static int g_tile_autotune_isa_ready = 0;
+
+// tuned tiles are only valid for the kernels selected on this cpu
+static unsigned int get_tile_autotune_isa()
+{
+    if (g_tile_autotune_isa_ready)
+        return g_tile_autotune_isa;
+
+    const int isa[] = {
+        cpu_support_x86_avx(),
+        cpu_support_x86_fma(),
+        cpu_support_x86_avx2(),
+        cpu_support_x86_avx_vnni(),
+        cpu_support_x86_avx512(),
+        cpu_support_x86_avx512_vnni(),
+        cpu_support_x86_avx512_bf16(),
+        cpu_support_x86_avx512_fp16(),
+        cpu_support_x86_amx_int8(),
+        cpu_support_x86_amx_bf16(),
+        cpu_support_arm_asimdhp(),
+        cpu_support_arm_asimddp(),
+        cpu_support_arm_bf16(),
+        cpu_support_arm_i8mm(),
+        cpu_support_arm_sve(),
+        cpu_support_arm_sve2()
+    };
+
+    unsigned int bits = 0;
+    for (int i = 0; i < (int)(sizeof(isa) / sizeof(isa[0])); i++)
+    {
+        if (isa[i])
+            bits |= 1u << i;
+    }
+
+    // racing threads compute the same bits
+    g_tile_autotune_isa = bits;
+    g_tile_autotune_isa_ready = 1;
+
+    return bits;
+}
+
+// fnv-1a over the kernel name and the shape
+static unsigned int tile_autotune_hash(const char* kernel, unsigned int isa, int M, int N, int K, int nT)
+{
+    unsigned int h = 2166136261u;
+    for (const char* p = kernel; *p; p++)
+    {
+        h ^= (unsigned char)*p;
+        h *= 16777619u;
+    }
+
+    const unsigned int v[5] = {isa, (unsigned int)nT, (unsigned int)M, (unsigned int)N, (unsigned int)K};
+    for (int i = 0; i < 5; i++)
+    {
+        for (int b = 0; b < 4; b++)
+        {
+            h ^= (v[i] >> (b * 8)) & 0xff;
+            h *= 16777619u;
+        }
+    }
+
+    return h;
+}
+
+static const tile_autotune_entry* find_tile_autotune_entry(const char* kernel, unsigned int isa, int M, int N, int K, int nT)
+{
+    if (g_tile_autotune_buckets.empty())
+        return 0;
+
+    const unsigned int h = tile_autotune_hash(kernel, isa, M, N, K, nT);
+    const std::vector<tile_autotune_entry>& bucket = g_tile_autotune_buckets[h & (g_tile_autotune_buckets.size() - 1)];
+    for (size_t i = 0; i < bucket.size(); i++)
+    {
+        const tile_autotune_entry& e = bucket[i];
+        if (e.isa == isa && e.nT == nT && e.M == M && e.N == N && e.K == K && strcmp(e.kernel, kernel) == 0)
+            return &e;
+    }
+
+    return 0;
+}
+
+// the caller holds the write lock
+static void insert_tile_autotune_entry(const tile_autotune_entry& e)
+{
+    tile_autotune_entry* found = (tile_autotune_entry*)find_tile_autotune_entry(e.kernel, e.isa, e.M, e.N, e.K, e.nT);
+    if (found)
+    {
+        *found = e;
+        return;
+    }
+
+    if (g_tile_autotune_count + 1 > g_tile_autotune_buckets.size() * 2)
+    {
+        // rehash into twice the buckets
+        std::vector<std::vector<tile_autotune_entry> > buckets(g_tile_autotune_buckets.empty() ? 64 : g_tile_autotune_buckets.size() * 2);
+        for (size_t i = 0; i < g_tile_autotune_buckets.size(); i++)
+        {
+            const std::vector<tile_autotune_entry>& bucket = g_tile_autotune_buckets[i];
+            for (size_t j = 0; j < bucket.size(); j++)
+            {
+                const tile_autotune_entry& be = bucket[j];
+                const unsigned int h = tile_autotune_hash(be.kernel, be.isa, be.M, be.N, be.K, be.nT);
+                buckets[h & (buckets.size() - 1)].push_back(be);
+            }
+        }
+
+        g_tile_autotune_buckets.swap(buckets);
+    }
+
+    const unsigned int h = tile_autotune_hash(e.kernel, e.isa, e.M, e.N, e.K, e.nT);
+    g_tile_autotune_buckets[h & (g_tile_autotune_buckets.size() - 1)].push_back(e);
+    g_tile_autotune_count++;
+}
+
+#if NCNN_STDIO
+static void save_tile_autotune_database()
+{
+    MutexLockGuard file_lock(g_tile_autotune_file_lock);
+
+    if (g_tile_autotune_path.empty())
+        return;
+
+    // snapshot the entries, the file is written without blocking the lookups
+    std::vector<tile_autotune_entry> entries;
+    {
+        TileAutotuneReadGuard lock(g_tile_autotune_lock);
+
+        entries.reserve(g_tile_autotune_count);
+        for (size_t i = 0; i < g_tile_autotune_buckets.size(); i++)
+        {
+            const std::vector<tile_autotune_entry>& bucket = g_tile_autotune_buckets[i];
+            for (size_t j = 0; j < bucket.size(); j++)
+            {
+                entries.push_back(bucket[j]);
+            }
+        }
+    }
+
+    // write aside and rename, other processes loading the database never see a partial file
+#if _WIN32
+    const int pid = _getpid();
+#else
+    const int pid = (int)getpid();
+#endif
+    const unsigned int salt = (unsigned int)(get_current_time() * 1000);
+
+    char suffix[64];
+    sprintf(suffix, ".%d.%08x.tmp", pid, salt);
+    std::string tmppath = g_tile_autotune_path + suffix;
+
+    FILE* fp = fopen(tmppath.c_str(), "wb");
+    if (!fp)
+    {
+        NCNN_LOGE("fopen %s failed", tmppath.c_str());
+        return;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const tile_autotune_entry& e = entries[i];
+        if (fprintf(fp, "%s %x %d %d %d %d %d %d %d\n", e.kernel, e.isa, e.nT, e.M, e.N, e.K, e.TILE_M, e.TILE_N, e.TILE_K) < 0)
+            ok = false;
+    }
+
+    if (fclose(fp) != 0 || !ok)
+    {
+        NCNN_LOGE("write %s failed", tmppath.c_str());
+        remove(tmppath.c_str());
+        return;
+    }
+
+#if _WIN32
+    remove(g_tile_autotune_path.c_str());
+#endif
+    if (rename(tmppath.c_str(), g_tile_autotune_path.c_str()) != 0)
+    {
+        NCNN_LOGE("rename %s failed", tmppath.c_str());
+        remove(tmppath.c_str());
+    }
+}
+#endif // NCNN_STDIO
+
+int get_tile_autotune(const char* kernel, int M, int N, int K, int nT, int& TILE_M, int& TILE_N, int& TILE_K)
+{
+    const unsigned int isa = get_tile_autotune_isa();
+
+    TileAutotuneReadGuard lock(g_tile_autotune_lock);
+
+    const tile_autotune_entry* e = find_tile_autotune_entry(kernel, isa, M, N, K, nT);
+    if (!e)
+        return -1;
+
+    TILE_M = e->TILE_M;
+    TILE_N = e->TILE_N;
+    TILE_K = e->TILE_K;
+
+    return 0;
+}
+
+void set_tile_autotune(const char* kernel, int M, int N, int K, int nT, int TILE_M, int TILE_N, int TILE_K)
+{
+    tile_autotune_entry e;
+    memset(&e, 0, sizeof(e));
+    strncpy(e.kernel, kernel, sizeof(e.kernel) - 1);
+    e.isa = get_tile_autotune_isa();
+    e.nT = nT;
+    e.M = M;
+    e.N = N;
+    e.K = K;
+    e.TILE_M = TILE_M;
+    e.TILE_N = TILE_N;
+    e.TILE_K = TILE_K;
+
+    {
+        TileAutotuneWriteGuard lock(g_tile_autotune_lock);
+
+        insert_tile_autotune_entry(e);
+    }
+
+#if NCNN_STDIO
+    save_tile_autotune_database();
+#endif
+}
+
+int set_tile_autotune_database(const char* path)
+{
+#if NCNN_STDIO
+    MutexLockGuard file_lock(g_tile_autotune_file_lock);
+
+    g_tile_autotune_path = path;
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+
+    std::vector<tile_autotune_entry> entries;
+
+    int ret = 0;
+    while (1)
+    {
+        tile_autotune_entry e;
+        memset(&e, 0, sizeof(e));
+
+        int nscan = fscanf(fp, "%31s %x %d %d %d %d %d %d %d", e.kernel, &e.isa, &e.nT, &e.M, &e.N, &e.K, &e.TILE_M, &e.TILE_N, &e.TILE_K);
+        if (nscan == EOF)
+            break;
+
+        if (nscan != 9)
+        {
+            NCNN_LOGE("malformed tile autotune database %s", path);
+            ret = -1;
+            break;
+        }
+
+        entries.push_back(e);
+    }
+
+    fclose(fp);
+
+    TileAutotuneWriteGuard lock(g_tile_autotune_lock);
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        insert_tile_autotune_entry(entries[i]);
+    }
+
+    return ret;
+#else
+    (void)path;
+    NCNN_LOGE("tile autotune database requires NCNN_STDIO");
+    return -1;
+#endif // NCNN_STDIO
+}
+
+} // namespace ncnn
@@ -0,0 +1,28 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef NCNN_TILEAUTOTUNE_H
+#define NCNN_TILEAUTOTUNE_H
+
+#include "platform.h"
+
+namespace ncnn {
+
+// tile autotune database shared by all nets in this process, see Option::use_tile_autotune
+// one entry per kernel name, M, N, K, cpu isa and thread count, 0 for a size unknown at tuning time
+// lookups only take a reader lock
+// return 0 and fill TILE_M/N/K if the entry exists
+NCNN_EXPORT int get_tile_autotune(const char* kernel, int M, int N, int K, int nT, int& TILE_M, int& TILE_N, int& TILE_K);
+
+// add or replace one entry, the database file is rewritten if set
+// the file is written to a temporary path and renamed over, readers never see a partial file
+NCNN_EXPORT void set_tile_autotune(const char* kernel, int M, int N, int K, int nT, int TILE_M, int TILE_N, int TILE_K);
+
+// load the entries from path and keep saving newly tuned entries to it
+// entries of other cpus are kept in the file but never matched
+// return 0 on success, a missing file is fine and starts an empty database
+NCNN_EXPORT int set_tile_autotune_database(const char* path);
+
+} // namespace ncnn
+
+#endif // NCNN_TILEAUTOTUNE_H
@@ -0,0 +1,385 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdio.h>
+#include <string.h>
+
+#include "allocator.h"
+#include "mat.h"
+
+// a small chain with one skip connection
+// a -> b -> c, d = b + c
+static float run_chain(ncnn::Allocator* allocator, ncnn::Mat& out)
+{
+    ncnn::Mat a(64, 32, 4, (size_t)4u, allocator);
+    a.fill(1.f);
+
+    ncnn::Mat b(64, 32, 4, (size_t)4u, allocator);
+    for (int i = 0; i < (int)b.total(); i++)
+    {
+        b[i] = a[i] + 1.f;
+    }
+    a.release();
+
+    ncnn::Mat c(64, 32, 4, (size_t)4u, allocator);
+    for (int i = 0; i < (int)c.total(); i++)
+    {
+        c[i] = b[i] * 3.f;
+    }
+
+    out.create(64, 32, 4, (size_t)4u, allocator);
+    for (int i = 0; i < (int)out.total(); i++)
+    {
+        out[i] = b[i] + c[i];
+    }
+
+    return out[0];
+}
+
+static int test_arena_allocator_0()
+{
+    ncnn::ArenaAllocator arena;
+
+    ncnn::Mat out0;
+    float v0 = run_chain(&arena, out0);
+
+    if (arena.arena_size() != 0)
+    {
+        fprintf(stderr, "test_arena_allocator arena_size before planning %d != 0\n", (int)arena.arena_size());
+        return -1;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        arena.rewind();
+
+        ncnn::Mat out1;
+        float v1 = run_chain(&arena, out1);
+        if (v1 != v0 || v1 != 8.f)
+        {
+            fprintf(stderr, "test_arena_allocator value failed %f != %f\n", v1, v0);
+            return -1;
+        }
+
+        out0 = out1;
+    }
+
+    // a and c share one slot
+    const size_t blocksize = ncnn::alignSize(64 * 32 * 4 * 4 + 4 + NCNN_MALLOC_OVERREAD, NCNN_MALLOC_ALIGN);
+    if (arena.arena_size() == 0 || arena.arena_size() > blocksize * 3)
+    {
+        fprintf(stderr, "test_arena_allocator arena_size %d > %d\n", (int)arena.arena_size(), (int)(blocksize * 3));
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_arena_allocator_1()
+{
+    ncnn::ArenaAllocator arena;
+
+    ncnn::Mat out0;
+    run_chain(&arena, out0);
+    out0.release();
+
+    arena.rewind();
+
+    // larger than planned, served from heap
+    ncnn::Mat m(128, 32, 4, (size_t)4u, &arena);
+    m.fill(2.f);
+
+    ncnn::Mat out1;
+    float v1 = run_chain(&arena, out1);
+    if (v1 != 8.f || m[m.total() - 1] != 2.f)
+    {
+        fprintf(stderr, "test_arena_allocator fallback failed %f %f\n", v1, m[m.total() - 1]);
+        return -1;
+    }
+
+    m.release();
+    out1.release();
+
+    // plan again
+    arena.clear();
+    if (arena.arena_size() != 0)
+    {
+        fprintf(stderr, "test_arena_allocator clear failed\n");
+        return -1;
+    }
+
+    run_chain(&arena, out1);
+    arena.rewind();
+    float v2 = run_chain(&arena, out1);
+    if (v2 != 8.f)
+    {
+        fprintf(stderr, "test_arena_allocator replan failed %f\n", v2);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_size_class_pool_allocator_0()
+{
+    ncnn::SizeClassPoolAllocator pool;
+
+    // same size class, second round is served from budgets
+    for (int i = 0; i < 2; i++)
+    {
+        ncnn::Mat a(100, 3, (size_t)4u, &pool);
+        ncnn::Mat b(101, 3, (size_t)4u, &pool);
+        a.fill(1.f);
+        b.fill(2.f);
+
+        if ((size_t)a.data % NCNN_MALLOC_ALIGN != 0 || (size_t)b.data % NCNN_MALLOC_ALIGN != 0)
+        {
+            fprintf(stderr, "test_size_class_pool_allocator unaligned %p %p\n", a.data, b.data);
+            return -1;
+        }
+    }
+
+    if (pool.hit_count() != 2 || pool.miss_count() != 2)
+    {
+        fprintf(stderr, "test_size_class_pool_allocator hit %d miss %d\n", (int)pool.hit_count(), (int)pool.miss_count());
+        return -1;
+    }
+
+    if (pool.bytes_held() < 101 * 3 * 4 * 2)
+    {
+        fprintf(stderr, "test_size_class_pool_allocator bytes_held %d\n", (int)pool.bytes_held());
+        return -1;
+    }
+
+    pool.clear();
+    if (pool.bytes_held() != 0)
+    {
+        fprintf(stderr, "test_size_class_pool_allocator clear failed %d\n", (int)pool.bytes_held());
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_size_class_pool_allocator_1()
+{
+    ncnn::SizeClassPoolAllocator pool;
+    pool.set_size_drop_threshold(2);
+
+    // budgets beyond threshold go back to OS
+    {
+        ncnn::Mat m[6];
+        for (int i = 0; i < 6; i++)
+        {
+            m[i].create(256, (size_t)4u, &pool);
+        }
+    }
+
+    const size_t bytes_held = pool.bytes_held();
+    if (bytes_held == 0 || bytes_held > 4 * ncnn::alignSize(256 * 4 * 2, 1024))
+    {
+        fprintf(stderr, "test_size_class_pool_allocator drop threshold bytes_held %d\n", (int)bytes_held);
+        return -1;
+    }
+
+    // large payouts obey the drop threshold as well
+    {
+        ncnn::Mat huge[6];
+        for (int i = 0; i < 6; i++)
+        {
+            huge[i].create(1 << 20, (size_t)1u, &pool);
+            memset(huge[i].data, 0, huge[i].total());
+        }
+    }
+
+    const size_t huge_bytes_held = pool.bytes_held() - bytes_held;
+    if (huge_bytes_held == 0 || huge_bytes_held > 4 * (((size_t)1 << 20) + ((size_t)1 << 18)))
+    {
+        fprintf(stderr, "test_size_class_pool_allocator huge kept %d\n", (int)huge_bytes_held);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_size_class_pool_allocator_3()
+{
+    ncnn::SizeClassPoolAllocator pool;
+    pool.set_thread_budget_bytes(64 * 1024);
+    pool.set_total_budget_bytes(160 * 1024);
+
+    // many size classes, the byte budgets bound what is kept
+    {
+        ncnn::Mat m[40];
+        for (int i = 0; i < 40; i++)
+        {
+            m[i].create(4096 + i * 1024, (size_t)4u, &pool);
+            m[i].fill(1.f);
+        }
+    }
+
+    const size_t bytes_held = pool.bytes_held();
+    if (bytes_held == 0 || bytes_held > 160 * 1024)
+    {
+        fprintf(stderr, "test_size_class_pool_allocator byte budget bytes_held %d\n", (int)bytes_held);
+        return -1;
+    }
+
+    pool.clear();
+    if (pool.bytes_held() != 0)
+    {
+        fprintf(stderr, "test_size_class_pool_allocator byte budget clear failed %d\n", (int)pool.bytes_held());
+        return -1;
+    }
+
+    return 0;
+}
+
+struct size_class_pool_thread_args
+{
+    ncnn::Allocator* allocator;
+    ncnn::Mat* outs;
+    int ret;
+};
+
+static void* size_class_pool_thread(void* args)
+{
+    size_class_pool_thread_args* a = (size_class_pool_thread_args*)args;
+
+    for (int i = 0; i < 100; i++)
+    {
+        ncnn::Mat m(17 + i % 7, 13, (size_t)4u, a->allocator);
+        m.fill((float)i);
+        if (m[m.total() - 1] != (float)i)
+            a->ret = -1;
+    }
+
+    // handed to another thread for release
+    for (int i = 0; i < 8; i++)
+    {
+        a->outs[i].create(32, 8, (size_t)4u, a->allocator);
+    }
+
+    return 0;
+}
+
+static int test_size_class_pool_allocator_2()
+{
+    ncnn::SizeClassPoolAllocator pool;
+
+    ncnn::Mat outs[4][8];
+    size_class_pool_thread_args args[4];
+    std::vector<ncnn::Thread*> threads(4);
+    for (int i = 0; i < 4; i++)
+    {
+        args[i].allocator = &pool;
+        args[i].outs = outs[i];
+        args[i].ret = 0;
+        threads[i] = new ncnn::Thread(size_class_pool_thread, &args[i]);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (args[i].ret != 0)
+        {
+            fprintf(stderr, "test_size_class_pool_allocator thread %d failed\n", i);
+            return -1;
+        }
+
+        for (int j = 0; j < 8; j++)
+        {
+            outs[i][j].release();
+        }
+    }
+
+    // budgets returned on this thread are reused here
+    ncnn::Mat m(32, 8, (size_t)4u, &pool);
+    const size_t hit = pool.hit_count();
+    ncnn::Mat m2(32, 8, (size_t)4u, &pool);
+    if (pool.hit_count() != hit + 1)
+    {
+        fprintf(stderr, "test_size_class_pool_allocator cross thread reuse failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void* size_class_pool_exit_thread(void* args)
+{
+    ncnn::Allocator* allocator = (ncnn::Allocator*)args;
+
+    // cached by this thread until it exits
+    ncnn::Mat m(64, 16, (size_t)4u, allocator);
+    m.fill(1.f);
+
+    return 0;
+}
+
+static int test_size_class_pool_allocator_4()
+{
+    // budgets cached by a thread go back to the allocator when the thread exits
+    {
+        ncnn::SizeClassPoolAllocator pool;
+
+        ncnn::Thread t(size_class_pool_exit_thread, &pool);
+        t.join();
+
+        const size_t hit = pool.hit_count();
+        const size_t miss = pool.miss_count();
+        ncnn::Mat m(64, 16, (size_t)4u, &pool);
+        if (pool.hit_count() != hit + 1 || pool.miss_count() != miss)
+        {
+            fprintf(stderr, "test_size_class_pool_allocator thread exit budgets not returned\n");
+            return -1;
+        }
+    }
+
+    // more allocators than thread local keys a process may create
+    std::vector<ncnn::SizeClassPoolAllocator*> pools(1200);
+    for (size_t i = 0; i < pools.size(); i++)
+    {
+        pools[i] = new ncnn::SizeClassPoolAllocator;
+    }
+
+    int ret = 0;
+    for (size_t i = 0; i < pools.size(); i++)
+    {
+        {
+            ncnn::Mat m(16, (size_t)4u, pools[i]);
+        }
+
+        ncnn::Mat m(16, (size_t)4u, pools[i]);
+        if (pools[i]->hit_count() != 1)
+        {
+            fprintf(stderr, "test_size_class_pool_allocator pool %d hit %d\n", (int)i, (int)pools[i]->hit_count());
+            ret = -1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < pools.size(); i++)
+    {
+        delete pools[i];
+    }
+
+    return ret;
+}
+
+int main()
+{
+    return 0
+           || test_arena_allocator_0()
+           || test_arena_allocator_1()
+           || test_size_class_pool_allocator_0()
+           || test_size_class_pool_allocator_1()
+           || test_size_class_pool_allocator_2()
+           || test_size_class_pool_allocator_3()
+           || test_size_class_pool_allocator_4();
+}
@@ -26,7 +26,8 @@ static int test_cumulativesum_1d()
            || test_cumulativesum(RandomMat(10), 0)
            || test_cumulativesum(RandomMat(10), -1)
            || test_cumulativesum(RandomMat(10), -2)
-           || test_cumulativesum(RandomMat(101), 0);
+           || test_cumulativesum(RandomMat(101), 0)
+           || test_cumulativesum(RandomMat(4099), 0);
 }
 
 static int test_cumulativesum_2d()
@@ -35,7 +36,9 @@ static int test_cumulativesum_2d()
            || test_cumulativesum(RandomMat(6, 8), 0)
            || test_cumulativesum(RandomMat(20, 103), 1)
            || test_cumulativesum(RandomMat(106, 50), -1)
-           || test_cumulativesum(RandomMat(106, 50), -2);
+           || test_cumulativesum(RandomMat(106, 50), -2)
+           || test_cumulativesum(RandomMat(12, 32), 0)
+           || test_cumulativesum(RandomMat(12, 32), 1);
 }
 
 static int test_cumulativesum_3d()
@@ -46,7 +49,9 @@ static int test_cumulativesum_3d()
            || test_cumulativesum(RandomMat(106, 50, 99), 2)
            || test_cumulativesum(RandomMat(303, 200, 103), -1)
            || test_cumulativesum(RandomMat(303, 200, 103), -2)
-           || test_cumulativesum(RandomMat(303, 200, 103), -2);
+           || test_cumulativesum(RandomMat(303, 200, 103), -2)
+           || test_cumulativesum(RandomMat(7, 5, 48), 0)
+           || test_cumulativesum(RandomMat(7, 5, 48), 2);
 }
 
 int main()
@@ -3,6 +3,8 @@
 
 #include "testutil.h"
 
+#include "einsum.h"
+
 static int test_einsum(const std::vector<ncnn::Mat>& a, const std::string& equation)
 {
     ncnn::Mat equation_mat(equation.size());
@@ -25,6 +27,49 @@ static int test_einsum(const std::vector<ncnn::Mat>& a, const std::string& equat
     return ret;
 }
 
+static int test_einsum_gemm(const std::vector<ncnn::Mat>& a, const std::string& equation)
+{
+    ncnn::Mat equation_mat(equation.size());
+    for (size_t i = 0; i < equation.size(); i++)
+    {
+        ((int*)equation_mat)[i] = equation[i];
+    }
+
+    ncnn::ParamDict pd;
+    pd.set(0, equation_mat);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Einsum op;
+    op.load_param(pd);
+    if (!op.use_gemm)
+    {
+        fprintf(stderr, "test_einsum_gemm failed equation=%s is not lowered to gemm\n", equation.c_str());
+        return -1;
+    }
+
+    op.create_pipeline(opt);
+
+    // compare the gemm lowering with the naive evaluation
+    std::vector<ncnn::Mat> b(1);
+    std::vector<ncnn::Mat> c(1);
+    int ret = op.forward(a, b, opt);
+    op.use_gemm = 0;
+    ret |= op.forward(a, c, opt);
+    op.use_gemm = 1;
+
+    op.destroy_pipeline(opt);
+
+    if (ret != 0 || CompareMat(b[0], c[0], 0.001) != 0)
+    {
+        fprintf(stderr, "test_einsum_gemm failed a[0].dims=%d a[0]=(%d %d %d) equation=%s\n", a[0].dims, a[0].w, a[0].h, a[0].c, equation.c_str());
+        return -1;
+    }
+
+    return test_einsum(a, equation);
+}
+
 static int test_einsum_0()
 {
     std::vector<ncnn::Mat> a(1);
@@ -80,7 +125,7 @@ static int test_einsum_4()
     a[0] = RandomMat(12, 28);
     a[1] = RandomMat(12);
 
-    return test_einsum(a, "ij,j->i");
+    return test_einsum_gemm(a, "ij,j->i");
 }
 
 static int test_einsum_5()
@@ -89,7 +134,7 @@ static int test_einsum_5()
     a[0] = RandomMat(14);
     a[1] = RandomMat(14, 7, 16);
 
-    return test_einsum(a, "k,ijk->ij");
+    return test_einsum_gemm(a, "k,ijk->ij");
 }
 
 static int test_einsum_6()
@@ -98,7 +143,7 @@ static int test_einsum_6()
     a[0] = RandomMat(27);
     a[1] = RandomMat(32);
 
-    return test_einsum(a, "i,j->ij");
+    return test_einsum_gemm(a, "i,j->ij");
 }
 
 static int test_einsum_7()
@@ -118,7 +163,7 @@ static int test_einsum_8()
     a[0] = RandomMat(5, 2, 3);
     a[1] = RandomMat(4, 5, 3);
 
-    return test_einsum(a, "ijl,ilk->ijk");
+    return test_einsum_gemm(a, "ijl,ilk->ijk");
 }
 
 static int test_einsum_9()
@@ -127,7 +172,7 @@ static int test_einsum_9()
     a[0] = RandomMat(4, 5, 3);
     a[1] = RandomMat(5, 2, 3);
 
-    return test_einsum(a, "ilk,ijl->ijk");
+    return test_einsum_gemm(a, "ilk,ijl->ijk");
 }
 
 static int test_einsum_10()
@@ -146,7 +191,28 @@ static int test_einsum_11()
     a[0] = RandomMat(7, 5, 3, 2);
     a[1] = RandomMat(5, 17, 3, 11);
 
-    return test_einsum(a, "imnj,kmln->ijkl");
+    return test_einsum_gemm(a, "imnj,kmln->ijkl");
+}
+
+static int test_einsum_12()
+{
+    std::vector<ncnn::Mat> a(2);
+    a[0] = RandomMat(16, 24, 4, 2);
+    a[1] = RandomMat(16, 20, 4, 2);
+
+    std::vector<ncnn::Mat> b(2);
+    b[0] = RandomMat(20, 24, 4, 2);
+    b[1] = RandomMat(16, 20, 4, 2);
+
+    std::vector<ncnn::Mat> c(2);
+    c[0] = RandomMat(13, 6, 5);
+    c[1] = RandomMat(13, 7, 5);
+
+    // attention style batched products
+    return 0
+           || test_einsum_gemm(a, "ijkm,ijlm->ijkl")
+           || test_einsum_gemm(b, "ijkm,ijml->ijkl")
+           || test_einsum_gemm(c, "ijl,ikl->ijk");
 }
 
 int main()
@@ -165,5 +231,6 @@ int main()
            || test_einsum_8()
            || test_einsum_9()
            || test_einsum_10()
-           || test_einsum_11();
+           || test_einsum_11()
+           || test_einsum_12();
 }
@@ -40,25 +40,27 @@ static int test_embed_0()
 }
 
 #if NCNN_INT8
-static int test_embed_int8(int words, int num_output, int input_dim, int bias)
+static int test_embed_int8(int words, int num_output, int input_dim, int bias, int int8_scale_term)
 {
     ncnn::ParamDict pd;
     pd.set(0, num_output);
     pd.set(1, input_dim);
     pd.set(2, bias);
     pd.set(3, num_output * input_dim);
-    pd.set(18, 2);
+    pd.set(18, int8_scale_term);
+
+    const int scale_count = int8_scale_term == 3 ? input_dim : 1;
 
     std::vector<ncnn::Mat> weights(bias ? 3 : 2);
     weights[0] = RandomS8Mat(num_output * input_dim);
     if (bias)
     {
         weights[1] = RandomMat(num_output);
-        weights[2] = RandomMat(1, 100.f, 200.f);
+        weights[2] = RandomMat(scale_count, 100.f, 200.f);
     }
     else
     {
-        weights[1] = RandomMat(1, 100.f, 200.f);
+        weights[1] = RandomMat(scale_count, 100.f, 200.f);
     }
 
     ncnn::Mat a(words);
@@ -67,7 +69,7 @@ static int test_embed_int8(int words, int num_output, int input_dim, int bias)
     int ret = test_layer("Embed", pd, weights, a);
     if (ret != 0)
     {
-        fprintf(stderr, "test_embed_int8 failed words=%d num_output=%d input_dim=%d bias=%d\n", words, num_output, input_dim, bias);
+        fprintf(stderr, "test_embed_int8 failed words=%d num_output=%d input_dim=%d bias=%d int8_scale_term=%d\n", words, num_output, input_dim, bias, int8_scale_term);
     }
 
     return ret;
@@ -76,12 +78,15 @@ static int test_embed_int8(int words, int num_output, int input_dim, int bias)
 static int test_embed_1()
 {
     return 0
-           || test_embed_int8(128, 128, 128, 0)
-           || test_embed_int8(128, 128, 128, 1)
-           || test_embed_int8(127, 127, 127, 0)
-           || test_embed_int8(127, 127, 127, 1)
-           || test_embed_int8(124, 124, 124, 0)
-           || test_embed_int8(124, 124, 124, 1);
+           || test_embed_int8(128, 128, 128, 0, 2)
+           || test_embed_int8(128, 128, 128, 1, 2)
+           || test_embed_int8(127, 127, 127, 0, 2)
+           || test_embed_int8(127, 127, 127, 1, 2)
+           || test_embed_int8(124, 124, 124, 0, 2)
+           || test_embed_int8(124, 124, 124, 1, 2)
+           || test_embed_int8(128, 128, 128, 0, 3)
+           || test_embed_int8(127, 127, 127, 1, 3)
+           || test_embed_int8(35, 19, 1000, 1, 3);
 }
 #endif // NCNN_INT8
 
@@ -3,6 +3,8 @@
 
 #include "testutil.h"
 
+#include "tileautotune.h"
+
 static int test_gemm(int M, int N, int K, float alpha, int transA, int transB, int output_transpose, int constantA, int constantB, int output_N1M = 0)
 {
     ncnn::ParamDict pd;
@@ -234,6 +236,150 @@ static int test_gemm_1(int M, int N, int K)
            || test_gemm_bias(M, N, K, RandomMat(N), 3.1f, 0.6f, 0, 1, 0, 1, 1, 1);
 }
 
+static int test_gemm_autotune(int M, int N, int K, int constantA, int constantB)
+{
+    ncnn::ParamDict pd;
+    pd.set(0, 1.f); // alpha
+    pd.set(1, 1.f); // beta
+    pd.set(2, 0);   // transA
+    pd.set(3, 1);   // transB
+    pd.set(4, constantA);
+    pd.set(5, constantB);
+    pd.set(6, 1);
+    pd.set(7, M);
+    pd.set(8, N);
+    pd.set(9, K);
+    pd.set(10, -1);
+
+    std::vector<ncnn::Mat> weights;
+    if (constantA) weights.push_back(RandomMat(K, M));
+    if (constantB) weights.push_back(RandomMat(K, N));
+
+    std::vector<ncnn::Mat> a;
+    if (!constantA) a.push_back(RandomMat(K, M));
+    if (!constantB) a.push_back(RandomMat(K, N));
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_packing_layout = true;
+    opt.use_fp16_packed = false;
+    opt.use_fp16_storage = false;
+    opt.use_fp16_arithmetic = false;
+    opt.use_bf16_storage = false;
+    opt.use_tile_autotune = true;
+
+    int ret = test_layer_opt("Gemm", pd, weights, opt, a);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_gemm_autotune failed M=%d N=%d K=%d constantA=%d constantB=%d\n", M, N, K, constantA, constantB);
+    }
+
+    return ret;
+}
+
+static int test_tile_autotune_database()
+{
+    const char* dbpath = "test_gemm_autotune.txt";
+    remove(dbpath);
+
+    if (ncnn::set_tile_autotune_database(dbpath) != 0)
+    {
+        fprintf(stderr, "set_tile_autotune_database failed\n");
+        return -1;
+    }
+
+    ncnn::set_tile_autotune("test_gemm", 70, 80, 90, 3, 32, 20, 48);
+
+    int TILE_M = 0;
+    int TILE_N = 0;
+    int TILE_K = 0;
+    if (ncnn::get_tile_autotune("test_gemm", 70, 80, 90, 3, TILE_M, TILE_N, TILE_K) != 0 || TILE_M != 32 || TILE_N != 20 || TILE_K != 48)
+    {
+        fprintf(stderr, "get_tile_autotune mismatch %d %d %d\n", TILE_M, TILE_N, TILE_K);
+        return -1;
+    }
+
+    if (ncnn::get_tile_autotune("test_gemm", 70, 80, 90, 4, TILE_M, TILE_N, TILE_K) == 0)
+    {
+        fprintf(stderr, "get_tile_autotune matched another thread count\n");
+        return -1;
+    }
+
+    // the tuned entry is saved for later runs
+    FILE* fp = fopen(dbpath, "rb");
+    if (!fp)
+    {
+        fprintf(stderr, "tile autotune database not saved\n");
+        return -1;
+    }
+
+    bool found = false;
+    char line[256];
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (strncmp(line, "test_gemm ", 10) == 0)
+            found = true;
+    }
+
+    fclose(fp);
+    remove(dbpath);
+
+    if (!found)
+    {
+        fprintf(stderr, "tile autotune database misses the tuned entry\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_tile_autotune_bucket()
+{
+    const char* dbpath = "test_gemm_autotune_bucket.txt";
+    remove(dbpath);
+
+    if (ncnn::set_tile_autotune_database(dbpath) != 0)
+    {
+        fprintf(stderr, "set_tile_autotune_database failed\n");
+        return -1;
+    }
+
+    // growing dynamic shapes share the entry of their power-of-two bucket
+    int ret = test_gemm_autotune(100, 120, 140, 0, 0)
+              || test_gemm_autotune(110, 125, 150, 0, 0)
+              || test_gemm_autotune(120, 127, 160, 0, 0);
+    if (ret != 0)
+    {
+        remove(dbpath);
+        return ret;
+    }
+
+    FILE* fp = fopen(dbpath, "rb");
+    if (!fp)
+        return 0;
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp))
+    {
+        char kernel[32];
+        unsigned int isa;
+        int nT, M, N, K;
+        if (sscanf(line, "%31s %x %d %d %d %d", kernel, &isa, &nT, &M, &N, &K) != 6)
+            continue;
+
+        if (strstr(kernel, "dynamic") && ((M & (M - 1)) || (N & (N - 1)) || (K & (K - 1))))
+        {
+            fprintf(stderr, "tile autotune database has an unbucketed entry %s", line);
+            ret = -1;
+        }
+    }
+
+    fclose(fp);
+    remove(dbpath);
+
+    return ret;
+}
+
 int main()
 {
     SRAND(7767517);
@@ -292,5 +438,12 @@ int main()
             return ret;
     }
 
-    return 0;
+    return 0
+           || test_gemm_autotune(47, 35, 48, 0, 0)
+           || test_gemm_autotune(100, 120, 140, 0, 0)
+           || test_gemm_autotune(100, 120, 140, 1, 0)
+           || test_gemm_autotune(100, 120, 140, 0, 1)
+           || test_gemm_autotune(100, 120, 140, 1, 1)
+           || test_tile_autotune_database()
+           || test_tile_autotune_bucket();
 }
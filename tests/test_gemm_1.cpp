@@ -74,7 +74,11 @@ int main()
         {52, 52, 52},
         {63, 64, 63},
         {64, 63, 64},
-        {64, 64, 64}
+        {64, 64, 64},
+        {48, 37, 45},
+        {33, 52, 46},
+        {64, 20, 47},
+        {80, 35, 71}
     };
 
     int tile_mnk[][3] = {
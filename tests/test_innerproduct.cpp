@@ -242,7 +242,10 @@ static int test_innerproduct_5()
            || test_innerproduct_gemm_int8(RandomMat(16, 12), 16, 0)
            || test_innerproduct_gemm_int8(RandomMat(4, 15), 8, 1)
            || test_innerproduct_gemm_int8(RandomMat(6, 16), 16, 0)
-           || test_innerproduct_gemm_int8(RandomMat(12, 16), 7, 1);
+           || test_innerproduct_gemm_int8(RandomMat(12, 16), 7, 1)
+           || test_innerproduct_gemm_int8(RandomMat(45, 20), 48, 1)
+           || test_innerproduct_gemm_int8(RandomMat(71, 35), 33, 0)
+           || test_innerproduct_gemm_int8(RandomMat(47, 64), 40, 1);
 }
 #endif // NCNN_INT8
 
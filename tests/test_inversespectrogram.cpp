@@ -3,6 +3,8 @@
 
 #include "testutil.h"
 
+#include <math.h>
+
 static int test_inversespectrogram(int frames, int freqs, int n_fft, int returns, int hoplen, int winlen, int window_type, int center, int normalized)
 {
     ncnn::Mat a = RandomMat(2, frames, freqs);
@@ -34,12 +36,138 @@ static int test_inversespectrogram_0()
            || test_inversespectrogram(39, 9, 17, 0, 7, 15, 0, 0, 1)
            || test_inversespectrogram(128, 6, 10, 0, 2, 7, 1, 1, 1)
            || test_inversespectrogram(255, 17, 17, 1, 14, 17, 2, 0, 0)
-           || test_inversespectrogram(124, 28, 55, 2, 12, 55, 1, 1, 2);
+           || test_inversespectrogram(124, 28, 55, 2, 12, 55, 1, 1, 2)
+           || test_inversespectrogram(12, 201, 400, 0, 100, 400, 1, 1, 2)
+           || test_inversespectrogram(16, 257, 512, 1, 128, 480, 1, 1, 0);
+}
+
+// compare against a naive inverse dft in double precision
+static int test_inversespectrogram_dft(int n_fft, int onesided, int returns)
+{
+    // non-overlapping frames with ones window, so overlap add only concatenates
+    const int frames = 3;
+    const int freqs = onesided ? n_fft / 2 + 1 : n_fft;
+
+    ncnn::Mat a = RandomMat(2, frames, freqs);
+
+    ncnn::ParamDict pd;
+    pd.set(0, n_fft);
+    pd.set(1, returns);
+    pd.set(2, n_fft);
+    pd.set(3, n_fft);
+    pd.set(4, 0);
+    pd.set(5, 0);
+    pd.set(7, 1);
+
+    std::vector<ncnn::Mat> weights(0);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Layer* op = ncnn::create_layer_cpu("InverseSpectrogram");
+
+    op->load_param(pd);
+
+    ncnn::ModelBinFromMatArray mb(weights.data());
+
+    op->load_model(mb);
+
+    op->create_pipeline(opt);
+
+    ncnn::Mat b;
+    op->forward(a, b, opt);
+
+    op->destroy_pipeline(opt);
+
+    delete op;
+
+    const int outsize = frames * n_fft;
+    if ((returns == 0 && (b.dims != 2 || b.w != 2 || b.h != outsize)) || (returns != 0 && (b.dims != 1 || b.w != outsize)))
+    {
+        fprintf(stderr, "test_inversespectrogram_dft failed n_fft=%d onesided=%d returns=%d shape=(%d %d)\n", n_fft, onesided, returns, b.w, b.h);
+        return -1;
+    }
+
+    double max_error = 0.0;
+    for (int j = 0; j < frames; j++)
+    {
+        for (int t = 0; t < n_fft; t++)
+        {
+            double re = 0.0;
+            double im = 0.0;
+            for (int k = 0; k < n_fft; k++)
+            {
+                // the missing half of a onesided spectrum is the conjugate mirror
+                double xr;
+                double xi;
+                if (k < freqs)
+                {
+                    xr = a.channel(k).row(j)[0];
+                    xi = a.channel(k).row(j)[1];
+                }
+                else
+                {
+                    xr = a.channel(n_fft - k).row(j)[0];
+                    xi = -a.channel(n_fft - k).row(j)[1];
+                }
+
+                const double angle = 2.0 * 3.14159265358979323846 * (double)((long)k * t % n_fft) / n_fft;
+                re += xr * cos(angle) - xi * sin(angle);
+                im += xr * sin(angle) + xi * cos(angle);
+            }
+            re /= sqrt((double)n_fft);
+            im /= sqrt((double)n_fft);
+
+            const int i = j * n_fft + t;
+            if (returns == 0)
+            {
+                max_error = std::max(max_error, fabs(b.row(i)[0] - re));
+                max_error = std::max(max_error, fabs(b.row(i)[1] - im));
+            }
+            if (returns == 1)
+            {
+                max_error = std::max(max_error, fabs(b[i] - re));
+            }
+            if (returns == 2)
+            {
+                max_error = std::max(max_error, fabs(b[i] - im));
+            }
+        }
+    }
+
+    if (max_error > 6e-6)
+    {
+        fprintf(stderr, "test_inversespectrogram_dft failed n_fft=%d onesided=%d returns=%d max_error=%g\n", n_fft, onesided, returns, max_error);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_inversespectrogram_1()
+{
+    // odd, prime and mixed radix sizes
+    static const int n_ffts[8] = {7, 12, 30, 64, 97, 100, 400, 512};
+
+    for (int i = 0; i < 8; i++)
+    {
+        int ret = 0
+                  || test_inversespectrogram_dft(n_ffts[i], 0, 0)
+                  || test_inversespectrogram_dft(n_ffts[i], 0, 2)
+                  || test_inversespectrogram_dft(n_ffts[i], 1, 0)
+                  || test_inversespectrogram_dft(n_ffts[i], 1, 1);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
 }
 
 int main()
 {
     SRAND(7767517);
 
-    return test_inversespectrogram_0();
+    return 0
+           || test_inversespectrogram_0()
+           || test_inversespectrogram_1();
 }
@@ -121,6 +121,98 @@ static int test_multiheadattention_sameqkv(const ncnn::Mat& a, int embed_dim, in
     return ret;
 }
 
+static int test_multiheadattention_causal(const ncnn::Mat& q, const ncnn::Mat& kv, int embed_dim, int num_heads, int attn_mask)
+{
+    const int qdim = q.w;
+    const int kvdim = kv.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, kvdim);
+    pd.set(4, kvdim);
+    pd.set(5, attn_mask);
+    pd.set(7, 1);
+
+    std::vector<ncnn::Mat> weights(8);
+    weights[0] = RandomMat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomMat(embed_dim * kvdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomMat(embed_dim * kvdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomMat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+
+    std::vector<ncnn::Mat> as(2);
+    as[0] = q;
+    as[1] = kv;
+
+    if (attn_mask)
+    {
+        as.push_back(RandomMat(kv.h, q.h));
+    }
+
+    float epsilon = 0.005;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 1, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_causal failed q=(%d %d) kv=(%d %d) embed_dim=%d num_heads=%d kvdim=%d attn_mask=%d\n", q.w, q.h, kv.w, kv.h, embed_dim, num_heads, kvdim, attn_mask);
+    }
+
+    return ret;
+}
+
+static int test_multiheadattention_kvcache(const ncnn::Mat& q, const ncnn::Mat& kv, int past_seqlen, int embed_dim, int num_heads, int attn_mask, int causal)
+{
+    const int qdim = q.w;
+    const int kvdim = kv.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, kvdim);
+    pd.set(4, kvdim);
+    pd.set(5, attn_mask);
+    pd.set(7, causal);
+    pd.set(8, 1);
+
+    std::vector<ncnn::Mat> weights(8);
+    weights[0] = RandomMat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomMat(embed_dim * kvdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomMat(embed_dim * kvdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomMat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+
+    std::vector<ncnn::Mat> as(2);
+    as[0] = q;
+    as[1] = kv;
+
+    if (attn_mask)
+    {
+        as.push_back(RandomMat(past_seqlen + kv.h, q.h));
+    }
+
+    as.push_back(RandomMat(past_seqlen, embed_dim));
+    as.push_back(RandomMat(past_seqlen, embed_dim));
+
+    float epsilon = 0.005;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 3, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_kvcache failed q=(%d %d) kv=(%d %d) past_seqlen=%d embed_dim=%d num_heads=%d kvdim=%d attn_mask=%d causal=%d\n", q.w, q.h, kv.w, kv.h, past_seqlen, embed_dim, num_heads, kvdim, attn_mask, causal);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_0()
 {
     return 0
@@ -152,6 +244,27 @@ static int test_multiheadattention_2()
            || test_multiheadattention_sameqkv(RandomMat(48, 127), 64, 8);
 }
 
+static int test_multiheadattention_3()
+{
+    return 0
+           || test_multiheadattention_causal(RandomMat(64, 128), RandomMat(64, 128), 64, 4, 0)
+           || test_multiheadattention_causal(RandomMat(48, 127), RandomMat(64, 127), 64, 16, 1)
+           || test_multiheadattention_causal(RandomMat(16, 33), RandomMat(44, 33), 16, 2, 0)
+           || test_multiheadattention_causal(RandomMat(12, 17), RandomMat(28, 127), 12, 3, 1)
+           || test_multiheadattention_causal(RandomMat(12, 1), RandomMat(11, 32), 12, 3, 0)
+           || test_multiheadattention_causal(RandomMat(12, 32), RandomMat(11, 7), 12, 3, 0);
+}
+
+static int test_multiheadattention_4()
+{
+    return 0
+           || test_multiheadattention_kvcache(RandomMat(64, 1), RandomMat(64, 1), 127, 64, 4, 0, 0)
+           || test_multiheadattention_kvcache(RandomMat(48, 1), RandomMat(64, 1), 33, 64, 16, 1, 1)
+           || test_multiheadattention_kvcache(RandomMat(16, 7), RandomMat(44, 7), 16, 16, 2, 0, 1)
+           || test_multiheadattention_kvcache(RandomMat(12, 17), RandomMat(28, 17), 5, 12, 3, 1, 0)
+           || test_multiheadattention_kvcache(RandomMat(12, 4), RandomMat(11, 4), 28, 12, 3, 0, 1);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -159,5 +272,7 @@ int main()
     return 0
            || test_multiheadattention_0()
            || test_multiheadattention_1()
-           || test_multiheadattention_2();
+           || test_multiheadattention_2()
+           || test_multiheadattention_3()
+           || test_multiheadattention_4();
 }
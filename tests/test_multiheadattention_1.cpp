@@ -139,6 +139,53 @@ static int test_multiheadattention_int8_sameqkv(const ncnn::Mat& a, int embed_di
     return ret;
 }
 
+static int test_multiheadattention_int8_kvcache(const ncnn::Mat& q, const ncnn::Mat& kv, int past_seqlen, int embed_dim, int num_heads, int causal)
+{
+    const int qdim = q.w;
+    const int kvdim = kv.w;
+
+    ncnn::ParamDict pd;
+    pd.set(0, embed_dim);
+    pd.set(1, num_heads);
+    pd.set(2, embed_dim * qdim);
+    pd.set(3, kvdim);
+    pd.set(4, kvdim);
+    pd.set(6, 1.f / sqrtf(embed_dim / num_heads));
+    pd.set(7, causal);
+    pd.set(8, 1);  // kv_cache
+    pd.set(18, 2); // int8_scale_term
+
+    std::vector<ncnn::Mat> weights(12);
+    weights[0] = RandomS8Mat(embed_dim * qdim);
+    weights[1] = RandomMat(embed_dim);
+    weights[2] = RandomS8Mat(embed_dim * kvdim);
+    weights[3] = RandomMat(embed_dim);
+    weights[4] = RandomS8Mat(embed_dim * kvdim);
+    weights[5] = RandomMat(embed_dim);
+    weights[6] = RandomS8Mat(qdim * embed_dim);
+    weights[7] = RandomMat(qdim);
+    weights[8] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[9] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[10] = RandomMat(embed_dim, 160.f, 200.f);
+    weights[11] = RandomMat(1, 160.f, 200.f);
+
+    std::vector<ncnn::Mat> as(4);
+    as[0] = q;
+    as[1] = kv;
+    as[2] = RandomMat(past_seqlen, embed_dim);
+    as[3] = RandomMat(past_seqlen, embed_dim);
+
+    float epsilon = 0.1;
+
+    int ret = test_layer("MultiHeadAttention", pd, weights, as, 3, epsilon);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_multiheadattention_int8_kvcache failed q=(%d %d) kv=(%d %d) past_seqlen=%d embed_dim=%d num_heads=%d kvdim=%d causal=%d\n", q.w, q.h, kv.w, kv.h, past_seqlen, embed_dim, num_heads, kvdim, causal);
+    }
+
+    return ret;
+}
+
 static int test_multiheadattention_0()
 {
     return 0
@@ -169,6 +216,14 @@ static int test_multiheadattention_2()
            || test_multiheadattention_int8_sameqkv(RandomMat(64, 128), 64, 4)
            || test_multiheadattention_int8_sameqkv(RandomMat(48, 127), 64, 8);
 }
+
+static int test_multiheadattention_3()
+{
+    return 0
+           || test_multiheadattention_int8_kvcache(RandomMat(64, 1), RandomMat(64, 1), 127, 64, 4, 0)
+           || test_multiheadattention_int8_kvcache(RandomMat(16, 7), RandomMat(44, 7), 16, 16, 2, 1)
+           || test_multiheadattention_int8_kvcache(RandomMat(12, 4), RandomMat(11, 4), 28, 12, 3, 1);
+}
 #endif
 
 int main()
@@ -179,7 +234,8 @@ int main()
     return 0
            || test_multiheadattention_0()
            || test_multiheadattention_1()
-           || test_multiheadattention_2();
+           || test_multiheadattention_2()
+           || test_multiheadattention_3();
 #else
     // test nothing
     return 0;
@@ -0,0 +1,1040 @@
+// Copyright 2025 Tencent
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cpu.h"
+#include "net.h"
+
+// conv -> relu -> global pooling -> fc -> sigmoid -> fc -> reshape
+static const char* test_net_param = "7767517\n"
+                                    "8 8\n"
+                                    "Input            data     0 1 data 0=7 1=9 2=3\n"
+                                    "Convolution      conv     1 1 data c0 0=4 1=3 4=1 5=1 6=108\n"
+                                    "ReLU             relu     1 1 c0 c1\n"
+                                    "Pooling          pool     1 1 c1 p0 0=1 4=1\n"
+                                    "InnerProduct     fc       1 1 p0 f0 0=8 1=1 2=32\n"
+                                    "Sigmoid          sig      1 1 f0 f1\n"
+                                    "InnerProduct     fc2      1 1 f1 f2 0=6 1=1 2=48\n"
+                                    "Reshape          reshape  1 1 f2 out 0=3 1=2\n";
+
+// data -> split -> conv 3x3 + conv 1x1 -> add
+static const char* test_net_branch_param = "7767517\n"
+                                           "5 6\n"
+                                           "Input            data     0 1 data 0=7 1=9 2=3\n"
+                                           "Split            split    1 2 data d0 d1\n"
+                                           "Convolution      conv0    1 1 d0 c0 0=4 1=3 4=1 5=1 6=108\n"
+                                           "Convolution      conv1    1 1 d1 c1 0=4 1=1 5=1 6=12\n"
+                                           "BinaryOp         add      2 1 c0 c1 out 0=0\n";
+
+// causal self attention with kv cache in and out
+static const char* test_net_kvcache_param = "7767517\n"
+                                            "4 6\n"
+                                            "Input              data     0 1 data 0=16 1=6\n"
+                                            "Input              cache_k  0 1 cache_k 0=0 1=16\n"
+                                            "Input              cache_v  0 1 cache_v 0=0 1=16\n"
+                                            "MultiHeadAttention attn     3 3 data cache_k cache_v out out_cache_k out_cache_v 0=16 1=2 2=256 7=1 8=1\n";
+
+static unsigned int g_seed = 7767517;
+
+static float random_float()
+{
+    g_seed = g_seed * 1664525 + 1013904223;
+    return (float)(g_seed >> 8) / 16777216.f * 2.f - 1.f;
+}
+
+static void append_weight(std::vector<float>& model, int size, bool flag)
+{
+    if (flag)
+    {
+        // raw float32
+        model.push_back(0.f);
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        model.push_back(random_float());
+    }
+}
+
+static void make_test_net_model(std::vector<float>& model)
+{
+    append_weight(model, 108, true);
+    append_weight(model, 4, false);
+    append_weight(model, 32, true);
+    append_weight(model, 8, false);
+    append_weight(model, 48, true);
+    append_weight(model, 6, false);
+}
+
+static int compare_mat(const ncnn::Mat& a, const ncnn::Mat& b, float epsilon = 0.001)
+{
+    if (a.dims != b.dims || a.w != b.w || a.h != b.h || a.c != b.c)
+    {
+        fprintf(stderr, "shape not match %d %d %d %d vs %d %d %d %d\n", a.dims, a.w, a.h, a.c, b.dims, b.w, b.h, b.c);
+        return -1;
+    }
+
+    for (int q = 0; q < a.c; q++)
+    {
+        const float* pa = a.channel(q);
+        const float* pb = b.channel(q);
+        for (int i = 0; i < a.w * a.h; i++)
+        {
+            if (fabs(pa[i] - pb[i]) > epsilon)
+            {
+                fprintf(stderr, "value not match at c:%d i:%d %f vs %f\n", q, i, pa[i], pb[i]);
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int test_net_batch(const ncnn::Option& opt, int batch_size)
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Net net;
+    net.opt = opt;
+    net.load_param_mem(test_net_param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    std::vector<ncnn::Mat> inputs(batch_size);
+    for (int b = 0; b < batch_size; b++)
+    {
+        inputs[b].create(7, 9, 3);
+        for (int i = 0; i < (int)inputs[b].total(); i++)
+        {
+            inputs[b][i] = random_float();
+        }
+    }
+
+    std::vector<ncnn::Mat> outs;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", inputs);
+
+        int ret = ex.extract("out", outs);
+        if (ret != 0 || (int)outs.size() != batch_size)
+        {
+            fprintf(stderr, "batch extract failed ret=%d\n", ret);
+            return -1;
+        }
+    }
+
+    for (int b = 0; b < batch_size; b++)
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", inputs[b]);
+
+        ncnn::Mat out;
+        ex.extract("out", out);
+
+        if (compare_mat(outs[b], out) != 0)
+        {
+            fprintf(stderr, "test_net_batch item %d of %d failed use_packing_layout=%d lightmode=%d\n", b, batch_size, opt.use_packing_layout, opt.lightmode);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_net_batch_mismatch()
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Net net;
+    net.load_param_mem(test_net_param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Extractor ex = net.create_extractor();
+
+    std::vector<ncnn::Mat> outs;
+    if (ex.extract("out", outs) == 0)
+    {
+        fprintf(stderr, "test_net_batch_mismatch extract without input should fail\n");
+        return -1;
+    }
+
+    std::vector<ncnn::Mat> inputs(2);
+    inputs[0].create(7, 9, 3);
+    inputs[1].create(7, 9, 3);
+    ex.input("data", inputs);
+
+    inputs.resize(3);
+    if (ex.input("data", inputs) == 0)
+    {
+        fprintf(stderr, "test_net_batch_mismatch batch size mismatch should fail\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_load_model_mmap()
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    const char* modelpath = "test_net_load_model_mmap.bin";
+    {
+        FILE* fp = fopen(modelpath, "wb");
+        if (!fp)
+        {
+            fprintf(stderr, "fopen %s failed\n", modelpath);
+            return -1;
+        }
+
+        fwrite(&model[0], sizeof(float), model.size(), fp);
+        fclose(fp);
+    }
+
+    ncnn::Mat in(7, 9, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Net net0;
+    net0.load_param_mem(test_net_param);
+    net0.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Net net1;
+    net1.load_param_mem(test_net_param);
+    int ret = net1.load_model_mmap(modelpath);
+    remove(modelpath);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_net_load_model_mmap load failed\n");
+        return -1;
+    }
+
+    ncnn::Mat out0;
+    {
+        ncnn::Extractor ex = net0.create_extractor();
+        ex.input("data", in);
+        ex.extract("out", out0);
+    }
+
+    ncnn::Mat out1;
+    {
+        ncnn::Extractor ex = net1.create_extractor();
+        ex.input("data", in);
+        ex.extract("out", out1);
+    }
+
+    if (compare_mat(out0, out1, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_load_model_mmap output mismatch\n");
+        return -1;
+    }
+
+    ncnn::Net net2;
+    net2.load_param_mem(test_net_param);
+    if (net2.load_model_mmap("test_net_load_model_mmap_missing.bin") == 0)
+    {
+        fprintf(stderr, "test_net_load_model_mmap missing file should fail\n");
+        return -1;
+    }
+
+    // a truncated model fails after the leading layers took their weights from the mapping
+    {
+        FILE* fp = fopen(modelpath, "wb");
+        if (!fp)
+        {
+            fprintf(stderr, "fopen %s failed\n", modelpath);
+            return -1;
+        }
+
+        fwrite(&model[0], sizeof(float), model.size() / 2, fp);
+        fclose(fp);
+    }
+
+    ncnn::Net net3;
+    net3.load_param_mem(test_net_param);
+    ret = net3.load_model_mmap(modelpath);
+    remove(modelpath);
+    if (ret == 0)
+    {
+        fprintf(stderr, "test_net_load_model_mmap truncated file should fail\n");
+        return -1;
+    }
+
+    net3.clear();
+
+    return 0;
+}
+
+static int test_net_parallel_create_pipeline(int num_threads)
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Mat in(7, 9, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Net net0;
+    net0.opt.num_threads = num_threads;
+    net0.load_param_mem(test_net_param);
+    net0.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Net net1;
+    net1.opt.num_threads = num_threads;
+    net1.opt.use_parallel_create_pipeline = true;
+    net1.load_param_mem(test_net_param);
+    if (net1.load_model((const unsigned char*)&model[0]) <= 0)
+    {
+        fprintf(stderr, "test_net_parallel_create_pipeline load failed\n");
+        return -1;
+    }
+
+    if (net1.create_pipeline_times().size() != net1.layers().size())
+    {
+        fprintf(stderr, "test_net_parallel_create_pipeline %d timings for %d layers\n", (int)net1.create_pipeline_times().size(), (int)net1.layers().size());
+        return -1;
+    }
+
+    ncnn::Mat out0;
+    {
+        ncnn::Extractor ex = net0.create_extractor();
+        ex.input("data", in);
+        ex.extract("out", out0);
+    }
+
+    ncnn::Mat out1;
+    {
+        ncnn::Extractor ex = net1.create_extractor();
+        ex.input("data", in);
+        ex.extract("out", out1);
+    }
+
+    if (compare_mat(out0, out1, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_parallel_create_pipeline output mismatch num_threads=%d\n", num_threads);
+        return -1;
+    }
+
+    return 0;
+}
+
+// same weight count with a 1x9 convolution kernel
+static const char* test_net_param_kernel_1x9 = "7767517\n"
+                                               "8 8\n"
+                                               "Input            data     0 1 data 0=7 1=9 2=3\n"
+                                               "Convolution      conv     1 1 data c0 0=4 1=1 11=9 4=1 5=1 6=108\n"
+                                               "ReLU             relu     1 1 c0 c1\n"
+                                               "Pooling          pool     1 1 c1 p0 0=1 4=1\n"
+                                               "InnerProduct     fc       1 1 p0 f0 0=8 1=1 2=32\n"
+                                               "Sigmoid          sig      1 1 f0 f1\n"
+                                               "InnerProduct     fc2      1 1 f1 f2 0=6 1=1 2=48\n"
+                                               "Reshape          reshape  1 1 f2 out 0=3 1=2\n";
+
+static int test_net_weight_cache_forward(const char* param, const std::vector<float>& model, const char* cachepath, const ncnn::Mat& in, ncnn::Mat& out, const ncnn::Option& opt = ncnn::Option())
+{
+    ncnn::Net net;
+    net.opt = opt;
+    if (cachepath)
+        net.set_weight_cache(cachepath);
+    net.load_param_mem(param);
+    if (net.load_model((const unsigned char*)&model[0]) <= 0)
+        return -1;
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("data", in);
+    return ex.extract("out", out);
+}
+
+static int test_net_weight_cache()
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    std::vector<float> model2;
+    make_test_net_model(model2);
+
+    ncnn::Mat in(7, 9, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    const char* cachepath = "test_net_weight_cache.bin";
+    remove(cachepath);
+
+    ncnn::Mat out0;
+    ncnn::Mat out1;
+    ncnn::Mat out2;
+    ncnn::Mat out3;
+    ncnn::Mat out4;
+    ncnn::Mat out5;
+    ncnn::Mat out6;
+    int ret = 0
+              || test_net_weight_cache_forward(test_net_param, model, 0, in, out0)
+              || test_net_weight_cache_forward(test_net_param, model, cachepath, in, out1)  // miss, write cache
+              || test_net_weight_cache_forward(test_net_param, model, cachepath, in, out2)  // hit
+              || test_net_weight_cache_forward(test_net_param, model2, 0, in, out3)
+              || test_net_weight_cache_forward(test_net_param, model2, cachepath, in, out4) // other weights, miss
+              || test_net_weight_cache_forward(test_net_param_kernel_1x9, model2, 0, in, out5)
+              || test_net_weight_cache_forward(test_net_param_kernel_1x9, model2, cachepath, in, out6); // other params, miss
+    remove(cachepath);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_net_weight_cache forward failed\n");
+        return -1;
+    }
+
+    if (compare_mat(out0, out1, 0.f) != 0 || compare_mat(out0, out2, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_weight_cache output mismatch\n");
+        return -1;
+    }
+
+    if (compare_mat(out3, out4, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_weight_cache stale cache used for other weights\n");
+        return -1;
+    }
+
+    if (compare_mat(out5, out6, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_weight_cache stale cache used for other params\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+// conv3x3s1 keeps fp32 winograd under bf16 storage
+static const char* test_net_param_conv3x3s1 = "7767517\n"
+                                              "2 2\n"
+                                              "Input            data     0 1 data 0=12 1=10 2=16\n"
+                                              "Convolution      conv     1 1 data out 0=16 1=3 4=1 5=1 6=2304\n";
+
+static int test_net_weight_cache_bf16()
+{
+    std::vector<float> model;
+    append_weight(model, 2304, true);
+    append_weight(model, 16, false);
+
+    ncnn::Mat in(12, 10, 16);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+    opt.use_bf16_storage = true;
+
+    const char* cachepath = "test_net_weight_cache_bf16.bin";
+    remove(cachepath);
+
+    ncnn::Mat out0;
+    ncnn::Mat out1;
+    ncnn::Mat out2;
+    int ret = 0
+              || test_net_weight_cache_forward(test_net_param_conv3x3s1, model, 0, in, out0, opt)
+              || test_net_weight_cache_forward(test_net_param_conv3x3s1, model, cachepath, in, out1, opt)  // miss, write cache
+              || test_net_weight_cache_forward(test_net_param_conv3x3s1, model, cachepath, in, out2, opt); // hit
+    remove(cachepath);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_net_weight_cache_bf16 forward failed\n");
+        return -1;
+    }
+
+    if (compare_mat(out0, out1, 0.f) != 0 || compare_mat(out0, out2, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_weight_cache_bf16 output mismatch\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_profiling()
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Net net;
+    net.opt.use_packing_layout = false;
+    net.load_param_mem(test_net_param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Mat in(7, 9, 3);
+    in.fill(0.5f);
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_profiling(true);
+    ex.input("data", in);
+
+    ncnn::Mat out;
+    ex.extract("out", out);
+
+    // all layers except input
+    const std::vector<ncnn::LayerProfile>& profiles = ex.layer_profiles();
+    if (profiles.size() != net.layers().size() - 1)
+    {
+        fprintf(stderr, "test_net_profiling %d records for %d layers\n", (int)profiles.size(), (int)net.layers().size());
+        return -1;
+    }
+
+    // conv runs first
+    const ncnn::LayerProfile& conv = profiles[0];
+    if (conv.layer_index != 1 || conv.end < conv.start || conv.bottom_shapes.size() != 1 || conv.top_shapes.size() != 1)
+    {
+        fprintf(stderr, "test_net_profiling conv record broken\n");
+        return -1;
+    }
+
+    const ncnn::Mat& conv_top = conv.top_shapes[0];
+    if (conv_top.dims != 3 || conv_top.w != 7 || conv_top.h != 9 || conv_top.c != 4 || conv_top.data != 0)
+    {
+        fprintf(stderr, "test_net_profiling conv top shape %d %d %d %d\n", conv_top.dims, conv_top.w, conv_top.h, conv_top.c);
+        return -1;
+    }
+
+    if (conv.allocated_bytes < (size_t)7 * 9 * 4 * sizeof(float))
+    {
+        fprintf(stderr, "test_net_profiling conv allocated %d bytes\n", (int)conv.allocated_bytes);
+        return -1;
+    }
+
+#if __x86_64__ || __i386__ || _M_X64 || _M_IX86
+    if (!conv.kernel)
+    {
+        fprintf(stderr, "test_net_profiling conv kernel not reported\n");
+        return -1;
+    }
+
+#if NCNN_BF16
+    // bf16 storage packs the conv weights for the bf16 gemm
+    {
+        ncnn::Net net_bf16;
+        net_bf16.opt.use_packing_layout = false;
+        net_bf16.opt.use_bf16_storage = true;
+        net_bf16.load_param_mem(test_net_param);
+        net_bf16.load_model((const unsigned char*)&model[0]);
+
+        ncnn::Extractor ex_bf16 = net_bf16.create_extractor();
+        ex_bf16.set_profiling(true);
+        ex_bf16.input("data", in);
+
+        ncnn::Mat out_bf16;
+        ex_bf16.extract("out", out_bf16);
+
+        const char* kernel = ex_bf16.layer_profiles().empty() ? 0 : ex_bf16.layer_profiles()[0].kernel;
+        if (!kernel || strcmp(kernel, "bf16s_sgemm") != 0)
+        {
+            fprintf(stderr, "test_net_profiling bf16 conv kernel %s\n", kernel ? kernel : "null");
+            return -1;
+        }
+    }
+#endif // NCNN_BF16
+#endif
+
+    const char* tracepath = "test_net_profiling.json";
+    if (ex.save_profile_chrome_trace(tracepath) != 0)
+    {
+        fprintf(stderr, "test_net_profiling save trace failed\n");
+        return -1;
+    }
+
+    char header[16] = {0};
+    FILE* fp = fopen(tracepath, "rb");
+    if (fp)
+    {
+        if (fread(header, 1, 15, fp) != 15)
+            header[0] = 0;
+        fclose(fp);
+    }
+    remove(tracepath);
+
+    if (strcmp(header, "{\"traceEvents\":") != 0)
+    {
+        fprintf(stderr, "test_net_profiling trace header %s\n", header);
+        return -1;
+    }
+
+    ex.set_profiling(false);
+    if (!ex.layer_profiles().empty())
+    {
+        fprintf(stderr, "test_net_profiling records kept after disabling\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_extractor_reuse(bool reuse_memory)
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Net net;
+    net.load_param_mem(test_net_param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_reuse_memory(reuse_memory);
+
+    for (int r = 0; r < 4; r++)
+    {
+        ncnn::Mat in(7, 9, 3);
+        for (int i = 0; i < (int)in.total(); i++)
+        {
+            in[i] = random_float();
+        }
+
+        ncnn::Mat out0;
+        {
+            ncnn::Extractor ex0 = net.create_extractor();
+            ex0.input("data", in);
+            ex0.extract("out", out0);
+        }
+
+        ex.reset();
+        ex.input("data", in);
+
+        ncnn::Mat out;
+        if (ex.extract("out", out) != 0 || compare_mat(out0, out, 0.f) != 0)
+        {
+            fprintf(stderr, "test_net_extractor_reuse round %d failed reuse_memory=%d\n", r, reuse_memory);
+            return -1;
+        }
+    }
+
+    // outputs outlive the extractor and its reuse pool
+    ncnn::Mat in(7, 9, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Mat out0;
+    {
+        ncnn::Extractor ex0 = net.create_extractor();
+        ex0.input("data", in);
+        ex0.extract("out", out0);
+    }
+
+    ncnn::Mat out1;
+    {
+        ncnn::Extractor ex1 = net.create_extractor();
+        ex1.set_reuse_memory(reuse_memory);
+        ex1.input("data", in);
+        ex1.extract("out", out1);
+    }
+
+    if (out1.empty() || out1.allocator != 0 || compare_mat(out0, out1, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_extractor_reuse output bound to extractor reuse_memory=%d\n", reuse_memory);
+        return -1;
+    }
+
+    // a copy outlives the extractor it was made from
+    ncnn::Mat out2;
+    {
+        ncnn::Extractor* ex2 = new ncnn::Extractor(net.create_extractor());
+        ex2->set_reuse_memory(reuse_memory);
+        ex2->input("data", in);
+        ex2->extract("out", out2);
+
+        ncnn::Extractor ex3 = *ex2;
+        ncnn::Extractor ex4 = net.create_extractor();
+        ex4 = *ex2;
+        delete ex2;
+
+        ncnn::Mat out3;
+        ncnn::Mat out4;
+        ex3.input("data", in);
+        ex4.input("data", in);
+        if (ex3.extract("out", out3) != 0 || ex4.extract("out", out4) != 0 || compare_mat(out0, out3, 0.f) != 0 || compare_mat(out0, out4, 0.f) != 0)
+        {
+            fprintf(stderr, "test_net_extractor_reuse copied extractor failed reuse_memory=%d\n", reuse_memory);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int test_net_extractor_arena(bool lightmode)
+{
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Net net;
+    net.opt.lightmode = lightmode;
+    net.load_param_mem(test_net_param);
+    net.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Extractor ex = net.create_extractor();
+    ex.set_arena_memory(true);
+
+    for (int r = 0; r < 4; r++)
+    {
+        ncnn::Mat in(7, 9, 3);
+        for (int i = 0; i < (int)in.total(); i++)
+        {
+            in[i] = random_float();
+        }
+
+        ncnn::Mat out0;
+        {
+            ncnn::Extractor ex0 = net.create_extractor();
+            ex0.input("data", in);
+            ex0.extract("out", out0);
+        }
+
+        // the first reset plans the arena, the following ones replay it
+        ex.reset();
+        ex.input("data", in);
+
+        ncnn::Mat out;
+        if (ex.extract("out", out) != 0 || out.allocator != 0 || compare_mat(out0, out, 0.f) != 0)
+        {
+            fprintf(stderr, "test_net_extractor_arena round %d failed lightmode=%d\n", r, lightmode);
+            return -1;
+        }
+    }
+
+    // other input shapes fall back to the heap
+    ncnn::Mat in(9, 11, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Mat out0;
+    {
+        ncnn::Extractor ex0 = net.create_extractor();
+        ex0.input("data", in);
+        ex0.extract("out", out0);
+    }
+
+    ex.reset();
+    ex.input("data", in);
+
+    ncnn::Mat out;
+    if (ex.extract("out", out) != 0 || compare_mat(out0, out, 0.f) != 0)
+    {
+        fprintf(stderr, "test_net_extractor_arena other shape failed lightmode=%d\n", lightmode);
+        return -1;
+    }
+
+    return 0;
+}
+
+static bool same_cpu_set(const ncnn::CpuSet& a, const ncnn::CpuSet& b)
+{
+    for (int i = 0; i < ncnn::get_cpu_count(); i++)
+    {
+        if (a.is_enabled(i) != b.is_enabled(i))
+            return false;
+    }
+
+    return true;
+}
+
+static int test_net_numa_node()
+{
+    const int node_count = ncnn::get_numa_node_count();
+    if (node_count < 1)
+    {
+        fprintf(stderr, "test_net_numa_node %d nodes\n", node_count);
+        return -1;
+    }
+
+    for (int i = 0; i < node_count; i++)
+    {
+        if (ncnn::get_numa_node_thread_affinity_mask(i).num_enabled() == 0)
+        {
+            fprintf(stderr, "test_net_numa_node node %d has no cpu\n", i);
+            return -1;
+        }
+    }
+
+    std::vector<float> model;
+    make_test_net_model(model);
+
+    ncnn::Mat in(7, 9, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Net net0;
+    net0.opt.num_threads = 1;
+    net0.load_param_mem(test_net_param);
+    net0.load_model((const unsigned char*)&model[0]);
+
+    ncnn::Mat out0;
+    {
+        ncnn::Extractor ex = net0.create_extractor();
+        ex.input("data", in);
+        ex.extract("out", out0);
+    }
+
+    // pin the caller to one cpu, which must survive load_model and extract
+    ncnn::CpuSet caller_mask;
+    ncnn::CpuSet pinned_mask;
+    const bool check_caller_mask = ncnn::get_current_thread_affinity(caller_mask) == 0;
+    if (check_caller_mask)
+    {
+        for (int i = 0; i < ncnn::get_cpu_count(); i++)
+        {
+            if (caller_mask.is_enabled(i))
+            {
+                pinned_mask.enable(i);
+                break;
+            }
+        }
+
+        ncnn::set_current_thread_affinity(pinned_mask);
+    }
+
+    // one replica per node
+    for (int i = 0; i < node_count; i++)
+    {
+        ncnn::Net net1;
+        net1.opt.num_threads = 1;
+        net1.opt.numa_node = i;
+        net1.load_param_mem(test_net_param);
+        if (net1.load_model((const unsigned char*)&model[0]) <= 0)
+        {
+            fprintf(stderr, "test_net_numa_node load failed node %d\n", i);
+            return -1;
+        }
+
+        ncnn::Mat out1;
+        {
+            ncnn::Extractor ex = net1.create_extractor();
+            ex.input("data", in);
+            ex.extract("out", out1);
+        }
+
+        if (compare_mat(out0, out1, 0.f) != 0)
+        {
+            fprintf(stderr, "test_net_numa_node output mismatch node %d\n", i);
+            return -1;
+        }
+
+        if (check_caller_mask)
+        {
+            ncnn::CpuSet mask;
+            ncnn::get_current_thread_affinity(mask);
+            if (!same_cpu_set(mask, pinned_mask))
+            {
+                fprintf(stderr, "test_net_numa_node caller affinity changed node %d\n", i);
+                return -1;
+            }
+        }
+    }
+
+    if (check_caller_mask)
+    {
+        ncnn::set_current_thread_affinity(caller_mask);
+    }
+
+    return 0;
+}
+
+static int test_net_branch_parallel()
+{
+    std::vector<float> model;
+    append_weight(model, 108, true);
+    append_weight(model, 4, false);
+    append_weight(model, 12, true);
+    append_weight(model, 4, false);
+
+    ncnn::Net net;
+    net.opt.num_threads = 4;
+    net.load_param_mem(test_net_branch_param);
+    if (net.load_model((const unsigned char*)&model[0]) <= 0)
+    {
+        fprintf(stderr, "test_net_branch_parallel load failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in(7, 9, 3);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    ncnn::Mat out0;
+    {
+        ncnn::Extractor ex = net.create_extractor();
+        ex.input("data", in);
+        ex.extract("out", out0);
+    }
+
+    // the same extractor reuses its workers, and rebuilds them when the count changes
+    ncnn::Extractor ex = net.create_extractor();
+    const int branch_counts[4] = {2, 2, 4, 2};
+    for (int i = 0; i < 4; i++)
+    {
+        ex.reset();
+        ex.set_branch_parallel(branch_counts[i]);
+        ex.input("data", in);
+
+        ncnn::Mat out1;
+        int ret = ex.extract("out", out1);
+        if (ret != 0 || compare_mat(out0, out1, 0.f) != 0)
+        {
+            fprintf(stderr, "test_net_branch_parallel output mismatch branch_count=%d\n", branch_counts[i]);
+            return -1;
+        }
+    }
+
+    // concurrent branches record through workspace allocators of their own
+    ex.reset();
+    ex.set_branch_parallel(2);
+    ex.set_profiling(true);
+    ex.input("data", in);
+
+    ncnn::Mat out2;
+    if (ex.extract("out", out2) != 0 || compare_mat(out0, out2, 0.f) != 0 || ex.layer_profiles().size() != net.layers().size() - 1)
+    {
+        fprintf(stderr, "test_net_branch_parallel profiling failed\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_net_kvcache_forward(const ncnn::Net& net, const ncnn::Mat& in, const ncnn::Mat& cache_k, const ncnn::Mat& cache_v, ncnn::Mat& out, ncnn::Mat& out_cache_k, ncnn::Mat& out_cache_v)
+{
+    ncnn::Extractor ex = net.create_extractor();
+    ex.input("data", in);
+    ex.input("cache_k", cache_k);
+    ex.input("cache_v", cache_v);
+
+    int ret = ex.extract("out", out);
+    if (ret != 0)
+        return ret;
+
+    ret = ex.extract("out_cache_k", out_cache_k);
+    if (ret != 0)
+        return ret;
+
+    return ex.extract("out_cache_v", out_cache_v);
+}
+
+static int test_net_kvcache(bool use_packing_layout)
+{
+    std::vector<float> model;
+    for (int i = 0; i < 4; i++)
+    {
+        append_weight(model, 256, true);
+        append_weight(model, 16, false);
+    }
+
+    ncnn::Net net;
+    net.opt.num_threads = 1;
+    net.opt.use_packing_layout = use_packing_layout;
+    net.load_param_mem(test_net_kvcache_param);
+    if (net.load_model((const unsigned char*)&model[0]) <= 0)
+    {
+        fprintf(stderr, "test_net_kvcache load failed\n");
+        return -1;
+    }
+
+    ncnn::Mat in(16, 6);
+    for (int i = 0; i < (int)in.total(); i++)
+    {
+        in[i] = random_float();
+    }
+
+    // the first step takes zero-length caches
+    ncnn::Mat empty_cache(0, 16);
+
+    ncnn::Mat out_full;
+    ncnn::Mat cache_k_full;
+    ncnn::Mat cache_v_full;
+    int ret = test_net_kvcache_forward(net, in, empty_cache, empty_cache, out_full, cache_k_full, cache_v_full);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_net_kvcache full forward failed\n");
+        return -1;
+    }
+
+    // four tokens as the first step, then two incremental tokens on the grown cache
+    ncnn::Mat out0;
+    ncnn::Mat cache_k0;
+    ncnn::Mat cache_v0;
+    ret = test_net_kvcache_forward(net, in.row_range(0, 4).clone(), empty_cache, empty_cache, out0, cache_k0, cache_v0);
+    if (ret != 0 || cache_k0.w != 4 || cache_v0.w != 4)
+    {
+        fprintf(stderr, "test_net_kvcache first step failed\n");
+        return -1;
+    }
+
+    ncnn::Mat out1;
+    ncnn::Mat cache_k1;
+    ncnn::Mat cache_v1;
+    ret = test_net_kvcache_forward(net, in.row_range(4, 2).clone(), cache_k0, cache_v0, out1, cache_k1, cache_v1);
+    if (ret != 0)
+    {
+        fprintf(stderr, "test_net_kvcache incremental step failed\n");
+        return -1;
+    }
+
+    if (compare_mat(out_full.row_range(0, 4).clone(), out0) != 0
+            || compare_mat(out_full.row_range(4, 2).clone(), out1) != 0
+            || compare_mat(cache_k_full, cache_k1) != 0
+            || compare_mat(cache_v_full, cache_v1) != 0)
+    {
+        fprintf(stderr, "test_net_kvcache output mismatch use_packing_layout=%d\n", use_packing_layout);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    for (int i = 0; i < 4; i++)
+    {
+        ncnn::Option opt;
+        opt.num_threads = 1;
+        opt.use_packing_layout = i / 2 == 0;
+        opt.lightmode = i % 2 == 0;
+
+        int ret = 0
+                  || test_net_batch(opt, 1)
+                  || test_net_batch(opt, 4)
+                  || test_net_batch(opt, 9);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0
+           || test_net_batch_mismatch()
+           || test_net_load_model_mmap()
+           || test_net_parallel_create_pipeline(1)
+           || test_net_parallel_create_pipeline(4)
+           || test_net_weight_cache()
+           || test_net_weight_cache_bf16()
+           || test_net_profiling()
+           || test_net_extractor_reuse(false)
+           || test_net_extractor_reuse(true)
+           || test_net_extractor_arena(false)
+           || test_net_extractor_arena(true)
+           || test_net_numa_node()
+           || test_net_branch_parallel()
+           || test_net_kvcache(false)
+           || test_net_kvcache(true);
+}
@@ -31,7 +31,8 @@ static int test_pixelshuffle_0()
            || test_pixelshuffle(RandomMat(7, 7, 48), 2, 0)
            || test_pixelshuffle(RandomMat(7, 7, 36), 3, 0)
            || test_pixelshuffle(RandomMat(7, 7, 72), 3, 0)
-           || test_pixelshuffle(RandomMat(7, 7, 90), 3, 0);
+           || test_pixelshuffle(RandomMat(7, 7, 90), 3, 0)
+           || test_pixelshuffle(RandomMat(5, 4, 128), 2, 0);
 }
 
 static int test_pixelshuffle_1()
@@ -44,7 +45,8 @@ static int test_pixelshuffle_1()
            || test_pixelshuffle(RandomMat(7, 7, 32), 2, 1)
            || test_pixelshuffle(RandomMat(7, 7, 48), 2, 1)
            || test_pixelshuffle(RandomMat(7, 7, 36), 3, 1)
-           || test_pixelshuffle(RandomMat(7, 7, 90), 3, 1);
+           || test_pixelshuffle(RandomMat(7, 7, 90), 3, 1)
+           || test_pixelshuffle(RandomMat(5, 4, 128), 2, 1);
 }
 
 int main()
@@ -3,6 +3,8 @@
 
 #include "testutil.h"
 
+#include <math.h>
+
 static int test_spectrogram(int size, int n_fft, int power, int hoplen, int winlen, int window_type, int center, int pad_type, int normalized, int onesided)
 {
     ncnn::Mat a = RandomMat(size);
@@ -36,12 +38,115 @@ static int test_spectrogram_0()
            || test_spectrogram(39, 17, 0, 7, 15, 0, 0, 0, 1, 0)
            || test_spectrogram(128, 10, 0, 2, 7, 1, 1, 1, 1, 1)
            || test_spectrogram(255, 17, 1, 14, 17, 2, 0, 0, 0, 1)
-           || test_spectrogram(124, 55, 2, 12, 55, 1, 1, 2, 2, 0);
+           || test_spectrogram(124, 55, 2, 12, 55, 1, 1, 2, 2, 0)
+           || test_spectrogram(1600, 400, 0, 160, 400, 1, 1, 2, 2, 1)
+           || test_spectrogram(2048, 512, 2, 128, 480, 1, 1, 2, 0, 0);
+}
+
+// compare against a naive dft in double precision
+static int test_spectrogram_dft(int n_fft, int onesided)
+{
+    const int hoplen = n_fft / 3 + 1;
+    const int size = n_fft * 2 + hoplen;
+
+    ncnn::Mat a = RandomMat(size);
+
+    ncnn::ParamDict pd;
+    pd.set(0, n_fft);
+    pd.set(1, 0);
+    pd.set(2, hoplen);
+    pd.set(3, n_fft);
+    pd.set(4, 0);
+    pd.set(5, 0);
+    pd.set(7, 1);
+    pd.set(8, onesided);
+
+    std::vector<ncnn::Mat> weights(0);
+
+    ncnn::Option opt;
+    opt.num_threads = 1;
+
+    ncnn::Layer* op = ncnn::create_layer_cpu("Spectrogram");
+
+    op->load_param(pd);
+
+    ncnn::ModelBinFromMatArray mb(weights.data());
+
+    op->load_model(mb);
+
+    op->create_pipeline(opt);
+
+    ncnn::Mat b;
+    op->forward(a, b, opt);
+
+    op->destroy_pipeline(opt);
+
+    delete op;
+
+    const int frames = (size - n_fft) / hoplen + 1;
+    const int freqs = onesided ? n_fft / 2 + 1 : n_fft;
+
+    if (b.dims != 3 || b.w != 2 || b.h != frames || b.c != freqs)
+    {
+        fprintf(stderr, "test_spectrogram_dft failed n_fft=%d onesided=%d shape=(%d %d %d)\n", n_fft, onesided, b.w, b.h, b.c);
+        return -1;
+    }
+
+    double max_error = 0.0;
+    for (int i = 0; i < freqs; i++)
+    {
+        for (int j = 0; j < frames; j++)
+        {
+            const float* ptr = (const float*)a + j * hoplen;
+
+            double re = 0.0;
+            double im = 0.0;
+            for (int k = 0; k < n_fft; k++)
+            {
+                const double angle = -2.0 * 3.14159265358979323846 * (double)((long)i * k % n_fft) / n_fft;
+                re += ptr[k] * cos(angle);
+                im += ptr[k] * sin(angle);
+            }
+            re /= sqrt((double)n_fft);
+            im /= sqrt((double)n_fft);
+
+            const float* outptr = b.channel(i).row(j);
+            max_error = std::max(max_error, fabs(outptr[0] - re));
+            max_error = std::max(max_error, fabs(outptr[1] - im));
+        }
+    }
+
+    if (max_error > 6e-6)
+    {
+        fprintf(stderr, "test_spectrogram_dft failed n_fft=%d onesided=%d max_error=%g\n", n_fft, onesided, max_error);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int test_spectrogram_1()
+{
+    // odd, prime and mixed radix sizes
+    static const int n_ffts[8] = {7, 12, 30, 64, 97, 100, 400, 512};
+
+    for (int i = 0; i < 8; i++)
+    {
+        int ret = 0
+                  || test_spectrogram_dft(n_ffts[i], 0)
+                  || test_spectrogram_dft(n_ffts[i], 1);
+        if (ret != 0)
+            return ret;
+    }
+
+    return 0;
 }
 
 int main()
 {
     SRAND(7767517);
 
-    return test_spectrogram_0();
+    return 0
+           || test_spectrogram_0()
+           || test_spectrogram_1();
 }
@@ -230,6 +230,37 @@ static int test_squeezenet(const ncnn::Option& opt, int load_model_type, float e
     return check_top2(cls_scores, epsilon);
 }
 
+static int test_squeezenet_branch_parallel(const ncnn::Option& opt, int branch_count, float epsilon = 0.001)
+{
+    ncnn::Net squeezenet;
+
+    squeezenet.opt = opt;
+
+    squeezenet.load_param(MODEL_DIR "/squeezenet_v1.1.param");
+    squeezenet.load_model(MODEL_DIR "/squeezenet_v1.1.bin");
+
+    ncnn::Mat in = generate_ncnn_logo(ncnn::Mat::PIXEL_BGR, 227, 227);
+
+    const float mean_vals[3] = {104.f, 117.f, 123.f};
+    in.substract_mean_normalize(mean_vals, 0);
+
+    ncnn::Extractor ex = squeezenet.create_extractor();
+    ex.set_branch_parallel(branch_count);
+
+    ncnn::Mat out;
+    ex.input("data", in);
+    ex.extract("prob", out);
+
+    std::vector<float> cls_scores;
+    cls_scores.resize(out.w);
+    for (int j = 0; j < out.w; j++)
+    {
+        cls_scores[j] = out[j];
+    }
+
+    return check_top2(cls_scores, epsilon);
+}
+
 class MyConvolution : public ncnn::Layer
 {
 public:
@@ -493,6 +524,13 @@ int main()
             return ret;
         }
 
+        ret = test_squeezenet_branch_parallel(opt_cpu, 4, epsilon);
+        if (ret != 0)
+        {
+            fprintf(stderr, "test_squeezenet_branch_parallel cpu failed use_packing_layout=%d use_fp16_packed=%d use_fp16_storage=%d use_shader_pack8=%d use_bf16_storage=%d\n", opt.use_packing_layout, opt.use_fp16_packed, opt.use_fp16_storage, opt.use_shader_pack8, opt.use_bf16_storage);
+            return ret;
+        }
+
 #if NCNN_VULKAN
         ret = test_squeezenet_overwrite_softmax(opt_gpu, load_model_types[i], epsilon);
         if (ret != 0)
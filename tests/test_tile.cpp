@@ -212,6 +212,25 @@ static int test_tile_3()
            || test_tile(c, IntArray(1, 3, 2, 2));
 }
 
+static int test_tile_4()
+{
+    // repeat along d without repeating c
+    ncnn::Mat a = RandomMat(5, 6, 7, 24);
+    ncnn::Mat b = RandomMat(7, 8, 9, 12);
+    ncnn::Mat c = RandomMat(3, 4, 5, 13);
+
+    return 0
+           || test_tile(a, IntArray(1, 3, 1, 1))
+           || test_tile(a, IntArray(1, 2, 2, 3))
+           || test_tile(a, IntArray(4, 1, 1))
+           || test_tile(b, IntArray(1, 2, 1, 1))
+           || test_tile(b, IntArray(2, 3, 1))
+           || test_tile(b, IntArray(1, 3, 1, 2))
+           || test_tile(c, IntArray(1, 4, 1, 1))
+           || test_tile(c, IntArray(3, 2, 2))
+           || test_tile(c, 1, 3);
+}
+
 int main()
 {
     SRAND(7767517);
@@ -220,5 +239,6 @@ int main()
            || test_tile_0()
            || test_tile_1()
            || test_tile_2()
-           || test_tile_3();
+           || test_tile_3()
+           || test_tile_4();
 }
@@ -1684,9 +1684,7 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             // write int8_scale data
             if (op->int8_scale_term)
             {
-                ncnn::Mat weight_data_int8_scales(1);
-                weight_data_int8_scales[0] = op->weight_data_int8_scale;
-                fwrite_weight_data(weight_data_int8_scales, bp, 90, 100);
+                fwrite_weight_data(op->weight_data_int8_scales, bp, 90, 100);
             }
 #endif // NCNN_INT8
         }
@@ -2039,6 +2037,8 @@ int ModelWriter::save(const char* parampath, const char* binpath)
             fprintf_param_value(" 4=%d", vdim)
             fprintf_param_value(" 5=%d", attn_mask)
             fprintf_param_value(" 6=%e", scale)
+            fprintf_param_value(" 7=%d", causal)
+            fprintf_param_value(" 8=%d", kv_cache)
             fprintf_param_value(" 18=%d", int8_scale_term)
 
             fwrite_weight_tag_data(op->q_weight_data, bp);
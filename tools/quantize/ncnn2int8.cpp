@@ -572,33 +572,37 @@ int NetQuantize::quantize_embed()
         const int num_output = embed->num_output;
         const int input_dim = embed->input_dim;
 
-        ncnn::Mat weight_data_int8_scales(1);
+        // one scale per row
+        ncnn::Mat weight_data_int8_scales(input_dim);
+        for (int q = 0; q < input_dim; q++)
         {
-            const float* ptr = embed->weight_data;
+            const float* ptr = (const float*)embed->weight_data + num_output * q;
             float absmax = 0.f;
-            for (int i = 0; i < embed->weight_data.w; i++)
+            for (int i = 0; i < num_output; i++)
             {
                 absmax = std::max(absmax, (float)fabs(ptr[i]));
             }
 
-            weight_data_int8_scales[0] = absmax == 0.f ? 1.f : 127 / absmax;
+            weight_data_int8_scales[q] = absmax == 0.f ? 1.f : 127 / absmax;
         }
 
         {
+            ncnn::Mat weight_data_r2 = embed->weight_data.reshape(num_output, input_dim);
+
             ncnn::Mat weight_data_int8;
 
             ncnn::Option opt_q = opt;
             opt_q.blob_allocator = embed->weight_data.allocator;
             opt_q.use_packing_layout = false;
-            ncnn::quantize_to_int8(embed->weight_data, weight_data_int8, weight_data_int8_scales, opt_q);
+            ncnn::quantize_to_int8(weight_data_r2, weight_data_int8, weight_data_int8_scales, opt_q);
             if (weight_data_int8.empty())
                 return -100;
 
-            embed->weight_data = weight_data_int8;
+            embed->weight_data = weight_data_int8.reshape(embed->weight_data_size);
         }
 
-        embed->int8_scale_term = 2;
-        embed->weight_data_int8_scale = weight_data_int8_scales[0];
+        embed->int8_scale_term = 3;
+        embed->weight_data_int8_scales = weight_data_int8_scales;
     }
 
     return 0;